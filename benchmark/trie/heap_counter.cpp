@@ -0,0 +1,60 @@
+﻿// benchmark/trie/heap_counter.cpp
+
+#include "heap_counter.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::size_t live = 0;
+	std::size_t peak = 0;
+
+	// 確保した大きさを delete で知るため、各ブロックの前に置く
+	constexpr std::size_t header = alignof(std::max_align_t);
+
+	void* allocate(std::size_t n) noexcept
+	{
+		void* p = std::malloc(n + header);
+		if (p == nullptr) return nullptr;
+
+		*static_cast<std::size_t*>(p) = n;
+		live += n;
+		if (peak < live) peak = live;
+
+		return static_cast<char*>(p) + header;
+	}
+
+	void deallocate(void* p) noexcept
+	{
+		if (p == nullptr) return;
+
+		p = static_cast<char*>(p) - header;
+		live -= *static_cast<std::size_t*>(p);
+		std::free(p);
+	}
+}
+
+std::size_t heap_live_bytes() noexcept { return live; }
+
+std::size_t heap_peak_bytes() noexcept { return peak; }
+
+void reset_heap_peak() noexcept { peak = live; }
+
+void* operator new(std::size_t n)
+{
+	if (void* p = allocate(n)) return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n) { return operator new(n); }
+void* operator new(std::size_t n, std::nothrow_t const&) noexcept { return allocate(n); }
+void* operator new[](std::size_t n, std::nothrow_t const&) noexcept { return allocate(n); }
+
+void operator delete(void* p) noexcept { deallocate(p); }
+void operator delete[](void* p) noexcept { deallocate(p); }
+void operator delete(void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete(void* p, std::nothrow_t const&) noexcept { deallocate(p); }
+void operator delete[](void* p, std::nothrow_t const&) noexcept { deallocate(p); }
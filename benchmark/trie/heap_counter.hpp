@@ -0,0 +1,20 @@
+﻿#pragma once
+
+#include <cstddef>
+
+/*! operator new で確保中のバイト数を返す
+
+コンテナごとのメモリ量を測るため、 heap_counter.cpp で大域の operator new / delete を置き換えて数える。
+常駐セット・サイズと違い、解放済みの領域の再利用に左右されない。
+置き換えた演算子が呼び出し側へインライン展開されないよう、別の翻訳単位に置く。
+計測は単一スレッドで行うため、排他しない。
+*/
+std::size_t heap_live_bytes() noexcept;
+
+/*! 最後に reset_heap_peak() を呼んでから、確保中のバイト数が最も多かった時の値を返す
+*/
+std::size_t heap_peak_bytes() noexcept;
+
+/*! 最大値を現在の確保中のバイト数に戻す
+*/
+void reset_heap_peak() noexcept;
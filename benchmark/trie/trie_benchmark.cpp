@@ -0,0 +1,700 @@
+﻿// benchmark/trie/trie_benchmark.cpp
+
+#include <wordring/string/atom.hpp>
+#include <wordring/string/matcher.hpp>
+#include <wordring/tree/tree_iterator.hpp>
+#include <wordring/trie/trie.hpp>
+#include <wordring/trie/trie_builder.hpp>
+#include <wordring/trie/trie_page_vector.hpp>
+
+#include <wordring/whatwg/infra/unicode.hpp>
+
+#include "heap_counter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#define STRING(str) #str
+#define TO_STRING(str) STRING(str)
+
+namespace
+{
+	std::string const english_words_path{ TO_STRING(ENGLISH_WORDS_PATH) };
+	std::string const japanese_words_path{ TO_STRING(JAPANESE_WORDS_PATH) };
+
+	/*! コマンドラインの指定
+	*/
+	struct options
+	{
+		std::string m_output;               // JSONの出力先、空の場合は標準出力
+		std::size_t m_limit         = 0;    // データセットのキー数の上限、0の場合は全て
+		std::size_t m_matcher_limit = 1000; // string_matcher に登録するキー数の上限
+		std::size_t m_urls          = 200000;
+		std::size_t m_wide          = 300000;
+		std::size_t m_repeats       = 5;    // 各操作の計測回数（ウォームアップを除く）
+	};
+
+	/*! コンテナとデータセットの組ごとの計測結果
+	- m_ops は操作名と1操作当たりのナノ秒（計測回数の中央値）の組。
+	  insert_p50 などは、一回毎に計った挿入時間の分位点。
+	- m_heap_bytes は構築したコンテナが保持するヒープのバイト数。
+	  trie_page_allocator が直接マップしたページは含まない。
+	- m_heap_peak は構築中に一時的に使ったものを含む、ヒープのバイト数の最大値。
+	- m_peak_rss は計測を終えた時点のプロセスの最大常駐セット・サイズ。
+	*/
+	struct result
+	{
+		result(std::string container, std::string dataset, std::size_t keys)
+			: m_container(std::move(container))
+			, m_dataset(std::move(dataset))
+			, m_keys(keys)
+		{
+		}
+
+		std::string m_container;
+		std::string m_dataset;
+		std::size_t m_keys          = 0;
+		double      m_bytes_per_key = 0;
+		std::size_t m_heap_bytes    = 0;
+		std::size_t m_heap_peak     = 0;
+		std::size_t m_peak_rss      = 0;
+
+		std::vector<std::pair<std::string, double>> m_ops;
+	};
+
+	/*! 整列済みで重複の無いキーと、同じキーを乱数で並べ替えたもの
+	*/
+	template <typename String>
+	struct dataset
+	{
+		std::string         m_name;
+		std::vector<String> m_keys;
+		std::vector<String> m_shuffled;
+	};
+
+	// 最適化で計測対象が消されないよう、結果を集める
+	std::size_t volatile sink = 0;
+
+	void consume(std::size_t n) { sink = sink + n; }
+
+	/*! プロセスの最大常駐セット・サイズを返す
+	- 取得できない場合、0を返す。
+	*/
+	std::size_t peak_rss()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS pmc;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return pmc.PeakWorkingSetSize;
+		return 0;
+#else
+		struct rusage ru;
+		if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+#ifdef __APPLE__
+		return static_cast<std::size_t>(ru.ru_maxrss);
+#else
+		return static_cast<std::size_t>(ru.ru_maxrss) * 1024;
+#endif
+#endif
+	}
+
+	/*! fn の前後で、保持するヒープのバイト数と、その間の最大値を r に記録する
+	- 計測の繰り返しで作り直すコンテナは、 fn の中で前のものを解放してから作る。
+	*/
+	template <typename Function>
+	void measure_heap(result& r, Function fn)
+	{
+		std::size_t live = heap_live_bytes();
+		reset_heap_peak();
+
+		fn();
+
+		r.m_heap_bytes = heap_live_bytes() < live ? 0 : heap_live_bytes() - live;
+		r.m_heap_peak = heap_peak_bytes() - live;
+		r.m_peak_rss = peak_rss();
+	}
+
+	/*! fnを計測し、n操作当たりのナノ秒を返す
+
+	- 最初の一回はウォームアップとして計測しない。
+	- 続けて repeats 回計測し、中央値を使う。
+	- 毎回 fn の前に setup を実行し、その時間は含めない。
+	*/
+	template <typename Setup, typename Function>
+	double measure(std::size_t n, std::size_t repeats, Setup setup, Function fn)
+	{
+		std::vector<double> v;
+		for (std::size_t i = 0; i <= repeats; ++i)
+		{
+			setup();
+
+			auto start = std::chrono::steady_clock::now();
+			fn();
+			auto duration = std::chrono::steady_clock::now() - start;
+
+			if (i != 0) v.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+		}
+
+		if (n == 0) return 0;
+
+		std::sort(v.begin(), v.end());
+		double median = (v.size() % 2 == 1)
+			? v[v.size() / 2]
+			: (v[v.size() / 2 - 1] + v[v.size() / 2]) / 2;
+
+		return median / n;
+	}
+
+	template <typename Function>
+	double measure(std::size_t n, std::size_t repeats, Function fn)
+	{
+		return measure(n, repeats, []() {}, fn);
+	}
+
+	template <typename String>
+	dataset<String> make_dataset(std::string name, std::vector<String> keys, options const& opt)
+	{
+		dataset<String> result{ std::move(name), std::move(keys), {} };
+
+		std::sort(result.m_keys.begin(), result.m_keys.end());
+		result.m_keys.erase(std::unique(result.m_keys.begin(), result.m_keys.end()), result.m_keys.end());
+		if (!result.m_keys.empty() && result.m_keys.front().empty()) result.m_keys.erase(result.m_keys.begin());
+
+		result.m_shuffled = result.m_keys;
+		std::shuffle(result.m_shuffled.begin(), result.m_shuffled.end(), std::mt19937());
+
+		if (opt.m_limit != 0 && opt.m_limit < result.m_keys.size())
+		{
+			result.m_shuffled.resize(opt.m_limit);
+			result.m_keys = result.m_shuffled;
+			std::sort(result.m_keys.begin(), result.m_keys.end());
+		}
+
+		return result;
+	}
+
+	std::vector<std::string> read_lines(std::string const& path)
+	{
+		std::vector<std::string> result;
+
+		std::ifstream is(path);
+		if (!is.is_open())
+		{
+			std::cerr << "cannot open " << path << std::endl;
+			std::exit(EXIT_FAILURE);
+		}
+
+		std::string buf;
+		while (std::getline(is, buf))
+		{
+			if (!buf.empty() && buf.back() == '\r') buf.pop_back();
+			if (!buf.empty()) result.push_back(buf);
+		}
+
+		return result;
+	}
+
+	/*! 英単語から URL 風のキーを作る
+	- 少数のホスト名と、単語を連ねたパスを持つため、長い共通接頭辞を共有する。
+	*/
+	std::vector<std::string> make_urls(std::vector<std::string> const& words, std::size_t n)
+	{
+		std::mt19937 mt(1);
+		auto word = [&]() -> std::string const& { return words[mt() % words.size()]; };
+
+		std::vector<std::string> hosts;
+		for (char const* tld : { ".com", ".org", ".net", ".co.jp", ".io" })
+		{
+			for (int i = 0; i < 20; ++i) hosts.push_back("https://www." + word() + tld);
+		}
+
+		std::vector<std::string> result;
+		result.reserve(n);
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			std::string s = hosts[mt() % hosts.size()];
+			for (std::uint32_t j = mt() % 4; j != static_cast<std::uint32_t>(-1); --j) s += "/" + word();
+			if (mt() % 2) s += "?id=" + std::to_string(mt() % 100000);
+			result.push_back(std::move(s));
+		}
+
+		return result;
+	}
+
+	/*! 250種のバイトから乱数でキーを作る
+	- 子の数が多いノードが多くなるため、子の並びを置く位置の探索が支配的になる。
+	*/
+	std::vector<std::string> make_wide(std::size_t n)
+	{
+		std::mt19937 mt(2);
+
+		std::vector<std::string> result;
+		result.reserve(n);
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			std::string s(mt() % 6 + 2, '\0');
+			for (char& ch : s) ch = static_cast<char>(mt() % 250 + 1);
+			result.push_back(std::move(s));
+		}
+
+		return result;
+	}
+
+	// ------------------------------------------------------------------------
+	// 計測
+	// ------------------------------------------------------------------------
+
+	/*! Builder は Trie を構築する basic_trie_builder
+	*/
+	template <typename Trie, typename Builder, typename String>
+	result run_trie(std::string name, dataset<String> const& ds, options const& opt)
+	{
+		using namespace wordring;
+
+		auto const& keys = ds.m_keys;
+		auto const& shuffled = ds.m_shuffled;
+		std::size_t const n = keys.size();
+		std::size_t const k = opt.m_repeats;
+
+		result r(std::move(name), ds.m_name, n);
+
+		double build = 0;
+		Trie t1;
+		measure_heap(r, [&]() { build = measure(n, k, [&]() { t1 = Trie(); }, [&]() { t1 = Trie(keys.begin(), keys.end()); }); });
+		r.m_ops.emplace_back("build", build);
+
+		Trie t4;
+		r.m_ops.emplace_back("builder", measure(n, k, [&]() { t4 = Trie(); }, [&]()
+		{
+			Builder b;
+			for (auto const& s : keys) b.push_back(s);
+			t4 = b.finish();
+		}));
+		consume(t4.size());
+
+		auto stats = t1.stats();
+		r.m_bytes_per_key = n == 0 ? 0 : static_cast<double>(stats.m_bytes + stats.m_index_bytes) / n;
+
+		Trie t2;
+		r.m_ops.emplace_back("insert", measure(n, k, [&]() { t2 = Trie(); }, [&]() { for (auto const& s : shuffled) t2.insert(s); }));
+
+		// 一回毎の挿入時間を計り、配列の伸長による遅延を分位点で記録する
+		std::vector<double> latency;
+		latency.reserve(n);
+		t2 = Trie();
+		for (auto const& s : shuffled)
+		{
+			auto start = std::chrono::steady_clock::now();
+			t2.insert(s);
+			auto duration = std::chrono::steady_clock::now() - start;
+			latency.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+		}
+		std::sort(latency.begin(), latency.end());
+
+		auto percentile = [&](double p) { return latency.empty() ? 0 : latency[static_cast<std::size_t>(p * (latency.size() - 1))]; };
+		r.m_ops.emplace_back("insert_p50", percentile(0.5));
+		r.m_ops.emplace_back("insert_p99", percentile(0.99));
+		r.m_ops.emplace_back("insert_p99_9", percentile(0.999));
+		r.m_ops.emplace_back("insert_max", percentile(1));
+
+		r.m_ops.emplace_back("find", measure(n, k, [&]()
+		{
+			std::size_t m = 0;
+			for (auto const& s : shuffled) m += t1.contains(s);
+			consume(m);
+		}));
+
+		r.m_ops.emplace_back("search", measure(n, k, [&]()
+		{
+			std::size_t m = 0;
+			for (auto const& s : shuffled) m += t1.search(s.begin(), s.begin() + (s.size() + 1) / 2) != t1.end();
+			consume(m);
+		}));
+
+		r.m_ops.emplace_back("iterate", measure(n, k, [&]()
+		{
+			using iterator = tree_iterator<typename Trie::const_iterator>;
+
+			std::size_t m = 0;
+			for (auto it = iterator(t1.begin()); it != iterator(); ++it) m += static_cast<bool>(it.base());
+			consume(m);
+		}));
+
+		r.m_ops.emplace_back("leaf_iterate", measure(n, k, [&]()
+		{
+			std::size_t m = 0;
+			for (auto it = t1.leaf_begin(); it != t1.leaf_end(); ++it) ++m;
+			consume(m);
+		}));
+
+		// 無作為な位置から10語ずつ列挙する
+		auto lower_bound = [&]()
+		{
+			return measure(n, k, [&]()
+			{
+				std::size_t m = 0;
+				for (auto const& s : shuffled)
+				{
+					auto it = t1.lower_bound(s);
+					for (int j = 0; j < 10 && it != t1.leaf_end(); ++j, ++it) ++m;
+				}
+				consume(m);
+			});
+		};
+
+		r.m_ops.emplace_back("lower_bound_10", lower_bound());
+		t1.use_sibling_table(true);
+		r.m_ops.emplace_back("lower_bound_10_sibling_table", lower_bound());
+		t1.use_sibling_table(false);
+
+		// 二文字目を置き換えた100語で、編集距離1と2の近似検索を計る
+		std::vector<String> fuzzy;
+		for (std::size_t i = 0; i < n; i += n / 100 + 1)
+		{
+			String s = shuffled[i];
+			if (1 < s.size()) s[1] = s[0];
+			fuzzy.push_back(s);
+		}
+
+		auto fuzzy_search = [&](std::uint32_t distance)
+		{
+			return measure(fuzzy.size(), k, [&]()
+			{
+				std::size_t m = 0;
+				for (auto const& s : fuzzy)
+				{
+					std::vector<std::tuple<String, std::uint32_t, std::uint32_t>> v;
+					t1.fuzzy_search(s, distance, std::back_inserter(v));
+					m += v.size();
+				}
+				consume(m);
+			});
+		};
+
+		r.m_ops.emplace_back("fuzzy_search_1", fuzzy_search(1));
+		r.m_ops.emplace_back("fuzzy_search_2", fuzzy_search(2));
+		t1.use_sibling_table(true);
+		r.m_ops.emplace_back("fuzzy_search_2_sibling_table", fuzzy_search(2));
+		t1.use_sibling_table(false);
+
+		std::stringstream ss;
+		Trie t3;
+		r.m_ops.emplace_back("serialize", measure(n, k, [&]() { ss.str(""); ss.clear(); }, [&]() { ss << t1; }));
+		r.m_ops.emplace_back("deserialize", measure(n, k, [&]() { ss.clear(); ss.seekg(0); t3 = Trie(); }, [&]() { ss >> t3; }));
+		consume(t3.size());
+
+		std::stringstream bulk;
+		r.m_ops.emplace_back("write", measure(n, k, [&]() { bulk.str(""); bulk.clear(); }, [&]() { t1.write(bulk); }));
+		r.m_ops.emplace_back("read", measure(n, k, [&]() { bulk.clear(); bulk.seekg(0); t3 = Trie(); }, [&]() { t3.read(bulk); }));
+		consume(t3.size());
+
+		r.m_ops.emplace_back("erase", measure(n, k, [&]() { t2 = t1; }, [&]() { for (auto const& s : shuffled) t2.erase(s); }));
+
+		return r;
+	}
+
+	template <typename String>
+	result run_atom_set(std::string name, dataset<String> const& ds, options const& opt)
+	{
+		using namespace wordring;
+		using atom_set = basic_atom_set<String>;
+		using view_type = std::basic_string_view<typename String::value_type>;
+
+		auto const& keys = ds.m_keys;
+		auto const& shuffled = ds.m_shuffled;
+		std::size_t const n = keys.size();
+		std::size_t const k = opt.m_repeats;
+
+		result r(std::move(name), ds.m_name, n);
+
+		double build = 0;
+		atom_set as1;
+		measure_heap(r, [&]() { build = measure(n, k, [&]() { as1 = atom_set(); }, [&]() { as1 = atom_set(keys.begin(), keys.end()); }); });
+		r.m_ops.emplace_back("build", build);
+
+		auto stats = as1.stats();
+		r.m_bytes_per_key = n == 0 ? 0 : static_cast<double>(stats.m_bytes + stats.m_index_bytes) / n;
+
+		atom_set as2;
+		r.m_ops.emplace_back("insert", measure(n, k, [&]() { as2 = atom_set(); }, [&]() { for (auto const& s : shuffled) as2.insert(view_type(s)); }));
+
+		std::vector<std::uint32_t> ids;
+		ids.reserve(n);
+		r.m_ops.emplace_back("find", measure(n, k, [&]() { ids.clear(); }, [&]() { for (auto const& s : shuffled) ids.push_back(as1.at(view_type(s))); }));
+
+		r.m_ops.emplace_back("string", measure(n, k, [&]()
+		{
+			std::size_t m = 0;
+			String s;
+			for (std::uint32_t id : ids) m += as1.at(id).string(s).size();
+			consume(m);
+		}));
+
+		as1.use_string_pool();
+		r.m_ops.emplace_back("view", measure(n, k, [&]()
+		{
+			std::size_t m = 0;
+			for (std::uint32_t id : ids) m += as1.at(id).view().size();
+			consume(m);
+		}));
+		as1.use_string_pool(false);
+
+		std::stringstream ss;
+		atom_set as3;
+		r.m_ops.emplace_back("serialize", measure(n, k, [&]() { ss.str(""); ss.clear(); }, [&]() { ss << as1; }));
+		r.m_ops.emplace_back("deserialize", measure(n, k, [&]() { ss.clear(); ss.seekg(0); as3 = atom_set(); }, [&]() { ss >> as3; }));
+		consume(as3.size());
+
+		std::stringstream bulk;
+		r.m_ops.emplace_back("write", measure(n, k, [&]() { bulk.str(""); bulk.clear(); }, [&]() { as1.write(bulk); }));
+		r.m_ops.emplace_back("read", measure(n, k, [&]() { bulk.clear(); bulk.seekg(0); as3 = atom_set(); }, [&]() { as3.read(bulk); }));
+		consume(as3.size());
+
+		r.m_ops.emplace_back("erase", measure(n, k, [&]() { as2 = as1; }, [&]() { for (auto const& s : shuffled) as2.erase(view_type(s)); }));
+
+		return r;
+	}
+
+	/*! string_matcher は1文字ごとに全ての文字列と比較するため、キー数を m_matcher_limit に制限する
+	*/
+	template <typename String>
+	result run_string_matcher(std::string name, dataset<String> const& ds, options const& opt)
+	{
+		using namespace wordring;
+		using matcher = string_matcher<String>;
+
+		std::vector<String> keys(ds.m_shuffled.begin(), ds.m_shuffled.begin() + std::min(opt.m_matcher_limit, ds.m_shuffled.size()));
+		std::size_t const n = keys.size();
+		std::size_t const k = opt.m_repeats;
+
+		result r(std::move(name), ds.m_name, n);
+
+		double build = 0;
+		matcher m({});
+		measure_heap(r, [&]() { build = measure(n, k, [&]() { m = matcher({}); }, [&]() { m = matcher(keys.begin(), keys.end()); }); });
+		r.m_ops.emplace_back("build", build);
+
+		std::size_t bytes = 0;
+		for (auto const& s : keys) bytes += sizeof(typename matcher::container_entry) + s.capacity() * sizeof(typename String::value_type);
+		r.m_bytes_per_key = n == 0 ? 0 : static_cast<double>(bytes) / n;
+
+		r.m_ops.emplace_back("find", measure(n, k, [&]()
+		{
+			std::size_t found = 0;
+			for (auto const& s : keys)
+			{
+				m.clear();
+				for (auto ch : s)
+				{
+					auto ret = m.push_back(ch);
+					if (ret == matcher::match_result::partial) continue;
+					if (ret == matcher::match_result::succeed) ++found;
+					break;
+				}
+			}
+			consume(found);
+		}));
+
+		return r;
+	}
+
+	/*! データセットを全てのコンテナで計測する
+	- label はラベルの型名、 string は文字列の型名で、結果のコンテナ名に使う。
+	*/
+	template <typename String>
+	void run(dataset<String> const& ds, std::string const& label, std::string const& string, options const& opt, std::vector<result>& results)
+	{
+		using namespace wordring;
+
+		std::cerr << ds.m_name << " (" << ds.m_keys.size() << " keys)" << std::endl;
+
+		std::cerr << "\ttrie<" << label << ">" << std::endl;
+		results.push_back(run_trie<trie<typename String::value_type>, trie_builder<typename String::value_type>>("trie<" + label + ">", ds, opt));
+
+		std::cerr << "\tstable_trie<" << label << ">" << std::endl;
+		results.push_back(run_trie<stable_trie<typename String::value_type>, stable_trie_builder<typename String::value_type>>("stable_trie<" + label + ">", ds, opt));
+
+		// ノード配列をページ単位で確保するアロケータ
+		using page_allocator = detail::trie_page_allocator<detail::trie_node, false>;
+		using huge_page_allocator = detail::trie_page_allocator<detail::trie_node>;
+
+		std::cerr << "\ttrie<" << label << ", trie_page_allocator<trie_node, false>>" << std::endl;
+		results.push_back(run_trie<trie<typename String::value_type, page_allocator>, trie_builder<typename String::value_type, page_allocator>>(
+			"trie<" + label + ", trie_page_allocator<trie_node, false>>", ds, opt));
+
+		std::cerr << "\ttrie<" << label << ", trie_page_allocator<trie_node>>" << std::endl;
+		results.push_back(run_trie<trie<typename String::value_type, huge_page_allocator>, trie_builder<typename String::value_type, huge_page_allocator>>(
+			"trie<" + label + ", trie_page_allocator<trie_node>>", ds, opt));
+
+		std::cerr << "\tbasic_atom_set<" << string << ">" << std::endl;
+		results.push_back(run_atom_set("basic_atom_set<" + string + ">", ds, opt));
+
+		std::cerr << "\tstring_matcher<" << string << ">" << std::endl;
+		results.push_back(run_string_matcher("string_matcher<" + string + ">", ds, opt));
+	}
+
+	// ------------------------------------------------------------------------
+	// JSON
+	// ------------------------------------------------------------------------
+
+	std::string quote(std::string const& s)
+	{
+		std::string result(1, '"');
+		for (char ch : s)
+		{
+			if (ch == '"' || ch == '\\') result.push_back('\\');
+			result.push_back(ch);
+		}
+		result.push_back('"');
+		return result;
+	}
+
+	std::string compiler()
+	{
+#if defined(__clang__)
+		return "clang " __clang_version__;
+#elif defined(__GNUC__)
+		return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+		return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+		return "unknown";
+#endif
+	}
+
+	void write_json(std::ostream& os, std::vector<result> const& results, options const& opt)
+	{
+		os << std::fixed << std::setprecision(2);
+
+		os << "{\n";
+		os << "\t\"format\": 3,\n";
+		os << "\t\"compiler\": " << quote(compiler()) << ",\n";
+#ifdef NDEBUG
+		os << "\t\"ndebug\": true,\n";
+#else
+		os << "\t\"ndebug\": false,\n";
+#endif
+		os << "\t\"limit\": " << opt.m_limit << ",\n";
+		os << "\t\"repeats\": " << opt.m_repeats << ",\n";
+		os << "\t\"peak_rss_bytes\": " << peak_rss() << ",\n";
+		os << "\t\"results\": [";
+
+		for (std::size_t i = 0; i < results.size(); ++i)
+		{
+			result const& r = results[i];
+
+			os << (i == 0 ? "\n" : ",\n");
+			os << "\t\t{\n";
+			os << "\t\t\t\"container\": " << quote(r.m_container) << ",\n";
+			os << "\t\t\t\"dataset\": " << quote(r.m_dataset) << ",\n";
+			os << "\t\t\t\"keys\": " << r.m_keys << ",\n";
+			os << "\t\t\t\"bytes_per_key\": " << r.m_bytes_per_key << ",\n";
+			os << "\t\t\t\"heap_bytes\": " << r.m_heap_bytes << ",\n";
+			os << "\t\t\t\"heap_peak_bytes\": " << r.m_heap_peak << ",\n";
+			os << "\t\t\t\"peak_rss_bytes\": " << r.m_peak_rss << ",\n";
+			os << "\t\t\t\"ns_per_op\": {";
+			for (std::size_t j = 0; j < r.m_ops.size(); ++j)
+			{
+				os << (j == 0 ? " " : ", ") << quote(r.m_ops[j].first) << ": " << r.m_ops[j].second;
+			}
+			os << " }\n";
+			os << "\t\t}";
+		}
+
+		os << "\n\t]\n";
+		os << "}\n";
+	}
+
+	void usage()
+	{
+		std::cerr
+			<< "usage: trie-benchmark [options]\n"
+			<< "\t--output <path>        JSON output path (default: stdout)\n"
+			<< "\t--limit <n>            use at most n keys per dataset\n"
+			<< "\t--matcher-limit <n>    use at most n keys for string_matcher (default: 1000)\n"
+			<< "\t--urls <n>             number of synthetic URL keys (default: 200000)\n"
+			<< "\t--wide <n>             number of random keys over 250 byte values (default: 300000)\n"
+			<< "\t--repeats <n>          timed runs per operation after one warm-up; the median is reported (default: 5)\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	using wordring::whatwg::encoding_cast;
+
+	options opt;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--help")
+		{
+			usage();
+			return EXIT_SUCCESS;
+		}
+		if (i + 1 == argc)
+		{
+			usage();
+			return EXIT_FAILURE;
+		}
+
+		std::string value = argv[++i];
+		if (arg == "--output") opt.m_output = value;
+		else if (arg == "--limit") opt.m_limit = std::stoul(value);
+		else if (arg == "--matcher-limit") opt.m_matcher_limit = std::stoul(value);
+		else if (arg == "--urls") opt.m_urls = std::stoul(value);
+		else if (arg == "--wide") opt.m_wide = std::stoul(value);
+		else if (arg == "--repeats") opt.m_repeats = std::max<std::size_t>(std::stoul(value), 1);
+		else
+		{
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::vector<result> results;
+
+	std::vector<std::string> english = read_lines(english_words_path);
+	run(make_dataset("english", english, opt), "char", "std::string", opt, results);
+
+	std::vector<std::u32string> japanese;
+	for (std::string const& s : read_lines(japanese_words_path)) japanese.push_back(encoding_cast<std::u32string>(s));
+	run(make_dataset("japanese", std::move(japanese), opt), "char32_t", "std::u32string", opt, results);
+
+	run(make_dataset("url", make_urls(english, opt.m_urls), opt), "char", "std::string", opt, results);
+
+	run(make_dataset("wide", make_wide(opt.m_wide), opt), "char", "std::string", opt, results);
+
+	if (opt.m_output.empty()) write_json(std::cout, results, opt);
+	else
+	{
+		std::ofstream os(opt.m_output);
+		if (!os.is_open())
+		{
+			std::cerr << "cannot open " << opt.m_output << std::endl;
+			return EXIT_FAILURE;
+		}
+		write_json(os, results, opt);
+	}
+
+	return EXIT_SUCCESS;
+}
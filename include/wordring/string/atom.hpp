@@ -3,9 +3,16 @@
 #include <wordring/compatibility.hpp>
 #include <wordring/trie/trie.hpp>
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <vector>
 
 namespace wordring
 {
@@ -15,6 +22,180 @@ namespace wordring
 
 namespace wordring::detail
 {
+	/*! @brief アトムIDから文字列を引く表
+
+	@tparam Label     文字の型
+	@tparam Allocator アロケータ
+
+	文字列を一つの連続した配列へ格納し、アトムID毎に位置と長さを記録する。
+	アトムIDはノードのINDEXであるため、位置と長さの表はノード配列と同じ長さを持つ。
+
+	- ノード一つにつき8バイトと、文字列の合計の長さを消費する。
+	- 削除された文字列の領域は、配列の半分を超えた時点で詰め直す。
+	- 表は basic_atom_set から再構築できるため、直列化されない。
+
+	@sa wordring::basic_atom_set::use_string_pool()
+	*/
+	template <typename Label, typename Allocator>
+	class basic_atom_string_pool
+	{
+	public:
+		using label_type = Label;
+		using view_type  = std::basic_string_view<label_type>;
+
+	protected:
+		struct slot
+		{
+			std::uint32_t m_offset;
+			std::uint32_t m_length;
+		};
+
+		using label_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<label_type>;
+		using slot_allocator  = typename std::allocator_traits<Allocator>::template rebind_alloc<slot>;
+
+	public:
+		explicit basic_atom_string_pool(Allocator const& alloc = Allocator())
+			: m_labels(label_allocator(alloc))
+			, m_slots(slot_allocator(alloc))
+			, m_garbage(0)
+			, m_enabled(false)
+		{
+		}
+
+		bool enabled() const noexcept { return m_enabled; }
+
+		/*! 表を使用するか設定する
+		- 使用しない場合、表の領域を解放する。
+		*/
+		void enable(bool enabled)
+		{
+			m_enabled = enabled;
+			if (!enabled)
+			{
+				std::vector<label_type, label_allocator>(m_labels.get_allocator()).swap(m_labels);
+				std::vector<slot, slot_allocator>(m_slots.get_allocator()).swap(m_slots);
+				m_garbage = 0;
+			}
+		}
+
+		/*! idの文字列を返す
+		- 記録されていない場合、空の文字列を返す。
+		*/
+		view_type view(std::uint32_t id) const noexcept
+		{
+			if (m_slots.size() <= id) return view_type();
+
+			slot s = m_slots[id];
+			return view_type(m_labels.data() + s.m_offset, s.m_length);
+		}
+
+		/*! idの文字列としてsvを記録する
+		*/
+		void assign(std::uint32_t id, view_type sv)
+		{
+			if (!m_enabled) return;
+
+			erase(id);
+			if (std::numeric_limits<std::uint32_t>::max() - m_labels.size() < sv.size()) throw std::length_error("");
+
+			if (m_slots.size() <= id) m_slots.resize(static_cast<std::size_t>(id) + 1, slot{ 0, 0 });
+			m_slots[id] = slot{ static_cast<std::uint32_t>(m_labels.size()), static_cast<std::uint32_t>(sv.size()) };
+			m_labels.insert(m_labels.end(), sv.begin(), sv.end());
+		}
+
+		/*! idの文字列を消す
+		*/
+		void erase(std::uint32_t id)
+		{
+			if (!m_enabled || m_slots.size() <= id) return;
+
+			m_garbage += m_slots[id].m_length;
+			m_slots[id] = slot{ 0, 0 };
+
+			if (m_labels.size() < m_garbage * 2) pack();
+		}
+
+		/*! fromの記録をtoへ移す
+		- 空遷移先のノードが移動した場合に使う。
+		*/
+		void move(std::uint32_t from, std::uint32_t to)
+		{
+			if (!m_enabled || m_slots.size() <= from) return;
+
+			if (m_slots.size() <= to) m_slots.resize(static_cast<std::size_t>(to) + 1, slot{ 0, 0 });
+			assert(m_slots[to].m_length == 0);
+			m_slots[to] = m_slots[from];
+			m_slots[from] = slot{ 0, 0 };
+		}
+
+		/*! 旧IDから新IDへの対応表に従って記録を移す
+		- 対応表の0は、そのIDが使われていなかったことを示す。
+		*/
+		template <typename Index>
+		void remap(std::vector<Index> const& remap)
+		{
+			if (!m_enabled) return;
+
+			std::vector<slot, slot_allocator> slots(m_slots.get_allocator());
+			for (std::size_t id = 0; id < m_slots.size() && id < remap.size(); ++id)
+			{
+				if (m_slots[id].m_length == 0 || remap[id] == 0) continue;
+
+				std::size_t to = static_cast<std::size_t>(remap[id]);
+				if (slots.size() <= to) slots.resize(to + 1, slot{ 0, 0 });
+				slots[to] = m_slots[id];
+			}
+			m_slots.swap(slots);
+		}
+
+		void clear() noexcept
+		{
+			m_labels.clear();
+			m_slots.clear();
+			m_garbage = 0;
+		}
+
+		/*! 表が確保しているバイト数を返す
+		*/
+		std::size_t bytes() const noexcept
+		{
+			return m_labels.capacity() * sizeof(label_type) + m_slots.capacity() * sizeof(slot);
+		}
+
+		void swap(basic_atom_string_pool& other)
+		{
+			m_labels.swap(other.m_labels);
+			m_slots.swap(other.m_slots);
+			std::swap(m_garbage, other.m_garbage);
+			std::swap(m_enabled, other.m_enabled);
+		}
+
+	protected:
+		/*! 削除された文字列の領域を詰める
+		*/
+		void pack()
+		{
+			std::vector<label_type, label_allocator> labels(m_labels.get_allocator());
+			labels.reserve(m_labels.size() - m_garbage);
+			for (slot& s : m_slots)
+			{
+				if (s.m_length == 0) continue;
+
+				std::uint32_t offset = static_cast<std::uint32_t>(labels.size());
+				labels.insert(labels.end(), m_labels.begin() + s.m_offset, m_labels.begin() + s.m_offset + s.m_length);
+				s.m_offset = offset;
+			}
+			m_labels.swap(labels);
+			m_garbage = 0;
+		}
+
+	protected:
+		std::vector<label_type, label_allocator> m_labels;
+		std::vector<slot, slot_allocator>        m_slots;
+		std::size_t                              m_garbage;
+		bool                                     m_enabled;
+	};
+
 	/*! @class basic_atom atom.hpp wordring/string/atom.hpp
 
 	@brief 文字列アトム
@@ -43,9 +224,12 @@ namespace wordring::detail
 		using typename base_type::index_type;
 		using typename base_type::node_type;
 
+		using pool_type = basic_atom_string_pool<typename String::value_type, Allocator>;
+
 	public:
 		using string_type = String;
 		using label_type  = typename string_type::value_type;
+		using view_type   = std::basic_string_view<label_type>;
 
 		using base_type::operator bool;
 		using base_type::operator !;
@@ -58,20 +242,24 @@ namespace wordring::detail
 	protected:
 		/*! @brief アトムを構築する
 
-		@param [in] it 基本クラスのイテレータ
+		@param [in] it   基本クラスのイテレータ
+		@param [in] pool 文字列表（使用しない場合 nullptr ）
 		*/
-		basic_atom(base_type it)
+		basic_atom(base_type it, pool_type const* pool = nullptr)
 			: base_type(it)
+			, m_pool(pool)
 		{
 		}
 
 		/*! @brief アトムを構築する
 
-		@param [in] c   ダブル・アレイの内部コンテナ
-		@param [in] idx ノードの索引
+		@param [in] c    ダブル・アレイの内部コンテナ
+		@param [in] idx  ノードの索引
+		@param [in] pool 文字列表（使用しない場合 nullptr ）
 		*/
-		basic_atom(container const& c, index_type idx)
+		basic_atom(container const& c, index_type idx, pool_type const* pool = nullptr)
 			: base_type(c, idx)
+			, m_pool(pool)
 		{
 		}
 
@@ -86,6 +274,7 @@ namespace wordring::detail
 		*/
 		basic_atom()
 			: base_type()
+			, m_pool(nullptr)
 		{
 		}
 
@@ -149,6 +338,8 @@ namespace wordring::detail
 		*/
 		operator string_type() const
 		{
+			if (m_pool != nullptr) return string_type(view());
+
 			string_type result;
 			base_type::string(result);
 			return result;
@@ -181,10 +372,52 @@ namespace wordring::detail
 		*/
 		string_type& string(string_type& result) const
 		{
-			if(m_index != 0) base_type::string(result);
+			if (m_pool != nullptr && m_index != 0)
+			{
+				// assign(view()) は GCC 12 で -Wrestrict の誤検知を出すため、resize してから複写する。
+				view_type v = view();
+				result.resize(v.size());
+				std::copy(v.begin(), v.end(), result.begin());
+			}
+			else if(m_index != 0) base_type::string(result);
 
 			return result;
 		}
+
+		/*! @brief アトムの文字列を参照する
+
+		@return アトムが文字列を持つ場合、その文字列への参照、それ以外の場合、空の文字列
+
+		文字列表を使うコンテナから取得したアトムでのみ文字列を返す。
+		既定構築したアトムや、文字列表を使わないコンテナから取得したアトムは、空の文字列を返す。
+		葉から根へ遡らず、文字列表を一度引くだけで文字列を返す。
+		参照は、コンテナへ文字列を挿入あるいは削除するまで有効である。
+
+		@sa wordring::basic_atom_set::use_string_pool()
+
+		@par 例
+		@code
+			// コンテナを構築し、文字列表を使う
+			std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+			auto as = basic_atom_set<std::u32string>(v.begin(), v.end());
+			as.use_string_pool();
+
+			// アトムの文字列を参照する
+			std::u32string_view sv = as.at(U"うあい").view();
+
+			// 検証
+			assert(sv == U"うあい");
+		@endcode
+		*/
+		view_type view() const
+		{
+			return (m_pool != nullptr && m_index != 0)
+				? m_pool->view(static_cast<std::uint32_t>(*this))
+				: view_type();
+		}
+
+	protected:
+		pool_type const* m_pool;
 	};
 
 	/* @brief 二つのアトムが等しいか調べる
@@ -258,18 +491,27 @@ namespace wordring
 	ibegin() の逆参照は32ビット整数値を返す。 ファイルへ保存するためにバイト列を必要とする場合、直列化イテレータを使う。
 
 	- @ref wordring::serialize_iterator
+
+	@par 文字列表
+
+	アトムを文字列へ繰り返し変換する場合、 use_string_pool() で文字列表を使うと、
+	basic_atom::view() によってO(1)で文字列を参照できる。
 	*/
 	template <typename String, typename Allocator = std::allocator<detail::trie_node>>
 	class basic_atom_set : public stable_trie<typename String::value_type>
 	{
+		template <typename String1, typename Allocator1>
+		friend std::istream& operator>>(std::istream&, basic_atom_set<String1, Allocator1>&);
+
 	protected:
 		using base_type = stable_trie<typename String::value_type>;
+		using pool_type = detail::basic_atom_string_pool<typename String::value_type, Allocator>;
 
 	public:
 		using allocator_type = Allocator;
 
 		using key_type   = String;
-		using value_type = detail::basic_atom<key_type>;
+		using value_type = detail::basic_atom<key_type, Allocator>;
 		using label_type = typename String::value_type;
 
 		using typename base_type::serialize_iterator;
@@ -278,10 +520,10 @@ namespace wordring
 		using base_type::size;
 		using base_type::ibegin;
 		using base_type::iend;
-		using base_type::clear;
 
 	protected:
 		using base_type::null_value;
+		using base_type::m_c;
 
 	public:
 		/*! @brief 空のコンテナを構築する
@@ -294,6 +536,7 @@ namespace wordring
 		*/
 		basic_atom_set()
 			: base_type()
+			, m_pool()
 		{
 		}
 
@@ -309,6 +552,7 @@ namespace wordring
 		*/
 		explicit basic_atom_set(allocator_type const& alloc)
 			: base_type(alloc)
+			, m_pool(alloc)
 		{
 		}
 
@@ -342,6 +586,7 @@ namespace wordring
 		template <typename InputIterator, typename std::enable_if_t<std::is_integral_v<typename std::iterator_traits<InputIterator>::value_type>, std::nullptr_t> = nullptr>
 		basic_atom_set(InputIterator first, InputIterator last, allocator_type const& alloc = allocator_type())
 			: base_type(alloc)
+			, m_pool(alloc)
 		{
 			assign(first, last);
 		}
@@ -370,6 +615,7 @@ namespace wordring
 		template <typename InputIterator, typename std::enable_if_t<std::negation_v<std::is_integral<typename std::iterator_traits<InputIterator>::value_type>>, std::nullptr_t> = nullptr>
 		basic_atom_set(InputIterator first, InputIterator last, allocator_type const& alloc = allocator_type())
 			: base_type(alloc)
+			, m_pool(alloc)
 		{
 			assign(first, last);
 		}
@@ -385,6 +631,7 @@ namespace wordring
 		*/
 		basic_atom_set(std::initializer_list<detail::trie_node> il, allocator_type const& alloc = allocator_type())
 			: base_type(il, alloc)
+			, m_pool(alloc)
 		{
 		}
 
@@ -415,6 +662,7 @@ namespace wordring
 		void assign(InputIterator first, InputIterator last)
 		{
 			base_type::assign(first, last);
+			rebuild_pool();
 		}
 
 		/*! @brief 文字列リストからの割り当て
@@ -443,6 +691,86 @@ namespace wordring
 			while (first != last) insert(*first++);
 		}
 
+		/*! @brief 一括入出力形式でストリームへ出力する
+
+		@param [out] os 出力先のストリーム
+
+		@return os
+
+		basic_trie::write() と同じ形式だが、種類に detail::trie_image_flavour::atom_set を記録する。
+		アトムIDはノードのINDEXであるため、入力後も同じIDが同じ文字列を指す。
+
+		@par 例
+		@code
+			// コンテナを作成
+			std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+			auto as1 = basic_atom_set<std::u32string>(v.begin(), v.end());
+			std::uint32_t id = as1.at(U"うあい");
+
+			// 一括入出力形式で出力
+			std::stringstream ss;
+			as1.write(ss);
+
+			// 一括入出力形式で入力
+			basic_atom_set<std::u32string> as2;
+			as2.read(ss);
+
+			// 検証
+			assert(static_cast<std::u32string>(as2.at(id)) == U"うあい");
+		@endcode
+		*/
+		std::ostream& write(std::ostream& os) const
+		{
+			base_type::write_image(os, sizeof(label_type), detail::trie_image_flavour::atom_set);
+			return os;
+		}
+
+		/*! @brief 一括入出力形式でストリームから入力する
+
+		@param [in] is 入力元のストリーム
+
+		@return is
+
+		ヘッダが一致しない場合、データが足りない場合、チェックサムが一致しない場合、
+		ストリームに failbit を立て、コンテナを変更しない。
+
+		@sa write(std::ostream& os) const
+		*/
+		std::istream& read(std::istream& is)
+		{
+			if (base_type::read_image(is, sizeof(label_type), detail::trie_image_flavour::atom_set)) rebuild_pool();
+			return is;
+		}
+
+		/*! @brief アトムIDから文字列を引く表を使用するか設定する
+
+		@param [in] enable 使用する場合 true
+
+		アトムを文字列に変換するには、葉から根へ親をたどる必要があり、文字列の長さに比例した時間がかかる。
+		表を使用すると、アトムの文字列をO(1)で参照できる basic_atom::view() が使えるようになり、
+		文字列への変換も表からの複写となる。
+		代わりに、ノード一つにつき8バイトと、格納した文字列の合計の長さを追加で消費する。
+
+		使用を開始する際に、格納されているすべての文字列から表を作る。
+		アトムIDとTrieによる検索は、表の有無にかかわらず変わらない。
+		表は直列化されないため、ストリームから入力した後も設定は引き継がれる。
+
+		@sa detail::basic_atom_string_pool
+		*/
+		void use_string_pool(bool enable = true)
+		{
+			m_pool.enable(enable);
+			rebuild_pool();
+		}
+
+		/*! @brief アトムIDから文字列を引く表を使用している場合、trueを返す
+		*/
+		bool uses_string_pool() const noexcept { return m_pool.enabled(); }
+
+		/*! @brief アトムIDから文字列を引く表が確保しているバイト数を返す
+		*/
+		std::size_t string_pool_bytes() const noexcept { return m_pool.bytes(); }
+
 		// 要素アクセス --------------------------------------------------------
 
 		/*! @brief IDからアトムを返す
@@ -477,7 +805,7 @@ namespace wordring
 			assert(1 < idx && idx < static_cast<int>(base_type::m_c.size()));
 			assert((d + idx)->m_base + base_type::null_value == id);
 
-			return value_type(base_type::m_c, idx);
+			return value_type(base_type::m_c, idx, pool());
 		}
 			  
 		/*! @brief 文字列からアトムを返す
@@ -506,7 +834,7 @@ namespace wordring
 		template <typename InputIterator>
 		value_type at(InputIterator first, InputIterator last) const
 		{
-			return base_type::find(first, last);
+			return value_type(base_type::find(first, last), pool());
 		}
 
 		/*! @brief 文字列からアトムを返す
@@ -556,13 +884,23 @@ namespace wordring
 		*/
 		value_type operator[](std::basic_string_view<label_type> sv)
 		{
-			value_type it = base_type::find(sv.begin(), sv.end());
+			value_type it(base_type::find(sv.begin(), sv.end()), pool());
 			if (!it) it = insert(sv.begin(), sv.end());
 			return it;
 		}
 		
 		// 変更 ---------------------------------------------------------------
 
+		/*! @brief すべてのアトムを削除する
+
+		文字列表の使用の設定は引き継がれる。
+		*/
+		void clear() noexcept
+		{
+			base_type::clear();
+			m_pool.clear();
+		}
+
 		/*! @brief 文字列を挿入する
 
 		@param [in] first 文字列の先頭を指すイテレータ
@@ -587,17 +925,28 @@ namespace wordring
 		template <typename InputIterator>
 		value_type insert(InputIterator first, InputIterator last)
 		{
-			auto it = base_type::insert(first, last);
+			if (!m_pool.enabled()) return insert_key(first, last);
 
-			typename base_type::index_type idx;
-			
-			if (it)
-			{
-				auto proxy = base_type::at(it, idx);
-				proxy = idx;
-			}
+			using index_type = typename base_type::index_type;
 
-			return it;
+			// 入力イテレータを二度読まないよう、文字列へ複写してから挿入する
+			key_type key(first, last);
+			if (key.empty()) return value_type();
+
+			// 挿入で子が移動し得るのは、既存の経路の末尾のノードだけである。
+			// そのノードが文字列の終端である場合、空遷移先（アトムID）も移動するため、表の記録を移す。
+			value_type tail(base_type::lookup(key.begin(), key.end()).first);
+			index_type parent = std::max(tail.m_index, index_type(1));
+			index_type before = (m_c.data() + parent)->m_base;
+			bool terminal = 1 <= before && is_atom(before + null_value) && (m_c.data() + before + null_value)->m_check == parent;
+
+			value_type result = insert_key(key.begin(), key.end());
+
+			index_type after = (m_c.data() + parent)->m_base;
+			if (terminal && after != before) m_pool.move(before + null_value, after + null_value);
+			if (result && result.view().empty()) m_pool.assign(static_cast<std::uint32_t>(result), key);
+
+			return result;
 		}
 
 		/*! @brief 文字列を挿入する
@@ -647,7 +996,10 @@ namespace wordring
 		*/
 		void erase(std::uint32_t id)
 		{
-			if(id != 0) base_type::erase(static_cast<typename base_type::const_iterator>(at(id)));
+			if (id == 0) return;
+
+			m_pool.erase(id);
+			base_type::erase(static_cast<typename base_type::const_iterator>(at(id)));
 		}
 
 		/*! @brief アトムを削除する
@@ -673,7 +1025,7 @@ namespace wordring
 		template <typename InputIterator>
 		void erase(InputIterator first, InputIterator last)
 		{
-			base_type::erase(base_type::find(first, last));
+			erase(static_cast<std::uint32_t>(at(first, last)));
 		}
 
 		/*! @brief アトムを削除する
@@ -737,8 +1089,95 @@ namespace wordring
 		{
 			return contains(sv.begin(), sv.end());
 		}
+
+		// その他 -------------------------------------------------------------
+
+		/*! @brief ダブル・アレイを詰め直す
+
+		すべてのアトムIDが変わるため、保存しているIDは戻り値の m_remap で付け替える。
+		文字列表は対応表に従って新しいIDへ移される。
+
+		@sa detail::trie_heap::compact()
+		*/
+		detail::trie_compact_result compact()
+		{
+			auto result = base_type::compact();
+			m_pool.remap(result.m_remap);
+
+			return result;
+		}
+
+		void swap(basic_atom_set& other)
+		{
+			base_type::swap(other);
+			m_pool.swap(other.m_pool);
+		}
+
+	protected:
+		/*! 文字列表を使用している場合、表へのポインタを返す
+		*/
+		pool_type const* pool() const noexcept { return m_pool.enabled() ? &m_pool : nullptr; }
+
+		/*! idxがアトムIDである場合、trueを返す
+		- アトムIDは、葉から空遷移したノードのINDEXである。
+		*/
+		bool is_atom(typename base_type::index_type idx) const
+		{
+			auto const* d = m_c.data();
+			if (m_c.size() <= static_cast<std::size_t>(idx)) return false;
+
+			auto parent = (d + idx)->m_check;
+			return 1 <= parent && (d + parent)->m_base + null_value == idx;
+		}
+
+		template <typename InputIterator>
+		value_type insert_key(InputIterator first, InputIterator last)
+		{
+			auto it = base_type::insert(first, last);
+
+			typename base_type::index_type idx;
+			
+			if (it)
+			{
+				auto proxy = base_type::at(it, idx);
+				proxy = idx;
+			}
+
+			return value_type(it, pool());
+		}
+
+		/*! 格納されているすべての文字列から文字列表を作り直す
+		*/
+		void rebuild_pool()
+		{
+			m_pool.clear();
+			if (!m_pool.enabled()) return;
+
+			key_type key;
+			for (std::size_t id = 2; id < m_c.size(); ++id)
+			{
+				auto idx = static_cast<typename base_type::index_type>(id);
+				if (!is_atom(idx)) continue;
+
+				value_type(m_c, (m_c.data() + idx)->m_check).string(key);
+				m_pool.assign(static_cast<std::uint32_t>(id), key);
+			}
+		}
+
+	protected:
+		pool_type m_pool;
 	};
 
+	template <typename String1, typename Allocator1>
+	inline std::istream& operator>>(std::istream& is, basic_atom_set<String1, Allocator1>& as)
+	{
+		typename basic_atom_set<String1, Allocator1>::base_type& base = as;
+		is >> base;
+		as.rebuild_pool();
+
+		return is;
+	}
+
 	template <typename Allocator = std::allocator<detail::trie_node>>
 	using u8atom_set = basic_atom_set<std::u8string, Allocator>;
 
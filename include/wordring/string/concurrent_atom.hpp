@@ -0,0 +1,309 @@
+﻿#pragma once
+
+#include <wordring/compatibility.hpp>
+#include <wordring/trie/concurrent_trie.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace wordring
+{
+	/*! @class basic_concurrent_atom_set concurrent_atom.hpp wordring/string/concurrent_atom.hpp
+
+	@brief 複数のスレッドから同時に文字列を登録できるアトム・コンテナ
+
+	@tparam String    文字列型
+	@tparam Allocator アロケータ
+
+	複数の文書を並列に解析し、タグ名や属性名、クラス名を一つの表へ登録して、
+	文書をまたいでIDで比較する用途を想定する。
+
+	@par ID
+
+	IDは登録順に1から振られる連番で、一度振られたIDは変わらない。
+	0は無効な値として使う。
+	basic_atom_set のIDはノードのINDEXであり、このクラスのIDとは互換性が無い。
+	登録した文字列を削除することは出来ない。
+
+	@par 文字列からIDへの検索
+
+	検索は basic_concurrent_trie の公開された版に対して行い、ロックを取らない。
+	版に無い文字列だけがミューテックスを取り、公開待ちの表を調べ、無ければ新しいIDを振る。
+	公開待ちの文字列が登録数の1/16（最低64）に達すると、まとめて新しい版として公開する。
+	版の複製の費用は、登録数に対して償却定数となる。
+
+	@par IDから文字列への変換
+
+	文字列は、登録数が2のべき乗に達する度に倍の大きさで確保する区画へ格納する。
+	区画は移動しないため、 view() はロックを取らず、返した参照はコンテナが破棄されるまで有効である。
+
+	@par 読み取り側の登録
+
+	スレッドは get_reader() で reader を得て、 reader::insert() 、 reader::find() を呼ぶ。
+	reader はスレッドごとに一つ保持し、コンテナより先に破棄すること。
+
+	@par 例
+	@code
+		auto as = concurrent_atom_set<std::string>();
+
+		// スレッドごと
+		auto r = as.get_reader();
+		std::uint32_t id = r.insert("div");
+
+		assert(r.find("div") == id);
+		assert(as.view(id) == "div");
+	@endcode
+	*/
+	template <typename String, typename Allocator = std::allocator<detail::trie_node>>
+	class basic_concurrent_atom_set
+	{
+	public:
+		using string_type = String;
+		using label_type  = typename string_type::value_type;
+		using view_type   = std::basic_string_view<label_type>;
+		using trie_type   = basic_concurrent_trie<label_type, detail::trie_base<Allocator>>;
+
+	protected:
+		using index_type = typename std::allocator_traits<Allocator>::value_type::index_type;
+
+		static constexpr std::uint32_t segment_count = 32;
+		static constexpr std::size_t   min_batch     = 64;
+
+	public:
+		/*! @brief 読み取り側スレッドの登録
+
+		公開された版を検索するための枠を一つ占有する。
+		*/
+		class reader
+		{
+			friend class basic_concurrent_atom_set;
+
+		public:
+			reader(reader&& other) noexcept = default;
+
+			/*! @brief 文字列のIDを返す
+
+			@param [in] sv 文字列
+
+			@return 登録されている場合ID、それ以外の場合0
+
+			公開された版にある場合、ロックを取らない。
+			*/
+			std::uint32_t find(view_type sv) const
+			{
+				if (sv.empty()) return 0;
+
+				std::uint32_t id = lookup(sv);
+				return id != 0 ? id : m_set->find_pending(sv, *this);
+			}
+
+			/*! @brief 文字列を登録し、IDを返す
+
+			@param [in] sv 文字列
+
+			@return 文字列のID、空の文字列の場合0
+
+			@throw std::length_error IDが葉の値に収まらない場合
+
+			既に公開された版にある場合、ロックを取らない。
+			*/
+			std::uint32_t insert(view_type sv)
+			{
+				if (sv.empty()) return 0;
+
+				std::uint32_t id = lookup(sv);
+				return id != 0 ? id : m_set->insert_pending(sv, *this);
+			}
+
+		protected:
+			reader(basic_concurrent_atom_set* set, typename trie_type::reader&& r)
+				: m_set(set)
+				, m_reader(std::move(r))
+			{
+			}
+
+			/*! 公開された版を検索する
+			- 見つからない場合、0を返す。
+			*/
+			std::uint32_t lookup(view_type sv) const
+			{
+				auto s = m_reader.pin();
+				auto it = s->find(sv.begin(), sv.end());
+
+				return it != s->cend()
+					? static_cast<std::uint32_t>(s->at(it))
+					: 0;
+			}
+
+		protected:
+			basic_concurrent_atom_set* m_set;
+			typename trie_type::reader m_reader;
+		};
+
+	public:
+		/*! @brief 空のコンテナを構築する
+		*/
+		basic_concurrent_atom_set()
+			: m_trie()
+			, m_size(0)
+			, m_segments()
+		{
+			for (auto& segment : m_segments) segment.store(nullptr, std::memory_order_relaxed);
+		}
+
+		basic_concurrent_atom_set(basic_concurrent_atom_set const&) = delete;
+		basic_concurrent_atom_set& operator=(basic_concurrent_atom_set const&) = delete;
+
+		/*! @brief 破棄する
+
+		すべての reader は、先に破棄されている必要がある。
+		*/
+		~basic_concurrent_atom_set()
+		{
+			for (auto& segment : m_segments) delete[] segment.load();
+		}
+
+		/*! @brief 読み取り側スレッドを登録する
+
+		@return 枠を占有する reader
+
+		@sa basic_concurrent_trie::get_reader()
+		*/
+		reader get_reader() { return reader(this, m_trie.get_reader()); }
+
+		/*! @brief IDから文字列を返す
+
+		@param [in] id アトムID
+
+		@return 文字列への参照、IDが登録されていない場合、空の文字列
+
+		ロックを取らない。
+		参照はコンテナが破棄されるまで有効である。
+		*/
+		view_type view(std::uint32_t id) const noexcept
+		{
+			if (id == 0 || m_size.load(std::memory_order_acquire) < id) return view_type();
+
+			std::uint32_t n = std::bit_width(id) - 1;
+			return m_segments[n].load(std::memory_order_acquire)[id - (1u << n)];
+		}
+
+		/*! @brief 登録されている文字列の数を返す
+		*/
+		std::size_t size() const noexcept { return m_size.load(std::memory_order_acquire); }
+
+		/*! @brief 公開待ちの文字列を新しい版として公開する
+
+		以後、それらの文字列の検索はロックを取らない。
+		文書の解析が一巡した後など、登録が落ち着いた時点で呼ぶと良い。
+		*/
+		void commit()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			publish();
+		}
+
+	protected:
+		/*! 公開待ちの表を検索する
+		*/
+		std::uint32_t find_pending(view_type sv, reader const& r) const
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			auto it = m_pending.find(string_type(sv));
+			if (it != m_pending.end()) return it->second;
+
+			// ロックを待つ間に公開された場合
+			return r.lookup(sv);
+		}
+
+		/*! 公開待ちの表を検索し、無ければ新しいIDを振る
+		- IDが葉の値に収まらない場合、 std::length_error を投げる。
+		- 葉の値は INDEX の型の正の範囲に限られる。
+		  公開時に投げられると登録数と区画が既に更新されているため、格納する前に調べる。
+		*/
+		std::uint32_t insert_pending(view_type sv, reader const& r)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			string_type key(sv);
+			auto it = m_pending.find(key);
+			if (it != m_pending.end()) return it->second;
+
+			std::uint32_t id = r.lookup(sv);
+			if (id != 0) return id;
+
+			id = m_size.load(std::memory_order_relaxed) + 1;
+			if (static_cast<std::uint64_t>(std::numeric_limits<index_type>::max()) < id) throw std::length_error("");
+
+			store(id, key);
+			m_size.store(id, std::memory_order_release);
+
+			m_trie.insert(key, id);
+			m_pending.emplace(std::move(key), id);
+			if (std::max<std::size_t>(min_batch, id / 16) <= m_pending.size()) publish();
+
+			return id;
+		}
+
+		/*! idの区画へ文字列を格納する
+		- ミューテックスを取った状態で呼び出す。
+		*/
+		void store(std::uint32_t id, string_type const& s)
+		{
+			assert(id != 0);
+
+			std::uint32_t n = std::bit_width(id) - 1;
+			string_type* segment = m_segments[n].load(std::memory_order_relaxed);
+			if (segment == nullptr)
+			{
+				segment = new string_type[std::size_t(1) << n];
+				m_segments[n].store(segment, std::memory_order_release);
+			}
+
+			segment[id - (1u << n)] = s;
+		}
+
+		/*! 公開待ちの文字列を公開する
+		- ミューテックスを取った状態で呼び出す。
+		*/
+		void publish()
+		{
+			if (m_pending.empty()) return;
+
+			m_trie.commit();
+			m_pending.clear();
+		}
+
+	protected:
+		trie_type                                            m_trie;
+		std::atomic<std::uint32_t>                           m_size;
+		std::array<std::atomic<string_type*>, segment_count> m_segments;
+
+		mutable std::mutex                             m_mutex;
+		std::unordered_map<string_type, std::uint32_t> m_pending;
+	};
+
+	template <typename String, typename Allocator = std::allocator<detail::trie_node>>
+	using concurrent_atom_set = basic_concurrent_atom_set<String, Allocator>;
+
+	template <typename Allocator = std::allocator<detail::trie_node>>
+	using u8concurrent_atom_set = basic_concurrent_atom_set<std::u8string, Allocator>;
+
+	template <typename Allocator = std::allocator<detail::trie_node>>
+	using u16concurrent_atom_set = basic_concurrent_atom_set<std::u16string, Allocator>;
+
+	template <typename Allocator = std::allocator<detail::trie_node>>
+	using u32concurrent_atom_set = basic_concurrent_atom_set<std::u32string, Allocator>;
+}
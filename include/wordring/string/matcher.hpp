@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include <cstdint>
 #include <initializer_list>
 #include <vector>
 
@@ -47,6 +48,17 @@ namespace wordring
 		{
 		}
 
+		/*! @brief 文字列のリストからマッチャーを構築する
+
+		@param first [in] 文字列リストの先頭を指すイテレータ
+		@param last  [in] 文字列リストの終端を指すイテレータ
+		*/
+		template <typename InputIterator>
+		string_matcher(InputIterator first, InputIterator last)
+			: m_c(first, last)
+		{
+		}
+
 		/*! @brief これまでに入力された文字のリストを返す
 		
 		@return 文字列
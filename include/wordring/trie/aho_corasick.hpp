@@ -0,0 +1,522 @@
+﻿#pragma once
+
+#include <wordring/trie/trie.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace wordring
+{
+	// ------------------------------------------------------------------------
+	// basic_aho_corasick
+	// ------------------------------------------------------------------------
+
+	/*! @class basic_aho_corasick aho_corasick.hpp wordring/trie/aho_corasick.hpp
+
+	@brief ダブル・アレイ上に構築する Aho-Corasick 法の複数パターン照合器
+
+	@tparam Label     ラベルとして使用する任意の整数型
+	@tparam Allocator アロケータ
+
+	string_matcher は文字を追加するたびに全てのパターンと比較するため、パターン数に比例して遅くなり、
+	最短一致しか報告できない。
+	このクラスはパターンを trie に格納し、文字境界のノードごとに失敗リンクと出力リンクを持つ。
+	文字列を一度走査するだけで、各位置で終わる全ての一致を報告する。
+	遷移の費用は文字当たり償却定数、報告の費用は一致数に比例する。
+
+	構築後の変更は出来ない。
+	検索とイテレータは basic_trie の読み取り専用のメンバを公開する。
+
+	@par 状態
+
+	状態はノードのINDEXで、根（1）から始まる。
+	next() で文字を一つ進め、 matches() 、 longest() でその位置で終わる一致を得る。
+	push 型で使う場合、状態を保持する matcher を使う。
+
+	@par リンクの格納
+
+	リンクはノードのINDEXで引く配列に格納する。
+	ラベルが1バイトより大きい場合、文字の途中のノードはリンクを持たず、配列の要素は使われない。
+
+	@par 例
+	@code
+		std::vector<std::string> v{ "he", "she", "his", "hers" };
+		auto ac = aho_corasick<char>(v.begin(), v.end());
+
+		// (開始位置, 長さ, 値) の組を出力する
+		std::string s{ "ushers" };
+		std::vector<std::tuple<std::size_t, std::size_t, std::uint32_t>> result;
+		ac.scan(s.begin(), s.end(), std::back_inserter(result));
+
+		// 「she」「he」「hers」
+		assert(result.size() == 3);
+	@endcode
+	*/
+	template <typename Label, typename Allocator = std::allocator<detail::trie_node>>
+	class basic_aho_corasick : protected basic_trie<Label, detail::trie_base<Allocator>>
+	{
+	protected:
+		using base_type = basic_trie<Label, detail::trie_base<Allocator>>;
+
+		using typename base_type::index_type;
+		using typename base_type::node_type;
+
+		using base_type::null_value;
+		using base_type::coefficient;
+		using base_type::m_c;
+
+		using unsigned_type = std::make_unsigned_t<Label>;
+
+		/*! ノードごとのリンク
+
+		- m_fail は失敗リンク、根の場合は根自身。
+		- m_output は失敗リンクをたどって最初に見つかる終端ノード、無い場合は0。
+		- m_length は根からの文字数。
+		*/
+		struct link
+		{
+			index_type    m_fail;
+			index_type    m_output;
+			std::uint32_t m_length;
+		};
+
+		using link_container = std::vector<link, typename std::allocator_traits<Allocator>::template rebind_alloc<link>>;
+
+	public:
+		using trie_type      = base_type;
+		using label_type     = typename base_type::label_type;
+		using value_type     = typename base_type::value_type;
+		using size_type      = typename base_type::size_type;
+		using allocator_type = typename base_type::allocator_type;
+		using const_iterator = typename base_type::const_iterator;
+		using state_type     = index_type;
+
+		/*! @brief 一致
+
+		first は一致の長さ（文字数）、 second は葉の値。
+		*/
+		using match_type = std::pair<std::size_t, value_type>;
+
+	public:
+		using base_type::get_allocator;
+		using base_type::ibegin;
+		using base_type::iend;
+		using base_type::begin;
+		using base_type::cbegin;
+		using base_type::end;
+		using base_type::cend;
+		using base_type::empty;
+		using base_type::size;
+		using base_type::lookup;
+		using base_type::search;
+		using base_type::find;
+		using base_type::contains;
+
+	public:
+		/*! @brief 入力された文字を保持して照合する push 型の照合器
+
+		@par 例
+		@code
+			std::vector<std::string> v{ "he", "she", "his", "hers" };
+			auto ac = aho_corasick<char>(v.begin(), v.end());
+
+			auto m = ac.get_matcher();
+			for (char ch : std::string("ushers"))
+			{
+				if (m.push_back(ch)) std::cout << m.longest().first;
+			}
+		@endcode
+		*/
+		class matcher
+		{
+			friend class basic_aho_corasick;
+
+		public:
+			/*! @brief 文字を追加する
+
+			@param [in] ch 文字
+
+			@return この文字で終わる一致が有る場合 true 、それ以外の場合 false
+			*/
+			bool push_back(label_type ch)
+			{
+				m_state = m_ac->next(m_state, ch);
+				++m_size;
+
+				return m_ac->matched(m_state);
+			}
+
+			/*! @brief 最後に追加した文字で終わる一致を長い順に全て出力する
+
+			@param [out] out 結果の出力先
+
+			@return 最後に出力した次を指す出力イテレータ
+
+			@sa basic_aho_corasick::matches()
+			*/
+			template <typename OutputIterator>
+			OutputIterator matches(OutputIterator out) const { return m_ac->matches(m_state, out); }
+
+			/*! @brief 最後に追加した文字で終わる最長の一致を返す
+
+			@return 一致の長さと値の組、一致が無い場合 (0, 0)
+			*/
+			match_type longest() const { return m_ac->longest(m_state); }
+
+			/*! @brief これまでに追加した文字数を返す
+			*/
+			std::size_t size() const noexcept { return m_size; }
+
+			/*! @brief 初期状態に戻す
+			*/
+			void clear() noexcept
+			{
+				m_state = m_ac->root();
+				m_size = 0;
+			}
+
+		protected:
+			explicit matcher(basic_aho_corasick const& ac)
+				: m_ac(&ac)
+				, m_state(ac.root())
+				, m_size(0)
+			{
+			}
+
+		protected:
+			basic_aho_corasick const* m_ac;
+			state_type                m_state;
+			std::size_t               m_size;
+		};
+
+	public:
+		/*! @brief 空の照合器を構築する
+		*/
+		basic_aho_corasick()
+			: base_type()
+			, m_links()
+		{
+			build();
+		}
+
+		/*! @brief 文字列のリストから構築する
+
+		@param [in] first 文字列リストの先頭を指すイテレータ
+		@param [in] last  文字列リストの終端を指すイテレータ
+		@param [in] alloc アロケータ
+
+		葉の値は、その文字列がリスト内で最初に現れる位置となる。
+		空の文字列は無視される。
+		*/
+		template <typename ForwardIterator, typename std::enable_if_t<std::negation_v<std::is_integral<typename std::iterator_traits<ForwardIterator>::value_type>>, std::nullptr_t> = nullptr>
+		basic_aho_corasick(ForwardIterator first, ForwardIterator last, allocator_type const& alloc = allocator_type())
+			: base_type(alloc)
+			, m_links(alloc)
+		{
+			using string_type = typename std::iterator_traits<ForwardIterator>::value_type;
+
+			// 同じ文字列は最初に現れる位置を残す
+			std::vector<std::pair<string_type, value_type>> v;
+			for (value_type i = 0; first != last; ++first, ++i) if (!std::empty(*first)) v.emplace_back(*first, i);
+			std::stable_sort(v.begin(), v.end(), [](auto const& lhs, auto const& rhs) { return lhs.first < rhs.first; });
+			v.erase(std::unique(v.begin(), v.end(), [](auto const& lhs, auto const& rhs) { return lhs.first == rhs.first; }), v.end());
+
+			std::vector<string_type> keys;
+			keys.reserve(v.size());
+			for (auto const& pair : v) keys.push_back(pair.first);
+			base_type::assign(keys.begin(), keys.end());
+
+			for (auto const& pair : v) base_type::at(pair.first) = pair.second;
+
+			build();
+		}
+
+		/*! @brief 文字列のリストから構築する
+
+		@param [in] il    文字列リスト
+		@param [in] alloc アロケータ
+		*/
+		basic_aho_corasick(std::initializer_list<std::basic_string<label_type>> il, allocator_type const& alloc = allocator_type())
+			: basic_aho_corasick(il.begin(), il.end(), alloc)
+		{
+		}
+
+		/*! @brief Trie木から構築する
+
+		@param [in] trie パターンを格納した Trie木
+
+		葉の値は、そのまま一致の値として報告される。
+		*/
+		explicit basic_aho_corasick(trie_type const& trie)
+			: base_type(trie)
+			, m_links(trie.get_allocator())
+		{
+			build();
+		}
+
+		/*! @brief 根の状態を返す
+		*/
+		state_type root() const noexcept { return 1; }
+
+		/*! @brief 状態を一文字進める
+
+		@param [in] state 現在の状態
+		@param [in] ch    文字
+
+		@return 次の状態
+
+		遷移が無い場合、失敗リンクをたどる。
+		文字当たりの費用は償却定数である。
+		*/
+		state_type next(state_type state, label_type ch) const noexcept
+		{
+			while (true)
+			{
+				index_type idx = child(state, ch);
+				if (idx != 0) return idx;
+				if (state == 1) return 1;
+
+				state = m_links[state].m_fail;
+			}
+		}
+
+		/*! @brief 状態で終わる一致が有るか調べる
+
+		@param [in] state 状態
+		*/
+		bool matched(state_type state) const noexcept
+		{
+			value_type value = 0;
+			return terminal(state, value) || m_links[state].m_output != 0;
+		}
+
+		/*! @brief 状態で終わる一致を長い順に全て出力する
+
+		@param [in]  state 状態
+		@param [out] out   結果の出力先
+
+		@return 最後に出力した次を指す出力イテレータ
+
+		出力される要素は match_type で、一致の長さ（文字数）と葉の値の組である。
+		出力リンクをたどるため、費用は一致数に比例する。
+		*/
+		template <typename OutputIterator>
+		OutputIterator matches(state_type state, OutputIterator out) const
+		{
+			value_type value = 0;
+			if (terminal(state, value)) *out++ = match_type(m_links[state].m_length, value);
+
+			for (index_type idx = m_links[state].m_output; idx != 0; idx = m_links[idx].m_output)
+			{
+				terminal(idx, value);
+				*out++ = match_type(m_links[idx].m_length, value);
+			}
+
+			return out;
+		}
+
+		/*! @brief 状態で終わる最長の一致を返す
+
+		@param [in] state 状態
+
+		@return 一致の長さと値の組、一致が無い場合 (0, 0)
+		*/
+		match_type longest(state_type state) const
+		{
+			value_type value = 0;
+			if (terminal(state, value)) return match_type(m_links[state].m_length, value);
+
+			index_type idx = m_links[state].m_output;
+			if (idx == 0) return match_type(0, 0);
+
+			terminal(idx, value);
+			return match_type(m_links[idx].m_length, value);
+		}
+
+		/*! @brief 文字列を走査し、全ての一致を出力する
+
+		@param [in]  first 文字列の先頭を指すイテレータ
+		@param [in]  last  文字列の終端を指すイテレータ
+		@param [out] out   結果の出力先
+
+		@return 最後に出力した次を指す出力イテレータ
+
+		出力される要素は、開始位置、長さ（文字数）、葉の値の std::tuple である。
+		終了位置の昇順、同じ終了位置では長い順に出力する。
+		*/
+		template <typename InputIterator, typename OutputIterator>
+		OutputIterator scan(InputIterator first, InputIterator last, OutputIterator out) const
+		{
+			using result_type = std::tuple<std::size_t, std::size_t, value_type>;
+
+			state_type state = root();
+			std::size_t n = 0;
+			value_type value = 0;
+
+			while (first != last)
+			{
+				assert(coefficient == sizeof(*first));
+
+				state = next(state, *first);
+				++first;
+				++n;
+
+				if (terminal(state, value)) *out++ = result_type(n - m_links[state].m_length, m_links[state].m_length, value);
+				for (index_type idx = m_links[state].m_output; idx != 0; idx = m_links[idx].m_output)
+				{
+					terminal(idx, value);
+					*out++ = result_type(n - m_links[idx].m_length, m_links[idx].m_length, value);
+				}
+			}
+
+			return out;
+		}
+
+		/*! @brief 文字列を走査し、全ての一致を出力する
+
+		@param [in]  s   文字列
+		@param [out] out 結果の出力先
+
+		@return 最後に出力した次を指す出力イテレータ
+
+		@sa scan(InputIterator first, InputIterator last, OutputIterator out) const
+		*/
+		template <typename String, typename OutputIterator>
+		OutputIterator scan(String const& s, OutputIterator out) const
+		{
+			return scan(std::begin(s), std::end(s), out);
+		}
+
+		/*! @brief push 型の照合器を返す
+
+		照合器はこのコンテナを参照するため、コンテナより先に破棄すること。
+		*/
+		matcher get_matcher() const { return matcher(*this); }
+
+	protected:
+		/*! 文字境界のノードから文字chで遷移する
+		- 遷移先が無い場合、0を返す。
+		*/
+		index_type child(index_type parent, label_type ch) const noexcept
+		{
+			node_type const* d = m_c.data();
+			index_type const limit = static_cast<index_type>(m_c.size());
+
+			unsigned_type label = static_cast<unsigned_type>(ch);
+			for (std::uint32_t i = 0; i < coefficient; ++i)
+			{
+				index_type base = (d + parent)->m_base;
+				if (base <= 0) return 0;
+
+				index_type idx = base + static_cast<index_type>(label >> ((coefficient - i - 1) * 8) & 0xFFu);
+				if (limit <= idx || (d + idx)->m_check != parent) return 0;
+
+				parent = idx;
+			}
+
+			return parent;
+		}
+
+		/*! 文字境界のノードが文字列終端か調べ、終端の場合valueに葉の値を設定する
+		*/
+		bool terminal(index_type idx, value_type& value) const noexcept
+		{
+			if (idx <= 1) return false;
+
+			node_type const* d = m_c.data();
+			index_type const limit = static_cast<index_type>(m_c.size());
+
+			index_type base = (d + idx)->m_base;
+			if (base <= 0)
+			{
+				value = static_cast<value_type>(-base);
+				return true;
+			}
+			if (base + null_value < limit && (d + base + null_value)->m_check == idx)
+			{
+				value = static_cast<value_type>(-(d + base + null_value)->m_base);
+				return true;
+			}
+
+			return false;
+		}
+
+		/*! 文字境界のノードparentの子を列挙し、子のINDEXと文字でfnを呼び出す
+		*/
+		template <typename Function>
+		void for_each_child(index_type parent, std::uint32_t level, std::uint64_t label, Function& fn) const
+		{
+			node_type const* d = m_c.data();
+			index_type const limit = static_cast<index_type>(m_c.size());
+
+			index_type base = (d + parent)->m_base;
+			if (base <= 0) return;
+
+			for (std::uint32_t i = 0; i < null_value; ++i)
+			{
+				index_type idx = base + static_cast<index_type>(i);
+				if (limit <= idx) break;
+				if ((d + idx)->m_check != parent) continue;
+
+				if (level + 1 == coefficient) fn(idx, static_cast<label_type>(label << 8 | i));
+				else for_each_child(idx, level + 1, label << 8 | i, fn);
+			}
+		}
+
+		/*! 幅優先に失敗リンクと出力リンクを設定する
+		*/
+		void build()
+		{
+			m_links.assign(m_c.size(), link{ 0, 0, 0 });
+			m_links[1] = link{ 1, 0, 0 };
+
+			std::vector<index_type> queue(1, 1);
+			for (std::size_t i = 0; i < queue.size(); ++i)
+			{
+				index_type parent = queue[i];
+
+				auto fn = [&](index_type idx, label_type ch)
+				{
+					index_type fail = 1;
+					if (parent != 1)
+					{
+						for (index_type f = m_links[parent].m_fail; ; f = m_links[f].m_fail)
+						{
+							index_type g = child(f, ch);
+							if (g != 0)
+							{
+								fail = g;
+								break;
+							}
+							if (f == 1) break;
+						}
+					}
+
+					value_type value = 0;
+					m_links[idx].m_fail   = fail;
+					m_links[idx].m_output = terminal(fail, value) ? fail : m_links[fail].m_output;
+					m_links[idx].m_length = m_links[parent].m_length + 1;
+
+					queue.push_back(idx);
+				};
+
+				for_each_child(parent, 0, 0, fn);
+			}
+		}
+
+	protected:
+		link_container m_links;
+	};
+
+	template <typename Label, typename Allocator = std::allocator<detail::trie_node>>
+	using aho_corasick = basic_aho_corasick<Label, Allocator>;
+}
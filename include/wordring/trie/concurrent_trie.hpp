@@ -0,0 +1,428 @@
+﻿#pragma once
+
+#include <wordring/trie/trie.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace wordring
+{
+	// ------------------------------------------------------------------------
+	// basic_concurrent_trie
+	// ------------------------------------------------------------------------
+
+	/*! @class basic_concurrent_trie concurrent_trie.hpp wordring/trie/concurrent_trie.hpp
+
+	@brief 読み取りがロックを取らない、実行時に更新可能なTrie
+
+	@tparam Label ラベルとして使用する任意の整数型
+	@tparam Base  基本クラスとして使用するTrie実装クラス
+
+	多数のスレッドが検索を続ける間に辞書を更新する用途を想定する。
+
+	@par 版の公開
+
+	このクラスは basic_trie の不変な版を保持する。
+	書き込み側は insert() 、 erase() で変更を溜め、 commit() で現在の版を複製して変更を適用し、
+	新しい版へのポインタを原子的に置き換えて公開する。
+	公開された版は二度と変更されないため、読み取り側は同期なしに検索できる。
+
+	書き込み側同士はミューテックスで排他される。
+	読み取り側はミューテックスを取らず、待たされることも無い。
+	commit() は版全体を複製するため、変更はまとめて行うことが望ましい。
+
+	@par 読み取り
+
+	読み取り側のスレッドは get_reader() で reader を得て、 reader::pin() で snapshot を得る。
+	snapshot が生存する間、その版は解放されない。
+	reader はスレッドごとに一つ保持し、同時に一つの snapshot だけを持つこと。
+
+	@par 版の回収
+
+	古い版は、エポック（世代番号）を使って回収する。
+	reader は固定を始める時点のエポックを自分の枠へ書き込み、固定を解くと0に戻す。
+	版を置き換える書き込み側は、置き換え時のエポックを付けて古い版を退避し、エポックを進める。
+	固定中のどの reader のエポックよりも小さいエポックで退避された版は、もう参照されていないため解放できる。
+
+	@par 例
+	@code
+		auto t = concurrent_trie<char>();
+
+		// 書き込み側
+		t.insert(std::string("あい"), 1);
+		t.insert(std::string("あう"), 2);
+		t.commit();
+
+		// 読み取り側（スレッドごと）
+		auto r = t.get_reader();
+		{
+			auto s = r.pin();
+			assert(s->contains(std::string("あい")));
+		}
+	@endcode
+	*/
+	template <typename Label, typename Base>
+	class basic_concurrent_trie
+	{
+	public:
+		using trie_type  = basic_trie<Label, Base>;
+		using label_type = typename trie_type::label_type;
+		using value_type = typename trie_type::value_type;
+
+	protected:
+		/*! reader ごとの枠
+
+		固定中の場合エポック、それ以外は0を保持する。
+		偽共有を避けるため、キャッシュ・ラインに揃える。
+		*/
+		struct alignas(64) reader_slot
+		{
+			std::atomic<std::uint64_t> m_epoch{ 0 };
+			std::atomic<bool>          m_used{ false };
+			reader_slot*               m_next{ nullptr };
+			bool                       m_pinned{ false };
+		};
+
+		/*! 溜められた変更
+		*/
+		struct operation
+		{
+			std::vector<label_type> m_key;
+			value_type              m_value;
+			bool                    m_erase;
+		};
+
+	public:
+		class reader;
+
+		/*! @brief 固定された版への参照
+
+		生存する間、版は解放されない。
+		*/
+		class snapshot
+		{
+			friend class reader;
+
+		public:
+			snapshot(snapshot const&) = delete;
+			snapshot& operator=(snapshot const&) = delete;
+
+			snapshot(snapshot&& other) noexcept
+				: m_slot(std::exchange(other.m_slot, nullptr))
+				, m_trie(std::exchange(other.m_trie, nullptr))
+			{
+			}
+
+			~snapshot()
+			{
+				if (m_slot == nullptr) return;
+
+				m_slot->m_pinned = false;
+				m_slot->m_epoch.store(0, std::memory_order_release);
+			}
+
+			trie_type const& operator*() const { return *m_trie; }
+
+			trie_type const* operator->() const { return m_trie; }
+
+			trie_type const* get() const { return m_trie; }
+
+		protected:
+			snapshot(reader_slot* slot, trie_type const* trie)
+				: m_slot(slot)
+				, m_trie(trie)
+			{
+			}
+
+		protected:
+			reader_slot*     m_slot;
+			trie_type const* m_trie;
+		};
+
+		/*! @brief 読み取り側スレッドの登録
+
+		枠を一つ占有する。
+		破棄されると枠は他の reader に再利用される。
+		*/
+		class reader
+		{
+			friend class basic_concurrent_trie;
+
+		public:
+			reader(reader const&) = delete;
+			reader& operator=(reader const&) = delete;
+
+			reader(reader&& other) noexcept
+				: m_trie(std::exchange(other.m_trie, nullptr))
+				, m_slot(std::exchange(other.m_slot, nullptr))
+			{
+			}
+
+			~reader()
+			{
+				if (m_slot == nullptr) return;
+
+				assert(!m_slot->m_pinned);
+				m_slot->m_used.store(false, std::memory_order_release);
+			}
+
+			/*! @brief 現在の版を固定する
+
+			@return 固定された版への参照
+
+			ロックを取らず、書き込み側を待つことも無い。
+			*/
+			snapshot pin() const
+			{
+				assert(!m_slot->m_pinned);
+
+				// エポックを公開してから版を読む（順序はseq_cstで保証する）
+				m_slot->m_epoch.store(m_trie->m_epoch.load());
+				m_slot->m_pinned = true;
+
+				return snapshot(m_slot, m_trie->m_current.load());
+			}
+
+		protected:
+			reader(basic_concurrent_trie const* trie, reader_slot* slot)
+				: m_trie(trie)
+				, m_slot(slot)
+			{
+			}
+
+		protected:
+			basic_concurrent_trie const* m_trie;
+			reader_slot*                 m_slot;
+		};
+
+	public:
+		/*! @brief 空のコンテナを構築する
+		*/
+		basic_concurrent_trie()
+			: m_current(new trie_type())
+			, m_epoch(1)
+			, m_slots(nullptr)
+		{
+		}
+
+		/*! @brief 文字列リストから構築する
+
+		@sa basic_trie::assign()
+		*/
+		template <typename ForwardIterator>
+		basic_concurrent_trie(ForwardIterator first, ForwardIterator last)
+			: m_current(new trie_type(first, last))
+			, m_epoch(1)
+			, m_slots(nullptr)
+		{
+		}
+
+		basic_concurrent_trie(basic_concurrent_trie const&) = delete;
+		basic_concurrent_trie& operator=(basic_concurrent_trie const&) = delete;
+
+		/*! @brief 破棄する
+
+		すべての reader と snapshot は、先に破棄されている必要がある。
+		*/
+		~basic_concurrent_trie()
+		{
+			delete m_current.load();
+			for (auto const& pair : m_retired) delete pair.second;
+
+			for (reader_slot* slot = m_slots.load(); slot != nullptr; )
+			{
+				assert(!slot->m_used.load());
+				delete std::exchange(slot, slot->m_next);
+			}
+		}
+
+		// 読み取り -----------------------------------------------------------
+
+		/*! @brief 読み取り側スレッドを登録する
+
+		@return 枠を占有する reader
+
+		空いている枠があれば再利用し、無ければ枠を追加する。
+		いずれもロックを取らない。
+		*/
+		reader get_reader() const
+		{
+			for (reader_slot* slot = m_slots.load(); slot != nullptr; slot = slot->m_next)
+			{
+				bool used = false;
+				if (!slot->m_used.load(std::memory_order_relaxed) && slot->m_used.compare_exchange_strong(used, true)) return reader(this, slot);
+			}
+
+			reader_slot* slot = new reader_slot();
+			slot->m_used.store(true);
+
+			reader_slot* head = m_slots.load();
+			do slot->m_next = head;
+			while (!m_slots.compare_exchange_weak(head, slot));
+
+			return reader(this, slot);
+		}
+
+		// 書き込み -----------------------------------------------------------
+
+		/*! @brief キー文字列の挿入を予約する
+
+		@param [in] key   キー文字列
+		@param [in] value 葉へ格納する値（省略時は0）
+
+		commit() まで読み取り側からは見えない。
+		既に格納されている場合、値を置き換える。
+		*/
+		template <typename Key>
+		void insert(Key const& key, value_type value = 0)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pending.push_back(operation{ std::vector<label_type>(std::begin(key), std::end(key)), value, false });
+		}
+
+		/*! @brief キー文字列の削除を予約する
+
+		@param [in] key キー文字列
+
+		commit() まで読み取り側からは見えない。
+		*/
+		template <typename Key>
+		void erase(Key const& key)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pending.push_back(operation{ std::vector<label_type>(std::begin(key), std::end(key)), 0, true });
+		}
+
+		/*! @brief 予約された変更の数を返す
+		*/
+		std::size_t pending() const
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_pending.size();
+		}
+
+		/*! @brief 予約された変更を適用した版を公開する
+
+		現在の版を複製し、予約された順に変更を適用してから公開する。
+		予約が無い場合、何もしない。
+		公開後、参照されなくなった古い版を解放する。
+		*/
+		void commit()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_pending.empty()) return;
+
+			auto trie = std::make_unique<trie_type>(*m_current.load());
+			for (operation const& op : m_pending)
+			{
+				if (op.m_erase) trie->erase(op.m_key.begin(), op.m_key.end());
+				else
+				{
+					auto it = trie->find(op.m_key.begin(), op.m_key.end());
+					if (it == trie->cend()) trie->insert(op.m_key.begin(), op.m_key.end(), op.m_value);
+					else trie->at(it) = op.m_value;
+				}
+			}
+			m_pending.clear();
+
+			publish(trie.release());
+		}
+
+		/*! @brief 文字列リストから構築した版を公開する
+
+		予約された変更は破棄される。
+
+		@sa basic_trie::assign()
+		*/
+		template <typename ForwardIterator>
+		void assign(ForwardIterator first, ForwardIterator last)
+		{
+			auto trie = std::make_unique<trie_type>(first, last);
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pending.clear();
+			publish(trie.release());
+		}
+
+		/*! @brief 参照されなくなった古い版を解放する
+
+		@return 解放されずに残っている古い版の数
+
+		commit() からも呼び出される。
+		*/
+		std::size_t reclaim()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return collect();
+		}
+
+		/*! @brief 公開された版の数を返す
+
+		版を公開する度に一つ進む。
+		*/
+		std::uint64_t version() const { return m_epoch.load() - 1; }
+
+	protected:
+		/*! 版を置き換え、古い版を退避する
+		- ミューテックスを取った状態で呼び出す。
+		*/
+		void publish(trie_type const* trie)
+		{
+			trie_type const* old = m_current.exchange(trie);
+			std::uint64_t epoch = m_epoch.fetch_add(1);
+
+			m_retired.emplace_back(epoch, old);
+			collect();
+		}
+
+		/*! 固定中の reader のエポックより前に退避された版を解放する
+		- ミューテックスを取った状態で呼び出す。
+		*/
+		std::size_t collect()
+		{
+			std::uint64_t min = std::numeric_limits<std::uint64_t>::max();
+			for (reader_slot* slot = m_slots.load(); slot != nullptr; slot = slot->m_next)
+			{
+				std::uint64_t epoch = slot->m_epoch.load();
+				if (epoch != 0) min = std::min(min, epoch);
+			}
+
+			auto it = std::remove_if(m_retired.begin(), m_retired.end(), [min](auto const& pair)
+			{
+				if (min <= pair.first) return false;
+				delete pair.second;
+				return true;
+			});
+			m_retired.erase(it, m_retired.end());
+
+			return m_retired.size();
+		}
+
+	protected:
+		std::atomic<trie_type const*>     m_current;
+		std::atomic<std::uint64_t>        m_epoch;
+		mutable std::atomic<reader_slot*> m_slots;
+
+		mutable std::mutex                                      m_mutex;
+		std::vector<operation>                                  m_pending;
+		std::vector<std::pair<std::uint64_t, trie_type const*>> m_retired;
+	};
+
+	/*! @brief 読み取りがロックを取らない、メモリー使用量削減を目標とする汎用Trie
+	*/
+	template <typename Label, typename Allocator = std::allocator<detail::trie_node>>
+	using concurrent_trie = basic_concurrent_trie<Label, detail::trie_base<Allocator>>;
+
+	/*! @brief 読み取りがロックを取らない、葉からの空遷移先INDEXが衝突によって変更されない汎用Trie
+	*/
+	template <typename Label, typename Allocator = std::allocator<detail::trie_node>>
+	using stable_concurrent_trie = basic_concurrent_trie<Label, detail::stable_trie_base<Allocator>>;
+}
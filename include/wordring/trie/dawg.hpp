@@ -0,0 +1,662 @@
+﻿#pragma once
+
+#include <wordring/serialize/serialize_iterator.hpp>
+#include <wordring/trie/dawg_iterator.hpp>
+#include <wordring/trie/trie_heap.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace wordring::detail
+{
+	// ------------------------------------------------------------------------
+	// dawg_builder
+	// ------------------------------------------------------------------------
+
+	/*! @brief 整列されたバイト列から最小非巡回オートマトンを構築する
+
+	Daciuk らの逐次構築法を用いる。
+	キーを辞書順に追加し、直前のキーと共有しなくなった経路を葉側から確定させる。
+	確定の際、遷移と終端の有無が等しい状態を登録簿から探して併合するため、
+	同じ接尾辞を持つ部分木は一つにまとめられる。
+
+	状態0は常に根である。
+	*/
+	class dawg_builder
+	{
+	public:
+		using state_id = std::uint32_t;
+
+		struct state
+		{
+			std::vector<std::pair<std::uint8_t, state_id>> m_edges;
+			bool                                           m_final;
+		};
+
+	protected:
+		using signature = std::vector<std::uint32_t>;
+
+		struct signature_hash
+		{
+			std::size_t operator()(signature const& s) const noexcept
+			{
+				std::size_t h = 14695981039346656037ull;
+				for (std::uint32_t v : s) h = (h ^ v) * 1099511628211ull;
+				return h;
+			}
+		};
+
+		struct transition
+		{
+			state_id     m_parent;
+			std::uint8_t m_label;
+			state_id     m_child;
+		};
+
+	public:
+		dawg_builder()
+			: m_states(1, state{ {}, false })
+			, m_register()
+			, m_unchecked()
+			, m_garbage()
+			, m_previous()
+		{
+		}
+
+		/*! @brief キーを追加する
+
+		@param [in] key 追加するバイト列
+
+		キーは空でなく、直前に追加したキーより辞書順で大きくなければならない。
+		*/
+		void push_back(std::string const& key)
+		{
+			assert(!key.empty());
+			assert(m_previous.empty() || m_previous < key);
+
+			std::size_t n = std::mismatch(key.begin(), key.end(), m_previous.begin(), m_previous.end()).first - key.begin();
+			minimize(n);
+
+			state_id parent = m_unchecked.empty() ? 0 : m_unchecked.back().m_child;
+			for (std::size_t i = n; i < key.size(); ++i)
+			{
+				state_id child = create();
+				std::uint8_t label = static_cast<std::uint8_t>(key[i]);
+				m_states[parent].m_edges.emplace_back(label, child);
+				m_unchecked.push_back({ parent, label, child });
+				parent = child;
+			}
+			m_states[parent].m_final = true;
+
+			m_previous = key;
+		}
+
+		/*! @brief 残りの経路を確定させる
+		*/
+		void finish()
+		{
+			minimize(0);
+			m_register.clear();
+			m_previous.clear();
+		}
+
+		std::vector<state> const& states() const noexcept { return m_states; }
+
+	protected:
+		state_id create()
+		{
+			if (m_garbage.empty())
+			{
+				m_states.push_back(state{ {}, false });
+				return static_cast<state_id>(m_states.size() - 1);
+			}
+
+			state_id id = m_garbage.back();
+			m_garbage.pop_back();
+			m_states[id].m_edges.clear();
+			m_states[id].m_final = false;
+
+			return id;
+		}
+
+		/*! 深さnより下の未確定の遷移を確定させる
+		*/
+		void minimize(std::size_t n)
+		{
+			while (n < m_unchecked.size())
+			{
+				transition const& t = m_unchecked.back();
+				state const& s = m_states[t.m_child];
+
+				signature key;
+				key.reserve(s.m_edges.size() * 2 + 1);
+				key.push_back(s.m_final);
+				for (auto const& e : s.m_edges)
+				{
+					key.push_back(e.first);
+					key.push_back(e.second);
+				}
+
+				auto it = m_register.find(key);
+				if (it != m_register.end())
+				{
+					m_states[t.m_parent].m_edges.back().second = it->second;
+					m_garbage.push_back(t.m_child);
+				}
+				else m_register.emplace(std::move(key), t.m_child);
+
+				m_unchecked.pop_back();
+			}
+		}
+
+	protected:
+		std::vector<state>                                     m_states;
+		std::unordered_map<signature, state_id, signature_hash> m_register;
+		std::vector<transition>                                m_unchecked;
+		std::vector<state_id>                                  m_garbage;
+		std::string                                            m_previous;
+	};
+}
+
+namespace wordring
+{
+	// ------------------------------------------------------------------------
+	// basic_dawg
+	// ------------------------------------------------------------------------
+
+	/*! @class basic_dawg dawg.hpp wordring/trie/dawg.hpp
+
+	@brief 接尾辞を共有する読み取り専用の最小非巡回オートマトン
+
+	@tparam Label     ラベルとして使用する任意の整数型
+	@tparam Allocator アロケータ
+
+	basic_trie は接頭辞を共有するが、活用語尾や「-ing」「-tion」のような接尾辞は語の数だけ重複する。
+	このクラスは文字列リストから最小非巡回オートマトン（DAWG）を構築し、
+	同じ接尾辞を持つ部分木を一つの子ブロックにまとめて trie_node のダブル・アレイへ格納する。
+
+	構築後の変更は出来ない。
+	検索とイテレータは basic_trie と同じインターフェースを持つ。
+	葉に値は格納しない。
+
+	@par 配列の利用法
+
+	ノードの形式は detail::trie_heap と同じだが、複数のノードが同じBASEを持ち、子ブロックを共有する。
+	そのため、遷移の判定は「CHECKが親と一致する」ではなく、
+	「CHECKが指すノードのBASEが親のBASEと一致する」で行う。
+	CHECKは子ブロックを共有するノードのうち、最初に配置されたものを指す。
+
+	この判定は1回多く配列を読む。
+	異なる子ブロックには異なるBASEを割り当てるため、誤った遷移を受け入れない。
+	CHECKが親を一意に示さないため、イテレータは根からの経路を保持する。
+	detail::trie_heap::compact() や basic_trie_view は、この配列に使えない。
+
+	@par 例
+	@code
+		std::vector<std::string> v{ "cooking", "looking", "taking", "walking" };
+		auto d = dawg<char>(v.begin(), v.end());
+
+		assert(d.contains(std::string("looking")));
+		assert(d.search(std::string("wal")) != d.end());
+	@endcode
+
+	- @ref wordring::basic_trie
+	- @ref detail::dawg_builder
+	- @ref detail::const_dawg_iterator
+	*/
+	template <typename Label, typename Allocator = std::allocator<detail::trie_node>>
+	class basic_dawg : protected detail::trie_heap<Allocator>
+	{
+		template <typename Label1, typename Allocator1>
+		friend std::ostream& operator<<(std::ostream&, basic_dawg<Label1, Allocator1> const&);
+
+		template <typename Label1, typename Allocator1>
+		friend std::istream& operator>>(std::istream&, basic_dawg<Label1, Allocator1>&);
+
+	protected:
+		using base_type = detail::trie_heap<Allocator>;
+
+		using typename base_type::container;
+		using typename base_type::index_type;
+		using typename base_type::label_vector;
+		using typename base_type::node_type;
+
+		using base_type::null_value;
+
+	public:
+		using label_type     = Label;
+		using size_type      = typename container::size_type;
+		using allocator_type = Allocator;
+		using const_iterator = detail::const_dawg_iterator<label_type, container>;
+
+		using typename base_type::serialize_iterator;
+
+		using base_type::get_allocator;
+		using base_type::ibegin;
+		using base_type::iend;
+		using base_type::data;
+		using base_type::node_size;
+		using base_type::clear;
+
+	protected:
+		using base_type::limit;
+
+		using base_type::m_c;
+		using base_type::m_free;
+
+		static std::uint32_t constexpr coefficient = sizeof(label_type);
+
+		static_assert(std::is_integral_v<label_type>);
+
+	protected:
+		/*! 未使用ノードを検索する
+		- detail::trie_heap::locate() と同じだが、BASEの値が他の子ブロックと重複しない位置を返す。
+		- BASEの値で子ブロックを識別するため、異なるブロックが同じBASEを持ってはならない。
+		- usedは使用済みのBASEをビットで表す。
+		*/
+		index_type locate(label_vector const& labels, std::vector<std::uint64_t> const& used, index_type& before) const
+		{
+			assert(!labels.empty());
+			assert(std::is_sorted(labels.begin(), labels.end()));
+
+			base_type::sync();
+
+			auto word = [&used](std::size_t i) { return i < used.size() ? used[i] : std::uint64_t(0); };
+
+			// baseから始まる64個のBASEのうち、使用済みのもの
+			auto exclude = [&word](std::size_t base)
+			{
+				std::size_t i = base / 64;
+				std::uint32_t shift = base % 64;
+
+				std::uint64_t result = word(i) >> shift;
+				if (shift != 0) result |= word(i + 1) << (64 - shift);
+
+				return result;
+			};
+
+			std::uint16_t offset = labels.front();
+
+			// 空きノードが無い場合、すべてのラベルが新規にreserveされるノードに配置される。
+			index_type idx = m_free.next(offset + 1);
+			index_type base = (idx != 0)
+				? idx - offset
+				: std::max<index_type>(limit() - offset, 1);
+
+			if (idx != 0)
+			{
+				std::uint64_t walk = 0;
+				base = m_free.find(base, detail::trie_label_set(labels), walk, exclude);
+			}
+			else while (exclude(base) & 1) base += std::countr_zero(~exclude(base));
+
+			before = m_free.prev(base + offset);
+
+			assert(1 <= base);
+			assert(base_type::is_free(base, labels));
+			assert((exclude(base) & 1) == 0);
+
+			return base;
+		}
+
+	public:
+		/*! @brief 空のコンテナを構築する
+		*/
+		basic_dawg()
+			: base_type()
+		{
+		}
+
+		/*! @brief アロケータを指定して空のコンテナを構築する
+
+		@param [in] alloc アロケータ
+		*/
+		explicit basic_dawg(allocator_type const& alloc)
+			: base_type(alloc)
+		{
+		}
+
+		/*! @brief 直列化データから構築する
+
+		@param [in] first 直列化データの先頭を指すイテレータ
+		@param [in] last  直列化データの終端を指すイテレータ
+		@param [in] alloc アロケータ
+		*/
+		template <typename InputIterator, typename std::enable_if_t<std::is_integral_v<typename std::iterator_traits<InputIterator>::value_type>, std::nullptr_t> = nullptr>
+		basic_dawg(InputIterator first, InputIterator last, allocator_type const& alloc = allocator_type())
+			: base_type(alloc)
+		{
+			assign(first, last);
+		}
+
+		/*! @brief 文字列のリストから構築する
+
+		@param [in] first 文字列リストの先頭を指すイテレータ
+		@param [in] last  文字列リストの終端を指すイテレータ
+		@param [in] alloc アロケータ
+
+		@sa assign(ForwardIterator first, ForwardIterator last)
+		*/
+		template <typename ForwardIterator, typename std::enable_if_t<std::negation_v<std::is_integral<typename std::iterator_traits<ForwardIterator>::value_type>>, std::nullptr_t> = nullptr>
+		basic_dawg(ForwardIterator first, ForwardIterator last, allocator_type const& alloc = allocator_type())
+			: base_type(alloc)
+		{
+			assign(first, last);
+		}
+
+		/*! @brief 直列化データから割り当てる
+
+		@param [in] first 直列化データの先頭を指すイテレータ
+		@param [in] last  直列化データの終端を指すイテレータ
+
+		@sa detail::trie_heap::assign(InputIterator first, InputIterator last)
+		*/
+		template <typename InputIterator, typename std::enable_if_t<std::is_integral_v<typename std::iterator_traits<InputIterator>::value_type>, std::nullptr_t> = nullptr>
+		void assign(InputIterator first, InputIterator last)
+		{
+			base_type::assign(first, last);
+		}
+
+		/*! @brief 文字列リストから割り当てる
+
+		@param [in] first 文字列リストの先頭を指すイテレータ
+		@param [in] last  文字列リストの終端を指すイテレータ
+
+		文字列リストは整列されている必要も、重複が無い必要もない。
+		空の文字列は無視される。
+
+		最小化した状態を根から幅優先に配置する。
+		子ブロックを持つ状態は、最初に訪れた時にだけブロックを配置し、
+		二度目以降は同じBASEを設定する。
+
+		@par 例
+		@code
+			std::vector<std::u32string> v{ U"たべる", U"たべない", U"のべる", U"のべない" };
+
+			dawg<char32_t> d;
+			d.assign(v.begin(), v.end());
+		@endcode
+		*/
+		template <typename ForwardIterator, typename std::enable_if_t<std::negation_v<std::is_integral<typename std::iterator_traits<ForwardIterator>::value_type>>, std::nullptr_t> = nullptr>
+		void assign(ForwardIterator first, ForwardIterator last)
+		{
+			using state_id = detail::dawg_builder::state_id;
+
+			assert(coefficient == sizeof(typename std::iterator_traits<ForwardIterator>::value_type::value_type));
+
+			// バイト列に変換して整列する
+			std::vector<std::string> keys;
+			for (; first != last; ++first)
+			{
+				auto it1 = wordring::serialize_iterator(std::begin(*first));
+				auto it2 = wordring::serialize_iterator(std::end(*first));
+				keys.emplace_back(it1, it2);
+			}
+			std::sort(keys.begin(), keys.end());
+			keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+			if (!keys.empty() && keys.front().empty()) keys.erase(keys.begin());
+
+			detail::dawg_builder builder;
+			for (auto const& key : keys) builder.push_back(key);
+			builder.finish();
+
+			auto const& states = builder.states();
+
+			clear();
+
+			std::vector<index_type> bases(states.size(), 0); // 状態毎に配置した子ブロックのBASE
+			std::vector<std::uint64_t> used;                 // BASEとして使用済みの値のビット
+
+			std::vector<std::pair<index_type, state_id>> queue(1, { 1, 0 }); // ノードと状態の待ち行列
+			for (std::size_t i = 0; i < queue.size(); ++i)
+			{
+				index_type idx = queue[i].first;
+				auto const& s = states[queue[i].second];
+
+				if (s.m_edges.empty()) continue; // 葉
+
+				index_type base = bases[queue[i].second];
+				if (base == 0)
+				{
+					label_vector labels;
+					for (auto const& e : s.m_edges) labels.push_back(e.first);
+					if (s.m_final) labels.push_back(null_value);
+
+					index_type before = 0;
+					base = locate(labels, used, before);
+					base_type::allocate(base, labels, before);
+					bases[queue[i].second] = base;
+
+					if (used.size() <= static_cast<std::size_t>(base) / 64) used.resize(base / 64 + 1);
+					used[base / 64] |= std::uint64_t(1) << (base % 64);
+
+					node_type* d = m_c.data();
+					for (std::uint16_t label : labels) (d + base + label)->m_check = idx;
+					for (auto const& e : s.m_edges) queue.emplace_back(base + e.first, e.second);
+				}
+
+				(m_c.data() + idx)->m_base = base;
+			}
+
+			m_c.front().m_base = static_cast<index_type>(keys.size());
+		}
+
+		// イテレータ ----------------------------------------------------------
+
+		/*! @brief 根を指すイテレータを返す
+		*/
+		const_iterator begin() const noexcept { return const_iterator(m_c, 1); }
+
+		/*! @brief 根を指すイテレータを返す
+		*/
+		const_iterator cbegin() const noexcept { return const_iterator(m_c, 1); }
+
+		/*! @brief 根の終端を指すイテレータを返す
+		*/
+		const_iterator end() const noexcept { return const_iterator(m_c, 0); }
+
+		/*! @brief 根の終端を指すイテレータを返す
+		*/
+		const_iterator cend() const noexcept { return const_iterator(m_c, 0); }
+
+		// 容量 ---------------------------------------------------------------
+
+		/*! @brief キー文字列を格納していないことを調べる
+		*/
+		bool empty() const noexcept { return size() == 0; }
+
+		/*! @brief 格納しているキー文字列数を調べる
+		*/
+		size_type size() const noexcept { return static_cast<std::uint32_t>(m_c.front().m_base); }
+
+		// 変更 ---------------------------------------------------------------
+
+		void swap(basic_dawg& other)
+		{
+			base_type::swap(other);
+		}
+
+		// 検索 ---------------------------------------------------------------
+
+		/*! @brief 部分一致検索
+
+		@param [in] first 検索するキー文字列の先頭を指すイテレータ
+		@param [in] last  検索するキー文字列の終端を指すイテレータ
+
+		@return 一致した最後のノードと次の文字を指すイテレータのペア
+
+		一文字も一致しない場合、cbegin()を返す。
+
+		@sa basic_trie::lookup(InputIterator first, InputIterator last) const
+		*/
+		template <typename InputIterator>
+		auto lookup(InputIterator first, InputIterator last) const
+		{
+			assert(coefficient == sizeof(typename std::iterator_traits<InputIterator>::value_type));
+
+			const_iterator it = cbegin();
+
+			auto it1 = wordring::serialize_iterator(first);
+			auto it2 = wordring::serialize_iterator(last);
+
+			std::uint32_t i = 0;
+			for (; it1 != it2; ++it1, ++i)
+			{
+				index_type idx = it.at_index(it.m_index, *it1);
+				if (idx == 0) break;
+
+				it.m_path.push_back(it.m_index);
+				it.m_index = idx;
+			}
+
+			// ラベルの途中で一致しなくなった場合、ラベルの境界まで戻る。
+			for (i = i % coefficient; i != 0; --i)
+			{
+				it.m_index = it.m_path.back();
+				it.m_path.pop_back();
+			}
+
+			return std::make_pair(it, it1.base());
+		}
+
+		/*! @brief 前方一致検索
+
+		@param [in] first 検索するキー文字列の先頭を指すイテレータ
+		@param [in] last  検索するキー文字列の終端を指すイテレータ
+
+		@return 一致した最後のノード、一致しない場合 cend()
+		*/
+		template <typename InputIterator>
+		const_iterator search(InputIterator first, InputIterator last) const
+		{
+			auto pair = lookup(first, last);
+
+			return (pair.second == last)
+				? pair.first
+				: cend();
+		}
+
+		/*! @brief 前方一致検索
+
+		@param [in] key 検索するキー文字列
+
+		@return 一致した最後のノード、一致しない場合 cend()
+		*/
+		template <typename Key>
+		const_iterator search(Key const& key) const
+		{
+			return search(std::begin(key), std::end(key));
+		}
+
+		/*! @brief 完全一致検索
+
+		@param [in] first 検索するキー文字列の先頭を指すイテレータ
+		@param [in] last  検索するキー文字列の終端を指すイテレータ
+
+		@return
+			入力されたキー文字列と完全に一致する葉がある場合、そのノードを指すイテレータ。
+			それ以外の場合、 cend() 。
+		*/
+		template <typename InputIterator>
+		const_iterator find(InputIterator first, InputIterator last) const
+		{
+			auto pair = lookup(first, last);
+
+			return (pair.second == last && pair.first)
+				? pair.first
+				: cend();
+		}
+
+		/*! @brief 完全一致検索
+
+		@param [in] key 検索するキー文字列
+
+		@return
+			入力されたキー文字列と完全に一致する葉がある場合、そのノードを指すイテレータ。
+			それ以外の場合、 cend() 。
+		*/
+		template <typename Key>
+		const_iterator find(Key const& key) const
+		{
+			return find(std::begin(key), std::end(key));
+		}
+
+		/*! @brief キー文字列が格納されているか調べる
+
+		@param [in] first キー文字列の先頭を指すイテレータ
+		@param [in] last  キー文字列の終端を指すイテレータ
+
+		@return 格納されている場合 true 、それ以外の場合 false
+
+		イテレータを返さないため、経路を保持せずに遷移する。
+		*/
+		template <typename InputIterator>
+		bool contains(InputIterator first, InputIterator last) const
+		{
+			assert(coefficient == sizeof(typename std::iterator_traits<InputIterator>::value_type));
+
+			const_iterator it = cbegin();
+
+			auto it1 = wordring::serialize_iterator(first);
+			auto it2 = wordring::serialize_iterator(last);
+
+			for (; it1 != it2; ++it1)
+			{
+				it.m_index = it.at_index(it.m_index, *it1);
+				if (it.m_index == 0) return false;
+			}
+
+			return static_cast<bool>(it);
+		}
+
+		/*! @brief キー文字列が格納されているか調べる
+
+		@param [in] key キー文字列
+
+		@return 格納されている場合 true 、それ以外の場合 false
+		*/
+		template <typename Key>
+		bool contains(Key const& key) const
+		{
+			return contains(std::begin(key), std::end(key));
+		}
+	};
+
+	/*! @brief ストリームへ出力する
+
+	速度を必要とする場合、使用を推奨しない。
+	*/
+	template <typename Label1, typename Allocator1>
+	inline std::ostream& operator<<(std::ostream& os, basic_dawg<Label1, Allocator1> const& dawg)
+	{
+		typename basic_dawg<Label1, Allocator1>::base_type const& base = dawg;
+		return os << base;
+	}
+
+	/*! @brief ストリームから入力する
+
+	速度を必要とする場合、使用を推奨しない。
+	*/
+	template <typename Label1, typename Allocator1>
+	inline std::istream& operator>>(std::istream& is, basic_dawg<Label1, Allocator1>& dawg)
+	{
+		typename basic_dawg<Label1, Allocator1>::base_type& base = dawg;
+		return is >> base;
+	}
+
+	/*! @brief 接尾辞を共有する読み取り専用の汎用オートマトン
+	*/
+	template <typename Label, typename Allocator = std::allocator<detail::trie_node>>
+	using dawg = basic_dawg<Label, Allocator>;
+}
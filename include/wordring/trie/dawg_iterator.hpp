@@ -0,0 +1,305 @@
+﻿#pragma once
+
+#include <wordring/trie/trie_heap.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace wordring
+{
+	template <typename Label, typename Allocator>
+	class basic_dawg;
+}
+
+namespace wordring::detail
+{
+	/*! @brief basic_dawg のイテレータ
+
+	@tparam Label     ラベルとして使用する任意の整数型
+	@tparam Container ノード配列のコンテナ
+
+	basic_dawg は同じ接尾辞を持つ部分木の子ブロックを共有するため、ノードのCHECKは親を一意に示さない。
+	このイテレータは根から指しているノードまでのバイト単位の経路を保持し、
+	親の取得とラベルの復元に経路を使う。
+
+	経路を保持するため、コピーのコストは basic_trie のイテレータより高い。
+	*/
+	template <typename Label, typename Container>
+	class const_dawg_iterator
+	{
+		template <typename Label1, typename Allocator1>
+		friend class wordring::basic_dawg;
+
+		template <typename Label1, typename Container1>
+		friend bool operator==(const_dawg_iterator<Label1, Container1> const&, const_dawg_iterator<Label1, Container1> const&);
+
+		template <typename Label1, typename Container1>
+		friend bool operator!=(const_dawg_iterator<Label1, Container1> const&, const_dawg_iterator<Label1, Container1> const&);
+
+	protected:
+		using index_type = typename trie_node::index_type;
+		using node_type  = trie_node;
+		using container  = Container const;
+
+		using unsigned_type = std::make_unsigned_t<Label>;
+
+	public:
+		using difference_type   = std::ptrdiff_t;
+		using value_type        = Label;
+		using pointer           = value_type*;
+		using reference         = value_type&;
+		using iterator_category = std::input_iterator_tag;
+
+		static constexpr std::uint16_t null_value = 256u;
+		static std::uint32_t constexpr coefficient = sizeof(value_type);
+
+		static_assert(std::is_integral_v<value_type>);
+
+	public:
+		const_dawg_iterator()
+			: m_c(nullptr)
+			, m_index(0)
+			, m_path()
+		{
+		}
+
+	protected:
+		const_dawg_iterator(container& c, index_type index)
+			: m_c(std::addressof(c))
+			, m_index(index)
+			, m_path()
+		{
+		}
+
+	public:
+		/*! @brief 文字列終端の場合trueを返す
+		*/
+		operator bool() const
+		{
+			if (m_index <= 1) return false;
+
+			index_type base = (m_c->data() + m_index)->m_base;
+
+			return base <= 0 || owns(base, base + null_value);
+		}
+
+		bool operator!() const { return operator bool() == false; }
+
+		/*! @brief 親から当該ノードへの遷移に使われたラベルを返す
+		*/
+		value_type operator*() const
+		{
+			assert(1 < m_index && m_index < limit());
+			assert(coefficient <= m_path.size());
+
+			node_type const* d = m_c->data();
+
+			value_type result = 0;
+
+			index_type idx = m_index;
+			for (std::uint32_t i = 0; i < coefficient; ++i)
+			{
+				index_type parent = m_path[m_path.size() - 1 - i];
+				result += static_cast<value_type>(static_cast<unsigned_type>(idx - (d + parent)->m_base) << (i * 8));
+				idx = parent;
+			}
+
+			return result;
+		}
+
+		/*! @brief ラベルで遷移できる子を返す
+
+		@param [in] label 遷移ラベル
+
+		@return 遷移先のノードを指すイテレータ、遷移先が無い場合 end()
+		*/
+		const_dawg_iterator operator[](value_type label) const
+		{
+			auto result = *this;
+
+			for (std::uint32_t i = 0; i < coefficient; ++i)
+			{
+				std::uint8_t ch = static_cast<unsigned_type>(label) >> (coefficient - i - 1) * 8 & 0xFFu;
+				index_type idx = at_index(result.m_index, ch);
+				if (idx == 0) return end();
+
+				result.m_path.push_back(result.m_index);
+				result.m_index = idx;
+			}
+
+			return result;
+		}
+
+		/*! @brief 次の兄弟へ移動する
+
+		兄弟が無い場合、 end() と等しくなる。
+		*/
+		const_dawg_iterator& operator++()
+		{
+			node_type const* d = m_c->data();
+
+			index_type    idx = 0;
+			std::uint32_t lv = 0;
+
+			// 右、あるいは右上を探す
+			for (index_type i = m_index; lv < coefficient && !m_path.empty(); ++lv)
+			{
+				index_type base = (d + m_path.back())->m_base;
+				idx = find(i + 1, base + null_value, base);
+				if (idx != 0) break;
+
+				i = m_path.back();
+				m_path.pop_back();
+			}
+
+			if (idx == 0)
+			{
+				m_index = 0;
+				m_path.clear();
+				return *this;
+			}
+
+			// 足の長さをそろえる
+			for (; 0 < lv; --lv)
+			{
+				index_type base = (d + idx)->m_base;
+				m_path.push_back(idx);
+				idx = find(base, base + null_value, base);
+				assert(idx != 0);
+			}
+
+			m_index = idx;
+
+			return *this;
+		}
+
+		const_dawg_iterator operator++(int)
+		{
+			auto result = *this;
+			operator++();
+			return result;
+		}
+
+		/*! @brief 根からイテレータが指すノードまでのラベル列を返す
+
+		@param [out] result ラベル列を出力する先のコンテナ
+		*/
+		template <typename String>
+		void string(String& result) const
+		{
+			result.clear();
+			for (auto p = *this; 1 < p.m_index; p = p.parent()) result.push_back(*p);
+			std::reverse(std::begin(result), std::end(result));
+		}
+
+		/*! @brief 親を取得する
+		*/
+		const_dawg_iterator parent() const
+		{
+			if (m_path.size() < coefficient) return end();
+
+			auto result = *this;
+			result.m_index = m_path[m_path.size() - coefficient];
+			result.m_path.resize(m_path.size() - coefficient);
+
+			return result;
+		}
+
+		/*! @brief 最初の子を指すイテレータを返す
+
+		空遷移は含めない。
+		子が無い場合、 end() を返す。
+		*/
+		const_dawg_iterator begin() const
+		{
+			auto result = *this;
+
+			node_type const* d = m_c->data();
+			for (std::uint32_t lv = 0; lv < coefficient; ++lv)
+			{
+				index_type base = (d + result.m_index)->m_base;
+				index_type idx = (1 <= base)
+					? find(base, base + null_value, base)
+					: 0;
+				if (idx == 0) return end();
+
+				result.m_path.push_back(result.m_index);
+				result.m_index = idx;
+			}
+
+			return result;
+		}
+
+		const_dawg_iterator end() const
+		{
+			const_dawg_iterator result;
+			result.m_c = m_c;
+
+			return result;
+		}
+
+	protected:
+		index_type limit() const { return static_cast<index_type>(m_c->size()); }
+
+		/*! idxがBASEを値baseとする子ブロックに属する場合、trueを返す
+		- CHECKはブロックを共有する親のうち、いずれか一つを指す。
+		- その親のBASEがbaseと一致すれば、同じブロックである。
+		*/
+		bool owns(index_type base, index_type idx) const
+		{
+			if (limit() <= idx) return false;
+
+			node_type const* d = m_c->data();
+			index_type check = (d + idx)->m_check;
+
+			return 1 <= check && (d + check)->m_base == base;
+		}
+
+		/*! parentからlabelで遷移したINDEXを返す
+		- 遷移先が無ければ0を返す。
+		*/
+		index_type at_index(index_type parent, std::uint16_t label) const
+		{
+			index_type base = (m_c->data() + parent)->m_base;
+			if (base <= 0) return 0;
+
+			index_type idx = base + label;
+			return owns(base, idx)
+				? idx
+				: 0;
+		}
+
+		/*! [first, last)の範囲で、BASEを値baseとする子ブロックに属する最初のINDEXを返す
+		- 見つからない場合、0を返す。
+		*/
+		index_type find(index_type first, index_type last, index_type base) const
+		{
+			index_type tail = std::min(last, limit());
+			for (; first < tail; ++first) if (owns(base, first)) return first;
+
+			return 0;
+		}
+
+	protected:
+		container*              m_c;
+		index_type              m_index;
+		std::vector<index_type> m_path;
+	};
+
+	template <typename Label1, typename Container1>
+	inline bool operator==(const_dawg_iterator<Label1, Container1> const& lhs, const_dawg_iterator<Label1, Container1> const& rhs)
+	{
+		return lhs.m_index == rhs.m_index && lhs.m_path == rhs.m_path;
+	}
+
+	template <typename Label1, typename Container1>
+	inline bool operator!=(const_dawg_iterator<Label1, Container1> const& lhs, const_dawg_iterator<Label1, Container1> const& rhs)
+	{
+		return !(lhs == rhs);
+	}
+}
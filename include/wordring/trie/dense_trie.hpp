@@ -0,0 +1,509 @@
+﻿#pragma once
+
+#include <wordring/serialize/serialize.hpp>
+#include <wordring/trie/dense_trie_iterator.hpp>
+#include <wordring/trie/stable_trie_base.hpp>
+#include <wordring/trie/trie_base.hpp>
+#include <wordring/trie/trie_label_map.hpp>
+
+#include <algorithm>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace wordring
+{
+	// ------------------------------------------------------------------------
+	// basic_dense_trie
+	// ------------------------------------------------------------------------
+
+	/*! @class basic_dense_trie dense_trie.hpp wordring/trie/dense_trie.hpp
+
+	@brief ラベルを頻度順の可変長符号へ写像して格納する汎用Trie
+
+	@tparam Label ラベルとして使用する任意の整数型
+	@tparam Base  基本クラスとして使用するTrie実装クラス
+
+	basic_trie は char32_t のラベル1つを4バイトの遷移として格納するため、日本語の5文字の単語でも
+	20回の遷移が必要になる。
+	このクラスは assign() に与えられた文字列リストのラベル頻度から detail::trie_label_map を構築し、
+	頻出する192個のラベルを1バイト、続く12,096個のラベルを2バイトの符号として格納する。
+	表に無いラベルも挿入できるが、 1 + trie_label_map::escape_length バイトの符号となる。
+
+	写像表はコンテナと共にストリームへ入出力され、挿入・検索・イテレータの操作では透過的に適用される。
+
+	@code
+		template <typename Label, typename Allocator = std::allocator<detail::trie_node>>
+		using dense_trie = basic_dense_trie<Label, detail::trie_base<Allocator>>;
+
+		template <typename Label, typename Allocator = std::allocator<detail::trie_node>>
+		using stable_dense_trie = basic_dense_trie<Label, detail::stable_trie_base<Allocator>>;
+	@endcode
+
+	@par basic_trie との違い
+
+	- 兄弟の順序は符号の順序であり、ラベルの順序と一致しない。
+	- 写像表は assign() で構築される。
+	  空のコンテナへ insert() のみで格納する場合、全てのラベルが表に無いラベルとして扱われる。
+	- ibegin() 、 iend() による直列化データは写像表を含まない。
+	  写像表は label_map() から取得し、 assign_labels() で復元する。
+
+	@par 例
+	@code
+		std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+		auto t = dense_trie<char32_t>(v.begin(), v.end());
+
+		assert(t.contains(std::u32string(U"うあい")));
+	@endcode
+
+	- @ref wordring::basic_trie
+	- @ref detail::trie_label_map
+	- @ref detail::const_dense_trie_iterator
+	*/
+	template <typename Label, typename Base>
+	class basic_dense_trie : public Base
+	{
+		template <typename Label1, typename Base1>
+		friend std::ostream& operator<<(std::ostream&, basic_dense_trie<Label1, Base1> const&);
+
+		template <typename Label1, typename Base1>
+		friend std::istream& operator>>(std::istream&, basic_dense_trie<Label1, Base1>&);
+
+	protected:
+		using base_type = Base;
+
+		using typename base_type::container;
+		using typename base_type::index_type;
+		using typename base_type::node_type;
+
+		using base_type::null_value;
+
+	public:
+		using label_type      = Label;
+		using value_type      = std::uint32_t;
+		using size_type       = typename container::size_type;
+		using allocator_type  = typename base_type::allocator_type;
+		using reference       = detail::trie_value_proxy;
+		using const_reference = detail::trie_value_proxy const;
+		using const_iterator  = detail::const_dense_trie_iterator<label_type, typename base_type::const_iterator>;
+		using label_map_type  = detail::trie_label_map<label_type>;
+
+	public:
+		using typename base_type::serialize_iterator;
+
+		using base_type::get_allocator;
+		using base_type::ibegin;
+		using base_type::iend;
+		using base_type::clear;
+
+	protected:
+		using base_type::is_tail;
+
+		using base_type::m_c;
+
+		template <typename InputIterator>
+		using encode_iterator = detail::trie_label_encode_iterator<InputIterator, label_type>;
+
+		static_assert(std::is_integral_v<label_type>);
+
+	public:
+		/*! @brief 空のコンテナを構築する
+		*/
+		basic_dense_trie()
+			: base_type()
+			, m_map()
+		{
+		}
+
+		/*! @brief アロケータを指定して空のコンテナを構築する
+
+		@param [in] alloc アロケータ
+		*/
+		explicit basic_dense_trie(allocator_type const& alloc)
+			: base_type(alloc)
+			, m_map()
+		{
+		}
+
+		/*! @brief 文字列のリストから構築する
+
+		@param [in] first 文字列リストの先頭を指すイテレータ
+		@param [in] last  文字列リストの終端を指すイテレータ
+		@param [in] alloc アロケータ
+
+		@sa assign(ForwardIterator first, ForwardIterator last)
+		*/
+		template <typename ForwardIterator, typename std::enable_if_t<std::negation_v<std::is_integral<typename std::iterator_traits<ForwardIterator>::value_type>>, std::nullptr_t> = nullptr>
+		basic_dense_trie(ForwardIterator first, ForwardIterator last, allocator_type const& alloc = allocator_type())
+			: base_type(alloc)
+			, m_map()
+		{
+			assign(first, last);
+		}
+
+		/*! @brief 直列化データと写像表から割り当てる
+
+		@param [in] first 直列化データの先頭を指すイテレータ
+		@param [in] last  直列化データの終端を指すイテレータ
+
+		写像表は変更されない。
+		直列化データを作成した時と同じ写像表を assign_labels() で事前に設定する必要がある。
+		*/
+		template <typename InputIterator, typename std::enable_if_t<std::is_integral_v<typename std::iterator_traits<InputIterator>::value_type>, std::nullptr_t> = nullptr>
+		void assign(InputIterator first, InputIterator last)
+		{
+			base_type::assign(first, last);
+		}
+
+		/*! @brief 文字列リストから割り当てる
+
+		@param [in] first 文字列リストの先頭を指すイテレータ
+		@param [in] last  文字列リストの終端を指すイテレータ
+
+		文字列リストのラベル頻度から写像表を構築し、符号化した文字列リストを整列して格納する。
+		文字列リストは整列されている必要も、重複が無い必要もない。
+		葉の値は全て0に初期化される。
+		*/
+		template <typename ForwardIterator, typename std::enable_if_t<std::negation_v<std::is_integral<typename std::iterator_traits<ForwardIterator>::value_type>>, std::nullptr_t> = nullptr>
+		void assign(ForwardIterator first, ForwardIterator last)
+		{
+			m_map.assign(first, last);
+
+			std::vector<std::string> v;
+			for (; first != last; ++first)
+			{
+				auto it1 = encode_iterator<decltype(std::begin(*first))>(std::begin(*first), m_map);
+				auto it2 = encode_iterator<decltype(std::begin(*first))>(std::end(*first), m_map);
+				if (it1 != it2) v.emplace_back(it1, it2);
+			}
+
+			std::sort(v.begin(), v.end());
+			v.erase(std::unique(v.begin(), v.end()), v.end());
+
+			base_type::assign(v.begin(), v.end());
+		}
+
+		/*! @brief 符号順のラベル列から写像表を設定する
+
+		@param [in] first ラベル列の先頭を指すイテレータ
+		@param [in] last  ラベル列の終端を指すイテレータ
+
+		格納済みの文字列は失われる。
+
+		@sa label_map()
+		*/
+		template <typename InputIterator>
+		void assign_labels(InputIterator first, InputIterator last)
+		{
+			clear();
+			m_map.assign_labels(first, last);
+		}
+
+		/*! @brief 写像表を返す
+		*/
+		label_map_type const& label_map() const noexcept { return m_map; }
+
+		// 要素アクセス --------------------------------------------------------
+
+		/*! @brief 葉の値への参照を返す
+
+		@param [in] pos 葉を指すイテレータ
+
+		@return 葉の値に対するプロキシ
+
+		入力の正当性はチェックされない。
+		*/
+		reference at(const_iterator pos)
+		{
+			return base_type::at(static_cast<typename base_type::const_iterator>(pos));
+		}
+
+		const_reference at(const_iterator pos) const
+		{
+			return const_cast<basic_dense_trie*>(this)->at(pos);
+		}
+
+		/*! @brief 葉の値への参照を返す
+
+		@param [in] first キー文字列の先頭を指すイテレータ
+		@param [in] last  キー文字列の終端を指すイテレータ
+
+		@return 葉の値に対するプロキシ
+
+		@throw std::out_of_range キー文字列が格納されていない場合
+		*/
+		template <typename InputIterator>
+		reference at(InputIterator first, InputIterator last)
+		{
+			auto it = find(first, last);
+			if (it == cend()) throw std::out_of_range("");
+
+			return at(it);
+		}
+
+		template <typename InputIterator>
+		const_reference at(InputIterator first, InputIterator last) const
+		{
+			return const_cast<basic_dense_trie*>(this)->at(first, last);
+		}
+
+		template <typename Key>
+		reference at(Key const& key)
+		{
+			return at(std::begin(key), std::end(key));
+		}
+
+		template <typename Key>
+		const_reference const at(Key const& key) const
+		{
+			return at(std::begin(key), std::end(key));
+		}
+
+		/*! @brief 葉の値への参照を返す
+
+		@param [in] key キー文字列（ラベル列）
+
+		@return 葉の値に対するプロキシ
+
+		キー文字列が格納されていない場合、新たに挿入し、その葉の値への参照を返す。
+		*/
+		template <typename Key>
+		reference operator[](Key const& key)
+		{
+			const_iterator it = find(key);
+			if (it == cend()) it = insert(key);
+
+			return at(it);
+		}
+
+		// イテレータ ----------------------------------------------------------
+
+		/*! @brief 根を指すイテレータを返す
+		*/
+		const_iterator begin() const noexcept { return const_iterator(m_c, 1, m_map); }
+
+		const_iterator cbegin() const noexcept { return const_iterator(m_c, 1, m_map); }
+
+		/*! @brief 根の終端を指すイテレータを返す
+		*/
+		const_iterator end() const noexcept { return const_iterator(m_c, 0, m_map); }
+
+		const_iterator cend() const noexcept { return const_iterator(m_c, 0, m_map); }
+
+		// 容量 ---------------------------------------------------------------
+
+		bool empty() const noexcept { return size() == 0; }
+
+		size_type size() const noexcept
+		{
+			return base_type::size();
+		}
+
+		static constexpr size_type max_size() noexcept
+		{
+			return base_type::max_size();
+		}
+
+		// 変更 ---------------------------------------------------------------
+
+		/*! @brief キー文字列を挿入する
+
+		@param [in] first キー文字列の先頭を指すイテレータ
+		@param [in] last  キー文字列の終端を指すイテレータ
+		@param [in] value 葉へ格納する値（省略時は0）
+
+		@return 挿入された最後の文字に対応するノードを指すイテレータ
+
+		写像表に無いラベルは、表に追加されず、長い符号で格納される。
+		*/
+		template <typename InputIterator>
+		const_iterator insert(InputIterator first, InputIterator last, value_type value = 0)
+		{
+			auto it1 = encode_iterator<InputIterator>(first, m_map);
+			auto it2 = encode_iterator<InputIterator>(last, m_map);
+
+			return const_iterator(base_type::insert(it1, it2, value), m_map);
+		}
+
+		template <typename Key>
+		const_iterator insert(Key const& key, value_type value = 0)
+		{
+			return insert(std::begin(key), std::end(key), value);
+		}
+
+		/*! @brief キー文字列を削除する
+
+		@param [in] pos 削除するキー文字列の末尾に対応するノードへのイテレータ
+		*/
+		void erase(const_iterator pos)
+		{
+			base_type::erase(static_cast<typename base_type::const_iterator>(pos));
+		}
+
+		template <typename InputIterator>
+		void erase(InputIterator first, InputIterator last)
+		{
+			erase(find(first, last));
+		}
+
+		template <typename Key>
+		void erase(Key const& key)
+		{
+			erase(std::begin(key), std::end(key));
+		}
+
+		void swap(basic_dense_trie& other)
+		{
+			base_type::swap(other);
+			m_map.swap(other.m_map);
+		}
+
+		// 検索 ---------------------------------------------------------------
+
+		/*! @brief 部分一致検索
+
+		@param [in] first 検索するキー文字列の先頭を指すイテレータ
+		@param [in] last  検索するキー文字列の終端を指すイテレータ
+
+		@return 一致した最後のノードと次の文字を指すイテレータのペア
+
+		一文字も一致しない場合、cbegin()を返す。
+		*/
+		template <typename InputIterator>
+		auto lookup(InputIterator first, InputIterator last) const
+		{
+			auto it1 = encode_iterator<InputIterator>(first, m_map);
+			auto it2 = encode_iterator<InputIterator>(last, m_map);
+
+			std::uint32_t i = 0;
+			auto ret = base_type::lookup(it1, it2, i);
+
+			// 符号の途中で止まった場合、符号の先頭まで戻る
+			for (i = ret.second.offset(); i != 0; --i) ret.first = ret.first.parent();
+
+			return std::pair<const_iterator, InputIterator>(const_iterator(ret.first, m_map), ret.second.base());
+		}
+
+		/*! @brief 前方一致検索
+
+		@return 一致した最後のノード、一致しない場合 cend()
+		*/
+		template <typename InputIterator>
+		const_iterator search(InputIterator first, InputIterator last) const
+		{
+			auto pair = lookup(first, last);
+
+			return (pair.second == last)
+				? pair.first
+				: cend();
+		}
+
+		template <typename Key>
+		const_iterator search(Key const& key) const
+		{
+			return search(std::begin(key), std::end(key));
+		}
+
+		/*! @brief 完全一致検索
+
+		@return 入力されたキー文字列と完全に一致する葉がある場合、そのノードを指すイテレータ。
+			それ以外の場合、 cend() 。
+		*/
+		template <typename InputIterator>
+		const_iterator find(InputIterator first, InputIterator last) const
+		{
+			auto pair = lookup(first, last);
+
+			return (pair.second == last && is_tail(pair.first.m_index))
+				? pair.first
+				: cend();
+		}
+
+		template <typename Key>
+		const_iterator find(Key const& key) const
+		{
+			return find(std::begin(key), std::end(key));
+		}
+
+		/*! @brief キー文字列が格納されているか調べる
+		*/
+		template <typename InputIterator>
+		bool contains(InputIterator first, InputIterator last) const
+		{
+			auto pair = lookup(first, last);
+
+			return pair.second == last && is_tail(pair.first.m_index);
+		}
+
+		template <typename Key>
+		bool contains(Key const& key) const
+		{
+			return contains(std::begin(key), std::end(key));
+		}
+
+	protected:
+		label_map_type m_map;
+	};
+
+	/*! @brief ストリームへ出力する
+
+	写像表のラベル数、符号順のラベル列、ダブル・アレイの順に出力する。
+
+	速度を必要とする場合、使用を推奨しない。
+	*/
+	template <typename Label1, typename Base1>
+	inline std::ostream& operator<<(std::ostream& os, basic_dense_trie<Label1, Base1> const& trie)
+	{
+		auto const& labels = trie.m_map.labels();
+
+		for (auto ch : serialize(static_cast<std::uint32_t>(labels.size()))) os.put(ch);
+		for (auto label : labels) for (auto ch : serialize(label)) os.put(ch);
+
+		typename basic_dense_trie<Label1, Base1>::base_type const& base = trie;
+		return os << base;
+	}
+
+	/*! @brief ストリームから入力する
+
+	速度を必要とする場合、使用を推奨しない。
+	*/
+	template <typename Label1, typename Base1>
+	inline std::istream& operator>>(std::istream& is, basic_dense_trie<Label1, Base1>& trie)
+	{
+		auto get = [&is](auto& result)
+		{
+			std::make_unsigned_t<std::remove_reference_t<decltype(result)>> buf = 0;
+			for (std::size_t i = 0; i < sizeof(result); ++i) buf = (buf << 8) + static_cast<std::uint8_t>(is.get());
+			result = buf;
+		};
+
+		std::uint32_t n = 0;
+		get(n);
+
+		std::vector<Label1> labels;
+		for (std::uint32_t i = 0; i < n && is; ++i)
+		{
+			Label1 label;
+			get(label);
+			labels.push_back(label);
+		}
+		trie.m_map.assign_labels(labels.begin(), labels.end());
+
+		typename basic_dense_trie<Label1, Base1>::base_type& base = trie;
+		return is >> base;
+	}
+
+	/*! @brief ラベルを可変長符号へ写像する、メモリー使用量削減を目標とする汎用Trie
+	*/
+	template <typename Label, typename Allocator = std::allocator<detail::trie_node>>
+	using dense_trie = basic_dense_trie<Label, detail::trie_base<Allocator>>;
+
+	/*! @brief ラベルを可変長符号へ写像する、葉からの空遷移先INDEXが衝突によって変更されない汎用Trie
+	*/
+	template <typename Label, typename Allocator = std::allocator<detail::trie_node>>
+	using stable_dense_trie = basic_dense_trie<Label, detail::stable_trie_base<Allocator>>;
+}
@@ -0,0 +1,291 @@
+﻿#pragma once
+
+#include <wordring/trie/trie_label_map.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <type_traits>
+
+namespace wordring
+{
+	template <typename Label, typename Base>
+	class basic_dense_trie;
+}
+
+namespace wordring::detail
+{
+	/*! @brief basic_dense_trie のイテレータ
+
+	@tparam Label ラベルとして使用する任意の整数型
+	@tparam Base  元となる trie_base::const_iterator あるいは stable_trie_base::const_iterator
+
+	ダブル・アレイのイテレータを、 trie_label_map による可変長符号単位の遷移に拡張する。
+
+	符号の2バイト目以降は0xC0未満に限られるため、ノードから親方向へ最大 trie_label_map::escape_length
+	バイトをたどることで、そのノードで終わる符号のバイト長を求められる。
+	*/
+	template <typename Label, typename Base>
+	class const_dense_trie_iterator : public Base
+	{
+		template <typename Label1, typename Base1>
+		friend class wordring::basic_dense_trie;
+
+		template <typename Label1, typename Base1>
+		friend bool operator==(const_dense_trie_iterator<Label1, Base1> const&, const_dense_trie_iterator<Label1, Base1> const&);
+
+		template <typename Label1, typename Base1>
+		friend bool operator!=(const_dense_trie_iterator<Label1, Base1> const&, const_dense_trie_iterator<Label1, Base1> const&);
+
+	protected:
+		using base_type = Base;
+		using map_type  = trie_label_map<Label>;
+
+		using typename base_type::index_type;
+		using typename base_type::node_type;
+		using typename base_type::container;
+
+	public:
+		using difference_type   = std::ptrdiff_t;
+		using value_type        = Label;
+		using pointer           = value_type*;
+		using reference         = value_type&;
+		using iterator_category = std::input_iterator_tag;
+
+		static constexpr std::uint16_t null_value = 256u;
+
+	public:
+		using base_type::operator bool;
+		using base_type::operator!;
+
+	protected:
+		using base_type::limit;
+		using base_type::find;
+
+		using base_type::m_c;
+		using base_type::m_index;
+
+	public:
+		const_dense_trie_iterator()
+			: base_type()
+			, m_map(nullptr)
+		{
+		}
+
+	protected:
+		const_dense_trie_iterator(container& c, index_type index, map_type const& map)
+			: base_type(c, index)
+			, m_map(std::addressof(map))
+		{
+		}
+
+		const_dense_trie_iterator(base_type const& it, map_type const& map)
+			: base_type(it)
+			, m_map(std::addressof(map))
+		{
+		}
+
+		/*! @brief idx の親から idx への遷移ラベル（バイト）を返す
+		*/
+		std::uint8_t byte(index_type idx) const
+		{
+			node_type const* d = m_c->data();
+
+			index_type parent = (d + idx)->m_check;
+			assert(1 <= parent && parent < limit());
+
+			return static_cast<std::uint8_t>(idx - (d + parent)->m_base);
+		}
+
+		/*! @brief idx で終わる符号のバイト長を返す
+		*/
+		std::uint32_t length(index_type idx) const
+		{
+			node_type const* d = m_c->data();
+
+			for (std::uint32_t j = 1; j <= map_type::escape_length; ++j)
+			{
+				idx = (d + idx)->m_check;
+				if (idx <= 1) break;
+
+				std::uint8_t ch = byte(idx);
+				if (!map_type::is_lead(ch)) continue;
+
+				if (ch == map_type::escape_value) return (j == map_type::escape_length) ? map_type::max_length : 1;
+				return (j == 1) ? 2 : 1;
+			}
+
+			return 1;
+		}
+
+		/*! @brief idx から最初の子を n 回たどったノードを返す
+
+		子が無い場合、0を返す。
+		*/
+		index_type descend(index_type idx, std::uint32_t n) const
+		{
+			node_type const* d = m_c->data();
+
+			for (; 0 < n && idx != 0; --n)
+			{
+				index_type base = (d + idx)->m_base;
+				idx = (1 <= base)
+					? find(base, base + null_value, idx)
+					: 0;
+			}
+
+			return idx;
+		}
+
+	public:
+		value_type operator*() const
+		{
+			assert(1 < m_index && m_index < limit());
+
+			std::uint8_t code[map_type::max_length];
+			std::uint32_t n = length(m_index);
+
+			index_type idx = m_index;
+			for (std::uint32_t i = n; 0 < i; --i)
+			{
+				code[i - 1] = byte(idx);
+				idx = (m_c->data() + idx)->m_check;
+			}
+
+			return m_map->decode(code, n);
+		}
+
+		/*! @brief ラベルで遷移できる子を返す
+
+		@param [in] label 遷移ラベル
+
+		@return 遷移先のノードを指すイテレータ
+		*/
+		const_dense_trie_iterator operator[](value_type label) const
+		{
+			assert(1 <= m_index && m_index < limit());
+
+			std::uint8_t code[map_type::max_length];
+			std::uint32_t n = m_map->encode(label, code);
+
+			node_type const* d = m_c->data();
+			index_type idx = m_index;
+			for (std::uint32_t i = 0; i < n; ++i)
+			{
+				index_type base = (d + idx)->m_base;
+				if (base <= 0 || limit() <= base + code[i] || (d + base + code[i])->m_check != idx)
+				{
+					idx = 0;
+					break;
+				}
+				idx = base + code[i];
+			}
+
+			return const_dense_trie_iterator(*m_c, idx, *m_map);
+		}
+
+		/*! @brief 次の兄弟へ進める
+
+		兄弟の順序は符号の順序であり、ラベルの順序と一致しない。
+		*/
+		const_dense_trie_iterator& operator++()
+		{
+			node_type const* d = m_c->data();
+
+			std::uint32_t n = length(m_index);
+			index_type idx = 0;
+			std::uint32_t lv = 0;
+
+			// 右、あるいは右上を探す
+			for (index_type i = m_index; lv < n; ++lv)
+			{
+				index_type parent = (d + i)->m_check;
+				index_type base = (d + parent)->m_base;
+				// 右兄弟を探す
+				i = find(i + 1, base + null_value, parent);
+				if (i != 0)
+				{
+					idx = i;
+					break;
+				}
+				i = parent;
+			}
+
+			// 足の長さをそろえる
+			if (idx != 0)
+			{
+				if (lv + 1 == n) lv = map_type::length(byte(idx)) - 1;
+				idx = descend(idx, lv);
+				assert(idx != 0);
+			}
+
+			m_index = idx;
+
+			return *this;
+		}
+
+		const_dense_trie_iterator operator++(int)
+		{
+			auto result = *this;
+			operator++();
+			return result;
+		}
+
+		/*! @brief 根からイテレータが指すノードまでのラベル列を返す
+
+		@param [out] result ラベル列を出力する先のコンテナ
+		*/
+		template <typename String>
+		void string(String& result) const
+		{
+			result.clear();
+			for (auto p = *this; 1 < p.m_index; p = p.parent()) result.push_back(*p);
+			std::reverse(std::begin(result), std::end(result));
+		}
+
+		/*! @brief 親を取得する
+
+		@return 親ノードを指すイテレータ
+		*/
+		const_dense_trie_iterator parent() const
+		{
+			index_type idx = m_index;
+			for (std::uint32_t n = length(m_index); 0 < n; --n)
+			{
+				idx = (m_c->data() + idx)->m_check;
+				assert(1 <= idx && idx < limit());
+			}
+
+			return const_dense_trie_iterator(*m_c, idx, *m_map);
+		}
+
+		const_dense_trie_iterator begin() const
+		{
+			index_type idx = descend(m_index, 1);
+			if (idx != 0) idx = descend(idx, map_type::length(byte(idx)) - 1);
+
+			return const_dense_trie_iterator(*m_c, idx, *m_map);
+		}
+
+		const_dense_trie_iterator end() const
+		{
+			return const_dense_trie_iterator(*m_c, 0, *m_map);
+		}
+
+	protected:
+		map_type const* m_map;
+	};
+
+	template <typename Label1, typename Base1>
+	inline bool operator==(const_dense_trie_iterator<Label1, Base1> const& lhs, const_dense_trie_iterator<Label1, Base1> const& rhs)
+	{
+		assert(lhs.m_c == rhs.m_c);
+		return lhs.m_index == rhs.m_index;
+	}
+
+	template <typename Label1, typename Base1>
+	inline bool operator!=(const_dense_trie_iterator<Label1, Base1> const& lhs, const_dense_trie_iterator<Label1, Base1> const& rhs)
+	{
+		return !(lhs == rhs);
+	}
+}
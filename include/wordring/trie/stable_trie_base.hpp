@@ -84,10 +84,14 @@ namespace wordring::detail
 		using value_type      = std::uint32_t;
 		using size_type       = typename container::size_type;
 		using allocator_type  = Allocator;
-		using reference       = trie_value_proxy;
-		using const_reference = trie_value_proxy const;
+		using reference       = basic_trie_value_proxy<node_type>;
+		using const_reference = basic_trie_value_proxy<node_type> const;
 		using const_iterator  = const_stable_trie_base_iterator<container const>;
 
+		/*! @brief 一括入出力形式に記録するTrieの種類
+		*/
+		static constexpr trie_image_flavour image_flavour = trie_image_flavour::stable_trie;
+
 	public:
 		using typename base_type::serialize_iterator;
 
@@ -103,6 +107,7 @@ namespace wordring::detail
 		using base_type::has_null;
 		using base_type::at;
 		using base_type::add;
+		using base_type::sibling_links;
 
 		using base_type::m_c;
 
@@ -196,7 +201,7 @@ namespace wordring::detail
 			auto trie = stable_trie_base({ { 0, 1 }, { 2, 3 } });
 		@endcode
 		*/
-		stable_trie_base(std::initializer_list<trie_node> il, allocator_type const& alloc = allocator_type())
+		stable_trie_base(std::initializer_list<typename Allocator::value_type> il, allocator_type const& alloc = allocator_type())
 			: base_type(il, alloc)
 		{
 		}
@@ -420,7 +425,7 @@ namespace wordring::detail
 
 		空のTrieも根を持つ。
 		*/
-		const_iterator begin() const noexcept { return const_iterator(m_c, 1); }
+		const_iterator begin() const noexcept { return const_iterator(m_c, 1, sibling_links()); }
 
 		/*! @brief 根を指すイテレータを返す
 
@@ -428,7 +433,7 @@ namespace wordring::detail
 
 		空のTrieも根を持つ。
 		*/
-		const_iterator cbegin() const noexcept { return const_iterator(m_c, 1); }
+		const_iterator cbegin() const noexcept { return const_iterator(m_c, 1, sibling_links()); }
 
 		/*! @brief 根の終端を指すイテレータを返す
 
@@ -468,7 +473,7 @@ namespace wordring::detail
 		*/
 		static constexpr size_type max_size() noexcept
 		{
-			return std::numeric_limits<std::int32_t>::max() / sizeof(node_type);
+			return std::numeric_limits<index_type>::max() / sizeof(node_type);
 		}
 
 		// 変更 ---------------------------------------------------------------
@@ -490,7 +495,7 @@ namespace wordring::detail
 		template <typename InputIterator>
 		const_iterator insert(InputIterator first, InputIterator last, value_type value = 0)
 		{
-			assert(value <= static_cast<value_type>(std::numeric_limits<int32_t>::max()));
+			assert(value <= static_cast<value_type>(std::numeric_limits<index_type>::max()));
 
 			if (first == last) return cend();
 
@@ -522,7 +527,7 @@ namespace wordring::detail
 				++m_c.front().m_base;
 			}
 
-			return const_iterator(m_c, parent);
+			return const_iterator(m_c, parent, sibling_links());
 		}
 
 		/*! @brief キー文字列を挿入する
@@ -636,7 +641,7 @@ namespace wordring::detail
 				assert(1 <= parent && parent < limit());
 			}
 
-			return std::make_pair(const_iterator(m_c, parent), first);
+			return std::make_pair(const_iterator(m_c, parent, sibling_links()), first);
 		}
 
 	public:
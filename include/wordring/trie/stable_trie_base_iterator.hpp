@@ -22,6 +22,7 @@ namespace wordring::detail
 		using typename base_type::index_type;
 		using typename base_type::node_type;
 		using typename base_type::container;
+		using typename base_type::links_type;
 
 	public:
 		using difference_type   = std::ptrdiff_t;
@@ -49,6 +50,7 @@ namespace wordring::detail
 
 		using base_type::m_c;
 		using base_type::m_index;
+		using base_type::m_links;
 
 	public:
 		const_stable_trie_base_iterator()
@@ -57,8 +59,8 @@ namespace wordring::detail
 		}
 
 	protected:
-		const_stable_trie_base_iterator(container& c, index_type index)
-			: base_type(c, index)
+		const_stable_trie_base_iterator(container& c, index_type index, links_type const* links = nullptr)
+			: base_type(c, index, links)
 		{
 		}
 
@@ -73,7 +75,7 @@ namespace wordring::detail
 
 		const_stable_trie_base_iterator operator[](value_type label) const
 		{
-			return const_stable_trie_base_iterator(*m_c, at_index(label));
+			return const_stable_trie_base_iterator(*m_c, at_index(label), m_links);
 		}
 
 		const_stable_trie_base_iterator& operator++()
@@ -99,7 +101,7 @@ namespace wordring::detail
 
 		const_stable_trie_base_iterator parent() const
 		{
-			return const_stable_trie_base_iterator(*m_c, parent_index());
+			return const_stable_trie_base_iterator(*m_c, parent_index(), m_links);
 		}
 
 		/*! 0-255に相当する文字で遷移できる最初の子を指すイテレータを返す
@@ -108,12 +110,12 @@ namespace wordring::detail
 		*/
 		const_stable_trie_base_iterator begin() const
 		{
-			return const_stable_trie_base_iterator(*m_c, begin_index());
+			return const_stable_trie_base_iterator(*m_c, begin_index(), m_links);
 		}
 
 		const_stable_trie_base_iterator end() const
 		{
-			return const_stable_trie_base_iterator(*m_c, end_index());
+			return const_stable_trie_base_iterator(*m_c, end_index(), m_links);
 		}
 	};
 
@@ -0,0 +1,908 @@
+﻿#pragma once
+
+#include <wordring/serialize/serialize.hpp>
+#include <wordring/trie/list_trie_iterator.hpp>
+#include <wordring/trie/tail_trie_base_iterator.hpp>
+#include <wordring/trie/trie_construct_iterator.hpp>
+#include <wordring/trie/trie_heap.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace wordring::detail
+{
+	// ------------------------------------------------------------------------
+	// trie_tail_value_proxy
+	// ------------------------------------------------------------------------
+
+	/*! @brief 接尾辞レコードに格納される値へのプロキシ
+
+	値はビッグエンディアンの32ビット整数として格納される。
+	*/
+	struct trie_tail_value_proxy
+	{
+		using index_type = typename trie_node::index_type;
+
+		std::uint8_t* m_value;
+
+		trie_tail_value_proxy()
+			: m_value(nullptr)
+		{
+		}
+
+		trie_tail_value_proxy(std::uint8_t* value)
+			: m_value(value)
+		{
+		}
+
+		/*! 葉の値を設定する
+		- 値が INDEX の型で表せない場合、 std::length_error を投げる。
+		*/
+		void operator=(std::uint32_t val)
+		{
+			if (static_cast<std::uint64_t>(std::numeric_limits<index_type>::max()) < val) throw std::length_error("");
+
+			auto a = serialize(static_cast<index_type>(val));
+			std::copy(a.begin(), a.end(), m_value);
+		}
+
+		operator index_type() const
+		{
+			index_type result = 0;
+			deserialize(m_value, m_value + 4, result);
+			return result;
+		}
+	};
+
+	// ------------------------------------------------------------------------
+	// tail_trie_base
+	// ------------------------------------------------------------------------
+
+	/*! @brief 一本道の接尾辞を接尾辞配列へ移したTrie木の実装
+
+	@tparam Allocator アロケータ
+
+	@details
+		ダブルアレイの制約により、labelの型は8ビット固定。
+		挿入や削除による衝突によってすべてのイテレータが無効となる。
+
+	@par 内部構造
+
+	trie_base では、キー文字列の一本道の接尾辞も1バイトにつき1ノード（8バイト）を消費する。
+	このクラスは、他のキー文字列と共有されない接尾辞をダブル・アレイから取り除き、
+	詰めたバイト列（接尾辞配列）へ格納する。
+
+	BASEが0以下のノードは葉であり、BASEを反転させた値が接尾辞配列内のレコードの位置を示す。
+	レコードは、接尾辞の長さ（4バイト）、葉の値（4バイト）、接尾辞のバイト列から成る。
+	長さと値はビッグエンディアンで格納する。
+
+	文字列が子を持つノードで終わる場合、 trie_base と同じく空遷移を追加し、
+	空遷移先のノードが空の接尾辞を持つレコードを参照する。
+
+	接尾辞の途中で分岐する文字列を挿入すると、共通部分と分岐をダブル・アレイへ戻す。
+	削除や分岐で不要になったレコードは、接尾辞配列の半分を超えた時点でまとめて回収される。
+
+	@par イテレータ
+
+	イテレータは接尾辞の途中も指すことが出来るため、 trie_base と同様に木として走査できる。
+	接尾辞内のノードは兄弟を持たない。
+
+	@par 直列化
+
+	ibegin() 、 iend() はダブル・アレイのみを返す。
+	接尾辞配列を含めて保存するには、ストリーム入出力を使う。
+
+	@sa trie_base
+	*/
+	template <typename Allocator = std::allocator<trie_node>>
+	class tail_trie_base : public trie_heap<Allocator>
+	{
+		template <typename Allocator1>
+		friend std::ostream& operator<<(std::ostream&, tail_trie_base<Allocator1> const&);
+
+		template <typename Allocator1>
+		friend std::istream& operator>>(std::istream&, tail_trie_base<Allocator1>&);
+
+	protected:
+		using base_type = trie_heap<Allocator>;
+
+		using typename base_type::container;
+		using typename base_type::label_vector;
+		using typename base_type::index_type;
+		using typename base_type::node_type;
+
+		using base_type::null_value;
+
+		using tail_container = std::vector<std::uint8_t, typename std::allocator_traits<Allocator>::template rebind_alloc<std::uint8_t>>;
+
+	public:
+		using label_type      = typename base_type::label_type;
+		using value_type      = std::uint32_t;
+		using size_type       = typename container::size_type;
+		using allocator_type  = Allocator;
+		using reference       = trie_tail_value_proxy;
+		using const_reference = trie_tail_value_proxy const;
+		using const_iterator  = const_tail_trie_base_iterator<container const, tail_container>;
+
+		static constexpr std::uint32_t header_size = const_iterator::header_size;
+
+	public:
+		using typename base_type::serialize_iterator;
+
+		using base_type::get_allocator;
+		using base_type::ibegin;
+		using base_type::iend;
+
+	protected:
+		using base_type::limit;
+		using base_type::free;
+		using base_type::has_child;
+		using base_type::has_null;
+		using base_type::has_sibling;
+		using base_type::at;
+		using base_type::add;
+
+		using base_type::m_c;
+
+	public:
+		/*! @brief 空のコンテナを構築する
+		*/
+		tail_trie_base()
+			: base_type()
+			, m_tail()
+			, m_garbage(0)
+		{
+		}
+
+		/*! @brief アロケータを指定して空のコンテナを構築する
+
+		@param [in] alloc アロケータ
+		*/
+		explicit tail_trie_base(allocator_type const& alloc)
+			: base_type(alloc)
+			, m_tail(alloc)
+			, m_garbage(0)
+		{
+		}
+
+		/*! @brief 文字列リストからの構築
+
+		@param [in] first 文字列リストの先頭を指すイテレータ
+		@param [in] last  文字列リストの終端を指すイテレータ
+		@param [in] alloc アロケータ
+
+		@sa assign(ForwardIterator first, ForwardIterator last)
+		*/
+		template <typename ForwardIterator>
+		tail_trie_base(ForwardIterator first, ForwardIterator last, allocator_type const& alloc = allocator_type())
+			: base_type(alloc)
+			, m_tail(alloc)
+			, m_garbage(0)
+		{
+			assign(first, last);
+		}
+
+		/*! @brief 文字列リストからの割り当て
+
+		@param [in] first 文字列リストの先頭を指すイテレータ
+		@param [in] last  文字列リストの終端を指すイテレータ
+
+		文字列リストが整列済みで重複を含まない場合、各文字列を他の文字列と区別できる最短の接頭辞までを
+		ダブル・アレイに一括で配置し、残りを接尾辞配列へ格納する。
+		そうでない場合、一つずつ挿入する。
+		空文字列は無視される。
+
+		葉の値は全て0に初期化される。
+		*/
+		template <typename ForwardIterator>
+		void assign(ForwardIterator first, ForwardIterator last)
+		{
+			using iterator_category = typename std::iterator_traits<ForwardIterator>::iterator_category;
+
+			static_assert(
+				   std::is_same_v<iterator_category, std::forward_iterator_tag>
+				|| std::is_same_v<iterator_category, std::bidirectional_iterator_tag>
+				|| std::is_same_v<iterator_category, std::random_access_iterator_tag>);
+
+			clear();
+
+			if (!std::is_sorted(first, last) || std::adjacent_find(first, last) != last)
+			{
+				while (first != last)
+				{
+					insert(*first);
+					++first;
+				}
+				return;
+			}
+
+			while (first != last && std::begin(*first) == std::end(*first)) ++first;
+			if (first == last) return;
+
+			// 前後の文字列と区別できる最短の接頭辞の長さを求める
+			std::vector<std::uint32_t> length;
+			std::uint32_t prev = 0;
+			for (auto it1 = first, it2 = std::next(first); it1 != last; ++it1, ++it2)
+			{
+				std::uint32_t next = 0;
+				if (it2 != last)
+				{
+					auto pair = std::mismatch(std::begin(*it1), std::end(*it1), std::begin(*it2), std::end(*it2));
+					next = static_cast<std::uint32_t>(std::distance(std::begin(*it1), pair.first));
+				}
+
+				std::uint32_t n = static_cast<std::uint32_t>(std::distance(std::begin(*it1), std::end(*it1)));
+				length.push_back(std::min(n, std::max(prev, next) + 1));
+				prev = next;
+			}
+
+			std::vector<std::string> prefixes;
+			prefixes.reserve(length.size());
+			auto it = first;
+			for (std::uint32_t n : length)
+			{
+				prefixes.emplace_back(std::begin(*it), std::next(std::begin(*it), n));
+				++it;
+			}
+
+			// 接頭辞をダブル・アレイへ配置する
+			using list_iterator      = const_list_trie_iterator<std::vector<std::string>::const_iterator>;
+			using construct_iterator = trie_construct_iterator<list_iterator>;
+
+			auto li = list_iterator(prefixes.cbegin(), prefixes.cend());
+			auto ci = construct_iterator(li);
+
+			while (!ci.empty() && !ci.children().empty())
+			{
+				auto view = ci.parent();
+				add(walk(view.first, view.second), ci.children());
+				++ci;
+			}
+
+			// 接尾辞を接尾辞配列へ格納する
+			it = first;
+			for (std::size_t i = 0; i < prefixes.size(); ++i, ++it)
+			{
+				index_type idx = walk(prefixes[i].begin(), prefixes[i].end());
+				index_type base = (m_c.data() + idx)->m_base;
+
+				if (1 <= base)
+				{
+					assert(has_null(idx));
+					index_type offset = push_tail(prefixes[i].end(), prefixes[i].end(), 0);
+					(m_c.data() + base + null_value)->m_base = -offset;
+				}
+				else
+				{
+					index_type offset = push_tail(std::next(std::begin(*it), length[i]), std::end(*it), 0);
+					(m_c.data() + idx)->m_base = -offset;
+				}
+			}
+
+			m_c.front().m_base = static_cast<index_type>(prefixes.size());
+		}
+
+		// 要素アクセス --------------------------------------------------------
+
+		/*! @brief 葉の値への参照を返す
+
+		@param [in] pos 文字列終端を指すイテレータ
+
+		@return 葉の値に対するプロキシ
+
+		入力の正当性はチェックされない。
+		*/
+		reference at(const_iterator pos)
+		{
+			node_type const* d = m_c.data();
+
+			index_type base = (d + pos.m_index)->m_base;
+			index_type offset = (base <= 0)
+				? -base
+				: -(d + base + null_value)->m_base;
+
+			return reference(m_tail.data() + offset + 4);
+		}
+
+		const_reference at(const_iterator pos) const
+		{
+			return const_cast<tail_trie_base*>(this)->at(pos);
+		}
+
+		/*! @brief 葉の値への参照を返す
+
+		@param [in] first キー文字列の先頭を指すイテレータ
+		@param [in] last  キー文字列の終端を指すイテレータ
+
+		@return 葉の値に対するプロキシ
+
+		@throw std::out_of_range キーが格納されていない場合
+		*/
+		template <typename InputIterator>
+		reference at(InputIterator first, InputIterator last)
+		{
+			auto it = find(first, last);
+			if (it == cend()) throw std::out_of_range("");
+
+			return at(it);
+		}
+
+		template <typename InputIterator>
+		const_reference at(InputIterator first, InputIterator last) const
+		{
+			return const_cast<tail_trie_base*>(this)->at(first, last);
+		}
+
+		template <typename Key>
+		reference at(Key const& key)
+		{
+			return at(std::begin(key), std::end(key));
+		}
+
+		template <typename Key>
+		const_reference const at(Key const& key) const
+		{
+			return at(std::begin(key), std::end(key));
+		}
+
+		/*! @brief 葉の値への参照を返す
+
+		キー文字列が格納されていない場合、新たに挿入し、その葉の値への参照を返す。
+		*/
+		template <typename Key>
+		reference operator[](Key const& key)
+		{
+			auto it = find(key);
+			if (it == cend()) it = insert(key);
+
+			return at(it);
+		}
+
+		// イテレータ ----------------------------------------------------------
+
+		const_iterator begin() const noexcept { return const_iterator(m_c, m_tail, 1); }
+
+		const_iterator cbegin() const noexcept { return const_iterator(m_c, m_tail, 1); }
+
+		const_iterator end() const noexcept { return const_iterator(m_c, m_tail, 0); }
+
+		const_iterator cend() const noexcept { return const_iterator(m_c, m_tail, 0); }
+
+		// 容量 ---------------------------------------------------------------
+
+		bool empty() const noexcept { return size() == 0; }
+
+		size_type size() const noexcept { return m_c.front().m_base; }
+
+		static constexpr size_type max_size() noexcept
+		{
+			return std::numeric_limits<std::int32_t>::max() / sizeof(node_type);
+		}
+
+		/*! @brief 接尾辞配列のバイト数を返す
+
+		回収されていない不要なレコードを含む。
+		*/
+		size_type tail_size() const noexcept { return m_tail.size(); }
+
+		// 変更 ---------------------------------------------------------------
+
+		/*! @brief すべての要素を削除する
+		*/
+		void clear() noexcept
+		{
+			base_type::clear();
+			m_tail.clear();
+			m_garbage = 0;
+		}
+
+		/*! @brief キー文字列を挿入する
+
+		@param [in] first キー文字列の先頭を指すイテレータ
+		@param [in] last  キー文字列の終端を指すイテレータ
+		@param [in] value 葉へ格納する値（省略時は0）
+
+		@return 挿入された最後の文字に対応する位置を指すイテレータ
+
+		既に格納されている場合、値は変更されない。
+		*/
+		template <typename InputIterator>
+		const_iterator insert(InputIterator first, InputIterator last, value_type value = 0)
+		{
+			assert(value <= static_cast<value_type>(std::numeric_limits<int32_t>::max()));
+
+			if (first == last) return cend();
+
+			index_type parent = 1;
+
+			// 登録済み遷移をスキップする
+			while (true)
+			{
+				if (is_leaf(parent)) return split(parent, first, last, value);
+				if (first == last) break;
+
+				index_type idx = at(parent, static_cast<std::uint8_t>(*first));
+				if (idx == 0) break;
+
+				parent = idx;
+				++first;
+			}
+
+			// 子を持つノードで終わる
+			if (first == last)
+			{
+				if (!has_null(parent)) attach(parent, null_value, first, last, value);
+				return const_iterator(m_c, m_tail, parent);
+			}
+
+			// 新しい葉を追加
+			std::uint16_t label = static_cast<std::uint8_t>(*first);
+			++first;
+
+			return attach(parent, label, first, last, value);
+		}
+
+		template <typename Key>
+		const_iterator insert(Key const& key, value_type value = 0)
+		{
+			return insert(std::begin(key), std::end(key), value);
+		}
+
+		/*! @brief キー文字列を削除する
+
+		@param [in] pos 削除するキー文字列の終端を指すイテレータ
+		*/
+		void erase(const_iterator pos)
+		{
+			index_type idx = pos.m_index;
+			assert(0 <= idx && idx < limit());
+
+			if (idx <= 1 || !pos) return;
+
+			if (!is_leaf(idx))
+			{
+				// 空遷移を削除する（子は残る）
+				index_type i = (m_c.data() + idx)->m_base + null_value;
+				release(-(m_c.data() + i)->m_base);
+				free(i);
+			}
+			else
+			{
+				release(-(m_c.data() + idx)->m_base);
+
+				while (true)
+				{
+					index_type parent = (m_c.data() + idx)->m_check;
+					bool sibling = has_sibling(idx);
+
+					free(idx);
+					if (sibling || parent == 1) break;
+
+					// 空遷移だけが残る場合、親を葉にする
+					if (has_null(parent))
+					{
+						index_type i = (m_c.data() + parent)->m_base + null_value;
+						index_type base = (m_c.data() + i)->m_base;
+						free(i);
+						(m_c.data() + parent)->m_base = base;
+						break;
+					}
+
+					idx = parent;
+				}
+			}
+
+			--m_c.front().m_base;
+			if (empty()) clear();
+			else collect();
+		}
+
+		template <typename InputIterator>
+		void erase(InputIterator first, InputIterator last)
+		{
+			erase(find(first, last));
+		}
+
+		template <typename Key>
+		void erase(Key const& key)
+		{
+			erase(std::begin(key), std::end(key));
+		}
+
+		void swap(tail_trie_base& other)
+		{
+			base_type::swap(other);
+			m_tail.swap(other.m_tail);
+			std::swap(m_garbage, other.m_garbage);
+		}
+
+		/*! @brief ダブル・アレイと接尾辞配列を詰め直す
+
+		@return 詰める前後のノード数と、旧INDEXから新INDEXへの対応表
+
+		ダブル・アレイを幅優先に詰め直した後、不要なレコードを取り除き、
+		接尾辞配列をノードの順に並べ直す。
+
+		@sa trie_heap::compact()
+		*/
+		basic_trie_compact_result<index_type> compact()
+		{
+			auto result = base_type::compact();
+			collect(true);
+
+			return result;
+		}
+
+		// 検索 ---------------------------------------------------------------
+
+		/*! @brief 部分一致検索
+
+		@param [in] first 検索するキー文字列の先頭を指すイテレータ
+		@param [in] last  検索するキー文字列の終端を指すイテレータ
+
+		@return 一致した最後の位置と次の文字を指すイテレータのペア
+
+		接尾辞の途中で一致しなくなった場合、接尾辞の途中を指すイテレータを返す。
+		一文字も一致しない場合、cbegin()を返す。
+		*/
+		template <typename InputIterator>
+		auto lookup(InputIterator first, InputIterator last) const
+		{
+			index_type parent = 1;
+
+			while (first != last)
+			{
+				if (is_leaf(parent))
+				{
+					std::uint8_t const* p = suffix(parent);
+					std::uint32_t n = length(parent);
+					std::uint32_t i = 0;
+					while (i < n && first != last && *(p + i) == static_cast<std::uint8_t>(*first))
+					{
+						++i;
+						++first;
+					}
+
+					return std::make_pair(const_iterator(m_c, m_tail, parent, i), first);
+				}
+
+				index_type idx = at(parent, static_cast<std::uint8_t>(*first));
+				if (idx == 0) break;
+
+				++first;
+				parent = idx;
+				assert(1 <= parent && parent < limit());
+			}
+
+			return std::make_pair(const_iterator(m_c, m_tail, parent), first);
+		}
+
+		/*! @brief 前方一致検索
+
+		@return 一致した最後の位置、一致しない場合 cend()
+		*/
+		template <typename InputIterator>
+		const_iterator search(InputIterator first, InputIterator last) const
+		{
+			auto pair = lookup(first, last);
+
+			return (pair.second == last)
+				? pair.first
+				: cend();
+		}
+
+		template <typename Key>
+		const_iterator search(Key const& key) const
+		{
+			return search(std::begin(key), std::end(key));
+		}
+
+		/*! @brief 完全一致検索
+
+		@return
+			入力されたキー文字列と完全に一致する場合、その終端を指すイテレータ。
+			それ以外の場合、 cend() 。
+
+		葉に到達した後の接尾辞の比較は、キー文字列が連続したメモリー上にある場合、一回の memcmp で行う。
+		*/
+		template <typename InputIterator>
+		const_iterator find(InputIterator first, InputIterator last) const
+		{
+			index_type parent = 1;
+
+			while (first != last)
+			{
+				if (is_leaf(parent)) break;
+
+				parent = at(parent, static_cast<std::uint8_t>(*first));
+				if (parent == 0) return cend();
+
+				++first;
+			}
+
+			if (!is_leaf(parent))
+			{
+				return (first == last && has_null(parent))
+					? const_iterator(m_c, m_tail, parent)
+					: cend();
+			}
+
+			std::uint8_t const* p = suffix(parent);
+			std::uint32_t n = length(parent);
+
+			if constexpr (std::contiguous_iterator<InputIterator> && sizeof(*first) == 1)
+			{
+				if (static_cast<std::size_t>(std::distance(first, last)) != n) return cend();
+				if (n != 0 && std::memcmp(p, std::to_address(first), n) != 0) return cend();
+			}
+			else
+			{
+				for (std::uint32_t i = 0; i < n; ++i, ++first)
+				{
+					if (first == last || *(p + i) != static_cast<std::uint8_t>(*first)) return cend();
+				}
+				if (first != last) return cend();
+			}
+
+			return const_iterator(m_c, m_tail, parent, n);
+		}
+
+		template <typename Key>
+		const_iterator find(Key const& key) const
+		{
+			return find(std::begin(key), std::end(key));
+		}
+
+		template <typename InputIterator>
+		bool contains(InputIterator first, InputIterator last) const
+		{
+			return find(first, last) != cend();
+		}
+
+		template <typename Key>
+		bool contains(Key const& key) const
+		{
+			return contains(std::begin(key), std::end(key));
+		}
+
+	protected:
+		/*! idx が接尾辞を参照する葉である場合、trueを返す
+		*/
+		bool is_leaf(index_type idx) const
+		{
+			return 1 < idx && (m_c.data() + idx)->m_base <= 0;
+		}
+
+		/*! 葉 idx が参照する接尾辞の先頭を返す
+		*/
+		std::uint8_t const* suffix(index_type idx) const
+		{
+			return m_tail.data() - (m_c.data() + idx)->m_base + header_size;
+		}
+
+		/*! 葉 idx が参照する接尾辞の長さを返す
+		*/
+		std::uint32_t length(index_type idx) const
+		{
+			return record_length(-(m_c.data() + idx)->m_base);
+		}
+
+		std::uint32_t record_length(index_type offset) const
+		{
+			std::uint8_t const* p = m_tail.data() + offset;
+			std::uint32_t n = 0;
+			deserialize(p, p + 4, n);
+
+			return n;
+		}
+
+		/*! 根から文字列で遷移したノードを返す
+		- 接尾辞は考慮しない。
+		*/
+		template <typename InputIterator>
+		index_type walk(InputIterator first, InputIterator last) const
+		{
+			index_type idx = 1;
+			for (; first != last; ++first) idx = at(idx, static_cast<std::uint8_t>(*first));
+			assert(idx != 0);
+
+			return idx;
+		}
+
+		/*! 接尾辞配列の末尾にレコードを追加し、その位置を返す
+		*/
+		template <typename InputIterator>
+		index_type push_tail(InputIterator first, InputIterator last, value_type value)
+		{
+			std::size_t offset = m_tail.size();
+			if (static_cast<std::size_t>(std::numeric_limits<index_type>::max()) < offset) throw std::length_error("");
+
+			m_tail.resize(offset + header_size);
+			while (first != last) m_tail.push_back(static_cast<std::uint8_t>(*first++));
+
+			auto n = serialize(static_cast<std::uint32_t>(m_tail.size() - offset - header_size));
+			auto v = serialize(static_cast<std::uint32_t>(value));
+			std::copy(n.begin(), n.end(), m_tail.begin() + offset);
+			std::copy(v.begin(), v.end(), m_tail.begin() + offset + 4);
+
+			return static_cast<index_type>(offset);
+		}
+
+		/*! 不要になったレコードを記録する
+		*/
+		void release(index_type offset)
+		{
+			m_garbage += header_size + record_length(offset);
+		}
+
+		/*! 不要なレコードが接尾辞配列の半分を超えた場合、回収する
+		- force が true の場合、常に回収する。
+		- レコードはノードのINDEX順に並べ直される。
+		*/
+		void collect(bool force = false)
+		{
+			if (!force && m_garbage * 2 <= m_tail.size()) return;
+
+			tail_container tail(m_tail.get_allocator());
+			tail.reserve(m_tail.size() - m_garbage);
+
+			node_type* d = m_c.data();
+			for (index_type i = 2; i < limit(); ++i)
+			{
+				if ((d + i)->m_check <= 0 || 0 < (d + i)->m_base) continue;
+
+				index_type offset = -(d + i)->m_base;
+				auto it = m_tail.begin() + offset;
+				(d + i)->m_base = -static_cast<index_type>(tail.size());
+				tail.insert(tail.end(), it, it + header_size + record_length(offset));
+			}
+
+			m_tail.swap(tail);
+			m_garbage = 0;
+		}
+
+		/*! parent に label で遷移する葉を追加し、[first, last) を接尾辞として格納する
+		*/
+		template <typename InputIterator>
+		const_iterator attach(index_type parent, std::uint16_t label, InputIterator first, InputIterator last, value_type value)
+		{
+			std::size_t n = m_tail.size();
+			index_type offset = push_tail(first, last, value);
+			n = m_tail.size() - n - header_size;
+
+			index_type base = add(parent, label);
+			(m_c.data() + base + label)->m_base = -offset;
+			++m_c.front().m_base;
+
+			return (label == null_value)
+				? const_iterator(m_c, m_tail, parent)
+				: const_iterator(m_c, m_tail, base + label, static_cast<std::uint32_t>(n));
+		}
+
+		/*! 葉 leaf の接尾辞の途中から分岐する文字列を挿入する
+
+		共通部分と分岐をダブル・アレイへ戻す。
+		*/
+		template <typename InputIterator>
+		const_iterator split(index_type leaf, InputIterator first, InputIterator last, value_type value)
+		{
+			index_type offset = -(m_c.data() + leaf)->m_base;
+
+			std::uint8_t const* p = suffix(leaf);
+			std::vector<std::uint8_t> s(p, p + length(leaf));
+
+			std::uint32_t c = 0;
+			while (c < s.size() && first != last && s[c] == static_cast<std::uint8_t>(*first))
+			{
+				++c;
+				++first;
+			}
+
+			if (c == s.size() && first == last) return const_iterator(m_c, m_tail, leaf, c);
+
+			value_type v = trie_tail_value_proxy(m_tail.data() + offset + 4);
+			release(offset);
+
+			// 共通部分をダブル・アレイへ戻す
+			index_type parent = leaf;
+			(m_c.data() + parent)->m_base = 0;
+			for (std::uint32_t i = 0; i < c; ++i)
+			{
+				index_type base = add(parent, s[i]);
+				parent = base + s[i];
+			}
+
+			// 既存の文字列の分岐
+			if (c == s.size()) attach(parent, null_value, s.end(), s.end(), v);
+			else attach(parent, s[c], s.begin() + c + 1, s.end(), v);
+			--m_c.front().m_base;
+
+			// 新しい文字列の分岐
+			const_iterator it;
+			if (first == last) it = attach(parent, null_value, first, last, value);
+			else
+			{
+				std::uint16_t label = static_cast<std::uint8_t>(*first);
+				++first;
+				it = attach(parent, label, first, last, value);
+			}
+
+			// イテレータはBASEからレコードを引くため、回収後も有効
+			collect();
+
+			return it;
+		}
+
+	protected:
+		tail_container m_tail;
+		std::size_t    m_garbage;
+	};
+
+	/*! @brief ストリームへ出力する
+
+	接尾辞配列のバイト数、接尾辞配列、ダブル・アレイの順に出力する。
+
+	速度を必要とする場合、使用を推奨しない。
+	*/
+	template <typename Allocator1>
+	inline std::ostream& operator<<(std::ostream& os, tail_trie_base<Allocator1> const& trie)
+	{
+		for (auto ch : serialize(static_cast<std::uint64_t>(trie.m_tail.size()))) os.put(ch);
+		os.write(reinterpret_cast<char const*>(trie.m_tail.data()), trie.m_tail.size());
+
+		typename tail_trie_base<Allocator1>::base_type const& heap = trie;
+		return os << heap;
+	}
+
+	/*! @brief ストリームから入力する
+
+	速度を必要とする場合、使用を推奨しない。
+	*/
+	template <typename Allocator1>
+	inline std::istream& operator>>(std::istream& is, tail_trie_base<Allocator1>& trie)
+	{
+		std::uint64_t n = 0;
+		for (std::size_t i = 0; i < sizeof(n); ++i) n = (n << 8) + static_cast<std::uint8_t>(is.get());
+
+		trie.m_tail.resize(is ? n : 0);
+		is.read(reinterpret_cast<char*>(trie.m_tail.data()), trie.m_tail.size());
+
+		typename tail_trie_base<Allocator1>::base_type& heap = trie;
+		is >> heap;
+
+		// 回収されていないレコードの大きさを求める
+		std::size_t live = 0;
+		for (auto idx = 2; idx < trie.limit(); ++idx)
+		{
+			auto const& node = *(trie.m_c.data() + idx);
+			if (0 < node.m_check && node.m_base <= 0) live += trie.header_size + trie.record_length(-node.m_base);
+		}
+		trie.m_garbage = trie.m_tail.size() - live;
+
+		return is;
+	}
+}
+
+namespace wordring
+{
+	/*! @brief 一本道の接尾辞を接尾辞配列へ移した、8ビット・ラベルのTrie
+
+	URLやパスのように、長く共有されない接尾辞を持つ文字列の辞書を用途として想定する。
+
+	@sa detail::tail_trie_base
+	*/
+	template <typename Allocator = std::allocator<detail::trie_node>>
+	using tail_trie = detail::tail_trie_base<Allocator>;
+}
@@ -0,0 +1,211 @@
+﻿#pragma once
+
+#include <wordring/serialize/serialize.hpp>
+#include <wordring/trie/trie_heap_iterator.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+
+namespace wordring::detail
+{
+	/*! @brief tail_trie_base のイテレータ
+
+	@tparam Container ダブル・アレイのコンテナ
+	@tparam Tail      接尾辞配列のコンテナ
+
+	ダブル・アレイのノードに加え、葉から参照される接尾辞の途中を指すことが出来る。
+	接尾辞の途中は m_index に葉のINDEX、 m_offset に接尾辞内で遷移したバイト数を持つ。
+	m_offset が0の場合、ノードそのものを指す。
+
+	接尾辞内のノードは兄弟を持たない。
+	*/
+	template <typename Container, typename Tail>
+	class const_tail_trie_base_iterator : public const_trie_heap_iterator<Container>
+	{
+		template <typename Allocator1>
+		friend class tail_trie_base;
+
+		template <typename Container1, typename Tail1>
+		friend bool operator==(const_tail_trie_base_iterator<Container1, Tail1> const&, const_tail_trie_base_iterator<Container1, Tail1> const&);
+
+		template <typename Container1, typename Tail1>
+		friend bool operator!=(const_tail_trie_base_iterator<Container1, Tail1> const&, const_tail_trie_base_iterator<Container1, Tail1> const&);
+
+	protected:
+		using base_type = const_trie_heap_iterator<Container>;
+		using tail_type = Tail const;
+
+		using typename base_type::index_type;
+		using typename base_type::node_type;
+		using typename base_type::container;
+
+	public:
+		using difference_type   = std::ptrdiff_t;
+		using value_type        = std::uint8_t;
+		using pointer           = value_type*;
+		using reference         = value_type&;
+		using iterator_category = std::input_iterator_tag;
+
+		static constexpr std::uint16_t null_value = 256u;
+
+		/*! 接尾辞レコードの見出しの大きさ（長さ4バイト、値4バイト）
+		*/
+		static constexpr std::uint32_t header_size = 8;
+
+	protected:
+		using base_type::value;
+		using base_type::at_index;
+		using base_type::advance;
+		using base_type::parent_index;
+		using base_type::begin_index;
+
+		using base_type::limit;
+		using base_type::has_null;
+
+		using base_type::m_c;
+		using base_type::m_index;
+
+	public:
+		const_tail_trie_base_iterator()
+			: base_type()
+			, m_tail(nullptr)
+			, m_offset(0)
+		{
+		}
+
+	protected:
+		const_tail_trie_base_iterator(container& c, tail_type& tail, index_type index, std::uint32_t offset = 0)
+			: base_type(c, index)
+			, m_tail(std::addressof(tail))
+			, m_offset(offset)
+		{
+		}
+
+		/*! 子を持たず、接尾辞を参照する葉である場合、trueを返す
+		*/
+		bool is_leaf() const
+		{
+			return 1 < m_index && (m_c->data() + m_index)->m_base <= 0;
+		}
+
+		/*! 葉が参照する接尾辞の先頭を返す
+		*/
+		std::uint8_t const* suffix() const
+		{
+			assert(is_leaf());
+			return m_tail->data() - (m_c->data() + m_index)->m_base + header_size;
+		}
+
+		/*! 葉が参照する接尾辞の長さを返す
+		*/
+		std::uint32_t length() const
+		{
+			assert(is_leaf());
+
+			std::uint8_t const* p = m_tail->data() - (m_c->data() + m_index)->m_base;
+			std::uint32_t n = 0;
+			deserialize(p, p + 4, n);
+
+			return n;
+		}
+
+	public:
+		/*! 文字列終端の場合trueを返す*/
+		operator bool() const
+		{
+			if (m_index <= 1) return false;
+			if (is_leaf()) return m_offset == length();
+
+			return has_null();
+		}
+
+		bool operator!() const { return operator bool() == false; }
+
+		value_type operator*() const
+		{
+			return (m_offset == 0)
+				? value()
+				: *(suffix() + m_offset - 1);
+		}
+
+		const_tail_trie_base_iterator operator[](value_type label) const
+		{
+			if (!is_leaf()) return const_tail_trie_base_iterator(*m_c, *m_tail, at_index(label));
+
+			return (m_offset < length() && *(suffix() + m_offset) == label)
+				? const_tail_trie_base_iterator(*m_c, *m_tail, m_index, m_offset + 1)
+				: end();
+		}
+
+		const_tail_trie_base_iterator& operator++()
+		{
+			if (m_offset == 0) advance();
+			else
+			{
+				m_index = 0;
+				m_offset = 0;
+			}
+
+			return *this;
+		}
+
+		const_tail_trie_base_iterator operator++(int)
+		{
+			auto result = *this;
+			operator++();
+			return result;
+		}
+
+		template <typename String>
+		void string(String& result) const
+		{
+			result.clear();
+			for (auto p = *this; 1 < p.m_index; p = p.parent()) result.push_back(*p);
+			std::reverse(std::begin(result), std::end(result));
+		}
+
+		const_tail_trie_base_iterator parent() const
+		{
+			return (m_offset == 0)
+				? const_tail_trie_base_iterator(*m_c, *m_tail, parent_index())
+				: const_tail_trie_base_iterator(*m_c, *m_tail, m_index, m_offset - 1);
+		}
+
+		/*! 0-255に相当する文字で遷移できる最初の子を指すイテレータを返す
+		- 256による空遷移は含めない。
+		- 遷移先（子）が無い場合、end()を返す。
+		*/
+		const_tail_trie_base_iterator begin() const
+		{
+			if (!is_leaf()) return const_tail_trie_base_iterator(*m_c, *m_tail, begin_index());
+
+			return (m_offset < length())
+				? const_tail_trie_base_iterator(*m_c, *m_tail, m_index, m_offset + 1)
+				: end();
+		}
+
+		const_tail_trie_base_iterator end() const
+		{
+			return const_tail_trie_base_iterator(*m_c, *m_tail, 0);
+		}
+
+	protected:
+		tail_type*    m_tail;
+		std::uint32_t m_offset;
+	};
+
+	template <typename Container1, typename Tail1>
+	inline bool operator==(const_tail_trie_base_iterator<Container1, Tail1> const& lhs, const_tail_trie_base_iterator<Container1, Tail1> const& rhs)
+	{
+		assert(lhs.m_c == rhs.m_c);
+		return lhs.m_index == rhs.m_index && lhs.m_offset == rhs.m_offset;
+	}
+
+	template <typename Container1, typename Tail1>
+	inline bool operator!=(const_tail_trie_base_iterator<Container1, Tail1> const& lhs, const_tail_trie_base_iterator<Container1, Tail1> const& rhs)
+	{
+		return !(lhs == rhs);
+	}
+}
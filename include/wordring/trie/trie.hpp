@@ -4,10 +4,20 @@
 #include <wordring/trie/stable_trie_base.hpp>
 #include <wordring/trie/trie_base.hpp>
 #include <wordring/trie/trie_iterator.hpp>
+#include <wordring/trie/trie_leaf_iterator.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <future>
 #include <memory>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace wordring
 {
@@ -94,7 +104,11 @@ namespace wordring
 	<b>%operator bool()</b> で葉を確認し、葉を発見するたびに <b>parent()</b> で親をたどると、後続の文字列を容易に列挙できる。
 	候補数を制限したい場合、数に達した時点で走査を止めると良い。
 
+	この方法は接頭辞以下の部分木全体を走査するため、短い接頭辞と大きな語彙では遅い。
+	葉の値を重みとして上位の候補だけを求める場合、 basic_weighted_trie::top_k() を使う。
+
 	- @ref wordring::basic_tree_iterator
+	- @ref wordring::basic_weighted_trie
 
 	@par 直列化
 
@@ -150,10 +164,12 @@ namespace wordring
 		using value_type      = std::uint32_t;
 		using size_type       = typename container::size_type;
 		using allocator_type  = typename base_type::allocator_type;
-		using reference       = detail::trie_value_proxy;
-		using const_reference = detail::trie_value_proxy const;
+		using reference       = typename base_type::reference;
+		using const_reference = typename base_type::const_reference;
 		using const_iterator  = detail::const_trie_iterator<label_type, typename base_type::const_iterator>;
 
+		using const_leaf_iterator = detail::const_trie_leaf_iterator<label_type, typename base_type::const_iterator>;
+
 	public:
 		using typename base_type::serialize_iterator;
 
@@ -164,6 +180,7 @@ namespace wordring
 
 	protected:
 		using base_type::is_tail;
+		using base_type::sibling_links;
 
 		using base_type::m_c;
 
@@ -264,7 +281,7 @@ namespace wordring
 		@param [in]
 			alloc アロケータ
 
-		@sa detail::trie_heap::trie_heap(std::initializer_list<trie_node>, allocator_type const&)
+		@sa detail::trie_heap::trie_heap(std::initializer_list<node_type>, allocator_type const&)
 
 		@par 例
 		@code
@@ -272,7 +289,7 @@ namespace wordring
 			auto t1 = trie<char32_t>({ { 1, 2 }, { 3, 4 }, { 5, 6 } });
 		@endcode
 		*/
-		basic_trie(std::initializer_list<detail::trie_node> il, allocator_type const& alloc = allocator_type())
+		basic_trie(std::initializer_list<node_type> il, allocator_type const& alloc = allocator_type())
 			: base_type(il, alloc)
 		{
 		}
@@ -344,8 +361,258 @@ namespace wordring
 			}
 		}
 
+		/*! @brief 文字列リストから複数のスレッドで割り当てる
+
+		@param [in]
+			first 文字列リストの先頭を指すイテレータ
+		@param [in]
+			last 文字列リストの終端を指すイテレータ
+		@param [in]
+			concurrency 使用するスレッド数（0の場合 std::thread::hardware_concurrency() ）
+
+		@sa assign(ForwardIterator first, ForwardIterator last)
+
+		文字列リストを直列化したバイト列の先頭部分（接頭辞）で分割し、分割毎の部分木を並行に構築する。
+		部分木はダブル・アレイの互いに重ならない範囲へ並行に配置され、接頭辞から成る木の葉へ接ぎ木される。
+		格納される文字列と検索結果は assign() と同じだが、ノードの配置は異なる。
+
+		文字列リストは直列化したバイト列の辞書順に整列し、重複と空文字列を含まない必要がある。
+		そうでない場合、あるいは分割できない場合、 assign() と同じ動作となる。
+		葉の値は全て0に初期化される。
+
+		@par 例
+		@code
+			// 整列済みの文字列リスト
+			std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+
+			// 4スレッドで割り当てる
+			trie<char32_t> t;
+			t.parallel_assign(v.begin(), v.end(), 4);
+		@endcode
+		*/
+		template <typename ForwardIterator>
+		void parallel_assign(ForwardIterator first, ForwardIterator last, std::uint32_t concurrency = 0)
+		{
+			using string_type = typename std::iterator_traits<ForwardIterator>::value_type;
+			using roots_type  = std::vector<std::pair<index_type, index_type>>;
+
+			struct part
+			{
+				ForwardIterator          m_first;
+				ForwardIterator          m_last;
+				std::vector<std::string> m_prefixes;
+				std::size_t              m_size;
+			};
+
+			std::uint32_t constexpr max_depth = 64; // 接頭辞の最大バイト長
+
+			if (concurrency == 0) concurrency = std::max(std::thread::hardware_concurrency(), 1u);
+
+			auto to_bytes = [](string_type const& key)
+			{
+				std::string result;
+				if constexpr (coefficient == 1) result.assign(std::begin(key), std::end(key));
+				else result.assign(wordring::serialize_iterator(std::begin(key)), wordring::serialize_iterator(std::end(key)));
+				return result;
+			};
+
+			auto walk = [](basic_trie const& t, std::string const& s)
+			{
+				index_type idx = 1;
+				for (char ch : s) idx = t.base_type::at(idx, static_cast<std::uint16_t>(static_cast<std::uint8_t>(ch)));
+				assert(1 < idx);
+				return idx;
+			};
+
+			// キーのバイト長と、直前のキーとの共通接頭辞のバイト長を調べる
+			std::vector<std::uint32_t> length, common;
+			std::string prev, curr;
+			for (auto it = first; it != last; ++it)
+			{
+				curr = to_bytes(*it);
+				if (curr.empty() || !(prev < curr)) return assign(first, last);
+
+				auto pair = std::mismatch(prev.begin(), prev.end(), curr.begin(), curr.end());
+				length.push_back(static_cast<std::uint32_t>(curr.size()));
+				common.push_back(static_cast<std::uint32_t>(std::distance(prev.begin(), pair.first)));
+				prev.swap(curr);
+			}
+
+			// 接頭辞の数が分割目標に達する最短のバイト長を選ぶ
+			std::size_t target = static_cast<std::size_t>(concurrency) * 4;
+			std::vector<std::int64_t> count(max_depth + 2, 0);
+			for (std::size_t i = 0; i < length.size(); ++i)
+			{
+				std::uint32_t lo = common[i] + 1;
+				std::uint32_t hi = std::min(length[i], max_depth);
+				if (hi < lo) continue;
+				++count[lo];
+				--count[hi + 1];
+			}
+			std::uint32_t depth = 0;
+			for (std::uint32_t d = 1; d <= max_depth; ++d)
+			{
+				count[d] += count[d - 1];
+				if (depth == 0 || count[depth] < count[d]) depth = d;
+				if (target <= static_cast<std::size_t>(count[d])) break;
+			}
+
+			if (concurrency == 1 || count[depth] < 2) return assign(first, last);
+
+			// 接頭辞の境界で文字列リストを分割する
+			std::size_t quota = (length.size() + target - 1) / target;
+			std::vector<std::string> top; // 接頭辞の木に格納する文字列
+			std::vector<part> parts;
+
+			auto it = first;
+			for (std::size_t i = 0; i < length.size(); ++i, ++it)
+			{
+				if (length[i] < depth)
+				{
+					top.push_back(to_bytes(*it));
+					continue;
+				}
+
+				if (common[i] < depth)
+				{
+					if (parts.empty() || quota <= parts.back().m_size)
+					{
+						if (!parts.empty()) parts.back().m_last = it;
+						parts.push_back(part{ it, last, {}, 0 });
+					}
+					top.push_back(to_bytes(*it).substr(0, depth));
+					parts.back().m_prefixes.push_back(top.back());
+				}
+				++parts.back().m_size;
+			}
+
+			// 接頭辞の木を構築し、接ぎ先を求める
+			base_type::assign(top.begin(), top.end());
+
+			std::vector<roots_type> roots(parts.size());
+			for (std::size_t k = 0; k < parts.size(); ++k)
+			{
+				for (std::string const& s : parts[k].m_prefixes) roots[k].emplace_back(0, walk(*this, s));
+			}
+
+			// 接ぎ先の子（ stable_trie の空遷移）を未使用とし、葉にする
+			// 以下は m_c を直接書き換えるため、 relink() まで未使用ノードの索引は使えない。
+			base_type::invalidate();
+			for (roots_type const& r : roots)
+			{
+				for (auto const& pair : r)
+				{
+					node_type* d = m_c.data();
+					index_type to = pair.second;
+					index_type base = (d + to)->m_base;
+					if (base <= 0) continue;
+
+					index_type last = static_cast<index_type>(std::min<std::int64_t>(base + null_value + 1, base_type::limit()));
+					for (index_type i = base; i < last; ++i) if ((d + i)->m_check == to) *(d + i) = node_type{ 0, 0 };
+					(d + to)->m_base = 0;
+				}
+			}
+
+			auto run = [concurrency](auto fn)
+			{
+				std::vector<std::future<void>> futures;
+				for (std::uint32_t i = 1; i < concurrency; ++i) futures.push_back(std::async(std::launch::async, fn));
+				fn();
+				for (auto& f : futures) f.get();
+			};
+
+			// 部分木を並行に構築する
+			std::vector<basic_trie> tries(parts.size(), basic_trie(get_allocator()));
+			std::atomic<std::size_t> next = 0;
+			run([&]()
+			{
+				for (std::size_t k = next++; k < parts.size(); k = next++)
+				{
+					tries[k].assign(parts[k].m_first, parts[k].m_last);
+					for (std::size_t j = 0; j < roots[k].size(); ++j) roots[k][j].first = walk(tries[k], parts[k].m_prefixes[j]);
+				}
+			});
+
+			// 部分木を重ならない範囲へ並行に配置する
+			std::vector<index_type> offsets(parts.size());
+			index_type offset = base_type::limit() - 2;
+			for (std::size_t k = 0; k < parts.size(); ++k)
+			{
+				offsets[k] = offset;
+				offset += tries[k].limit() - 2;
+			}
+			m_c.resize(offset + 2, node_type{ 0, 0 });
+
+			next = 0;
+			run([&]()
+			{
+				for (std::size_t k = next++; k < parts.size(); k = next++)
+				{
+					base_type::graft(tries[k], offsets[k], roots[k]);
+					basic_trie(get_allocator()).swap(tries[k]);
+				}
+			});
+
+			// 未使用ノードのリンクリストと索引を作り直す。
+			base_type::relink();
+			m_c.front().m_base = static_cast<index_type>(length.size());
+		}
+
 		// 要素アクセス --------------------------------------------------------
 
+		/*! @brief 一括入出力形式でストリームへ出力する
+
+		@param [out] os 出力先のストリーム
+
+		@return os
+
+		版、ラベルの型、Trieの種類、ノード数、チェックサムを記録したヘッダに続けて、ノード配列を一度に出力する。
+		operator<<() のような1バイト毎の直列化を行わないため、大きな辞書の保存に向く。
+		ストリームはバイナリ・モードで開く必要がある。
+
+		@par 例
+		@code
+			// Trie木を作成
+			std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+			auto t1 = trie<char32_t>(v.begin(), v.end());
+
+			// 一括入出力形式で出力
+			std::stringstream ss;
+			t1.write(ss);
+
+			// 一括入出力形式で入力
+			trie<char32_t> t2;
+			t2.read(ss);
+
+			// 検証
+			assert(t1.size() == t2.size());
+		@endcode
+
+		@sa detail::trie_image_header
+		*/
+		std::ostream& write(std::ostream& os) const
+		{
+			base_type::write_image(os, sizeof(label_type), base_type::image_flavour);
+			return os;
+		}
+
+		/*! @brief 一括入出力形式でストリームから入力する
+
+		@param [in] is 入力元のストリーム
+
+		@return is
+
+		ヘッダが一致しない場合、データが足りない場合、チェックサムが一致しない場合、
+		ストリームに failbit を立て、コンテナを変更しない。
+
+		@sa write(std::ostream& os) const
+		*/
+		std::istream& read(std::istream& is)
+		{
+			base_type::read_image(is, sizeof(label_type), base_type::image_flavour);
+			return is;
+		}
+
 		/*! @brief 葉の値への参照を返す
 
 		@param [in]  pos 葉を指すイテレータ
@@ -564,7 +831,7 @@ namespace wordring
 
 		空のTrieも根を持つ。
 		*/
-		const_iterator begin() const noexcept { return const_iterator(m_c, 1); }
+		const_iterator begin() const noexcept { return const_iterator(m_c, 1, sibling_links()); }
 
 		/*! @brief 根を指すイテレータを返す
 
@@ -572,7 +839,7 @@ namespace wordring
 
 		空のTrieも根を持つ。
 		*/
-		const_iterator cbegin() const noexcept { return const_iterator(m_c, 1); }
+		const_iterator cbegin() const noexcept { return const_iterator(m_c, 1, sibling_links()); }
 
 		/*! @brief 根の終端を指すイテレータを返す
 
@@ -586,6 +853,44 @@ namespace wordring
 		*/
 		const_iterator cend() const noexcept { return const_iterator(m_c, 0); }
 
+		/*! @brief 辞書順で最初の葉を指すイテレータを返す
+
+		@return 最初の葉を指すイテレータ、葉が無い場合 leaf_end()
+
+		@sa detail::const_trie_leaf_iterator
+
+		@par 例
+		@code
+			// Trie木を作成
+			std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+			auto t = trie<char32_t>(v.begin(), v.end());
+
+			// 全てのキー文字列を辞書順に列挙する
+			std::vector<std::u32string> result;
+			for (auto it = t.leaf_begin(); it != t.leaf_end(); ++it)
+			{
+				std::u32string s;
+				it.string(s);
+				result.push_back(s);
+			}
+
+			// 検証
+			assert(result == v);
+		@endcode
+		*/
+		const_leaf_iterator leaf_begin() const
+		{
+			const_leaf_iterator it(m_c, 0, sibling_links());
+			it.m_index = it.leftmost(1);
+			return it;
+		}
+
+		/*! @brief 最後の葉の次を指すイテレータを返す
+
+		@return 最後の葉の次を指すイテレータ
+		*/
+		const_leaf_iterator leaf_end() const { return const_leaf_iterator(m_c, 0, sibling_links()); }
+
 		// 容量 ---------------------------------------------------------------
 
 		/*! @brief キー文字列を格納していないことを調べる
@@ -976,11 +1281,612 @@ namespace wordring
 		{
 			return contains(std::begin(key), std::end(key));
 		}
+
+		/*! @brief キー文字列以上の最初の葉を検索する
+
+		@param [in] first キー文字列の先頭を指すイテレータ
+		@param [in] last  キー文字列の終端を指すイテレータ
+
+		@return
+			辞書順でキー文字列以上の最初の葉を指すイテレータ。
+			そのような葉が無い場合、 leaf_end() 。
+
+		辞書順は、キー文字列を直列化したバイト列の順、つまり Label を符号無し整数と見做した順である。
+		キー文字列自体は格納されていなくても良い。
+
+		@sa upper_bound(InputIterator first, InputIterator last) const
+		*/
+		template <typename InputIterator>
+		const_leaf_iterator lower_bound(InputIterator first, InputIterator last) const
+		{
+			return bound(first, last, false);
+		}
+
+		/*! @brief キー文字列以上の最初の葉を検索する
+
+		@param [in] key キー文字列
+
+		@return
+			辞書順でキー文字列以上の最初の葉を指すイテレータ。
+			そのような葉が無い場合、 leaf_end() 。
+
+		lower_bound() と upper_bound() を組み合わせると、範囲内のキー文字列を出力の大きさに比例する時間で列挙できる。
+
+		@par 例
+		@code
+			// Trie木を作成
+			std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+			auto t = trie<char32_t>(v.begin(), v.end());
+
+			// 「あい」以上「うあい」以下のキー文字列を列挙する
+			auto it1 = t.lower_bound(std::u32string(U"あい"));
+			auto it2 = t.upper_bound(std::u32string(U"うあい"));
+
+			std::vector<std::u32string> result;
+			for (; it1 != it2; ++it1)
+			{
+				std::u32string s;
+				it1.string(s);
+				result.push_back(s);
+			}
+
+			// 検証
+			assert(result == std::vector<std::u32string>({ U"あう", U"い", U"うあい" }));
+		@endcode
+		*/
+		template <typename Key>
+		const_leaf_iterator lower_bound(Key const& key) const
+		{
+			return lower_bound(std::begin(key), std::end(key));
+		}
+
+		/*! @brief キー文字列より大きい最初の葉を検索する
+
+		@param [in] first キー文字列の先頭を指すイテレータ
+		@param [in] last  キー文字列の終端を指すイテレータ
+
+		@return
+			辞書順でキー文字列より大きい最初の葉を指すイテレータ。
+			そのような葉が無い場合、 leaf_end() 。
+
+		@sa lower_bound(InputIterator first, InputIterator last) const
+		*/
+		template <typename InputIterator>
+		const_leaf_iterator upper_bound(InputIterator first, InputIterator last) const
+		{
+			return bound(first, last, true);
+		}
+
+		/*! @brief キー文字列より大きい最初の葉を検索する
+
+		@param [in] key キー文字列
+
+		@return
+			辞書順でキー文字列より大きい最初の葉を指すイテレータ。
+			そのような葉が無い場合、 leaf_end() 。
+
+		@sa lower_bound(Key const& key) const
+		*/
+		template <typename Key>
+		const_leaf_iterator upper_bound(Key const& key) const
+		{
+			return upper_bound(std::begin(key), std::end(key));
+		}
+
+		/*! @brief 共通接頭辞検索
+
+		@param [in]  first 検索する文字列の先頭を指すイテレータ
+		@param [in]  last  検索する文字列の終端を指すイテレータ
+		@param [out] out   結果の出力先
+
+		@return 最後に出力した次を指す出力イテレータ
+
+		入力文字列の接頭辞となる格納済みキー文字列を、短い順に全て出力する。
+		出力される要素は、キー文字列の長さ（ラベル数）と葉の値のペアである。
+
+		根から一度だけ遷移し、遷移するたびに文字列終端か調べるため、
+		lookup() の後に parent() で親をたどる必要が無い。
+		最後に出力された要素が最長一致となるため、辞書による分かち書きや最長一致の走査に使える。
+
+		@par 例
+		@code
+			// Trie木を作成
+			std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+			auto t = trie<char32_t>(v.begin(), v.end());
+			t[std::u32string(U"あう")] = 10;
+
+			// 共通接頭辞検索する
+			std::u32string s{ U"あうえお" };
+			std::vector<std::pair<std::size_t, std::uint32_t>> result;
+			t.common_prefix_search(s.begin(), s.end(), std::back_inserter(result));
+
+			// 検証
+			assert(result.size() == 2);
+			assert(result[0].first == 1);
+			assert(result[1].first == 2 && result[1].second == 10);
+		@endcode
+		*/
+		template <typename InputIterator, typename OutputIterator>
+		OutputIterator common_prefix_search(InputIterator first, InputIterator last, OutputIterator out) const
+		{
+			using unsigned_type = std::make_unsigned_t<label_type>;
+
+			node_type const* d = m_c.data();
+			index_type const limit = base_type::limit();
+
+			index_type parent = 1;
+			std::size_t n = 0;
+
+			while (first != last)
+			{
+				assert(coefficient == sizeof(*first));
+
+				unsigned_type label = static_cast<unsigned_type>(*first);
+				for (std::uint32_t i = 0; i < coefficient; ++i)
+				{
+					index_type base = (d + parent)->m_base;
+					if (base <= 0) return out;
+
+					index_type idx = base + (label >> ((coefficient - i - 1) * 8) & 0xFFu);
+					if (limit <= idx || (d + idx)->m_check != parent) return out;
+
+					parent = idx;
+				}
+				++first;
+				++n;
+
+				// 文字列終端を調べる
+				index_type base = (d + parent)->m_base;
+				if (base <= 0)
+				{
+					*out++ = std::make_pair(n, static_cast<value_type>(-base));
+					break;
+				}
+				if (base + null_value < limit && (d + base + null_value)->m_check == parent)
+				{
+					*out++ = std::make_pair(n, static_cast<value_type>(-(d + base + null_value)->m_base));
+				}
+			}
+
+			return out;
+		}
+
+		/*! @brief 共通接頭辞検索
+
+		@param [in]  key 検索する文字列
+		@param [out] out 結果の出力先
+
+		@return 最後に出力した次を指す出力イテレータ
+
+		@sa common_prefix_search(InputIterator first, InputIterator last, OutputIterator out) const
+		*/
+		template <typename Key, typename OutputIterator>
+		OutputIterator common_prefix_search(Key const& key, OutputIterator out) const
+		{
+			return common_prefix_search(std::begin(key), std::end(key), out);
+		}
+
+		/*! @brief 編集距離による曖昧検索
+
+		@param [in]  first        検索するキー文字列の先頭を指すイテレータ
+		@param [in]  last         検索するキー文字列の終端を指すイテレータ
+		@param [in]  max_distance 許容する最大の編集距離
+		@param [out] out          結果の出力先
+
+		@return 最後に出力した次を指す出力イテレータ
+
+		検索するキー文字列とのレーベンシュタイン距離が max_distance 以下の格納済みキー文字列を、ラベル順に全て出力する。
+		出力される要素は、キー文字列と葉の値と編集距離の組（ std::tuple<String, value_type, std::uint32_t> ）である。
+
+		根から深さ優先に遷移し、ノード毎に編集距離表の一行を計算する。
+		行の最小値が max_distance を超えた時点で、その部分木の走査を打ち切る。
+		ラベルは直列化されているが、走査は const_iterator と同じくラベル単位で行われるため、
+		多バイトのラベルでも一文字の置換は距離1として数えられる。
+
+		行の最小値が max_distance に等しいノードでは、距離を増やさない遷移しか許容範囲内に残らない。
+		この場合、子を列挙せず、行の値が max_distance である位置の検索キー文字列のラベルで直接遷移する。
+		それ以外のノードでは全ての子を列挙するため、 use_sibling_table() で兄弟表を有効にすると速くなる。
+
+		@par 例
+		@code
+			// Trie木を作成
+			std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+			auto t = trie<char32_t>(v.begin(), v.end());
+
+			// 曖昧検索する
+			std::u32string s{ U"うい" };
+			std::vector<std::tuple<std::u32string, std::uint32_t, std::uint32_t>> result;
+			t.fuzzy_search<std::u32string>(s.begin(), s.end(), 1, std::back_inserter(result));
+
+			// 検証
+			assert(result.size() == 3); // 「い」、「うあい」、「うえ」
+		@endcode
+		*/
+		template <typename String, typename InputIterator, typename OutputIterator>
+		OutputIterator fuzzy_search(InputIterator first, InputIterator last, std::uint32_t max_distance, OutputIterator out) const
+		{
+			using unsigned_type = std::make_unsigned_t<label_type>;
+
+			std::vector<label_type> key(first, last);
+			std::size_t const n = key.size();
+
+			node_type const* d = m_c.data();
+			index_type const limit = base_type::limit();
+
+			// 深さ毎の編集距離表
+			std::vector<std::uint32_t> rows(n + 1);
+			for (std::size_t i = 0; i <= n; ++i) rows[i] = static_cast<std::uint32_t>(i);
+
+			// 子を列挙する範囲と、その後に使う直接遷移した子の数
+			struct frame
+			{
+				const_iterator m_first;
+				const_iterator m_last;
+				std::size_t    m_probes;
+			};
+
+			String s{};
+			std::vector<frame> stack;
+			std::vector<index_type> probes; // 直接遷移した子（フレーム毎にラベルの降順に積む）
+			std::vector<label_type> labels;
+
+			// 行の最小値が max_distance に等しい場合、直接遷移した子だけを積む
+			auto push = [&](const_iterator const& it, std::uint32_t const* row, std::uint32_t min)
+			{
+				if (min < max_distance)
+				{
+					stack.push_back({ it.begin(), it.end(), 0 });
+					return;
+				}
+
+				labels.clear();
+				for (std::size_t i = 0; i < n; ++i) if (row[i] == max_distance) labels.push_back(key[i]);
+				std::sort(labels.begin(), labels.end(), [](label_type a, label_type b) { return static_cast<unsigned_type>(b) < static_cast<unsigned_type>(a); });
+				labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+				std::size_t count = 0;
+				for (label_type label : labels)
+				{
+					index_type idx = it.m_index;
+					for (std::uint32_t i = 0; i < coefficient && idx != 0; ++i)
+					{
+						index_type base = (d + idx)->m_base;
+						index_type next = base + (static_cast<unsigned_type>(label) >> ((coefficient - i - 1) * 8) & 0xFFu);
+						idx = (0 < base && next < limit && (d + next)->m_check == idx) ? next : 0;
+					}
+					if (idx == 0) continue;
+
+					probes.push_back(idx);
+					++count;
+				}
+
+				stack.push_back({ it.end(), it.end(), count });
+			};
+
+			push(cbegin(), rows.data(), 0);
+
+			while (!stack.empty())
+			{
+				frame& top = stack.back();
+
+				const_iterator it;
+				if (top.m_first != top.m_last) it = top.m_first++;
+				else if (top.m_probes != 0)
+				{
+					it = const_iterator(m_c, probes.back(), sibling_links());
+					probes.pop_back();
+					--top.m_probes;
+				}
+				else
+				{
+					stack.pop_back();
+					if (!stack.empty()) s.pop_back();
+					continue;
+				}
+
+				label_type label = *it;
+
+				std::size_t depth = stack.size();
+				rows.resize((depth + 1) * (n + 1));
+				std::uint32_t const* prev = rows.data() + (depth - 1) * (n + 1);
+				std::uint32_t* row = rows.data() + depth * (n + 1);
+
+				row[0] = static_cast<std::uint32_t>(depth);
+				std::uint32_t min = row[0];
+				for (std::size_t i = 1; i <= n; ++i)
+				{
+					std::uint32_t cost = prev[i - 1] + (key[i - 1] == label ? 0 : 1);
+					row[i] = std::min({ prev[i] + 1, row[i - 1] + 1, cost });
+					min = std::min(min, row[i]);
+				}
+
+				if (max_distance < min) continue;
+
+				s.push_back(label);
+				if (it && row[n] <= max_distance)
+				{
+					*out++ = std::make_tuple(s, static_cast<value_type>(at(it)), row[n]);
+				}
+				push(it, row, min);
+			}
+
+			return out;
+		}
+
+		/*! @brief 編集距離による曖昧検索
+
+		@param [in]  key          検索するキー文字列
+		@param [in]  max_distance 許容する最大の編集距離
+		@param [out] out          結果の出力先
+
+		@return 最後に出力した次を指す出力イテレータ
+
+		出力される要素は、 std::tuple<Key, value_type, std::uint32_t> である。
+
+		@sa fuzzy_search(InputIterator first, InputIterator last, std::uint32_t max_distance, OutputIterator out) const
+		*/
+		template <typename Key, typename OutputIterator>
+		OutputIterator fuzzy_search(Key const& key, std::uint32_t max_distance, OutputIterator out) const
+		{
+			return fuzzy_search<Key>(std::begin(key), std::end(key), max_distance, out);
+		}
+
+		/*! @brief 複数のキー文字列を部分一致検索する
+
+		@param [in]  first キー文字列リストの先頭を指すイテレータ
+		@param [in]  last  キー文字列リストの終端を指すイテレータ
+		@param [out] out   結果の出力先
+
+		@return 最後に出力した次を指す出力イテレータ
+
+		キー文字列毎に lookup() と同じ結果（一致した最後のノードと次の文字を指すイテレータのペア）を、
+		キー文字列リストの順に出力する。
+
+		最大 batch_size 個のキー文字列の遷移を交互に進め、それぞれの次の遷移先を先読みする。
+		一つのキー文字列の遷移は前の遷移に依存する読み込みの連鎖だが、異なるキー文字列の読み込みは重ねられる。
+		短いキー文字列を大量に検索する場合、 lookup() を繰り返すより速い。
+
+		文字列リストの要素は出力が終わるまで有効である必要がある。
+
+		@par 例
+		@code
+			// Trie木を作成
+			std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+			auto t = trie<char32_t>(v.begin(), v.end());
+
+			// 部分一致検索する
+			std::vector<std::u32string> keys{ U"うい", U"あう" };
+			std::vector<std::pair<trie<char32_t>::const_iterator, std::u32string::const_iterator>> result;
+			t.lookup_batch(keys.cbegin(), keys.cend(), std::back_inserter(result));
+
+			// 検証
+			assert(*result[0].first == U'う');
+			assert(*result[0].second == U'い');
+		@endcode
+		*/
+		template <typename ForwardIterator, typename OutputIterator>
+		OutputIterator lookup_batch(ForwardIterator first, ForwardIterator last, OutputIterator out) const
+		{
+			batch(first, last, [this, &out](auto const& s)
+			{
+				index_type idx = s.m_parent;
+				for (std::uint32_t i = s.m_offset; i != 0; --i) idx = (m_c.data() + idx)->m_check;
+
+				*out++ = std::make_pair(const_iterator(m_c, idx, sibling_links()), s.m_first);
+			});
+
+			return out;
+		}
+
+		/*! @brief 複数のキー文字列を完全一致検索する
+
+		@param [in]  first キー文字列リストの先頭を指すイテレータ
+		@param [in]  last  キー文字列リストの終端を指すイテレータ
+		@param [out] out   結果の出力先
+
+		@return 最後に出力した次を指す出力イテレータ
+
+		キー文字列毎に find() と同じ結果を、キー文字列リストの順に出力する。
+
+		@sa lookup_batch()
+
+		@par 例
+		@code
+			// Trie木を作成
+			std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+			auto t = trie<char32_t>(v.begin(), v.end());
+
+			// 完全一致検索する
+			std::vector<std::u32string> keys{ U"あう", U"うあ" };
+			std::vector<trie<char32_t>::const_iterator> result;
+			t.find_batch(keys.begin(), keys.end(), std::back_inserter(result));
+
+			// 検証
+			assert(*result[0] == U'う');
+			assert(result[1] == t.cend());
+		@endcode
+		*/
+		template <typename ForwardIterator, typename OutputIterator>
+		OutputIterator find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out) const
+		{
+			batch(first, last, [this, &out](auto const& s)
+			{
+				*out++ = (s.m_first == s.m_last && is_tail(s.m_parent))
+					? const_iterator(m_c, s.m_parent, sibling_links())
+					: cend();
+			});
+
+			return out;
+		}
+
+		/*! @brief 複数のキー文字列が格納されているか調べる
+
+		@param [in]  first キー文字列リストの先頭を指すイテレータ
+		@param [in]  last  キー文字列リストの終端を指すイテレータ
+		@param [out] out   結果の出力先
+
+		@return 最後に出力した次を指す出力イテレータ
+
+		キー文字列毎に contains() と同じ結果を、キー文字列リストの順に出力する。
+
+		@sa lookup_batch()
+		*/
+		template <typename ForwardIterator, typename OutputIterator>
+		OutputIterator contains_batch(ForwardIterator first, ForwardIterator last, OutputIterator out) const
+		{
+			batch(first, last, [this, &out](auto const& s)
+			{
+				*out++ = s.m_first == s.m_last && is_tail(s.m_parent);
+			});
+
+			return out;
+		}
+
+	protected:
+		/*! @brief lower_bound() 、 upper_bound() の実装
+
+		キー文字列をバイト単位でたどり、遷移できなくなった所で、より大きいラベルの兄弟から最も左の葉へ降りる。
+		*/
+		template <typename InputIterator>
+		const_leaf_iterator bound(InputIterator first, InputIterator last, bool upper) const
+		{
+			assert(coefficient == sizeof(typename std::iterator_traits<InputIterator>::value_type));
+
+			if constexpr (coefficient == 1) return bound_bytes(first, last, upper);
+			else return bound_bytes(wordring::serialize_iterator(first), wordring::serialize_iterator(last), upper);
+		}
+
+		template <typename InputIterator>
+		const_leaf_iterator bound_bytes(InputIterator first, InputIterator last, bool upper) const
+		{
+			node_type const* d = m_c.data();
+			index_type limit = base_type::limit();
+
+			const_leaf_iterator it(m_c, 0, sibling_links());
+
+			index_type parent = 1;
+			for (; first != last; ++first)
+			{
+				std::uint8_t label = static_cast<std::uint8_t>(*first);
+
+				index_type base = (d + parent)->m_base;
+				index_type idx = base + label;
+				if (base <= 0 || limit <= idx || (d + idx)->m_check != parent)
+				{
+					it.m_index = it.next(parent, label);
+					return it;
+				}
+				parent = idx;
+			}
+
+			if (!upper && is_tail(parent) && parent != 1) it.m_index = parent;
+			else
+			{
+				index_type idx = it.first_child(parent);
+				it.m_index = (idx != 0) ? it.leftmost(idx) : it.next(parent);
+			}
+
+			return it;
+		}
+
+		/*! @brief 一度に遷移を交互に進めるキー文字列の数
+		*/
+		static std::uint32_t constexpr batch_size = 16;
+
+		/*! @brief 複数のキー文字列の遷移を交互に進める
+
+		@param [in] first キー文字列リストの先頭を指すイテレータ
+		@param [in] last  キー文字列リストの終端を指すイテレータ
+		@param [in] fn    キー文字列毎の遷移の結果を受け取る関数
+
+		fn には、キー文字列リストの順に、以下のメンバを持つ状態が渡される。
+
+		- m_first  一致しなかった最初のラベルを指すイテレータ
+		- m_last   キー文字列の終端を指すイテレータ
+		- m_parent 最後に遷移したノードのインデックス
+		- m_offset m_first が指すラベルのうち、遷移したバイト数
+		*/
+		template <typename ForwardIterator, typename Function>
+		void batch(ForwardIterator first, ForwardIterator last, Function fn) const
+		{
+			using key_iterator  = decltype(std::begin(*first));
+			using unsigned_type = std::make_unsigned_t<label_type>;
+
+			struct state
+			{
+				key_iterator  m_first;
+				key_iterator  m_last;
+				index_type    m_parent;
+				index_type    m_base;
+				std::uint32_t m_offset;
+			};
+
+			auto byte = [](state const& s) -> std::uint16_t
+			{
+				assert(coefficient == sizeof(*s.m_first));
+				return static_cast<unsigned_type>(*s.m_first) >> ((coefficient - s.m_offset - 1) * 8) & 0xFFu;
+			};
+
+			node_type const* d = m_c.data();
+			index_type const limit = base_type::limit();
+			index_type const root = (d + 1)->m_base;
+
+			std::array<state, batch_size> v;
+			std::array<std::uint32_t, batch_size> active;
+
+			while (first != last)
+			{
+				// キー文字列を読み込み、最初の遷移先を先読みする
+				std::uint32_t n = 0, m = 0;
+				for (; n < batch_size && first != last; ++n, ++first)
+				{
+					v[n] = state{ std::begin(*first), std::end(*first), 1, root, 0 };
+					if (v[n].m_first == v[n].m_last || root <= 0) continue;
+
+					detail::trie_prefetch(d + root + byte(v[n]));
+					active[m++] = n;
+				}
+
+				// 遷移を交互に進める
+				while (m != 0)
+				{
+					std::uint32_t k = 0;
+					for (std::uint32_t j = 0; j < m; ++j)
+					{
+						state& s = v[active[j]];
+
+						index_type idx = s.m_base + byte(s);
+						if (limit <= idx) continue;
+
+						node_type const* p = d + idx;
+						if (p->m_check != s.m_parent) continue;
+
+						s.m_parent = idx;
+						s.m_base = p->m_base;
+						if (++s.m_offset == coefficient)
+						{
+							s.m_offset = 0;
+							++s.m_first;
+						}
+
+						if (s.m_first == s.m_last || s.m_base <= 0) continue;
+
+						// 次の遷移先を先読みする
+						detail::trie_prefetch(d + s.m_base + byte(s));
+						active[k++] = active[j];
+					}
+					m = k;
+				}
+
+				for (std::uint32_t j = 0; j < n; ++j) fn(v[j]);
+			}
+		}
 	};
 
 	/*! @brief ストリームへ出力する
 
 	速度を必要とする場合、使用を推奨しない。
+	代わりに basic_trie::write() を使う。
 
 	@par 例
 	@code
@@ -1010,6 +1916,7 @@ namespace wordring
 	/*! @brief ストリームから入力する
 
 	速度を必要とする場合、使用を推奨しない。
+	代わりに basic_trie::read() を使う。
 	*/
 	template <typename Label1, typename Base1>
 	inline std::istream& operator>>(std::istream& is, basic_trie<Label1, Base1>& trie)
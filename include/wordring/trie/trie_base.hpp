@@ -84,10 +84,14 @@ namespace wordring::detail
 		using value_type      = std::uint32_t;
 		using size_type       = typename container::size_type;
 		using allocator_type  = Allocator;
-		using reference       = trie_value_proxy;
-		using const_reference = trie_value_proxy const;
+		using reference       = basic_trie_value_proxy<node_type>;
+		using const_reference = basic_trie_value_proxy<node_type> const;
 		using const_iterator  = const_trie_base_iterator<container const>;
 
+		/*! @brief 一括入出力形式に記録するTrieの種類
+		*/
+		static constexpr trie_image_flavour image_flavour = trie_image_flavour::trie;
+
 	public:
 		using typename base_type::serialize_iterator;
 
@@ -106,6 +110,7 @@ namespace wordring::detail
 		using base_type::has_sibling;
 		using base_type::at;
 		using base_type::add;
+		using base_type::sibling_links;
 
 		using base_type::m_c;
 
@@ -167,7 +172,7 @@ namespace wordring::detail
 		@param [in]
 			alloc アロケータ
 		*/
-		trie_base(std::initializer_list<trie_node> il, allocator_type const& alloc = allocator_type())
+		trie_base(std::initializer_list<typename Allocator::value_type> il, allocator_type const& alloc = allocator_type())
 			: base_type(il, alloc)
 		{
 		}
@@ -236,7 +241,7 @@ namespace wordring::detail
 				++it;
 			}
 
-			m_c.front().m_base = static_cast<std::uint32_t>(std::distance(first, last)); // m_base は int32_t なので大きさを合わせる
+			m_c.front().m_base = static_cast<index_type>(std::distance(first, last)); // m_base は INDEX の型なので大きさを合わせる
 		}
 
 		// 要素アクセス --------------------------------------------------------
@@ -391,7 +396,7 @@ namespace wordring::detail
 
 		空のTrieも根を持つ。
 		*/
-		const_iterator begin() const noexcept { return const_iterator(m_c, 1); }
+		const_iterator begin() const noexcept { return const_iterator(m_c, 1, sibling_links()); }
 
 		/*! @brief 根を指すイテレータを返す
 
@@ -399,7 +404,7 @@ namespace wordring::detail
 
 		空のTrieも根を持つ。
 		*/
-		const_iterator cbegin() const noexcept { return const_iterator(m_c, 1); }
+		const_iterator cbegin() const noexcept { return const_iterator(m_c, 1, sibling_links()); }
 
 		/*! @brief 根の終端を指すイテレータを返す
 
@@ -439,7 +444,7 @@ namespace wordring::detail
 		*/
 		static constexpr size_type max_size() noexcept
 		{
-			return std::numeric_limits<std::int32_t>::max() / sizeof(node_type);
+			return std::numeric_limits<index_type>::max() / sizeof(node_type);
 		}
 
 		// 変更 ---------------------------------------------------------------
@@ -457,7 +462,7 @@ namespace wordring::detail
 		template <typename InputIterator>
 		const_iterator insert(InputIterator first, InputIterator last, value_type value = 0)
 		{
-			assert(value <= static_cast<value_type>(std::numeric_limits<int32_t>::max()));
+			assert(value <= static_cast<value_type>(std::numeric_limits<index_type>::max()));
 
 			if (first == last) return cend();
 
@@ -509,7 +514,7 @@ namespace wordring::detail
 
 			assert(parent != 1);
 
-			return const_iterator(m_c, parent);
+			return const_iterator(m_c, parent, sibling_links());
 		}
 
 		/*! @brief キー文字列を挿入する
@@ -532,6 +537,9 @@ namespace wordring::detail
 		@param [in] pos 削除するキー文字列の末尾に対応するノードへのイテレータ
 
 		このメンバは、継承するクラスから呼び出される目的で用意した。
+
+		子を失った祖先が空遷移を持つ場合、その祖先は別のキー文字列の終端である。
+		空遷移を解放して祖先を葉に戻す際、空遷移に格納されていた値を葉へ移す。
 		*/
 		void erase(const_iterator pos)
 		{
@@ -540,15 +548,16 @@ namespace wordring::detail
 
 			if (idx <= 1 || !is_tail(idx)) return;
 
-			while (true)
+			for (bool first = true; true; first = false)
 			{
 				if (has_null(idx))
 				{
 					index_type i = (m_c.data() + idx)->m_base + null_value;
 					assert((m_c.data() + i)->m_check == idx);
 
+					index_type value = first ? 0 : (m_c.data() + i)->m_base;
 					free(i);
-					if (!has_child(idx)) (m_c.data() + idx)->m_base = 0;
+					if (!has_child(idx)) (m_c.data() + idx)->m_base = value;
 
 					break;
 				}
@@ -632,7 +641,7 @@ namespace wordring::detail
 				assert(1 <= parent && parent < limit());
 			}
 
-			return std::make_pair(const_iterator(m_c, parent), first);
+			return std::make_pair(const_iterator(m_c, parent, sibling_links()), first);
 		}
 
 	public:
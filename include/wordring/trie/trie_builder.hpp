@@ -0,0 +1,294 @@
+﻿#pragma once
+
+#include <wordring/trie/stable_trie_base.hpp>
+#include <wordring/trie/trie.hpp>
+#include <wordring/trie/trie_base.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace wordring
+{
+	// ------------------------------------------------------------------------
+	// basic_trie_builder
+	// ------------------------------------------------------------------------
+
+	/*! @class basic_trie_builder trie_builder.hpp wordring/trie/trie_builder.hpp
+
+	@brief 整列済みのキー文字列を一つずつ受け取り、Trie木を構築する
+
+	@tparam Label ラベルとして使用する任意の整数型
+	@tparam Base  構築する basic_trie の基本クラス（ detail::trie_base あるいは detail::stable_trie_base ）
+
+	basic_trie::assign() は整列済みの文字列リスト全体を必要とし、
+	insert() を繰り返すと、整列済みであってもキー毎に根からの検索と子の再配置が起こる。
+	このクラスは、直前のキーとの共通接頭辞より深いノードを確定させながら構築するため、
+	ファイルから読み込んだ整列済みのキーをそのまま渡せる。
+
+	作業領域は、最も長いキーの長さと、経路上のノードの子の数に比例する。
+
+	@par 配置
+
+	子の集合が確定したノードから、子の並びを一度で配置する。
+	この時点でノード自身の位置は決まっていないため、子のCHECKには仮の値を書き込み、
+	親の子の並びを配置した時に、孫のCHECKを書き換える。
+	配置済みのノードを再配置することは無い。
+
+	@par 例
+	@code
+		std::ifstream is("words.txt"); // 整列済み
+
+		trie_builder<char> b;
+		std::string s;
+		while (std::getline(is, s)) b.push_back(s);
+
+		trie<char> t = b.finish();
+	@endcode
+	*/
+	template <typename Label, typename Base = detail::trie_base<>>
+	class basic_trie_builder : protected basic_trie<Label, Base>
+	{
+	protected:
+		using base_type = basic_trie<Label, Base>;
+
+		using typename base_type::index_type;
+		using typename base_type::node_type;
+		using typename base_type::label_vector;
+
+		using base_type::null_value;
+		using base_type::coefficient;
+		using base_type::m_c;
+
+		/*! 終端のノードが、子の有無にかかわらず空遷移を持つ場合 true
+		*/
+		static constexpr bool stable = Base::image_flavour == detail::trie_image_flavour::stable_trie;
+
+		/*! 確定した子
+
+		- m_base は子の並びの配置起点、葉の場合は値の符号を反転したもの。
+		- m_offset 、 m_count は、親の深さの m_grandchildren に積んだ孫のラベルの範囲。
+		*/
+		struct child
+		{
+			std::uint16_t m_label;
+			index_type    m_base;
+			std::uint32_t m_offset;
+			std::uint16_t m_count;
+		};
+
+		/*! 現在の経路上の一つのノード
+		*/
+		struct level
+		{
+			std::uint16_t              m_label    = 0;
+			bool                       m_terminal = false;
+			index_type                 m_value    = 0;
+			std::vector<child>         m_children;
+			std::vector<std::uint16_t> m_grandchildren;
+		};
+
+	public:
+		using trie_type      = base_type;
+		using label_type     = typename base_type::label_type;
+		using value_type     = typename base_type::value_type;
+		using size_type      = typename base_type::size_type;
+		using allocator_type = typename base_type::allocator_type;
+
+	public:
+		/*! @brief 空のビルダーを構築する
+
+		@param [in] alloc 構築する Trie木のアロケータ
+		*/
+		explicit basic_trie_builder(allocator_type const& alloc = allocator_type())
+			: base_type(alloc)
+			, m_levels(1)
+			, m_key()
+			, m_size(0)
+		{
+		}
+
+		/*! @brief キー文字列を追加する
+
+		@param [in] first キー文字列の先頭を指すイテレータ
+		@param [in] last  キー文字列の終端を指すイテレータ
+		@param [in] value 葉へ格納する値（省略時は0）
+
+		@throw std::invalid_argument キー文字列を直列化したバイト列が、直前のキーより辞書順で大きくない場合
+
+		空のキー文字列は無視する。
+		*/
+		template <typename InputIterator>
+		void push_back(InputIterator first, InputIterator last, value_type value = 0)
+		{
+			using unsigned_type = std::make_unsigned_t<label_type>;
+
+			assert(value <= static_cast<value_type>(std::numeric_limits<index_type>::max()));
+
+			m_buffer.clear();
+			for (; first != last; ++first)
+			{
+				assert(coefficient == sizeof(*first));
+
+				unsigned_type label = static_cast<unsigned_type>(*first);
+				for (std::uint32_t i = 0; i < coefficient; ++i)
+				{
+					m_buffer.push_back(static_cast<std::uint8_t>(label >> ((coefficient - i - 1) * 8) & 0xFFu));
+				}
+			}
+			if (m_buffer.empty()) return;
+
+			// 直前のキーとの共通接頭辞
+			std::size_t n = std::mismatch(m_buffer.begin(), m_buffer.end(), m_key.begin(), m_key.end()).first - m_buffer.begin();
+			if (n == m_buffer.size() || (n < m_key.size() && m_buffer[n] < m_key[n])) throw std::invalid_argument("");
+
+			// 共通接頭辞より深いノードは、もう子が増えない
+			for (std::size_t depth = m_key.size(); n < depth; --depth) complete(depth);
+
+			if (m_levels.size() <= m_buffer.size()) m_levels.resize(m_buffer.size() + 1);
+			for (std::size_t depth = n + 1; depth <= m_buffer.size(); ++depth)
+			{
+				level& lv = m_levels[depth];
+				lv.m_label = m_buffer[depth - 1];
+				lv.m_terminal = false;
+				lv.m_children.clear();
+				lv.m_grandchildren.clear();
+			}
+			m_levels[m_buffer.size()].m_terminal = true;
+			m_levels[m_buffer.size()].m_value = static_cast<index_type>(value);
+
+			m_key.swap(m_buffer);
+			++m_size;
+		}
+
+		/*! @brief キー文字列を追加する
+
+		@param [in] key   キー文字列
+		@param [in] value 葉へ格納する値（省略時は0）
+
+		@sa push_back(InputIterator first, InputIterator last, value_type value)
+		*/
+		template <typename Key>
+		void push_back(Key const& key, value_type value = 0)
+		{
+			push_back(std::begin(key), std::end(key), value);
+		}
+
+		/*! @brief 追加したキー文字列の数を返す
+		*/
+		size_type size() const noexcept { return m_size; }
+
+		/*! @brief 残りのノードを確定させ、Trie木を返す
+
+		@return 構築した Trie木
+
+		ビルダーは空の状態に戻る。
+		*/
+		trie_type finish()
+		{
+			for (std::size_t depth = m_key.size(); 0 < depth; --depth) complete(depth);
+
+			label_vector labels;
+			for (child const& c : m_levels.front().m_children) labels.push_back(c.m_label);
+			if (!labels.empty())
+			{
+				// 根の子のCHECKは、仮の値が既に正しい
+				index_type base = place(m_levels.front(), labels);
+				(m_c.data() + 1)->m_base = base;
+			}
+			m_c.front().m_base = static_cast<index_type>(m_size);
+
+			trie_type result(std::move(static_cast<trie_type&>(*this)));
+
+			static_cast<trie_type&>(*this) = trie_type(result.get_allocator());
+			m_levels.assign(1, level());
+			m_key.clear();
+			m_size = 0;
+
+			return result;
+		}
+
+	protected:
+		/*! 深さdepthのノードの子を配置し、親の深さへ確定した子として積む
+		*/
+		void complete(std::size_t depth)
+		{
+			assert(0 < depth && depth < m_levels.size());
+
+			level& lv = m_levels[depth];
+			level& parent = m_levels[depth - 1];
+
+			child c{ lv.m_label, 0, static_cast<std::uint32_t>(parent.m_grandchildren.size()), 0 };
+
+			if (lv.m_terminal && (stable || !lv.m_children.empty()))
+			{
+				lv.m_children.push_back(child{ static_cast<std::uint16_t>(null_value), -lv.m_value, 0, 0 });
+			}
+
+			if (lv.m_children.empty())
+			{
+				assert(lv.m_terminal);
+				c.m_base = -lv.m_value;
+			}
+			else
+			{
+				label_vector labels;
+				for (child const& gc : lv.m_children) labels.push_back(gc.m_label);
+
+				c.m_base = place(lv, labels);
+				c.m_count = static_cast<std::uint16_t>(labels.size());
+				parent.m_grandchildren.insert(parent.m_grandchildren.end(), labels.begin(), labels.end());
+			}
+
+			parent.m_children.push_back(c);
+
+			lv.m_terminal = false;
+			lv.m_children.clear();
+			lv.m_grandchildren.clear();
+		}
+
+		/*! lvの子を配置し、配置起点を返す
+		- 子のCHECKには仮に1を書き込む。
+		- 子のINDEXが決まるため、孫のCHECKを書き換える。
+		*/
+		index_type place(level const& lv, label_vector const& labels)
+		{
+			index_type before = 0;
+			index_type base = this->locate(labels, before);
+			this->allocate(base, labels, before);
+
+			node_type* d = m_c.data();
+			for (child const& c : lv.m_children)
+			{
+				index_type idx = base + c.m_label;
+				(d + idx)->m_base = c.m_base;
+				(d + idx)->m_check = 1;
+
+				for (std::uint32_t i = c.m_offset; i < c.m_offset + c.m_count; ++i)
+				{
+					(d + c.m_base + lv.m_grandchildren[i])->m_check = idx;
+				}
+			}
+
+			return base;
+		}
+
+	protected:
+		std::vector<level>        m_levels;
+		std::vector<std::uint8_t> m_key;
+		std::vector<std::uint8_t> m_buffer;
+		std::size_t               m_size;
+	};
+
+	template <typename Label, typename Allocator = std::allocator<detail::trie_node>>
+	using trie_builder = basic_trie_builder<Label, detail::trie_base<Allocator>>;
+
+	template <typename Label, typename Allocator = std::allocator<detail::trie_node>>
+	using stable_trie_builder = basic_trie_builder<Label, detail::stable_trie_base<Allocator>>;
+}
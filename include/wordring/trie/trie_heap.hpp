@@ -3,61 +3,336 @@
 #include <wordring/serialize/serialize.hpp>
 #include <wordring/serialize/serialize_iterator.hpp>
 #include <wordring/static_vector/static_vector.hpp>
+#include <wordring/trie/trie_page_vector.hpp>
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
 #include <cstdint>
 #include <initializer_list>
 #include <istream>
 #include <iterator>
+#include <limits>
+#include <memory>
 #include <ostream>
+#include <stdexcept>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#endif
+
 namespace wordring::detail
 {
 	// ------------------------------------------------------------------------
 	// trie_node
 	// ------------------------------------------------------------------------
 
-	struct trie_node
+	/*! @brief ダブル・アレイのノード
+
+	@tparam Index BASE と CHECK に使う符号付き整数型
+
+	INDEX の幅はノード配列の大きさと、格納できる値の上限を決める。
+
+	- 16ビットは小さな辞書でノード配列を半分にする。
+	- 64ビットは32ビットの INDEX に収まらない大きな辞書に使う。
+
+	ノード型はアロケータの value_type として trie_heap へ渡す。
+
+	@code
+		using trie16 = wordring::trie<char, std::allocator<wordring::detail::trie_node16>>;
+	@endcode
+	*/
+	template <typename Index>
+	struct basic_trie_node
 	{
-		using index_type = std::int32_t;
+		static_assert(std::is_integral_v<Index> && std::is_signed_v<Index>);
+
+		using index_type = Index;
 
 		index_type m_base;
 		index_type m_check;
 	};
 
-	inline bool operator==(trie_node const& lhs, trie_node const& rhs)
+	using trie_node   = basic_trie_node<std::int32_t>;
+	using trie_node16 = basic_trie_node<std::int16_t>;
+	using trie_node64 = basic_trie_node<std::int64_t>;
+
+	template <typename Index>
+	inline bool operator==(basic_trie_node<Index> const& lhs, basic_trie_node<Index> const& rhs)
 	{
 		return lhs.m_base == rhs.m_base && lhs.m_check == rhs.m_check;
 	}
 
+	/*! @brief ノードをキャッシュへ先読みする
+
+	複数のキーの遷移を交互に進める際、次の遷移先の読み込みを重ねるために使う。
+	対応しない環境では何もしない。
+	*/
+	template <typename Node>
+	inline void trie_prefetch(Node const* p) noexcept
+	{
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+		_mm_prefetch(reinterpret_cast<char const*>(p), _MM_HINT_T0);
+#elif defined(__GNUC__)
+		__builtin_prefetch(p, 0, 3);
+#else
+		static_cast<void>(p);
+#endif
+	}
+
+	// ------------------------------------------------------------------------
+	// trie_compact_result
+	// ------------------------------------------------------------------------
+
+	/*! @brief trie_heap::compact() の結果
+
+	m_remap は旧INDEXから新INDEXへの対応表で、旧 limit() の長さを持つ。
+	未使用だったノードには0が入る。
+	*/
+	template <typename Index>
+	struct basic_trie_compact_result
+	{
+		using index_type = Index;
+
+		std::size_t             m_before; // 詰める前のノード数（未使用ノードを含む）
+		std::size_t             m_after;  // 詰めた後のノード数
+		std::vector<index_type> m_remap;
+	};
+
+	using trie_compact_result = basic_trie_compact_result<std::int32_t>;
+
+	// ------------------------------------------------------------------------
+	// trie_stats
+	// ------------------------------------------------------------------------
+
+	/*! @brief trie_heap の累積カウンタを有効にする場合、trueとなる
+
+	WORDRING_TRIE_COUNTERS を定義してコンパイルすると有効になる。
+	無効の場合、カウンタを更新するコードは生成されず、カウンタは常に0のままとなる。
+	*/
+#ifdef WORDRING_TRIE_COUNTERS
+	inline constexpr bool trie_counters_enabled = true;
+#else
+	inline constexpr bool trie_counters_enabled = false;
+#endif
+
+	/*! @brief trie_heap の累積カウンタ
+
+	挿入が遅い原因が、衝突による再配置か、空きノード探索の長さかを見分けるために使う。
+	*/
+	struct trie_counters
+	{
+		std::uint64_t m_relocate = 0; // relocate() の呼び出し回数
+		std::uint64_t m_locate   = 0; // locate() の呼び出し回数
+		std::uint64_t m_walk     = 0; // locate() が調べた64ノード幅の窓の数の合計
+	};
+
+	/*! @brief trie_heap::stats() の結果
+
+	深さと子の数はバイト単位のノードで数える。
+	多バイトのラベルを使う basic_trie では、一文字が複数の深さにまたがる。
+
+	- m_depth[n] は深さnのノード数で、根の深さは0となる。
+	- m_fanout[n] は子をn個持つノード数で、空遷移も子として数える（最大257）。
+	- m_tail[n] は、分岐の無い経路で葉まで続くn個のノードの列の数である。
+	  長い列が多い場合、接尾辞の共有や末尾の圧縮が有効である。
+	*/
+	struct trie_stats
+	{
+		std::size_t m_size;        // 格納しているキー文字列数
+		std::size_t m_nodes;       // ノード配列の要素数（INDEX0を含む）
+		std::size_t m_live;        // 使用中のノード数（根を含む）
+		std::size_t m_free;        // 未使用ノード数
+		double      m_fill;        // 充填率（使用中のノード数 / INDEX0を除く要素数）
+		std::size_t m_bytes;       // ノード配列が確保しているバイト数
+		std::size_t m_index_bytes; // 未使用ノードの索引と、子と兄弟のラベルの表が確保しているバイト数
+
+		std::vector<std::size_t> m_depth;
+		std::vector<std::size_t> m_fanout;
+		std::vector<std::size_t> m_tail;
+
+		trie_counters m_counters;
+	};
+
+	// ------------------------------------------------------------------------
+	// trie_image
+	// ------------------------------------------------------------------------
+
+	/*! @brief 一括入出力形式に記録するTrieの種類
+
+	同じダブル・アレイでも、種類によって葉の値や空遷移の意味が異なるため、異なる種類としては読み込めない。
+	*/
+	enum class trie_image_flavour : std::uint8_t
+	{
+		trie        = 1, // trie_base
+		stable_trie = 2, // stable_trie_base
+		atom_set    = 3, // basic_atom_set
+	};
+
+	/*! @brief 一括入出力形式のヘッダ
+
+	ヘッダは32バイトで、整数はすべてリトル・エンディアンで記録する。
+
+	| 位置 | 大きさ | 内容 |
+	| ---- | ---- | ---- |
+	| 0  | 8 | マジック "WRTRIE\r\n" |
+	| 8  | 2 | 版（現在1） |
+	| 10 | 1 | ラベルのバイト数 |
+	| 11 | 1 | INDEXのバイト数 |
+	| 12 | 1 | Trieの種類（ trie_image_flavour ） |
+	| 13 | 3 | 予約（0） |
+	| 16 | 8 | ノード数 |
+	| 24 | 8 | ノード配列のチェックサム |
+
+	ヘッダの後に、ノード数分の BASE 、 CHECK の組がリトル・エンディアンで続く。
+	マジックの末尾の改行は、テキスト・モードでの改行変換による破損を検出するためにある。
+
+	@sa trie_heap::write_image()
+	@sa trie_heap::read_image()
+	*/
+	struct trie_image_header
+	{
+		static constexpr std::uint16_t current_version = 1;
+		static constexpr std::size_t   size            = 32;
+
+		static constexpr std::array<std::uint8_t, 8> magic{ 'W', 'R', 'T', 'R', 'I', 'E', '\r', '\n' };
+
+		std::uint16_t      m_version;
+		std::uint8_t       m_label_size;
+		std::uint8_t       m_index_size;
+		trie_image_flavour m_flavour;
+		std::uint64_t      m_nodes;
+		std::uint64_t      m_checksum;
+
+		std::array<std::uint8_t, size> encode() const
+		{
+			std::array<std::uint8_t, size> result{};
+
+			std::copy(magic.begin(), magic.end(), result.begin());
+			store(result.data() + 8, m_version);
+			result[10] = m_label_size;
+			result[11] = m_index_size;
+			result[12] = static_cast<std::uint8_t>(m_flavour);
+			store(result.data() + 16, m_nodes);
+			store(result.data() + 24, m_checksum);
+
+			return result;
+		}
+
+		/*! マジックが一致しない場合、falseを返す
+		*/
+		bool decode(std::array<std::uint8_t, size> const& buf)
+		{
+			if (!std::equal(magic.begin(), magic.end(), buf.begin())) return false;
+
+			load(buf.data() + 8, m_version);
+			m_label_size = buf[10];
+			m_index_size = buf[11];
+			m_flavour    = static_cast<trie_image_flavour>(buf[12]);
+			load(buf.data() + 16, m_nodes);
+			load(buf.data() + 24, m_checksum);
+
+			return true;
+		}
+
+		template <typename T>
+		static void store(std::uint8_t* p, T val)
+		{
+			for (std::size_t i = 0; i < sizeof(T); ++i) p[i] = static_cast<std::uint8_t>(val >> (i * 8));
+		}
+
+		template <typename T>
+		static void load(std::uint8_t const* p, T& val)
+		{
+			val = 0;
+			for (std::size_t i = 0; i < sizeof(T); ++i) val |= static_cast<T>(p[i]) << (i * 8);
+		}
+	};
+
+	/*! @brief ノード配列のチェックサムを計算する
+
+	BASE と CHECK を一つの64ビット語とし、語単位のFNV-1aで計算する。
+	INDEX が64ビットの場合、 BASE と CHECK をそれぞれ一語とする。
+	バイトではなく値から計算するため、ホストのバイト順に依存しない。
+	*/
+	template <typename Node>
+	inline std::uint64_t trie_image_checksum(Node const* d, std::size_t n) noexcept
+	{
+		using unsigned_type = std::make_unsigned_t<typename Node::index_type>;
+
+		std::uint64_t h = 14695981039346656037ull;
+		for (Node const* last = d + n; d != last; ++d)
+		{
+			std::uint64_t base  = static_cast<unsigned_type>(d->m_base);
+			std::uint64_t check = static_cast<unsigned_type>(d->m_check);
+			if constexpr (sizeof(unsigned_type) < sizeof(std::uint64_t))
+			{
+				h = (h ^ (base | check << 32)) * 1099511628211ull;
+			}
+			else
+			{
+				h = (h ^ base) * 1099511628211ull;
+				h = (h ^ check) * 1099511628211ull;
+			}
+		}
+
+		return h;
+	}
+
+	/*! @brief ノードのバイト順を入れ替える
+
+	ビッグ・エンディアンのホストで、一括入出力形式のリトル・エンディアンと変換するために使う。
+	*/
+	template <typename Node>
+	inline Node trie_image_byteswap(Node node) noexcept
+	{
+		using index_type    = typename Node::index_type;
+		using unsigned_type = std::make_unsigned_t<index_type>;
+
+		auto swap = [](index_type v)
+		{
+			unsigned_type u = static_cast<unsigned_type>(v);
+			unsigned_type r = 0;
+			for (std::size_t i = 0; i < sizeof(unsigned_type); ++i, u >>= 8) r = static_cast<unsigned_type>(r << 8 | (u & 0xFFu));
+			return static_cast<index_type>(r);
+		};
+
+		return Node{ swap(node.m_base), swap(node.m_check) };
+	}
+
 	// ------------------------------------------------------------------------
 	// trie_value_proxy
 	// ------------------------------------------------------------------------
 
-	struct trie_value_proxy
+	template <typename Node>
+	struct basic_trie_value_proxy
 	{
-		using index_type = typename trie_node::index_type;
-		using node_type = trie_node;
+		using index_type = typename Node::index_type;
+		using node_type = Node;
 
 		node_type* m_node;
 
-		trie_value_proxy()
+		basic_trie_value_proxy()
 			: m_node(nullptr)
 		{
 		}
 
-		trie_value_proxy(node_type* node)
+		basic_trie_value_proxy(node_type* node)
 			: m_node(node)
 		{
 		}
 
-		void operator=(index_type val)
+		/*! 葉の値を設定する
+		- 値が INDEX の型で表せない場合、 std::length_error を投げる。
+		*/
+		void operator=(std::uint32_t val)
 		{
-			if (val < 0) throw std::invalid_argument("");
-			m_node->m_base = -val;
+			if (static_cast<std::uint64_t>(std::numeric_limits<index_type>::max()) < val) throw std::length_error("");
+			m_node->m_base = -static_cast<index_type>(val);
 		}
 
 		operator index_type() const
@@ -67,12 +342,14 @@ namespace wordring::detail
 		}
 	};
 
+	using trie_value_proxy = basic_trie_value_proxy<trie_node>;
+
 	// ------------------------------------------------------------------------
 	// trie_heap_serialize_iterator
 	// ------------------------------------------------------------------------
 
 	/*! trie_heap を直列化するためのイテレータ
-	- 値として32bit整数を返す。
+	- 値として INDEX と同じ幅の符号無し整数を返す。
 	*/
 	template <typename Container>
 	class trie_heap_serialize_iterator
@@ -86,17 +363,17 @@ namespace wordring::detail
 		template <typename Container1>
 		friend bool operator!=(trie_heap_serialize_iterator<Container1> const&, trie_heap_serialize_iterator<Container1> const&);
 
+	protected:
+		using node_type = std::remove_cv_t<typename Container::value_type>;
+		using container = Container const;
+
 	public:
 		using difference_type   = std::ptrdiff_t;
-		using value_type        = std::uint32_t;
+		using value_type        = std::make_unsigned_t<typename node_type::index_type>;
 		using pointer           = value_type*;
 		using reference         = value_type&;
 		using iterator_category = std::input_iterator_tag;
 
-	protected:
-		using node_type = trie_node;
-		using container = Container const;
-
 	public:
 		trie_heap_serialize_iterator()
 			: m_c(nullptr)
@@ -105,7 +382,7 @@ namespace wordring::detail
 		}
 
 	protected:
-		trie_heap_serialize_iterator(container const& c, std::uint32_t n)
+		trie_heap_serialize_iterator(container const& c, std::size_t n)
 			: m_c(std::addressof(c))
 			, m_index(n * 2)
 		{
@@ -132,8 +409,8 @@ namespace wordring::detail
 		}
 
 	protected:
-		container*    m_c;
-		std::uint32_t m_index;
+		container*  m_c;
+		std::size_t m_index;
 	};
 
 	template <typename Container1>
@@ -151,268 +428,1426 @@ namespace wordring::detail
 	}
 
 	// ------------------------------------------------------------------------
-	// trie_heap
+	// trie_label_set
 	// ------------------------------------------------------------------------
 
-	/*! @brief ダブル・アレイによるTrie実装のメモリー管理を行う
+	/*! @brief ラベル（0-256）の集合
 
-	根は常にINDEX1となる。
-	INDEX0は使用されないため、0は末尾を示す値としても使用される。
+	子のラベルを257ビットで表す。
+	和集合や、配置起点の検索でのラベルの列挙を語単位のビット演算で行うために使う。
+	*/
+	class trie_label_set
+	{
+	public:
+		using word_type = std::uint64_t;
 
-	@par 配列の利用法
+		static constexpr std::uint32_t word_bits = 64;
+		static constexpr std::uint32_t words     = 5;
 
-	ダブル・アレイの添字は1から始まるため、INDEX0は使用されない。
-	そのため、以下の用途で使う。
+	public:
+		trie_label_set()
+			: m_words{}
+		{
+		}
 
-	- INDEX0のBASEに葉の数を記録し、size()の戻り値として使う（葉は格納するキーの数と同義）。
-	- INDEX0のCHECKに符号を反転させて未使用ノードの先頭INDEXを記録する（未使用ノードが無い場合、0）。
+		template <typename Labels>
+		explicit trie_label_set(Labels const& labels)
+			: m_words{}
+		{
+			for (std::uint16_t label : labels) set(label);
+		}
 
-	ダブル・アレイのBASEは子の配置基準INDEXを示すため、1未満の値は格納されない。
-	および、葉は子を持たないため、BASEを使用しない。
-	そのため、以下の用途で使う。
+		void set(std::uint16_t label)
+		{
+			assert(label <= 256);
+			m_words[label / word_bits] |= word_type(1) << (label % word_bits);
+		}
 
-	- 1未満の値が格納されている場合、そのノードは葉である（デフォルト値は0）。
-	- オプションとして葉に正の整数値を格納可能とする。
-	- 葉に正の整数値を格納する場合、符号を反転させて格納し、葉であることを示す。
-	- 値を取り出す場合、符号を反転させて、正の整数値として返す。
+		bool test(std::uint16_t label) const
+		{
+			assert(label <= 256);
+			return (m_words[label / word_bits] >> (label % word_bits)) & 1;
+		}
 
-	ダブル・アレイのCHECKは親のINDEXを示すため、1未満の値は格納されない。
-	そのため、以下の用途に使う。
+		bool empty() const noexcept
+		{
+			return (m_words[0] | m_words[1] | m_words[2] | m_words[3] | m_words[4]) == 0;
+		}
 
-	- 1未満の値が格納されている場合、そのノードは未使用である（ただし、根のCHECKは常に使用状態且つ値は0）。
-	- 未使用ノードのINDEXの符号を反転させてつなげ、一方向リンクリストとする。
-	- 未使用ノードの末尾は、値を0として示す。
-	- 未使用ノードのリンクリストは、解放のたびに、INDEX順に並ぶよう整列させる。
-	- 整列によってキーの挿入・検索速度が30％～40％向上する。
-	- 検索速度の向上は、キー挿入時にINDEXが散らばらず、キャッシュに乗りやすく配置されるためと
-	  考えられる。
+		word_type word(std::uint32_t i) const noexcept { return m_words[i]; }
 
-	@par 配列のイメージ
+		trie_label_set& operator|=(trie_label_set const& other) noexcept
+		{
+			for (std::uint32_t i = 0; i < words; ++i) m_words[i] |= other.m_words[i];
+			return *this;
+		}
 
-	@image html trie_heap_concept.svg
+		/*! ラベルを昇順に関数fnへ渡す
+		- fnが false を返した場合、そこで打ち切り false を返す。
+		*/
+		template <typename Function>
+		bool for_each(Function fn) const
+		{
+			for (std::uint32_t i = 0; i < words; ++i)
+			{
+				for (word_type w = m_words[i]; w != 0; w &= w - 1)
+				{
+					if (!fn(static_cast<std::uint16_t>(i * word_bits + std::countr_zero(w)))) return false;
+				}
+			}
+			return true;
+		}
 
-	- 上図で未使用ノードは2と4。
-	- 格納される文字列は「2」一つ。
-	- 根である1からラベル「2」で3へ遷移。
-	- 葉3の値として100を保持。
+		/*! ラベルを昇順にコンテナへ追加する
+		*/
+		template <typename Labels>
+		void labels(Labels& result) const
+		{
+			for_each([&result](std::uint16_t label) { result.push_back(label); return true; });
+		}
+
+	protected:
+		std::array<word_type, words> m_words;
+	};
+
+	// ------------------------------------------------------------------------
+	// trie_free_bitmap
+	// ------------------------------------------------------------------------
+
+	/*! @brief 未使用ノードの索引
+
+	未使用ノードのリンクリストは INDEX 順に整列されているため、解放や割り当ての度に
+	直前の未使用ノードを先頭からたどる必要があり、ノード数に比例した時間がかかる。
+	この索引は、未使用ノードを1ノード1ビットで記録し、直前・直後の未使用ノードを
+	語単位のビット演算で求める。
+
+	- 1語は64ノードを受け持つ。
+	- 64語（4,096ノード）をブロックとし、ブロック毎に未使用ノード数を記録する。
+	- 未使用ノードが無いブロックは、語を調べずに読み飛ばす。
+
+	INDEX0はリンクリストの先頭であり、未使用ノードとして記録されることは無い。
+	そのため、検索結果の0は「見つからない」を示す。
 	*/
 	template <typename Allocator>
-	class trie_heap
+	class trie_free_bitmap
 	{
-		template <typename Allocator1>
-		friend std::ostream& operator<<(std::ostream&, trie_heap<Allocator1> const&);
-
-		template <typename Allocator1>
-		friend std::istream& operator>>(std::istream&, trie_heap<Allocator1>&);
+	public:
+		using index_type = typename std::allocator_traits<Allocator>::value_type::index_type;
 
 	protected:
-		using index_type   = typename trie_node::index_type;
-		using node_type    = trie_node;
-		using container    = std::vector<trie_node, Allocator>;
-		using label_vector = static_vector<std::uint16_t, 257>;
+		using word_type  = std::uint64_t;
+		using count_type = std::uint32_t;
 
-		static constexpr std::uint16_t null_value = 256u;
+		using word_allocator  = typename std::allocator_traits<Allocator>::template rebind_alloc<word_type>;
+		using count_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<count_type>;
 
-	public:
-		using label_type         = std::uint8_t;
-		using allocator_type     = Allocator;
-		using serialize_iterator = trie_heap_serialize_iterator<container const>;
+		static constexpr std::uint32_t word_bits   = 64;
+		static constexpr std::uint32_t block_words = 64;
+		static constexpr std::uint32_t block_bits  = word_bits * block_words;
 
 	public:
-		/*! @brief コンテナに関連付けられているアロケータを返す
-		
-		@return コンテナに関連付けられているアロケータ
+		explicit trie_free_bitmap(Allocator const& alloc = Allocator())
+			: m_words(word_allocator(alloc))
+			, m_counts(count_allocator(alloc))
+			, m_limit(0)
+		{
+		}
+
+		/*! 索引が受け持つノード数を返す
 		*/
-		allocator_type get_allocator() const { return m_c.get_allocator(); }
+		index_type limit() const noexcept { return m_limit; }
 
-		/*! @brief 直列化データから割り当てる
+		/*! 索引が受け持つノード数を変更する
+		- 新たに受け持つノードは使用中として記録される。
+		*/
+		void resize(index_type n)
+		{
+			assert(m_limit <= n);
 
-		@param [in]
-			first 直列化データの先頭を指すイテレータ
-		@param [in]
-			last 直列化データの終端を指すイテレータ
+			std::size_t words = (static_cast<std::size_t>(n) + word_bits - 1) / word_bits;
+			m_words.resize(words, 0);
+			m_counts.resize((words + block_words - 1) / block_words, 0);
+			m_limit = n;
+		}
 
-		直列化データは[ibegin(), iend())から作成された整数値のリストを想定する。
-		整数の型（ビットの大きさ）は指定されず、適切に処理される。
-		[ibegin(), iend())から返される32ビット整数のコンテナでも、ファイルから読み込まれた8ビット整数のコンテナでも構わない。
+		/*! 受け持つノード数をnとし、すべて使用中として記録する
+		*/
+		void reset(index_type n)
+		{
+			m_words.clear();
+			m_counts.clear();
+			m_limit = 0;
+			resize(n);
+		}
 
-		@sa
-			ibegin() const\n
-			iend() const
+		/*! idxを未使用ノードとして記録する
+		*/
+		void set(index_type idx)
+		{
+			assert(0 < idx && idx < m_limit);
 
-		@par 例
+			word_type& w = m_words[idx / word_bits];
+			word_type mask = word_type(1) << (idx % word_bits);
+			if ((w & mask) == 0)
+			{
+				w |= mask;
+				++m_counts[idx / block_bits];
+			}
+		}
 
-		※trie_heapは単独で構築できないため、サンプルはtrieを使用。
-		@code
-			// 元となるTrieを作成
-			std::vector<std::string> v1{ "a", "ac", "b", "cab", "cd" };
-			auto t1 = trie<char>(v1.begin(), v1.end());
+		/*! idxを使用中ノードとして記録する
+		*/
+		void erase(index_type idx)
+		{
+			assert(0 < idx && idx < m_limit);
+
+			word_type& w = m_words[idx / word_bits];
+			word_type mask = word_type(1) << (idx % word_bits);
+			if ((w & mask) != 0)
+			{
+				w &= ~mask;
+				--m_counts[idx / block_bits];
+			}
+		}
+
+		/*! 記録されている未使用ノード数を返す
+		*/
+		std::size_t count() const noexcept
+		{
+			std::size_t result = 0;
+			for (count_type n : m_counts) result += n;
+			return result;
+		}
+
+		/*! idxが未使用ノードとして記録されている場合、trueを返す
+		*/
+		bool test(index_type idx) const
+		{
+			assert(0 <= idx && idx < m_limit);
+			return (m_words[idx / word_bits] >> (idx % word_bits)) & 1;
+		}
+
+		/*! idx未満で最大の未使用ノードを返す
+		- 無い場合、0を返す。
+		*/
+		index_type prev(index_type idx) const
+		{
+			idx = std::min(idx, m_limit);
+			if (idx <= 1) return 0;
+
+			std::size_t i = static_cast<std::size_t>(idx - 1);
+			std::size_t w = i / word_bits;
+
+			// 同じ語
+			word_type bits = m_words[w] & (~word_type(0) >> (word_bits - 1 - i % word_bits));
+			if (bits != 0) return static_cast<index_type>(w * word_bits + word_bits - 1 - std::countl_zero(bits));
+
+			// 同じブロック
+			std::size_t b = w / block_words;
+			for (std::size_t j = w; b * block_words < j--;)
+			{
+				if (m_words[j] != 0) return static_cast<index_type>(j * word_bits + word_bits - 1 - std::countl_zero(m_words[j]));
+			}
+
+			// 先行するブロック
+			while (b-- != 0)
+			{
+				if (m_counts[b] == 0) continue;
+				for (std::size_t j = (b + 1) * block_words; b * block_words < j--;)
+				{
+					if (m_words[j] != 0) return static_cast<index_type>(j * word_bits + word_bits - 1 - std::countl_zero(m_words[j]));
+				}
+			}
+
+			return 0;
+		}
+
+		/*! idx以上で最小の未使用ノードを返す
+		- 無い場合、0を返す。
+		*/
+		index_type next(index_type idx) const
+		{
+			idx = std::max<index_type>(idx, 1);
+			if (m_limit <= idx) return 0;
+
+			std::size_t i = static_cast<std::size_t>(idx);
+			std::size_t w = i / word_bits;
+
+			// 同じ語
+			word_type bits = m_words[w] & (~word_type(0) << (i % word_bits));
+			if (bits != 0) return static_cast<index_type>(w * word_bits + std::countr_zero(bits));
+
+			// 同じブロック
+			std::size_t b = w / block_words;
+			std::size_t last = std::min((b + 1) * block_words, m_words.size());
+			for (std::size_t j = w + 1; j < last; ++j)
+			{
+				if (m_words[j] != 0) return static_cast<index_type>(j * word_bits + std::countr_zero(m_words[j]));
+			}
+
+			// 後続するブロック
+			for (++b; b < m_counts.size(); ++b)
+			{
+				if (m_counts[b] == 0) continue;
+				last = std::min((b + 1) * block_words, m_words.size());
+				for (std::size_t j = b * block_words; j < last; ++j)
+				{
+					if (m_words[j] != 0) return static_cast<index_type>(j * word_bits + std::countr_zero(m_words[j]));
+				}
+			}
+
+			return 0;
+		}
+
+		/*! idxから始まる64ノード分の未使用ビットを返す
+		- 受け持つ範囲外のノードは未使用として扱う。
+		*/
+		word_type window(std::size_t idx) const noexcept
+		{
+			std::size_t w = idx / word_bits;
+			std::uint32_t shift = idx % word_bits;
+
+			word_type result = word(w) >> shift;
+			if (shift != 0) result |= word(w + 1) << (word_bits - shift);
+
+			return result;
+		}
+
+		/*! base + labelsがすべて未使用となる、first以上で最小のbaseを返す
+
+		@param [in] first  検索を始めるbase
+		@param [in] labels 配置するラベルの集合
+		@param [in] walk   調べた64ノード幅の窓の数を加算する先
+
+		- 受け持つ範囲外のノードは未使用として扱うため、必ず見つかる。
+		- 連続する64個のbaseを一度に調べる。
+		  各ラベルについて、base + labelから始まる64ビットを論理積し、残ったビットが配置可能なbaseとなる。
+		- 最初のラベルの位置に未使用ノードが無い範囲は、ブロック単位で読み飛ばす。
+		*/
+		index_type find(index_type first, trie_label_set const& labels, std::uint64_t& walk) const
+		{
+			return find(first, labels, walk, [](std::size_t) { return word_type(0); });
+		}
+
+		/*! base + labelsがすべて未使用となり、除外されない、first以上で最小のbaseを返す
+
+		@param [in] first   検索を始めるbase
+		@param [in] labels  配置するラベルの集合
+		@param [in] walk    調べた64ノード幅の窓の数を加算する先
+		@param [in] exclude baseから始まる64個のbaseのうち、除外するもののビットを返す関数
+
+		basic_dawg のように、BASEの値が重複してはならない場合に使う。
+		*/
+		template <typename Exclude>
+		index_type find(index_type first, trie_label_set const& labels, std::uint64_t& walk, Exclude exclude) const
+		{
+			assert(1 <= first);
+			assert(!labels.empty());
+
+			std::uint16_t offset = 0;
+			labels.for_each([&offset](std::uint16_t label) { offset = label; return false; });
+
+			assert(offset < m_limit);
+
+			std::size_t base = static_cast<std::size_t>(first);
+			while (true)
+			{
+				word_type bits = ~exclude(base);
+				if (static_cast<std::size_t>(m_limit) <= base + offset)
+				{
+					if (bits != 0) return static_cast<index_type>(base + std::countr_zero(bits));
+					base += word_bits;
+					continue;
+				}
+
+				++walk;
+
+				labels.for_each([&](std::uint16_t label)
+				{
+					bits &= window(base + label);
+					return bits != 0;
+				});
+				if (bits != 0) return static_cast<index_type>(base + std::countr_zero(bits));
+
+				// 次の未使用ノードに最初のラベルを重ねる
+				index_type idx = next(static_cast<index_type>(base + word_bits + offset));
+				base = (idx != 0)
+					? static_cast<std::size_t>(idx) - offset
+					: std::max<std::size_t>(static_cast<std::size_t>(m_limit) - offset, base + word_bits);
+			}
+		}
+
+		/*! 索引が確保しているバイト数を返す
+		*/
+		std::size_t bytes() const noexcept
+		{
+			return m_words.capacity() * sizeof(word_type) + m_counts.capacity() * sizeof(count_type);
+		}
+
+		void swap(trie_free_bitmap& other)
+		{
+			m_words.swap(other.m_words);
+			m_counts.swap(other.m_counts);
+			std::swap(m_limit, other.m_limit);
+		}
+
+	protected:
+		/*! i番目の語を返す
+		- 受け持つ範囲外のビットは未使用として立てる。
+		*/
+		word_type word(std::size_t i) const noexcept
+		{
+			std::size_t limit = static_cast<std::size_t>(m_limit);
+
+			if (limit <= i * word_bits) return ~word_type(0);
+
+			word_type result = m_words[i];
+			if (limit < (i + 1) * word_bits) result |= ~word_type(0) << (limit % word_bits);
+
+			return result;
+		}
+
+	protected:
+		std::vector<word_type, word_allocator>   m_words;
+		std::vector<count_type, count_allocator> m_counts;
+		index_type                               m_limit;
+	};
+
+	// ------------------------------------------------------------------------
+	// trie_sibling_table
+	// ------------------------------------------------------------------------
+
+	/*! @brief ノードの最初の子と次の兄弟のラベル
+
+	ラベル（0-256）に1を加えて格納し、0は「無し」を示す。
+	*/
+	struct trie_sibling_link
+	{
+		std::uint16_t m_child;
+		std::uint16_t m_sibling;
+	};
+
+	/*! @brief 子と兄弟のラベルの表を読み取るためのインターフェース
+
+	イテレータはアロケータに依存しないこのクラスを通して表を参照する。
+	*/
+	template <typename Node>
+	class basic_trie_sibling_links
+	{
+	public:
+		using index_type = typename Node::index_type;
+		using node_type  = Node;
+
+		static constexpr std::uint16_t null_value = 256u;
+
+	public:
+		/*! parentの最初の子のINDEXを返す
+		- 空遷移は含めない。
+		- 子が無い場合、0を返す。
+		*/
+		index_type first_child(node_type const* d, index_type parent) const
+		{
+			assert(1 <= parent && parent < m_limit);
+
+			std::uint16_t label = m_data[parent].m_child;
+
+			return (label != 0 && label <= null_value)
+				? (d + parent)->m_base + label - 1
+				: 0;
+		}
+
+		/*! idxの次の兄弟のINDEXを返す
+		- 空遷移は含めない。
+		- 兄弟が無い場合、0を返す。
+		*/
+		index_type next_sibling(node_type const* d, index_type idx) const
+		{
+			assert(1 < idx && idx < m_limit);
+
+			std::uint16_t label = m_data[idx].m_sibling;
+
+			return (label != 0 && label <= null_value)
+				? (d + (d + idx)->m_check)->m_base + label - 1
+				: 0;
+		}
+
+	protected:
+		basic_trie_sibling_links()
+			: m_data(nullptr)
+			, m_limit(0)
+		{
+		}
+
+	protected:
+		trie_sibling_link* m_data;
+		index_type         m_limit;
+	};
+
+	using trie_sibling_links = basic_trie_sibling_links<trie_node>;
+
+	/*! @brief ノード毎に最初の子と次の兄弟のラベルを記録する表
+
+	ダブル・アレイで子を列挙するには、親のBASEから257個のCHECKを調べる必要がある。
+	この表は、子をラベル順の一方向リストとしてつなぎ、子の数に比例した時間で列挙できるようにする。
+	cedarの ninfo と同じ考え方である。
+
+	- ノード一つにつき4バイトを消費する。
+	- 子の挿入・削除・移動は trie_heap の add() 、 free() 、 relocate() で反映される。
+	- 配列を直接置き換えた場合は、 trie_heap::rebuild() で再構築される。
+	- 表はダブル・アレイに含まれないため、直列化データの形式は変わらない。
+	*/
+	template <typename Allocator>
+	class trie_sibling_table : public basic_trie_sibling_links<typename std::allocator_traits<Allocator>::value_type>
+	{
+	protected:
+		using base_type = basic_trie_sibling_links<typename std::allocator_traits<Allocator>::value_type>;
+
+		using base_type::m_data;
+		using base_type::m_limit;
+
+	public:
+		using index_type   = typename base_type::index_type;
+		using node_type    = typename base_type::node_type;
+		using label_vector = static_vector<std::uint16_t, 257>;
+
+		using base_type::null_value;
+
+	protected:
+		using link_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<trie_sibling_link>;
+
+	public:
+		explicit trie_sibling_table(Allocator const& alloc = Allocator())
+			: base_type()
+			, m_links(link_allocator(alloc))
+			, m_enabled(false)
+		{
+		}
+
+		// m_data が自身の配列を指すよう、複製と移動の度に更新する
+
+		trie_sibling_table(trie_sibling_table const& other)
+			: base_type()
+			, m_links(other.m_links)
+			, m_enabled(other.m_enabled)
+		{
+			update();
+		}
+
+		trie_sibling_table(trie_sibling_table&& other) noexcept
+			: base_type()
+			, m_links(std::move(other.m_links))
+			, m_enabled(other.m_enabled)
+		{
+			update();
+			other.update();
+		}
+
+		trie_sibling_table& operator=(trie_sibling_table const& other)
+		{
+			m_links = other.m_links;
+			m_enabled = other.m_enabled;
+			update();
+			return *this;
+		}
+
+		trie_sibling_table& operator=(trie_sibling_table&& other) noexcept
+		{
+			m_links = std::move(other.m_links);
+			m_enabled = other.m_enabled;
+			update();
+			other.update();
+			return *this;
+		}
+
+		bool enabled() const noexcept { return m_enabled; }
+
+		/*! 表を使用するか設定する
+		- 使用しない場合、表の領域を解放する。
+		*/
+		void enable(bool enabled)
+		{
+			m_enabled = enabled;
+			if (!enabled)
+			{
+				std::vector<trie_sibling_link, link_allocator>(m_links.get_allocator()).swap(m_links);
+				update();
+			}
+		}
+
+		/*! 表が受け持つノード数を変更する
+		- 新たに受け持つノードは子も兄弟も持たない。
+		*/
+		void resize(index_type n)
+		{
+			if (!m_enabled) return;
+
+			m_links.resize(n, trie_sibling_link{ 0, 0 });
+			update();
+		}
+
+		/*! 配列全体から表を作り直す
+		- 親のBASEからラベルとして0-256の範囲にあるノードを、その親の子とみなす。
+		*/
+		template <typename Container>
+		void rebuild(Container const& c)
+		{
+			if (!m_enabled) return;
+
+			m_links.assign(c.size(), trie_sibling_link{ 0, 0 });
+			update();
+
+			node_type const* d = c.data();
+			// 後ろから先頭へつなぐことで、ラベル順のリストとなる
+			for (index_type idx = m_limit - 1; 1 < idx; --idx)
+			{
+				index_type parent = (d + idx)->m_check;
+				if (parent < 1 || m_limit <= parent) continue;
+
+				index_type base = (d + parent)->m_base;
+				if (base < 1 || idx < base || null_value < idx - base) continue;
+
+				m_data[idx].m_sibling = m_data[parent].m_child;
+				m_data[parent].m_child = static_cast<std::uint16_t>(idx - base + 1);
+			}
+		}
+
+		/*! parentの子のリストへラベル列labelsを加える
+		- labelsは整列済みである必要がある。
+		- 既にリストにあるラベルは無視する。
+		*/
+		void link(node_type const* d, index_type parent, label_vector const& labels)
+		{
+			if (!m_enabled) return;
+
+			assert(1 <= parent && parent < m_limit);
+			assert(std::is_sorted(labels.begin(), labels.end()));
+
+			index_type base = (d + parent)->m_base;
+			assert(1 <= base);
+
+			std::uint16_t* prev = &m_data[parent].m_child;
+			for (std::uint16_t label : labels)
+			{
+				std::uint16_t code = label + 1;
+				while (*prev != 0 && *prev < code) prev = &m_data[base + *prev - 1].m_sibling;
+				if (*prev == code) continue;
+
+				assert(base + label < m_limit);
+				m_data[base + label].m_sibling = *prev;
+				*prev = code;
+				prev = &m_data[base + label].m_sibling;
+			}
+		}
+
+		/*! idxがparentの子である場合、リストから外す
+		*/
+		void unlink(node_type const* d, index_type idx)
+		{
+			if (!m_enabled) return;
+
+			assert(1 < idx && idx < m_limit);
+
+			index_type parent = (d + idx)->m_check;
+			if (1 <= parent && parent < m_limit)
+			{
+				index_type base = (d + parent)->m_base;
+				if (1 <= base && base <= idx && idx - base <= null_value)
+				{
+					std::uint16_t code = static_cast<std::uint16_t>(idx - base + 1);
+					std::uint16_t* prev = &m_data[parent].m_child;
+					while (*prev != 0 && *prev != code) prev = &m_data[base + *prev - 1].m_sibling;
+					if (*prev == code) *prev = m_data[idx].m_sibling;
+				}
+			}
+
+			m_data[idx] = trie_sibling_link{ 0, 0 };
+		}
+
+		/*! fromの子のリストをtoへ移す
+		- 子のラベルは変わらないため、兄弟のリストはそのまま使える。
+		*/
+		void move(index_type from, index_type to)
+		{
+			if (!m_enabled) return;
+
+			assert(1 < from && from < m_limit);
+			assert(1 < to && to < m_limit);
+
+			m_data[to] = m_data[from];
+			m_data[from] = trie_sibling_link{ 0, 0 };
+		}
+
+		/*! parentの子のラベルをlabelsへ出力する
+		- 空遷移を含む。
+		*/
+		void children(node_type const* d, index_type parent, label_vector& labels) const
+		{
+			assert(1 <= parent && parent < m_limit);
+
+			index_type base = (d + parent)->m_base;
+			for (std::uint16_t code = m_data[parent].m_child; code != 0; code = m_data[base + code - 1].m_sibling)
+			{
+				labels.push_back(code - 1);
+			}
+		}
+
+		/*! 表が確保しているバイト数を返す
+		*/
+		std::size_t bytes() const noexcept { return m_links.capacity() * sizeof(trie_sibling_link); }
+
+		void swap(trie_sibling_table& other)
+		{
+			m_links.swap(other.m_links);
+			std::swap(m_enabled, other.m_enabled);
+			update();
+			other.update();
+		}
+
+	protected:
+		void update()
+		{
+			m_data = m_links.data();
+			m_limit = static_cast<index_type>(m_links.size());
+		}
+
+	protected:
+		std::vector<trie_sibling_link, link_allocator> m_links;
+		bool                                           m_enabled;
+	};
+
+	// ------------------------------------------------------------------------
+	// trie_heap
+	// ------------------------------------------------------------------------
+
+	/*! @brief ダブル・アレイによるTrie実装のメモリー管理を行う
+
+	根は常にINDEX1となる。
+	INDEX0は使用されないため、0は末尾を示す値としても使用される。
+
+	@par 配列の利用法
+
+	ダブル・アレイの添字は1から始まるため、INDEX0は使用されない。
+	そのため、以下の用途で使う。
+
+	- INDEX0のBASEに葉の数を記録し、size()の戻り値として使う（葉は格納するキーの数と同義）。
+	- INDEX0のCHECKに符号を反転させて未使用ノードの先頭INDEXを記録する（未使用ノードが無い場合、0）。
+
+	ダブル・アレイのBASEは子の配置基準INDEXを示すため、1未満の値は格納されない。
+	および、葉は子を持たないため、BASEを使用しない。
+	そのため、以下の用途で使う。
+
+	- 1未満の値が格納されている場合、そのノードは葉である（デフォルト値は0）。
+	- オプションとして葉に正の整数値を格納可能とする。
+	- 葉に正の整数値を格納する場合、符号を反転させて格納し、葉であることを示す。
+	- 値を取り出す場合、符号を反転させて、正の整数値として返す。
+
+	ダブル・アレイのCHECKは親のINDEXを示すため、1未満の値は格納されない。
+	そのため、以下の用途に使う。
+
+	- 1未満の値が格納されている場合、そのノードは未使用である（ただし、根のCHECKは常に使用状態且つ値は0）。
+	- 未使用ノードのINDEXの符号を反転させてつなげ、一方向リンクリストとする。
+	- 未使用ノードの末尾は、値を0として示す。
+	- 未使用ノードのリンクリストは、解放のたびに、INDEX順に並ぶよう整列させる。
+	- 整列によってキーの挿入・検索速度が30％～40％向上する。
+	- 検索速度の向上は、キー挿入時にINDEXが散らばらず、キャッシュに乗りやすく配置されるためと
+	  考えられる。
+	- リンクリストの走査を避けるため、未使用ノードを trie_free_bitmap で索引付けする。
+	- 索引は配列に含まれないため、直列化データの形式は変わらない。
+
+	@par 配列の格納先
+
+	配列の型はアロケータによって選ばれる（ trie_heap_container ）。
+	既定は std::vector で、容量を超えると全体を複写する。
+	trie_page_allocator を渡すと、複写せずに伸長し、透過的ヒュージページを使える trie_page_vector となる。
+
+	@par 配列のイメージ
+
+	@image html trie_heap_concept.svg
+
+	- 上図で未使用ノードは2と4。
+	- 格納される文字列は「2」一つ。
+	- 根である1からラベル「2」で3へ遷移。
+	- 葉3の値として100を保持。
+	*/
+	template <typename Allocator>
+	class trie_heap
+	{
+		template <typename Allocator1>
+		friend std::ostream& operator<<(std::ostream&, trie_heap<Allocator1> const&);
+
+		template <typename Allocator1>
+		friend std::istream& operator>>(std::istream&, trie_heap<Allocator1>&);
+
+	protected:
+		using node_type    = typename std::allocator_traits<Allocator>::value_type;
+		using index_type   = typename node_type::index_type;
+		using container    = typename trie_heap_container<Allocator>::type;
+		using free_bitmap  = trie_free_bitmap<Allocator>;
+		using link_table   = trie_sibling_table<Allocator>;
+		using label_vector = static_vector<std::uint16_t, 257>;
+
+		static constexpr std::uint16_t null_value = 256u;
+
+		/*! read_image() が一度に読み込むノード数
+		*/
+		static constexpr std::size_t read_image_chunk = 65536;
+
+	public:
+		using label_type         = std::uint8_t;
+		using allocator_type     = Allocator;
+		using serialize_iterator = trie_heap_serialize_iterator<container const>;
+
+	public:
+		/*! @brief コンテナに関連付けられているアロケータを返す
+		
+		@return コンテナに関連付けられているアロケータ
+		*/
+		allocator_type get_allocator() const { return m_c.get_allocator(); }
+
+		/*! @brief 直列化データから割り当てる
+
+		@param [in]
+			first 直列化データの先頭を指すイテレータ
+		@param [in]
+			last 直列化データの終端を指すイテレータ
+
+		直列化データは[ibegin(), iend())から作成された整数値のリストを想定する。
+		整数の型（ビットの大きさ）は指定されず、適切に処理される。
+		[ibegin(), iend())から返される32ビット整数のコンテナでも、ファイルから読み込まれた8ビット整数のコンテナでも構わない。
+
+		@sa
+			ibegin() const\n
+			iend() const
+
+		@par 例
+
+		※trie_heapは単独で構築できないため、サンプルはtrieを使用。
+		@code
+			// 元となるTrieを作成
+			std::vector<std::string> v1{ "a", "ac", "b", "cab", "cd" };
+			auto t1 = trie<char>(v1.begin(), v1.end());
+
+			// 直列化データを作成
+			std::vector<std::int32_t> v2{ t1.ibegin(), t1.iend() };
+
+			// 直列化データから割り当て
+			trie<char> t2;
+			t2.assign(v2.begin(), v2.end());
+		@endcode
+		*/
+		template <typename InputIterator, typename std::enable_if_t<std::is_integral_v<typename std::iterator_traits<InputIterator>::value_type>, std::nullptr_t> = nullptr>
+		void assign(InputIterator first, InputIterator last)
+		{
+			using iterator_category = typename std::iterator_traits<InputIterator>::iterator_category;
+			using value_type        = typename std::iterator_traits<InputIterator>::value_type;
+			using unsigned_type     = std::make_unsigned_t<value_type>;
+
+			std::uint32_t constexpr n = sizeof(index_type) / sizeof(value_type);
+
+			static_assert(sizeof(value_type) <= sizeof(index_type));
+
+			m_c.clear();
+			if constexpr (std::is_same_v<iterator_category, std::random_access_iterator_tag>)
+				m_c.reserve(std::distance(first, last) / 2);
+
+			while (first != last)
+			{
+				std::make_unsigned_t<index_type> base = 0;
+				std::make_unsigned_t<index_type> check = 0;
+
+				if constexpr (n == 1)
+				{
+					base = *first++;
+					check = *first++;
+				}
+				else
+				{
+					for (std::uint32_t j = 0; j < n && first != last; ++j) base = (base << 8) + static_cast<unsigned_type>(*first++);
+					for (std::uint32_t j = 0; j < n && first != last; ++j) check = (check << 8) + static_cast<unsigned_type>(*first++);
+				}
+
+				m_c.push_back(node_type{ static_cast<index_type>(base), static_cast<index_type>(check) });
+			}
+
+			rebuild();
+		}
+
+		/*! @brief 直列化用のイテレータを返す
+
+		@return 直列化データの先頭を示すイテレータ
+
+		@sa assign(InputIterator first, InputIterator last)
+		@sa trie_heap::iend() const
+
+		@sa wordring::serialize_iterator
+
+		このイテレータは逆参照すると32ビット整数値を返すが、 wordring::serialize_iterator を使用してバイト値を返すイテレータに変換できる。
+		一般に、ファイルへ保存する場合にバイトへ直列化する。
+		いずれの場合も、逆参照時に最小限の計算によって値を返すため、軽量である。
+
+		@par バイト直列化イテレータを使用する例
+
+		※trie_heapは単独で構築できないため、サンプルはtrieを使用。
+		@code
+			// 元となるTrieを作成
+			std::vector<std::string> v1{ "a", "ac", "b", "cab", "cd" };
+			auto t1 = trie<char>(v1.begin(), v1.end());
+
+			// バイト直列化イテレータを作成
+			auto it1 = serialize_iterator(t1.ibegin());
+			auto it2 = serialize_iterator(t1.iend());
+
+			// バイト直列化イテレータから構築
+			auto t2 = trie<char>(it1, it2);
+		@endcode
+
+		@par バイト列に保存する例
+
+		※trie_heapは単独で構築できないため、サンプルはtrieを使用。
+		@code
+			// 元となるTrieを作成
+			std::vector<std::string> v1{ "a", "ac", "b", "cab", "cd" };
+			auto t1 = trie<char>(v1.begin(), v1.end());
+
+			// バイト直列化イテレータを作成
+			auto it1 = serialize_iterator(t1.ibegin());
+			auto it2 = serialize_iterator(t1.iend());
+
+			// バイト列に保存
+			auto v2 = std::vector<char>(it1, it2);
+
+			// バイト列から構築
+			auto t2 = trie<char>(v2.begin(), v2.end());
+		@endcode
+		*/
+		serialize_iterator ibegin() const
+		{
+			return serialize_iterator(m_c, 0);
+		}
+
+		/*! @brief 直列化用のイテレータを返す
+
+		@return 直列化データの終端を示すイテレータ
+
+		@sa trie_heap::ibegin() const
+		*/
+		serialize_iterator iend() const
+		{
+			return serialize_iterator(m_c, m_c.size());
+		}
+
+		/*! @brief ノード配列の先頭を指すポインタを返す
+
+		@return ノード配列の先頭を指すポインタ
+
+		ノード配列は、ホストのバイト順のまま連続したメモリーに格納されている。
+		[data(), data() + node_size()) をそのままファイルへ書き出すと、
+		読み取り専用ビュー wordring::basic_trie_view で直接参照できるイメージとなる。
+
+		@sa node_size() const
+		@sa wordring::basic_trie_view
+		*/
+		node_type const* data() const noexcept { return m_c.data(); }
+
+		/*! @brief ノード配列の要素数を返す
+
+		@return ノード配列の要素数（未使用ノードを含む）
+
+		@sa data() const
+		*/
+		std::size_t node_size() const noexcept { return m_c.size(); }
+
+		/*! @brief 子と兄弟のラベルの表を使用するか設定する
+
+		@param [in] enable 使用する場合 true
+
+		ダブル・アレイで子を列挙するには、親のBASEから257個のCHECKを調べる必要がある。
+		表を使用すると、イテレータによる子の列挙、 has_child() 、 relocate() が子の数に比例した時間で動作する。
+		代わりに、ノード一つにつき4バイトを追加で消費する。
+
+		使用を開始する際に、配列全体から表を作る。
+		表は直列化されないため、ストリームから入力した後も設定は引き継がれる。
+
+		@sa trie_sibling_table
+		*/
+		void use_sibling_table(bool enable = true)
+		{
+			m_link.enable(enable);
+			m_link.rebuild(m_c);
+		}
+
+		/*! @brief 子と兄弟のラベルの表を使用している場合、trueを返す
+		*/
+		bool uses_sibling_table() const noexcept { return m_link.enabled(); }
+
+		/*! @brief 配列の形とメモリー使用量を調べる
+
+		@return ノード数、充填率、バイト数、深さ・子の数・末尾の長さのヒストグラム、累積カウンタ
+
+		根から幅優先にすべてのノードを訪れるため、ノード数に比例した時間と作業領域を使う。
+		辞書が遅い原因が、未使用ノードの散らばりか、挿入順か、単に大きさかを見分けるために使う。
+
+		@sa trie_stats
+		*/
+		trie_stats stats() const
+		{
+			trie_stats result{ 0, m_c.size(), 0, 0, 0, 0, 0, {}, {}, {}, m_counters };
+
+			result.m_bytes = m_c.capacity() * sizeof(node_type);
+			result.m_index_bytes = m_free.bytes() + m_link.bytes();
+			if (m_c.size() < 2) return result;
+
+			node_type const* d = m_c.data();
+			index_type const n = limit();
+
+			result.m_size = static_cast<std::size_t>(d->m_base);
+			for (index_type i = 2; i < n; ++i) if ((d + i)->m_check <= 0) ++result.m_free;
+
+			// 幅優先に訪れる
+			struct entry
+			{
+				index_type    m_index;
+				std::uint32_t m_depth;
+				std::uint32_t m_parent; // 親の位置
+				std::uint32_t m_first;  // 最初の子の位置
+				std::uint16_t m_fanout;
+				std::uint32_t m_tail;
+			};
+
+			std::vector<entry> queue(1, entry{ 1, 0, 0, 0, 0, 0 });
+			for (std::size_t i = 0; i < queue.size(); ++i)
+			{
+				queue[i].m_first = static_cast<std::uint32_t>(queue.size());
+
+				index_type idx = queue[i].m_index;
+				index_type base = (d + idx)->m_base;
+				if (base <= 0) continue;
+
+				index_type last = static_cast<index_type>(std::min<std::int64_t>(base + null_value + 1, n));
+				for (index_type j = base; j < last; ++j)
+				{
+					if ((d + j)->m_check != idx) continue;
+					queue.push_back(entry{ j, queue[i].m_depth + 1, static_cast<std::uint32_t>(i), 0, 0, 0 });
+					++queue[i].m_fanout;
+				}
+			}
+
+			result.m_live = queue.size();
+			result.m_fill = 1 < n
+				? static_cast<double>(result.m_live) / (n - 1)
+				: 0;
+
+			// 葉から分岐の無い経路の長さを求める（分岐するノードは0）
+			for (std::size_t i = queue.size(); i-- != 0;)
+			{
+				entry& e = queue[i];
+				if (e.m_fanout == 0) e.m_tail = 1;
+				else if (e.m_fanout == 1 && queue[e.m_first].m_tail != 0) e.m_tail = queue[e.m_first].m_tail + 1;
+			}
+
+			result.m_fanout.assign(null_value + 2, 0);
+			for (std::size_t i = 0; i < queue.size(); ++i)
+			{
+				entry const& e = queue[i];
+
+				if (result.m_depth.size() <= e.m_depth) result.m_depth.resize(e.m_depth + 1, 0);
+				++result.m_depth[e.m_depth];
+				++result.m_fanout[e.m_fanout];
+
+				// 根を除き、分岐するノードの直下から始まる列を数える
+				if (i != 0 && e.m_tail != 0 && (e.m_parent == 0 || queue[e.m_parent].m_tail == 0))
+				{
+					if (result.m_tail.size() <= e.m_tail) result.m_tail.resize(e.m_tail + 1, 0);
+					++result.m_tail[e.m_tail];
+				}
+			}
+
+			while (!result.m_fanout.empty() && result.m_fanout.back() == 0) result.m_fanout.pop_back();
+
+			return result;
+		}
+
+		/*! @brief 累積カウンタを返す
+
+		WORDRING_TRIE_COUNTERS を定義してコンパイルした場合のみ数えられる。
+
+		@sa trie_counters_enabled
+		*/
+		trie_counters const& counters() const noexcept { return m_counters; }
+
+		/*! @brief 累積カウンタを0に戻す
+		*/
+		void reset_counters() noexcept { m_counters = trie_counters(); }
+
+		// 変更 ---------------------------------------------------------------
+
+		/*! @brief すべての要素を削除する
+		
+		ただし、根は削除されない。
+		*/
+		void clear() noexcept
+		{
+			m_c.clear();
+			m_c.insert(m_c.begin(), 2, node_type{ 0, 0 });
+			m_free.reset(limit());
+			m_stale = false;
+			m_link.rebuild(m_c);
+		}
+
+		void swap(trie_heap& other)
+		{
+			m_c.swap(other.m_c);
+			m_free.swap(other.m_free);
+			std::swap(m_stale, other.m_stale);
+			m_link.swap(other.m_link);
+			std::swap(m_counters, other.m_counters);
+		}
+
+		/*! @brief ダブル・アレイを詰め直す
+
+		@return 詰める前後のノード数と、旧INDEXから新INDEXへの対応表
+
+		削除を繰り返すと、未使用ノードが散らばったまま limit() は縮まない。
+		根から幅優先にノードを訪れ、空のダブル・アレイへ先頭から詰めて配置し直す。
+		兄弟は隣接し、浅いノードほど前方に集まる。
+		葉の値（0以下のBASE）はそのまま移される。
+
+		すべてのINDEXが変わるため、イテレータは無効となる。
+		stable_trie の空遷移先INDEXを保存している場合、戻り値の m_remap で付け替える。
+
+		@par 例
+		@code
+			std::vector<std::string> v{ "a", "ac", "b", "cab", "cd" };
+			auto t = stable_trie<char>(v.begin(), v.end());
+
+			// 空遷移先INDEXを得る
+			std::int32_t idx = 0;
+			t.at(t.find(std::string("ac")), idx);
+
+			t.erase(std::string("cab"));
+			t.erase(std::string("cd"));
 
-			// 直列化データを作成
-			std::vector<std::int32_t> v2{ t1.ibegin(), t1.iend() };
+			// 詰め直して、INDEXを付け替える
+			auto r = t.compact();
+			idx = r.m_remap[idx];
 
-			// 直列化データから割り当て
-			trie<char> t2;
-			t2.assign(v2.begin(), v2.end());
+			assert(r.m_after <= r.m_before);
 		@endcode
 		*/
-		template <typename InputIterator, typename std::enable_if_t<std::is_integral_v<typename std::iterator_traits<InputIterator>::value_type>, std::nullptr_t> = nullptr>
-		void assign(InputIterator first, InputIterator last)
+		basic_trie_compact_result<index_type> compact()
 		{
-			using iterator_category = typename std::iterator_traits<InputIterator>::iterator_category;
-			using value_type        = typename std::iterator_traits<InputIterator>::value_type;
-			using unsigned_type     = std::make_unsigned_t<value_type>;
-
-			std::uint32_t constexpr n = sizeof(index_type) / sizeof(value_type);
+			basic_trie_compact_result<index_type> result{ m_c.size(), 0, {} };
+			result.m_remap.assign(m_c.size(), 0);
 
-			static_assert(sizeof(value_type) <= sizeof(index_type));
+			container old(m_c.get_allocator());
+			old.swap(m_c);
+			clear();
 
-			m_c.clear();
-			if constexpr (std::is_same_v<iterator_category, std::random_access_iterator_tag>)
-				m_c.reserve(std::distance(first, last) / 2);
+			node_type const* s = old.data();
+			index_type const n = static_cast<index_type>(old.size());
 
-			while (first != last)
+			if (2 <= n)
 			{
-				std::make_unsigned_t<index_type> base = 0;
-				std::make_unsigned_t<index_type> check = 0;
+				result.m_remap[1] = 1;
 
-				if constexpr (n == 1)
-				{
-					base = *first++;
-					check = *first++;
-				}
-				else
+				std::vector<index_type> queue(1, 1); // 旧INDEXの待ち行列
+				for (std::size_t i = 0; i < queue.size(); ++i)
 				{
-					for (std::uint32_t j = 0; j < n && first != last; ++j) base = (base << 8) + static_cast<unsigned_type>(*first++);
-					for (std::uint32_t j = 0; j < n && first != last; ++j) check = (check << 8) + static_cast<unsigned_type>(*first++);
+					index_type from = queue[i];
+					index_type to = result.m_remap[from];
+					index_type base = (s + from)->m_base;
+
+					if (base <= 0)
+					{
+						(m_c.data() + to)->m_base = base;
+						continue;
+					}
+
+					label_vector labels;
+					index_type last = static_cast<index_type>(std::min<std::int64_t>(base + null_value + 1, n));
+					for (index_type idx = base; idx < last; ++idx) if ((s + idx)->m_check == from) labels.push_back(static_cast<std::uint16_t>(idx - base));
+					if (labels.empty()) continue;
+
+					index_type before = 0;
+					index_type b = locate(labels, before);
+					allocate(b, labels, before);
+
+					node_type* d = m_c.data();
+					(d + to)->m_base = b;
+					for (std::uint16_t label : labels)
+					{
+						(d + b + label)->m_check = to;
+						result.m_remap[base + label] = b + label;
+						queue.push_back(base + label);
+					}
 				}
 
-				m_c.push_back(node_type{ static_cast<index_type>(base), static_cast<index_type>(check) });
+				m_c.front().m_base = s->m_base;
 			}
+
+			// 索引は clear() で作り直され、以降は allocate() が更新している。
+			assert(free_consistent());
+
+			m_link.rebuild(m_c);
+			result.m_after = m_c.size();
+
+			return result;
 		}
 
-		/*! @brief 直列化用のイテレータを返す
+	protected:
+		trie_heap()
+			: m_c(2, { 0, 0 })
+			, m_free()
+			, m_stale(false)
+			, m_link()
+			, m_counters()
+		{
+			m_free.reset(limit());
+		}
 
-		@return 直列化データの先頭を示すイテレータ
+		explicit trie_heap(allocator_type const& alloc)
+			: m_c(2, { 0, 0 }, alloc)
+			, m_free(alloc)
+			, m_stale(false)
+			, m_link(alloc)
+			, m_counters()
+		{
+			m_free.reset(limit());
+		}
 
-		@sa assign(InputIterator first, InputIterator last)
-		@sa trie_heap::iend() const
+		/*! @brief 初期化子リストから構築する
 
-		@sa wordring::serialize_iterator
+		@param [in]
+			il ノード・データの初期化子リスト
+		@param [in]
+			alloc アロケータ
+		*/
+		trie_heap(std::initializer_list<node_type> il, allocator_type const& alloc = allocator_type())
+			: m_c(il, alloc)
+			, m_free(alloc)
+			, m_stale(false)
+			, m_link(alloc)
+			, m_counters()
+		{
+			rebuild();
+		}
 
-		このイテレータは逆参照すると32ビット整数値を返すが、 wordring::serialize_iterator を使用してバイト値を返すイテレータに変換できる。
-		一般に、ファイルへ保存する場合にバイトへ直列化する。
-		いずれの場合も、逆参照時に最小限の計算によって値を返すため、軽量である。
+		index_type limit() const { return static_cast<index_type>(m_c.size()); }
 
-		@par バイト直列化イテレータを使用する例
+		/*! @brief 一括入出力形式でストリームへ出力する
 
-		※trie_heapは単独で構築できないため、サンプルはtrieを使用。
-		@code
-			// 元となるTrieを作成
-			std::vector<std::string> v1{ "a", "ac", "b", "cab", "cd" };
-			auto t1 = trie<char>(v1.begin(), v1.end());
+		@param [out] os         出力先のストリーム
+		@param [in]  label_size ラベルのバイト数
+		@param [in]  flavour    Trieの種類
 
-			// バイト直列化イテレータを作成
-			auto it1 = serialize_iterator(t1.ibegin());
-			auto it2 = serialize_iterator(t1.iend());
+		リトル・エンディアンのホストでは、ノード配列を一度の write() で出力する。
+		ビッグ・エンディアンのホストでは、区切ってバイト順を入れ替えながら出力する。
 
-			// バイト直列化イテレータから構築
-			auto t2 = trie<char>(it1, it2);
-		@endcode
+		@sa trie_image_header
+		*/
+		void write_image(std::ostream& os, std::uint8_t label_size, trie_image_flavour flavour) const
+		{
+			trie_image_header h{ trie_image_header::current_version, label_size, sizeof(index_type), flavour
+				, m_c.size(), trie_image_checksum(m_c.data(), m_c.size()) };
 
-		@par バイト列に保存する例
+			auto head = h.encode();
+			os.write(reinterpret_cast<char const*>(head.data()), head.size());
 
-		※trie_heapは単独で構築できないため、サンプルはtrieを使用。
-		@code
-			// 元となるTrieを作成
-			std::vector<std::string> v1{ "a", "ac", "b", "cab", "cd" };
-			auto t1 = trie<char>(v1.begin(), v1.end());
+			if constexpr (std::endian::native == std::endian::little)
+			{
+				os.write(reinterpret_cast<char const*>(m_c.data()), m_c.size() * sizeof(node_type));
+			}
+			else
+			{
+				std::array<node_type, 4096> buf;
+				for (std::size_t i = 0; i < m_c.size(); i += buf.size())
+				{
+					std::size_t n = std::min(buf.size(), m_c.size() - i);
+					std::transform(m_c.begin() + i, m_c.begin() + i + n, buf.begin(), trie_image_byteswap<node_type>);
+					os.write(reinterpret_cast<char const*>(buf.data()), n * sizeof(node_type));
+				}
+			}
+		}
 
-			// バイト直列化イテレータを作成
-			auto it1 = serialize_iterator(t1.ibegin());
-			auto it2 = serialize_iterator(t1.iend());
+		/*! @brief 一括入出力形式でストリームから入力する
 
-			// バイト列に保存
-			auto v2 = std::vector<char>(it1, it2);
+		@param [in] is         入力元のストリーム
+		@param [in] label_size ラベルのバイト数
+		@param [in] flavour    Trieの種類
 
-			// バイト列から構築
-			auto t2 = trie<char>(v2.begin(), v2.end());
-		@endcode
+		@return 入力に成功した場合 true
+
+		ノード配列を read_image_chunk 個ずつ読み込み、読み込んだ分だけ配列を伸ばす。
+		ヘッダーのノード数を信用して先に確保しないため、壊れたヘッダーが巨大なノード数を示していても、
+		確保する量はストリームに実際に有るデータの量を超えない。
+		マジック、版、ラベルとINDEXのバイト数、種類、チェックサムのいずれかが一致しない場合、
+		あるいはデータが足りない場合、ストリームに failbit を立て、コンテナを変更せずに false を返す。
+
+		@sa trie_image_header
 		*/
-		serialize_iterator ibegin() const
+		bool read_image(std::istream& is, std::uint8_t label_size, trie_image_flavour flavour)
 		{
-			return serialize_iterator(m_c, 0);
-		}
+			std::array<std::uint8_t, trie_image_header::size> head;
+			is.read(reinterpret_cast<char*>(head.data()), head.size());
+
+			trie_image_header h;
+			if (is.gcount() != static_cast<std::streamsize>(head.size())
+				|| !h.decode(head)
+				|| h.m_version != trie_image_header::current_version
+				|| h.m_label_size != label_size
+				|| h.m_index_size != sizeof(index_type)
+				|| h.m_flavour != flavour
+				|| h.m_nodes < 2
+				|| static_cast<std::uint64_t>(std::numeric_limits<index_type>::max()) < h.m_nodes)
+			{
+				is.setstate(std::ios::failbit);
+				return false;
+			}
 
-		/*! @brief 直列化用のイテレータを返す
+			container c(m_c.get_allocator());
+			while (c.size() < h.m_nodes)
+			{
+				std::size_t i = c.size();
+				std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(read_image_chunk, h.m_nodes - i));
 
-		@return 直列化データの終端を示すイテレータ
+				c.resize(i + n, node_type{ 0, 0 });
+				std::streamsize bytes = static_cast<std::streamsize>(n * sizeof(node_type));
+				is.read(reinterpret_cast<char*>(c.data() + i), bytes);
 
-		@sa trie_heap::ibegin() const
+				if (is.gcount() != bytes)
+				{
+					is.setstate(std::ios::failbit);
+					return false;
+				}
+
+				if constexpr (std::endian::native != std::endian::little)
+				{
+					std::transform(c.begin() + i, c.end(), c.begin() + i, trie_image_byteswap<node_type>);
+				}
+			}
+
+			if (trie_image_checksum(c.data(), c.size()) != h.m_checksum)
+			{
+				is.setstate(std::ios::failbit);
+				return false;
+			}
+
+			m_c.swap(c);
+			rebuild();
+
+			return true;
+		}
+
+		/*! イテレータへ渡す子と兄弟のラベルの表を返す
+		- 表を使用しない場合、nullptrを返す。
 		*/
-		serialize_iterator iend() const
+		basic_trie_sibling_links<node_type> const* sibling_links() const noexcept
 		{
-			return serialize_iterator(m_c, static_cast<std::uint32_t>(m_c.size()));
+			return m_link.enabled()
+				? &m_link
+				: nullptr;
 		}
 
-		// 変更 ---------------------------------------------------------------
-
-		/*! @brief すべての要素を削除する
-		
-		ただし、根は削除されない。
+		/*! 未使用ノードのリンクリストから索引を再構築する
+		- 子と兄弟のラベルの表を使用している場合、それも再構築する。
 		*/
-		void clear() noexcept
+		void rebuild() const
 		{
-			m_c.clear();
-			m_c.insert(m_c.begin(), 2, trie_node{ 0, 0 });
+			m_free.reset(limit());
+			m_stale = false;
+			m_link.rebuild(m_c);
+			if (m_c.empty()) return;
+
+			node_type const* d = m_c.data();
+			// 整列していないリンクや範囲外のリンクに達した場合、そこで打ち切る。
+			for (index_type before = 0, i = -d->m_check; before < i && i < limit(); i = -(d + i)->m_check)
+			{
+				m_free.set(i);
+				before = i;
+			}
 		}
 
-		void swap(trie_heap& other) { m_c.swap(other.m_c); }
+		/*! 未使用ノードの索引を無効にする
+		- m_c を直接書き換えた場合に呼び出す。
+		- 索引は、次に未使用ノードを探す時に sync() で再構築される。
+		*/
+		void invalidate() const noexcept { m_stale = true; }
 
-	protected:
-		trie_heap()
-			: m_c(2, { 0, 0 })
+		/*! 索引が無効にされている場合、再構築する
+		- 大きさが同じまま書き換えられた場合も検出するため、大きさではなく invalidate() の記録を見る。
+		- 全体の照合は O(n) であるため、一括で書き換える操作の後に free_consistent() で行う。
+		*/
+		void sync() const
 		{
+			if (m_stale) rebuild();
+			assert(m_free.limit() == limit());
 		}
 
-		explicit trie_heap(allocator_type const& alloc)
-			: m_c(2, { 0, 0 }, alloc)
+		/*! 未使用ノードの索引がリンクリストと一致する場合、trueを返す
+		- リンクリストが INDEX 順に整列し、すべてのノードが索引に記録され、
+		  索引の未使用ノード数がリンクリストの長さと等しいことを調べる。
+		- O(n) であるため、 assert の中でのみ使う。
+		*/
+		bool free_consistent() const
 		{
-		}
+			if (m_free.limit() != limit()) return false;
+			if (m_c.empty()) return true;
 
-		/*! @brief 初期化子リストから構築する
+			node_type const* d = m_c.data();
+			std::size_t n = 0;
+			for (index_type before = 0, i = -d->m_check; i != 0; before = i, i = -(d + i)->m_check)
+			{
+				if (i <= before || limit() <= i || !m_free.test(i)) return false;
+				++n;
+			}
 
-		@param [in]
-			il ノード・データの初期化子リスト
-		@param [in]
-			alloc アロケータ
+			return n == m_free.count();
+		}
+
+		/*! idxの直前の未使用ノードを返す
+		- 直前の未使用ノードが無い場合、リンクリストの先頭として0を返す。
+		- hintが直前の未使用ノードである場合、索引を引かずにそのまま返す。
 		*/
-		trie_heap(std::initializer_list<trie_node> il, allocator_type const& alloc = allocator_type())
-			: m_c(il, alloc)
+		index_type prev_free(index_type idx, index_type hint = 0) const
 		{
-		}
+			assert(0 <= hint && hint < limit());
 
-		index_type limit() const { return static_cast<index_type>(m_c.size()); }
+			if (hint < idx && (hint == 0 || m_free.test(hint)))
+			{
+				index_type i = -(m_c.data() + hint)->m_check;
+				if (i == 0 || idx <= i) return hint;
+			}
 
+			return m_free.prev(idx);
+		}
+
+		/*! 末尾にn個の未使用ノードを加える
+		- BASE + ラベルが INDEX の型で表せるよう、ノード数を INDEX の最大値 - null_value までに制限する。
+		- 制限を超える場合、 std::length_error を投げる。
+		*/
 		void reserve(std::size_t n, index_type before = 0)
 		{
 			assert(0 <= before  && before < limit());
 
+			std::size_t constexpr max_nodes = static_cast<std::size_t>(std::numeric_limits<index_type>::max()) - null_value;
+			if (max_nodes < m_c.size() || max_nodes - m_c.size() < n) throw std::length_error("");
+
+			sync();
+
 			index_type id = static_cast<index_type>(m_c.size()); // reserveする先頭の番号
 			m_c.insert(m_c.end(), n, { 0, 0 });
+			m_free.resize(limit());
+			m_link.resize(limit());
 
 			node_type* d = m_c.data();
-			// 値が0のINDEXを探す
-			for (index_type i = -(d + before)->m_check; i != 0; i = -(d + before)->m_check)
-			{
-				assert(i < limit());
-				before = i;
-			}
+			// 未使用ノードの末尾を探す
+			before = m_free.prev(id);
 			// CHECKを更新する
 			for (index_type last = static_cast<index_type>(m_c.size()); id != last; before = id++)
 			{
 				assert(before < limit());
 				(d + before)->m_check = -id;
+				m_free.set(id);
 			}
 		}
 
@@ -424,16 +1859,16 @@ namespace wordring::detail
 			assert(m_c[idx].m_check <= 0);
 			assert(0 <= before && before < limit());
 
+			sync();
+
 			node_type* d = m_c.data();
 			// CHECKがidxと一致するINDEXを探す
-			for (index_type i = -(d + before)->m_check; i != idx; i = -(d + before)->m_check)
-			{
-				assert(i < limit());
-				before = i;
-			}
+			before = prev_free(idx, before);
+			assert(-(d + before)->m_check == idx);
 			// CHECKを更新する
 			(d + before)->m_check = (d + idx)->m_check;
 			(d + idx)->m_check = 0;
+			m_free.erase(idx);
 		}
 
 		/*! base + labelsを使用可能にする
@@ -445,23 +1880,23 @@ namespace wordring::detail
 			assert(std::is_sorted(labels.begin(), labels.end()));
 			assert(before < limit());
 
+			sync();
+
 			if (limit() <= base + labels.back()) reserve(base + labels.back() + 1 - m_c.size());
 
-			trie_node* d = m_c.data();
+			node_type* d = m_c.data();
 			for (std::uint16_t label : labels)
 			{
 				index_type idx = base + label;
 				assert(idx < limit());
 				if (1 <= (d + idx)->m_check) continue; // 登録済み
 
-				for (index_type i = before; i != idx; i = -(d + before)->m_check)
-				{
-					assert(i < limit());
-					before = i;
-				}
+				before = prev_free(idx, before);
+				assert(-(d + before)->m_check == idx);
 
 				(d + before)->m_check = (d + idx)->m_check;
 				(d + idx)->m_check = 0;
+				m_free.erase(idx);
 			}
 		}
 
@@ -472,18 +1907,27 @@ namespace wordring::detail
 			assert(1 <= parent && parent < limit());
 			assert(1 <= from && from < limit());
 
+			if constexpr (trie_counters_enabled) ++m_counters.m_relocate;
+
 			label_vector children;
 
-			index_type last = std::min(from + null_value, limit() - 1);
-			for (index_type i = from; i <= last; ++i)
+			if (m_link.enabled()) m_link.children(m_c.data(), parent, children);
+			else
 			{
-				assert(i < limit());
-				assert(0 <= i - from);
-				if ((m_c.data() + i)->m_check == parent) children.push_back(i - from);
+				index_type last = std::min(from + null_value, limit() - 1);
+				for (index_type i = from; i <= last; ++i)
+				{
+					assert(i < limit());
+					assert(0 <= i - from);
+					if ((m_c.data() + i)->m_check == parent) children.push_back(i - from);
+				}
 			}
 
+			trie_label_set set(labels);
+			set |= trie_label_set(children);
+
 			label_vector all;
-			std::set_union(labels.begin(), labels.end(), children.begin(), children.end(), std::back_inserter(all));
+			set.labels(all);
 
 			index_type before = 0;
 			index_type to = locate(all, before);
@@ -501,7 +1945,13 @@ namespace wordring::detail
 
 				// 孫のCHECKを置き換え
 				index_type base = (d + idx)->m_base;
-				if (1 <= base)
+				if (1 <= base && m_link.enabled())
+				{
+					label_vector grandchildren;
+					m_link.children(d, idx, grandchildren);
+					for (std::uint16_t i : grandchildren) (d + base + i)->m_check = to + label;
+				}
+				else if (1 <= base)
 				{
 					index_type last = std::min(base + null_value, limit() - 1);
 					for (index_type i = base; i <= last; ++i)
@@ -510,6 +1960,11 @@ namespace wordring::detail
 						if ((d + i)->m_check == idx) (d + i)->m_check = to + label;
 					}
 				}
+
+				// 子の兄弟のリストはラベルでつながるため、そのまま移せる。
+				// 旧INDEXは親から外れたノードとして解放させる。
+				m_link.move(idx, to + label);
+				(d + idx)->m_check = 0;
 			}
 
 			assert(parent < limit());
@@ -528,17 +1983,17 @@ namespace wordring::detail
 			assert(1 < idx && idx < limit());
 			assert(0 <= before && before < limit());
 
+			sync();
+
 			node_type* d = m_c.data();
 
-			for (index_type i = -(d + before)->m_check; i != 0 && i < idx; i = -(d + before)->m_check)
-			{
-				assert(i < limit());
-				before = i;
-			}
+			m_link.unlink(d, idx);
+			before = prev_free(idx, before);
 
 			(d + idx)->m_base = 0;
 			(d + idx)->m_check = (d + before)->m_check;
 			(d + before)->m_check = -idx;
+			m_free.set(idx);
 
 			return before;
 		}
@@ -574,28 +2029,27 @@ namespace wordring::detail
 			assert(!labels.empty());
 			assert(std::is_sorted(labels.begin(), labels.end()));
 
-			index_type base = 0;
-			before = 0;
+			sync();
 
-			std::uint16_t offset = labels.front();
+			if constexpr (trie_counters_enabled) ++m_counters.m_locate;
 
-			trie_node const* d = m_c.data();
-			index_type idx = -d->m_check;
+			std::uint16_t offset = labels.front();
 
-			// BASEが負にならないよう、検索開始位置を設定する。
-			for (; 0 < idx && idx <= offset; idx = -(d + idx)->m_check) before = idx;
+			// BASEが正となる最初の空きノードに、最初のラベルを重ねた位置から検索する。
+			// 空きノードが無い場合、すべてのラベルが新規にreserveされるノードに配置される。
+			index_type idx = m_free.next(offset + 1);
+			index_type base = (idx != 0)
+				? idx - offset
+				: std::max<index_type>(limit() - offset, 1);
 
-			// BASEを正に調整可能な位置に一つでもラべルを配置可能な空きノードがある場合、それに基づき計算する。
-			if (offset < idx)
-			{
-				for(; 0 != idx && !is_free(idx - offset, labels); idx = -(d + idx)->m_check) before = idx;
-				if (idx != 0) base = idx - offset;
-			}
+			std::uint64_t walk = 0;
+			if (idx != 0) base = m_free.find(base, trie_label_set(labels), walk);
+			if constexpr (trie_counters_enabled) m_counters.m_walk += walk;
 
-			// そのような空きノードが無い場合、すべてのラベルが新規にreserveされるノードに配置される。
-			if (base == 0) base = std::max(limit() - offset, 1);
+			before = m_free.prev(base + offset);
 
 			assert(1 <= base);
+			assert(is_free(base, labels));
 			assert(0 <= before && before < base + labels.front());
 
 			return base;
@@ -667,12 +2121,14 @@ namespace wordring::detail
 
 			node_type const* d = m_c.data();
 
+			if (m_link.enabled()) return m_link.first_child(d, parent) != 0;
+
 			index_type base = (d + parent)->m_base;
 			assert(base < limit());
 
 			if (1 <= base)
 			{
-				index_type last = std::min(base + null_value, limit());
+				index_type last = static_cast<index_type>(std::min<std::int64_t>(base + null_value, limit()));
 				assert(1 <= last && last <= limit());
 
 				for (index_type idx = base; 1 <= idx && idx < last; ++idx)
@@ -717,10 +2173,16 @@ namespace wordring::detail
 			index_type parent = (d + idx)->m_check;
 			assert(1 <= parent && parent < limit());
 
+			if (m_link.enabled())
+			{
+				index_type first = m_link.first_child(d, parent);
+				return first != 0 && (first != idx || m_link.next_sibling(d, idx) != 0);
+			}
+
 			index_type base = (d + parent)->m_base;
 			assert(1 <= base && base < limit());
 
-			index_type last = std::min(base + null_value, limit());
+			index_type last = static_cast<index_type>(std::min<std::int64_t>(base + null_value, limit()));
 			assert(1 <= last && last <= limit());
 
 			for (index_type i = base; i < last; ++i)
@@ -744,10 +2206,16 @@ namespace wordring::detail
 
 			node_type const* d = m_c.data();
 
+			if (m_link.enabled())
+			{
+				index_type first = m_link.first_child(d, parent);
+				return first != 0 && (first != idx || m_link.next_sibling(d, idx) != 0);
+			}
+
 			index_type base = (d + parent)->m_base;
 			assert(1 <= base && base < limit());
 
-			index_type last = std::min(base + null_value, limit());
+			index_type last = static_cast<index_type>(std::min<std::int64_t>(base + null_value, limit()));
 			assert(1 <= last && last <= limit());
 
 			for (index_type i = base; i < last; ++i)
@@ -816,20 +2284,143 @@ namespace wordring::detail
 
 			(d + parent)->m_base = base;
 			for (std::uint16_t label : labels) (d + base + label)->m_check = parent;
+			m_link.link(d, parent, labels);
 
 			assert(1 <= base && base < limit());
 
 			return base;
 		}
 
+		/*! @brief otherの部分木をこのヒープへ接ぎ木する
+
+		@param [in] other  部分木を含むヒープ
+		@param [in] offset other のINDEXに加算する値
+		@param [in] roots  other側の部分木の根と、このヒープ側の接ぎ先の組の列
+
+		- other の [2, other.limit()) は、このヒープの [offset + 2, offset + other.limit()) へ移される。
+		- 移す範囲は、呼び出し前に確保されている必要がある。
+		- 部分木の根自身は移されず、接ぎ先がその子を引き継ぐ。
+		- 接ぎ先は子を持たない葉である必要がある。
+		- いずれの部分木にも属さないノードは、未使用ノードとして書き込まれる。
+		- 未使用ノードのリンクリストと索引は更新されないため、すべての接ぎ木の後に relink() を呼び出す必要がある。
+		- 移す範囲と接ぎ先が重ならない限り、異なるスレッドから同時に呼び出せる。
+		*/
+		void graft(trie_heap const& other, index_type offset, std::vector<std::pair<index_type, index_type>> const& roots)
+		{
+			assert(0 <= offset && offset + other.limit() <= limit());
+
+			node_type const* s = other.m_c.data();
+			node_type* d = m_c.data();
+
+			index_type n = other.limit();
+
+			// 移動先のINDEX（0は未定、-1は移さないノード）
+			std::vector<index_type> remap(n, 0);
+			remap[1] = -1;
+			for (auto const& pair : roots)
+			{
+				assert(1 < pair.first && pair.first < n);
+				assert(1 <= pair.second && pair.second < offset + 2);
+				remap[pair.first] = pair.second;
+			}
+
+			// 親をたどって、部分木に属するか決める
+			std::vector<index_type> path;
+			for (index_type i = 2; i < n; ++i)
+			{
+				index_type j = i;
+				while (remap[j] == 0)
+				{
+					index_type check = (s + j)->m_check;
+					if (check < 1)
+					{
+						remap[j] = -1; // 未使用
+						break;
+					}
+					path.push_back(j);
+					j = check;
+				}
+				bool keep = 1 <= remap[j];
+				for (index_type k : path) remap[k] = keep ? offset + k : -1;
+				path.clear();
+			}
+
+			for (index_type i = 2; i < n; ++i)
+			{
+				node_type* p = d + offset + i;
+				if (remap[i] != offset + i) *p = node_type{ 0, 0 };
+				else
+				{
+					index_type base = (s + i)->m_base;
+					p->m_base  = (1 <= base) ? base + offset : base;
+					p->m_check = remap[(s + i)->m_check];
+					assert(1 <= p->m_check);
+				}
+			}
+
+			for (auto const& pair : roots)
+			{
+				assert((d + pair.second)->m_base <= 0);
+
+				index_type base = (s + pair.first)->m_base;
+				(d + pair.second)->m_base = (1 <= base) ? base + offset : base;
+			}
+		}
+
+		/*! @brief 未使用ノードのリンクリストを配列全体から作り直す
+
+		- CHECKが1未満のノードを未使用ノードとして、INDEX順につなげる。
+		- 未使用ノードの索引と、子と兄弟のラベルの表も再構築する。
+		- graft() による構築の後に使う。
+		*/
+		void relink()
+		{
+			node_type* d = m_c.data();
+
+			index_type before = 0;
+			for (index_type i = 2; i < limit(); ++i)
+			{
+				if (1 <= (d + i)->m_check) continue;
+
+				(d + i)->m_base = 0;
+				(d + before)->m_check = -i;
+				before = i;
+			}
+			(d + before)->m_check = 0;
+
+			rebuild();
+			assert(free_consistent());
+		}
+
 	protected:
 		container m_c;
+
+		/*! 未使用ノードの索引
+		- m_c から再構築できるキャッシュであるため、 const メンバからも更新する。
+		*/
+		mutable free_bitmap m_free;
+
+		/*! 未使用ノードの索引が m_c と一致しない可能性がある場合 true
+		- invalidate() で立て、 rebuild() で下ろす。
+		*/
+		mutable bool m_stale;
+
+		/*! 子と兄弟のラベルの表
+		- 使用しない場合、空である。
+		- m_free と同じく、 m_c から再構築できるキャッシュである。
+		*/
+		mutable link_table m_link;
+
+		/*! 累積カウンタ
+		- locate() が const であるため、 const メンバからも更新する。
+		*/
+		mutable trie_counters m_counters;
 	};
 
 	template <typename Allocator1>
 	inline std::ostream& operator<<(std::ostream& os, trie_heap<Allocator1> const& heap)
 	{
-		std::uint64_t n = static_cast<std::uint64_t>(heap.m_c.size()) * sizeof(trie_node);
+		std::uint64_t n = static_cast<std::uint64_t>(heap.m_c.size()) * sizeof(typename trie_heap<Allocator1>::node_type);
 		auto length = serialize(n);
 		auto it1 = length.begin();
 		auto it2 = length.end();
@@ -855,12 +2446,14 @@ namespace wordring::detail
 
 		for (std::uint64_t i = 0; i < n && it1 != it2; ++i)
 		{
-			std::int32_t base, check;
+			typename trie_heap<Allocator1>::index_type base, check;
 			it1 = deserialize(it1, it2, base);
 			it1 = deserialize(it1, it2, check);
 			heap.m_c.push_back({ base, check });
 		}
 
+		heap.rebuild();
+
 		return is;
 	}
 }
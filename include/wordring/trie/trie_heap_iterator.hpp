@@ -17,9 +17,10 @@ namespace wordring::detail
 		using iterator_category = std::input_iterator_tag;
 
 	protected:
-		using index_type = typename trie_node::index_type;
-		using node_type  = trie_node;
+		using node_type  = std::remove_cv_t<typename Container::value_type>;
+		using index_type = typename node_type::index_type;
 		using container  = Container const;
+		using links_type = basic_trie_sibling_links<node_type>;
 
 		static constexpr std::uint16_t null_value = 256;
 
@@ -27,12 +28,16 @@ namespace wordring::detail
 		const_trie_heap_iterator()
 			: m_c(nullptr)
 			, m_index(0)
+			, m_links(nullptr)
 		{
 		}
 
-		const_trie_heap_iterator(container& c, index_type index)
+		/*! links が与えられた場合、子と兄弟の列挙に trie_sibling_table を使う
+		*/
+		const_trie_heap_iterator(container& c, index_type index, links_type const* links = nullptr)
 			: m_c(std::addressof(c))
 			, m_index(index)
+			, m_links(links)
 		{
 		}
 
@@ -65,7 +70,7 @@ namespace wordring::detail
 
 		/*! イテレータを前進させる
 		*/
-		void advance() { m_index = find(m_index + 1, base() + null_value, mother()); }
+		void advance() { m_index = next_sibling(m_index); }
 
 		/*! 親のINDEXを返す
 		- 根で呼び出した場合、0を返す。
@@ -85,14 +90,40 @@ namespace wordring::detail
 		{
 			assert(1 <= m_index);
 
-			index_type idx = (m_c->data() + m_index)->m_base;
-			return (1 <= idx)
-				? find(idx, idx + null_value, m_index)
-				: 0;
+			return first_child(m_index);
 		}
 
 		index_type end_index() const { return 0; }
 
+		/*! parentの最初の子のINDEXを返す
+		- 空遷移は含めない。
+		- 子が無い場合、0を返す。
+		- 表がある場合は表を引き、無い場合はCHECKを走査する。
+		*/
+		index_type first_child(index_type parent) const
+		{
+			if (m_links != nullptr) return m_links->first_child(m_c->data(), parent);
+
+			index_type base = (m_c->data() + parent)->m_base;
+			return (1 <= base)
+				? find(base, base + null_value, parent)
+				: 0;
+		}
+
+		/*! idxの次の兄弟のINDEXを返す
+		- 空遷移は含めない。
+		- 兄弟が無い場合、0を返す。
+		*/
+		index_type next_sibling(index_type idx) const
+		{
+			if (m_links != nullptr) return m_links->next_sibling(m_c->data(), idx);
+
+			node_type const* d = m_c->data();
+			index_type parent = (d + idx)->m_check;
+
+			return find(idx + 1, (d + parent)->m_base + null_value, parent);
+		}
+
 		/*! 引数firstからlastの範囲で、m_checkが引数checkと一致する状態番号を返す
 
 		- 見つからない場合、0を返す。
@@ -160,6 +191,12 @@ namespace wordring::detail
 		{
 			if (m_index == 1) return false;
 
+			if (m_links != nullptr)
+			{
+				index_type first = first_child(mother());
+				return first != 0 && (first != m_index || next_sibling(m_index) != 0);
+			}
+
 			index_type check = (m_c->data() + m_index)->m_check;
 
 			index_type first = base();
@@ -177,7 +214,8 @@ namespace wordring::detail
 		}
 
 	protected:
-		container* m_c;
-		index_type m_index;
+		container*        m_c;
+		index_type        m_index;
+		links_type const* m_links;
 	};
 }
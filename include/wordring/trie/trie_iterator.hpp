@@ -8,6 +8,12 @@ namespace wordring
 {
 	template <typename Label, typename Base>
 	class basic_trie;
+
+	template <typename Label, typename Base>
+	class basic_trie_view;
+
+	template <typename Label, typename Base>
+	class basic_weighted_trie;
 }
 
 namespace wordring::detail
@@ -27,6 +33,15 @@ namespace wordring::detail
 		template <typename Label1, typename Base1>
 		friend class wordring::basic_trie;
 
+		template <typename Label1, typename Base1>
+		friend class wordring::basic_trie_view;
+
+		template <typename Label1, typename Base1>
+		friend class wordring::basic_weighted_trie;
+
+		template <typename Label1, typename Base1>
+		friend class const_trie_leaf_iterator;
+
 		template <typename Label1, typename Base1>
 		friend bool operator==(const_trie_iterator<Label1, Base1> const&, const_trie_iterator<Label1, Base1> const&);
 
@@ -39,6 +54,7 @@ namespace wordring::detail
 		using typename base_type::index_type;
 		using typename base_type::node_type;
 		using typename base_type::container;
+		using typename base_type::links_type;
 
 		using unsigned_type = std::make_unsigned_t<Label>;
 
@@ -65,6 +81,7 @@ namespace wordring::detail
 
 		using base_type::m_c;
 		using base_type::m_index;
+		using base_type::m_links;
 
 	public:
 		const_trie_iterator()
@@ -73,8 +90,8 @@ namespace wordring::detail
 		}
 
 	protected:
-		const_trie_iterator(container& c, index_type index)
-			: base_type(c, index)
+		const_trie_iterator(container& c, index_type index, links_type const* links = nullptr)
+			: base_type(c, index, links)
 		{
 		}
 
@@ -171,7 +188,7 @@ namespace wordring::detail
 				}
 			}
 
-			return const_trie_iterator(*m_c, idx);
+			return const_trie_iterator(*m_c, idx, m_links);
 		}
 
 		const_trie_iterator& operator++()
@@ -187,16 +204,14 @@ namespace wordring::detail
 				// 右、あるいは右上を探す
 				for (index_type i = m_index; lv < coefficient; ++lv)
 				{
-					index_type parent = (d + i)->m_check;
-					index_type base = (d + parent)->m_base;
 					// 右兄弟を探す
-					i = find(i + 1, base + null_value, parent);
-					if (i != 0)
+					index_type sibling = base_type::next_sibling(i);
+					if (sibling != 0)
 					{
-						idx = i;
+						idx = sibling;
 						break;
 					}
-					i = parent;
+					i = (d + i)->m_check;
 				}
 
 				// 足の長さをそろえる
@@ -204,9 +219,7 @@ namespace wordring::detail
 				{
 					for (; 0 < lv; --lv)
 					{
-						index_type parent = idx;
-						index_type base = (d + idx)->m_base;
-						idx = find(base, base + null_value, parent);
+						idx = base_type::first_child(idx);
 						assert(idx != 0);
 					}
 				}
@@ -290,7 +303,7 @@ namespace wordring::detail
 				}
 			}
 
-			return const_trie_iterator(*m_c, idx);
+			return const_trie_iterator(*m_c, idx, m_links);
 		}
 
 		const_trie_iterator begin() const
@@ -302,13 +315,9 @@ namespace wordring::detail
 			{
 				std::uint32_t lv = 0;
 
-				trie_node const* d = m_c->data();
 				while (lv < coefficient && idx != 0)
 				{
-					index_type base = (d + idx)->m_base;
-					idx = (1 <= base)
-						? find(base, base + null_value, idx)
-						: 0;
+					idx = base_type::first_child(idx);
 					++lv;
 				}
 
@@ -317,12 +326,12 @@ namespace wordring::detail
 					: 0;
 			}
 
-			return const_trie_iterator(*m_c, idx);
+			return const_trie_iterator(*m_c, idx, m_links);
 		}
 
 		const_trie_iterator end() const
 		{
-			return const_trie_iterator(*m_c, 0);
+			return const_trie_iterator(*m_c, 0, m_links);
 		}
 	};
 
@@ -0,0 +1,330 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace wordring::detail
+{
+	// ------------------------------------------------------------------------
+	// trie_label_map
+	// ------------------------------------------------------------------------
+
+	/*! @brief ラベルを頻度順の可変長バイト符号へ写像する表
+
+	@tparam Label ラベルとして使用する任意の整数型
+
+	char32_t のラベルを直列化すると1文字が4バイトの遷移となり、その多くは0x00である。
+	この表は出現頻度の高いラベルに短い符号を割り当て、遷移数とノード数を減らす。
+
+	@par 符号
+
+	| 先頭バイト | 符号長 | 符号の数 |
+	| ---- | ---- | ---- |
+	| 0x00-0xBF | 1 | 192 |
+	| 0xC0-0xFE | 2 | 63 × 192 |
+	| 0xFF | 1 + escape_length | 表に無いラベル |
+
+	- 2バイト目以降は常に0xC0未満であるため、符号の末尾から符号の先頭を一意に求められる。
+	- 表に無いラベルは、0xFFに続けてラベルの値を192進数で格納する。
+	- 符号の順序はラベルの順序と一致しない。
+	*/
+	template <typename Label>
+	class trie_label_map
+	{
+	public:
+		using label_type    = Label;
+		using unsigned_type = std::make_unsigned_t<label_type>;
+
+		static constexpr std::uint8_t  lead_value   = 0xC0u; // 2バイト符号の最初の先頭バイト
+		static constexpr std::uint8_t  escape_value = 0xFFu; // 表に無いラベルの先頭バイト
+		static constexpr std::uint32_t radix        = lead_value;
+
+		static constexpr std::uint32_t single_size = lead_value;
+		static constexpr std::uint32_t double_size = (escape_value - lead_value) * radix;
+
+		/*! ラベルの値を192進数で表すために必要な桁数
+		*/
+		static constexpr std::uint32_t escape_length = []()
+		{
+			std::uint32_t n = 0;
+			for (unsigned_type v = ~unsigned_type(0); v != 0; v /= radix) ++n;
+			return n;
+		}();
+
+		static constexpr std::uint32_t max_length = 1 + escape_length;
+
+	public:
+		trie_label_map()
+			: m_labels()
+			, m_ranks()
+		{
+		}
+
+		/*! @brief 文字列リストのラベル頻度から表を構築する
+
+		@param [in] first 文字列リストの先頭を指すイテレータ
+		@param [in] last  文字列リストの終端を指すイテレータ
+
+		頻度の降順、同じ頻度の場合はラベルの昇順に符号を割り当てる。
+		*/
+		template <typename ForwardIterator>
+		void assign(ForwardIterator first, ForwardIterator last)
+		{
+			std::unordered_map<unsigned_type, std::uint64_t> freq;
+			for (; first != last; ++first)
+			{
+				for (auto ch : *first) ++freq[static_cast<unsigned_type>(ch)];
+			}
+
+			std::vector<std::pair<std::uint64_t, unsigned_type>> v;
+			v.reserve(freq.size());
+			for (auto const& pair : freq) v.emplace_back(pair.second, pair.first);
+			std::sort(v.begin(), v.end(), [](auto const& lhs, auto const& rhs)
+			{
+				return lhs.first != rhs.first ? rhs.first < lhs.first : lhs.second < rhs.second;
+			});
+
+			std::vector<label_type> labels;
+			labels.reserve(std::min<std::size_t>(v.size(), single_size + double_size));
+			for (auto const& pair : v)
+			{
+				if (labels.size() == single_size + double_size) break;
+				labels.push_back(static_cast<label_type>(pair.second));
+			}
+
+			assign_labels(labels.begin(), labels.end());
+		}
+
+		/*! @brief 符号順のラベル列から表を構築する
+
+		@param [in] first ラベル列の先頭を指すイテレータ
+		@param [in] last  ラベル列の終端を指すイテレータ
+
+		labels() が返すラベル列から表を復元するために使う。
+		*/
+		template <typename InputIterator>
+		void assign_labels(InputIterator first, InputIterator last)
+		{
+			m_labels.clear();
+			m_ranks.clear();
+
+			for (; first != last && m_labels.size() < single_size + double_size; ++first)
+			{
+				unsigned_type ch = static_cast<unsigned_type>(*first);
+				if (m_ranks.count(ch) != 0) continue;
+
+				m_ranks.emplace(ch, static_cast<std::uint32_t>(m_labels.size()));
+				m_labels.push_back(static_cast<label_type>(ch));
+			}
+		}
+
+		/*! @brief 符号順のラベル列を返す
+		*/
+		std::vector<label_type> const& labels() const noexcept { return m_labels; }
+
+		/*! @brief 表に格納されているラベルの数を返す
+		*/
+		std::size_t size() const noexcept { return m_labels.size(); }
+
+		bool empty() const noexcept { return m_labels.empty(); }
+
+		void clear()
+		{
+			m_labels.clear();
+			m_ranks.clear();
+		}
+
+		void swap(trie_label_map& other)
+		{
+			m_labels.swap(other.m_labels);
+			m_ranks.swap(other.m_ranks);
+		}
+
+		/*! @brief ラベルを符号化する
+
+		@param [in]  label ラベル
+		@param [out] code  符号の出力先（ max_length バイト以上）
+
+		@return 符号のバイト長
+		*/
+		std::uint32_t encode(label_type label, std::uint8_t* code) const
+		{
+			unsigned_type ch = static_cast<unsigned_type>(label);
+
+			auto it = m_ranks.find(ch);
+			if (it != m_ranks.end())
+			{
+				std::uint32_t rank = it->second;
+				if (rank < single_size)
+				{
+					*code = static_cast<std::uint8_t>(rank);
+					return 1;
+				}
+
+				rank -= single_size;
+				*code++ = static_cast<std::uint8_t>(lead_value + rank / radix);
+				*code   = static_cast<std::uint8_t>(rank % radix);
+				return 2;
+			}
+
+			*code = escape_value;
+			for (std::uint32_t i = escape_length; 0 < i; --i)
+			{
+				*(code + i) = static_cast<std::uint8_t>(ch % radix);
+				ch /= radix;
+			}
+
+			return max_length;
+		}
+
+		/*! @brief 符号をラベルへ復号する
+
+		@param [in] code 符号の先頭
+		@param [in] n    符号のバイト長
+
+		@return ラベル
+		*/
+		label_type decode(std::uint8_t const* code, std::uint32_t n) const
+		{
+			assert(n == length(*code));
+
+			if (n == 1) return m_labels[*code];
+			if (n == 2) return m_labels[single_size + (*code - lead_value) * radix + *(code + 1)];
+
+			unsigned_type ch = 0;
+			for (std::uint32_t i = 1; i < n; ++i) ch = static_cast<unsigned_type>(ch * radix + *(code + i));
+
+			return static_cast<label_type>(ch);
+		}
+
+		/*! @brief 先頭バイトから符号のバイト長を返す
+		*/
+		static constexpr std::uint32_t length(std::uint8_t lead)
+		{
+			return (lead < lead_value) ? 1 : (lead == escape_value) ? max_length : 2;
+		}
+
+		/*! @brief 符号の先頭バイトにしか現れない値である場合、trueを返す
+		*/
+		static constexpr bool is_lead(std::uint8_t ch) { return lead_value <= ch; }
+
+	protected:
+		std::vector<label_type>                         m_labels; // 符号順のラベル
+		std::unordered_map<unsigned_type, std::uint32_t> m_ranks;  // ラベルから符号順への索引
+	};
+
+	// ------------------------------------------------------------------------
+	// trie_label_encode_iterator
+	// ------------------------------------------------------------------------
+
+	/*! @brief ラベル列に対するイテレータを符号のバイトを返すイテレータへ変換する
+
+	@tparam InputIterator ラベル列に対する入力イテレータ
+	@tparam Label         trie_label_map のラベル型
+
+	wordring::serialize_iterator と同じく、遷移の途中で止まった場合に備え、
+	offset() で現在のラベルの符号内の位置を返す。
+	*/
+	template <typename InputIterator, typename Label>
+	class trie_label_encode_iterator
+	{
+		template <typename InputIterator1, typename Label1>
+		friend bool operator==(trie_label_encode_iterator<InputIterator1, Label1> const&, trie_label_encode_iterator<InputIterator1, Label1> const&);
+
+		template <typename InputIterator1, typename Label1>
+		friend bool operator!=(trie_label_encode_iterator<InputIterator1, Label1> const&, trie_label_encode_iterator<InputIterator1, Label1> const&);
+
+	public:
+		using iterator_type = InputIterator;
+		using map_type      = trie_label_map<Label>;
+
+		using difference_type   = std::ptrdiff_t;
+		using value_type        = std::uint8_t;
+		using pointer           = value_type*;
+		using reference         = value_type&;
+		using iterator_category = std::input_iterator_tag;
+
+	public:
+		trie_label_encode_iterator()
+			: m_it()
+			, m_map(nullptr)
+			, m_offset(0)
+			, m_length(0)
+			, m_code()
+		{
+		}
+
+		trie_label_encode_iterator(iterator_type it, map_type const& map)
+			: m_it(it)
+			, m_map(std::addressof(map))
+			, m_offset(0)
+			, m_length(0)
+			, m_code()
+		{
+		}
+
+		/*! @brief 元となるイテレータを返す
+		*/
+		iterator_type base() const { return m_it; }
+
+		/*! @brief 現在のラベルの符号内で、既に進めたバイト数を返す
+		*/
+		std::uint32_t offset() const { return m_offset; }
+
+		value_type operator*() const
+		{
+			load();
+			return m_code[m_offset];
+		}
+
+		trie_label_encode_iterator& operator++()
+		{
+			load();
+			if (++m_offset == m_length)
+			{
+				++m_it;
+				m_offset = 0;
+				m_length = 0;
+			}
+			return *this;
+		}
+
+		trie_label_encode_iterator operator++(int)
+		{
+			auto result = *this;
+			operator++();
+			return result;
+		}
+
+	protected:
+		void load() const
+		{
+			if (m_length == 0) m_length = m_map->encode(*m_it, m_code);
+		}
+
+	protected:
+		iterator_type           m_it;
+		map_type const*         m_map;
+		std::uint32_t           m_offset;
+		std::uint32_t mutable   m_length; // キャッシュ
+		std::uint8_t mutable    m_code[map_type::max_length];
+	};
+
+	template <typename InputIterator1, typename Label1>
+	inline bool operator==(trie_label_encode_iterator<InputIterator1, Label1> const& lhs, trie_label_encode_iterator<InputIterator1, Label1> const& rhs)
+	{
+		return !(lhs != rhs);
+	}
+
+	template <typename InputIterator1, typename Label1>
+	inline bool operator!=(trie_label_encode_iterator<InputIterator1, Label1> const& lhs, trie_label_encode_iterator<InputIterator1, Label1> const& rhs)
+	{
+		return lhs.m_it != rhs.m_it || lhs.m_offset != rhs.m_offset;
+	}
+}
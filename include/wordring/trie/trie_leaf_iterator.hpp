@@ -0,0 +1,197 @@
+﻿#pragma once
+
+#include <wordring/trie/trie_iterator.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+
+namespace wordring::detail
+{
+	/*! @brief basic_trie の葉だけを辞書順に巡るイテレータ
+
+	@tparam Label ラベルとして使用する任意の整数型
+	@tparam Base  元となる trie_base::const_iterator あるいは stable_trie_base::const_iterator
+
+	終端を持つノード（葉）だけを、直列化したバイト列の辞書順に指す。
+	これは Label を符号無し整数と見做した辞書順と一致する。
+	wordring::basic_tree_iterator と異なり、作業領域を持たず、ダブル・アレイを直接たどって次の葉へ進む。
+
+	前進では、子があれば最も左の葉へ降り、無ければ右の兄弟を持つ祖先まで昇る。
+	各枝を降りる時と昇る時に一度ずつ通るため、範囲の走査にかかる時間は出力の大きさに比例する。
+	兄弟の列挙は const_trie_heap_iterator と同じく、兄弟表がある場合は表を引き、無い場合はCHECKを走査する。
+
+	逆参照すると葉を指す const_trie_iterator を返すため、 basic_trie::at() や parent() と組み合わせて使える。
+
+	@sa wordring::basic_trie::lower_bound()
+	@sa wordring::basic_trie::upper_bound()
+	*/
+	template <typename Label, typename Base>
+	class const_trie_leaf_iterator : protected Base
+	{
+		template <typename Label1, typename Base1>
+		friend class wordring::basic_trie;
+
+		template <typename Label1, typename Base1>
+		friend bool operator==(const_trie_leaf_iterator<Label1, Base1> const&, const_trie_leaf_iterator<Label1, Base1> const&);
+
+		template <typename Label1, typename Base1>
+		friend bool operator!=(const_trie_leaf_iterator<Label1, Base1> const&, const_trie_leaf_iterator<Label1, Base1> const&);
+
+	protected:
+		using base_type = Base;
+
+		using typename base_type::index_type;
+		using typename base_type::node_type;
+		using typename base_type::container;
+		using typename base_type::links_type;
+
+		using base_type::first_child;
+		using base_type::next_sibling;
+
+		using base_type::m_c;
+		using base_type::m_index;
+		using base_type::m_links;
+
+	public:
+		using difference_type   = std::ptrdiff_t;
+		using value_type        = const_trie_iterator<Label, Base>;
+		using pointer           = value_type*;
+		using reference         = value_type;
+		using iterator_category = std::input_iterator_tag;
+
+		static constexpr std::uint16_t null_value = 256u;
+
+	public:
+		const_trie_leaf_iterator()
+			: base_type()
+		{
+		}
+
+	protected:
+		const_trie_leaf_iterator(container& c, index_type index, links_type const* links = nullptr)
+			: base_type(c, index, links)
+		{
+		}
+
+	public:
+		/*! @brief 葉を指すノードのイテレータを返す
+		*/
+		value_type operator*() const
+		{
+			assert(m_index != 0);
+
+			return value_type(static_cast<base_type const&>(*this));
+		}
+
+		/*! @brief 葉に格納されている値を返す
+		*/
+		std::uint32_t value() const
+		{
+			assert(1 < m_index && is_tail(m_index));
+
+			node_type const* d = m_c->data();
+			index_type base = (d + m_index)->m_base;
+
+			return static_cast<std::uint32_t>((base <= 0) ? -base : -(d + base + null_value)->m_base);
+		}
+
+		/*! @brief 根から葉までのラベル列を返す
+
+		@param [out] result ラベル列を出力する先のコンテナ
+
+		@sa const_trie_iterator::string()
+		*/
+		template <typename String>
+		void string(String& result) const
+		{
+			operator*().string(result);
+		}
+
+		const_trie_leaf_iterator& operator++()
+		{
+			assert(m_index != 0);
+
+			index_type idx = first_child(m_index);
+			m_index = (idx != 0) ? leftmost(idx) : next(m_index);
+
+			return *this;
+		}
+
+		const_trie_leaf_iterator operator++(int)
+		{
+			auto result = *this;
+			operator++();
+			return result;
+		}
+
+	protected:
+		/*! idxを根とする部分木で、辞書順の最初の葉のINDEXを返す
+		- 葉が無い場合、0を返す。
+		*/
+		index_type leftmost(index_type idx) const
+		{
+			while (idx != 0 && !is_tail(idx)) idx = first_child(idx);
+
+			return idx;
+		}
+
+		/*! idxが葉の場合、trueを返す
+		- 子が無いか、空遷移を持つノードを葉とする。
+		*/
+		bool is_tail(index_type idx) const
+		{
+			assert(1 <= idx && idx < base_type::limit());
+
+			node_type const* d = m_c->data();
+			index_type base = (d + idx)->m_base;
+
+			return (base <= 0 && idx != 1)
+				|| (1 <= base && base + null_value < base_type::limit() && (d + base + null_value)->m_check == idx);
+		}
+
+		/*! idxの部分木より後ろにある最初の葉のINDEXを返す
+		- 右の兄弟を持つ祖先まで昇り、その兄弟から最も左の葉へ降りる。
+		- 葉が無い場合、0を返す。
+		*/
+		index_type next(index_type idx) const
+		{
+			node_type const* d = m_c->data();
+
+			for (; 1 < idx; idx = (d + idx)->m_check)
+			{
+				index_type sibling = next_sibling(idx);
+				if (sibling != 0) return leftmost(sibling);
+			}
+
+			return 0;
+		}
+
+		/*! parentの子のうち、ラベルがlabelより大きい最初の子から後ろにある最初の葉のINDEXを返す
+		- 空遷移は含めない。
+		*/
+		index_type next(index_type parent, std::uint16_t label) const
+		{
+			node_type const* d = m_c->data();
+			index_type base = (d + parent)->m_base;
+
+			index_type idx = (1 <= base)
+				? base_type::find(base + label + 1, base + null_value, parent)
+				: 0;
+
+			return (idx != 0) ? leftmost(idx) : next(parent);
+		}
+	};
+
+	template <typename Label1, typename Base1>
+	inline bool operator==(const_trie_leaf_iterator<Label1, Base1> const& lhs, const_trie_leaf_iterator<Label1, Base1> const& rhs)
+	{
+		return lhs.m_index == rhs.m_index;
+	}
+
+	template <typename Label1, typename Base1>
+	inline bool operator!=(const_trie_leaf_iterator<Label1, Base1> const& lhs, const_trie_leaf_iterator<Label1, Base1> const& rhs)
+	{
+		return !(lhs == rhs);
+	}
+}
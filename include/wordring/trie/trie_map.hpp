@@ -0,0 +1,697 @@
+﻿#pragma once
+
+#include <wordring/serialize/serialize.hpp>
+#include <wordring/trie/trie.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace wordring
+{
+	template <typename Label, typename T, typename Base>
+	class basic_trie_map;
+}
+
+namespace wordring::detail
+{
+	// ------------------------------------------------------------------------
+	// trie_map_iterator
+	// ------------------------------------------------------------------------
+
+	/*! @brief basic_trie_map の要素を辞書順に走査するイテレータ
+
+	@tparam Map basic_trie_map あるいは basic_trie_map const
+
+	キー文字列の終端となるノードを前順で訪問する。
+	参照先はキー文字列と値の組 std::pair<key_type const&, mapped_type&> である。
+	キー文字列は参照の度にノードから復元するため、参照は次の参照まで有効である。
+	*/
+	template <typename Map>
+	class trie_map_iterator
+	{
+		template <typename Label1, typename T1, typename Base1>
+		friend class wordring::basic_trie_map;
+
+		template <typename Map1>
+		friend class trie_map_iterator;
+
+		template <typename Map1>
+		friend bool operator==(trie_map_iterator<Map1> const&, trie_map_iterator<Map1> const&);
+
+		template <typename Map1>
+		friend bool operator!=(trie_map_iterator<Map1> const&, trie_map_iterator<Map1> const&);
+
+	protected:
+		using map_type      = std::remove_const_t<Map>;
+		using node_iterator = typename map_type::node_iterator;
+
+	public:
+		using key_type    = typename map_type::key_type;
+		using mapped_type = std::conditional_t<std::is_const_v<Map>, typename map_type::mapped_type const, typename map_type::mapped_type>;
+
+		using difference_type   = std::ptrdiff_t;
+		using value_type        = std::pair<key_type const&, mapped_type&>;
+		using pointer           = void;
+		using reference         = value_type;
+		using iterator_category = std::input_iterator_tag;
+
+	public:
+		trie_map_iterator()
+			: m_map(nullptr)
+			, m_node()
+			, m_key()
+		{
+		}
+
+		/*! @brief 変更可能なイテレータから変換する
+		*/
+		template <typename Map1, typename std::enable_if_t<std::is_same_v<Map1 const, Map> && !std::is_same_v<Map1, Map>, std::nullptr_t> = nullptr>
+		trie_map_iterator(trie_map_iterator<Map1> const& other)
+			: m_map(other.m_map)
+			, m_node(other.m_node)
+			, m_key()
+		{
+		}
+
+	protected:
+		trie_map_iterator(Map& map, node_iterator node)
+			: m_map(std::addressof(map))
+			, m_node(node)
+			, m_key()
+		{
+		}
+
+	public:
+		value_type operator*() const
+		{
+			m_node.string(m_key);
+			return value_type(m_key, m_map->slot(m_node));
+		}
+
+		trie_map_iterator& operator++()
+		{
+			m_node = m_map->next_terminal(m_node);
+			return *this;
+		}
+
+		trie_map_iterator operator++(int)
+		{
+			auto result = *this;
+			operator++();
+			return result;
+		}
+
+		/*! @brief キー文字列の終端を指すノード・イテレータを返す
+
+		basic_trie_map::trie() と組み合わせて、ノード単位の探索に用いる。
+		*/
+		node_iterator node() const { return m_node; }
+
+	protected:
+		Map*             m_map;
+		node_iterator    m_node;
+		mutable key_type m_key;
+	};
+
+	template <typename Map1>
+	inline bool operator==(trie_map_iterator<Map1> const& lhs, trie_map_iterator<Map1> const& rhs)
+	{
+		return lhs.m_node == rhs.m_node;
+	}
+
+	template <typename Map1>
+	inline bool operator!=(trie_map_iterator<Map1> const& lhs, trie_map_iterator<Map1> const& rhs)
+	{
+		return !(lhs == rhs);
+	}
+
+	// ------------------------------------------------------------------------
+	// trie_map_value_io
+	// ------------------------------------------------------------------------
+
+	/*! @brief basic_trie_map の値を直列化する
+
+	- 整数型は serialize() と同じビッグ・エンディアンで出力する。
+	- 整数型の要素を持つコンテナ（ std::basic_string 、 std::vector 等）は、
+	  要素数を4バイトで出力し、続けて各要素を出力する。
+	- それ以外のトリビアルにコピー可能な型は、メモリー表現をそのまま出力する。
+	  この形式はエンディアンとパディングに依存する。
+	*/
+	template <typename T, typename = void>
+	struct trie_map_value_io
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		static void write(std::ostream& os, T const& value)
+		{
+			os.write(reinterpret_cast<char const*>(std::addressof(value)), sizeof(T));
+		}
+
+		template <typename InputIterator>
+		static InputIterator read(InputIterator first, InputIterator last, T& value)
+		{
+			char* p = reinterpret_cast<char*>(std::addressof(value));
+			for (std::size_t i = 0; i < sizeof(T) && first != last; ++i) *p++ = *first++;
+			return first;
+		}
+	};
+
+	template <typename T>
+	struct trie_map_value_io<T, std::enable_if_t<std::is_integral_v<T>>>
+	{
+		static void write(std::ostream& os, T value)
+		{
+			for (auto ch : serialize(value)) os.put(ch);
+		}
+
+		template <typename InputIterator>
+		static InputIterator read(InputIterator first, InputIterator last, T& value)
+		{
+			return deserialize(first, last, value);
+		}
+	};
+
+	template <typename T>
+	struct trie_map_value_io<T, std::enable_if_t<std::is_integral_v<typename T::value_type>>>
+	{
+		using element_io = trie_map_value_io<typename T::value_type>;
+
+		static void write(std::ostream& os, T const& value)
+		{
+			trie_map_value_io<std::uint32_t>::write(os, static_cast<std::uint32_t>(value.size()));
+			for (auto const& e : value) element_io::write(os, e);
+		}
+
+		template <typename InputIterator>
+		static InputIterator read(InputIterator first, InputIterator last, T& value)
+		{
+			std::uint32_t n = 0;
+			first = deserialize(first, last, n);
+
+			value.clear();
+			for (std::uint32_t i = 0; i < n && first != last; ++i)
+			{
+				typename T::value_type e{};
+				first = element_io::read(first, last, e);
+				value.push_back(e);
+			}
+
+			return first;
+		}
+	};
+}
+
+namespace wordring
+{
+	// ------------------------------------------------------------------------
+	// basic_trie_map
+	// ------------------------------------------------------------------------
+
+	/*! @class basic_trie_map trie_map.hpp wordring/trie/trie_map.hpp
+
+	@brief キー文字列に任意の型の値を対応付ける連想コンテナ
+
+	@tparam Label ラベルとして使用する任意の整数型
+	@tparam T     値の型
+	@tparam Base  基本クラスとして使用するTrie実装クラス
+
+	basic_trie の葉には31ビットの整数しか格納できない。
+	このクラスは値を連続したメモリー上の配列に格納し、葉にはその配列の添字（スロット）を格納する。
+	値の配列はダブル・アレイとは独立しているため、挿入によってノードが移動しても値は移動しない。
+
+	erase() で空いたスロットは再利用のため記録され、次の挿入に使われる。
+	空いたスロットには T() を代入して資源を解放するため、 erase() には T がデフォルト構築可能である必要がある。
+
+	ストリーム入出力は、値の配列と空きスロットに続けてダブル・アレイを出力する。
+	値の形式は detail::trie_map_value_io に従う。
+
+	@par 例
+	@code
+		auto m = trie_map<char, std::string>();
+		m.emplace(std::string("apple"), "りんご");
+		m[std::string("orange")] = "みかん";
+
+		assert(m.at(std::string("apple")) == "りんご");
+
+		for (auto [key, value] : m) std::cout << key << ": " << value << std::endl;
+	@endcode
+
+	@sa basic_trie
+	*/
+	template <typename Label, typename T, typename Base>
+	class basic_trie_map : protected basic_trie<Label, Base>
+	{
+		template <typename Map>
+		friend class detail::trie_map_iterator;
+
+		template <typename Label1, typename T1, typename Base1>
+		friend std::ostream& operator<<(std::ostream&, basic_trie_map<Label1, T1, Base1> const&);
+
+		template <typename Label1, typename T1, typename Base1>
+		friend std::istream& operator>>(std::istream&, basic_trie_map<Label1, T1, Base1>&);
+
+	protected:
+		using base_type = basic_trie<Label, Base>;
+
+		using typename base_type::index_type;
+
+		using value_container = std::vector<T, typename std::allocator_traits<typename Base::allocator_type>::template rebind_alloc<T>>;
+		using slot_container  = std::vector<std::uint32_t, typename std::allocator_traits<typename Base::allocator_type>::template rebind_alloc<std::uint32_t>>;
+
+	public:
+		using label_type      = Label;
+		using key_type        = std::basic_string<Label>;
+		using mapped_type     = T;
+		using value_type      = std::pair<key_type const&, mapped_type&>;
+		using size_type       = typename base_type::size_type;
+		using allocator_type  = typename base_type::allocator_type;
+		using reference       = mapped_type&;
+		using const_reference = mapped_type const&;
+		using node_iterator   = typename base_type::const_iterator;
+		using iterator        = detail::trie_map_iterator<basic_trie_map>;
+		using const_iterator  = detail::trie_map_iterator<basic_trie_map const>;
+
+	public:
+		using base_type::get_allocator;
+		using base_type::size;
+		using base_type::empty;
+		using base_type::max_size;
+		using base_type::contains;
+
+	public:
+		/*! @brief 空のコンテナを構築する
+		*/
+		basic_trie_map()
+			: base_type()
+			, m_values()
+			, m_free()
+		{
+		}
+
+		/*! @brief アロケータを指定して空のコンテナを構築する
+
+		@param [in] alloc アロケータ
+		*/
+		explicit basic_trie_map(allocator_type const& alloc)
+			: base_type(alloc)
+			, m_values(alloc)
+			, m_free(alloc)
+		{
+		}
+
+		/*! @brief キー文字列と値の組のリストから構築する
+
+		@param [in] first 組のリストの先頭を指すイテレータ
+		@param [in] last  組のリストの終端を指すイテレータ
+		@param [in] alloc アロケータ
+
+		同じキー文字列が複数ある場合、最初の組が採用される。
+		*/
+		template <typename InputIterator>
+		basic_trie_map(InputIterator first, InputIterator last, allocator_type const& alloc = allocator_type())
+			: base_type(alloc)
+			, m_values(alloc)
+			, m_free(alloc)
+		{
+			insert(first, last);
+		}
+
+		basic_trie_map(std::initializer_list<std::pair<key_type const, mapped_type>> il, allocator_type const& alloc = allocator_type())
+			: basic_trie_map(il.begin(), il.end(), alloc)
+		{
+		}
+
+		// 要素アクセス --------------------------------------------------------
+
+		/*! @brief 値への参照を返す
+
+		@throw std::out_of_range キー文字列が格納されていない場合
+		*/
+		template <typename Key>
+		reference at(Key const& key)
+		{
+			node_iterator it = base_type::find(key);
+			if (it == base_type::cend()) throw std::out_of_range("");
+
+			return slot(it);
+		}
+
+		template <typename Key>
+		const_reference at(Key const& key) const
+		{
+			return const_cast<basic_trie_map*>(this)->at(key);
+		}
+
+		/*! @brief 値への参照を返す
+
+		キー文字列が格納されていない場合、 T() を値として挿入し、その参照を返す。
+		*/
+		template <typename Key>
+		reference operator[](Key const& key)
+		{
+			return (*emplace(key).first).second;
+		}
+
+		/*! @brief 値を格納する配列の先頭を指すポインタを返す
+
+		配列には空きスロットも含まれる。
+		*/
+		mapped_type const* data() const noexcept { return m_values.data(); }
+
+		/*! @brief ノード単位の探索に用いる、内部の basic_trie への参照を返す
+
+		葉の値はスロットの添字である。
+		*/
+		base_type const& trie() const noexcept { return *this; }
+
+		// イテレータ ----------------------------------------------------------
+
+		iterator begin() noexcept { return iterator(*this, first_terminal()); }
+
+		const_iterator begin() const noexcept { return const_iterator(*this, first_terminal()); }
+
+		const_iterator cbegin() const noexcept { return begin(); }
+
+		iterator end() noexcept { return iterator(*this, base_type::cend()); }
+
+		const_iterator end() const noexcept { return const_iterator(*this, base_type::cend()); }
+
+		const_iterator cend() const noexcept { return end(); }
+
+		// 容量 ---------------------------------------------------------------
+
+		/*! @brief 値の配列が保持するスロット数を返す
+
+		空きスロットを含む。
+		*/
+		size_type capacity() const noexcept { return m_values.size(); }
+
+		// 変更 ---------------------------------------------------------------
+
+		/*! @brief すべての要素を削除する
+		*/
+		void clear() noexcept
+		{
+			base_type::clear();
+			m_values.clear();
+			m_free.clear();
+		}
+
+		/*! @brief キー文字列が格納されていない場合、値を構築して挿入する
+
+		@param [in] key  キー文字列
+		@param [in] args 値のコンストラクタへ渡す引数
+
+		@return 要素を指すイテレータと、挿入した場合 true の組
+
+		キー文字列が既に格納されている場合、値は構築されない。
+		空文字列は格納できず、 end() と false の組を返す。
+		*/
+		template <typename Key, typename... Args>
+		std::pair<iterator, bool> emplace(Key const& key, Args&&... args)
+		{
+			node_iterator it = base_type::find(key);
+			if (it != base_type::cend()) return { iterator(*this, it), false };
+			if (std::begin(key) == std::end(key)) return { end(), false };
+
+			std::uint32_t idx = acquire(std::forward<Args>(args)...);
+			try
+			{
+				it = base_type::insert(key, idx);
+			}
+			catch (...)
+			{
+				release(idx);
+				throw;
+			}
+
+			return { iterator(*this, it), true };
+		}
+
+		/*! @brief キー文字列と値の組を挿入する
+
+		@sa emplace()
+		*/
+		template <typename Pair>
+		std::pair<iterator, bool> insert(Pair const& value)
+		{
+			return emplace(value.first, value.second);
+		}
+
+		template <typename InputIterator>
+		void insert(InputIterator first, InputIterator last)
+		{
+			while (first != last) insert(*first++);
+		}
+
+		/*! @brief キー文字列を挿入し、あるいは既存の値に代入する
+
+		@return 要素を指すイテレータと、挿入した場合 true の組
+		*/
+		template <typename Key, typename M>
+		std::pair<iterator, bool> insert_or_assign(Key const& key, M&& value)
+		{
+			auto result = emplace(key, std::forward<M>(value));
+			if (!result.second && result.first != end()) slot(result.first.m_node) = std::forward<M>(value);
+
+			return result;
+		}
+
+		/*! @brief 要素を削除する
+
+		@param [in] pos 削除する要素を指すイテレータ
+
+		@return 削除した要素の次の要素を指すイテレータ
+
+		値のスロットは空きとして記録され、次の挿入で再利用される。
+		*/
+		iterator erase(const_iterator pos)
+		{
+			node_iterator it = pos.m_node;
+
+			// 削除によって後続のノードが移動することは無いが、経路上のノードは解放される。
+			// 次の要素を先に求め、そのキー文字列で探し直す。
+			node_iterator next = next_terminal(it);
+			key_type key;
+			if (next != base_type::cend()) next.string(key);
+
+			std::uint32_t idx = static_cast<std::uint32_t>(base_type::at(it));
+			base_type::erase(it);
+			release(idx);
+
+			return iterator(*this, key.empty() ? base_type::cend() : base_type::find(key));
+		}
+
+		iterator erase(iterator pos)
+		{
+			return erase(const_iterator(pos));
+		}
+
+		/*! @brief キー文字列を削除する
+
+		@return 削除した要素の数
+		*/
+		template <typename Key>
+		size_type erase(Key const& key)
+		{
+			node_iterator it = base_type::find(key);
+			if (it == base_type::cend()) return 0;
+
+			std::uint32_t idx = static_cast<std::uint32_t>(base_type::at(it));
+			base_type::erase(it);
+			release(idx);
+
+			return 1;
+		}
+
+		void swap(basic_trie_map& other)
+		{
+			base_type::swap(other);
+			m_values.swap(other.m_values);
+			m_free.swap(other.m_free);
+		}
+
+		// 検索 ---------------------------------------------------------------
+
+		template <typename Key>
+		iterator find(Key const& key)
+		{
+			return iterator(*this, base_type::find(key));
+		}
+
+		template <typename Key>
+		const_iterator find(Key const& key) const
+		{
+			return const_iterator(*this, base_type::find(key));
+		}
+
+		template <typename Key>
+		size_type count(Key const& key) const
+		{
+			return contains(key) ? 1 : 0;
+		}
+
+	protected:
+		/*! 終端ノードに対応する値を返す
+		*/
+		mapped_type& slot(node_iterator pos)
+		{
+			std::uint32_t idx = static_cast<std::uint32_t>(base_type::at(pos));
+			assert(idx < m_values.size());
+
+			return m_values[idx];
+		}
+
+		mapped_type const& slot(node_iterator pos) const
+		{
+			return const_cast<basic_trie_map*>(this)->slot(pos);
+		}
+
+		/*! 空きスロットに値を構築し、その添字を返す
+		*/
+		template <typename... Args>
+		std::uint32_t acquire(Args&&... args)
+		{
+			if (m_free.empty())
+			{
+				m_values.emplace_back(std::forward<Args>(args)...);
+				return static_cast<std::uint32_t>(m_values.size() - 1);
+			}
+
+			std::uint32_t idx = m_free.back();
+			m_values[idx] = mapped_type(std::forward<Args>(args)...);
+			m_free.pop_back();
+
+			return idx;
+		}
+
+		/*! スロットを空きとして記録する
+		*/
+		void release(std::uint32_t idx)
+		{
+			m_values[idx] = mapped_type();
+			m_free.push_back(idx);
+		}
+
+		/*! 前順で最初の終端ノードを返す
+		*/
+		node_iterator first_terminal() const
+		{
+			node_iterator it = base_type::cbegin();
+			return it ? it : next_terminal(it);
+		}
+
+		/*! pos の後に前順で現れる最初の終端ノードを返す
+		- 無い場合、 cend() を返す。
+		*/
+		node_iterator next_terminal(node_iterator pos) const
+		{
+			node_iterator root = base_type::cbegin();
+			node_iterator last = base_type::cend();
+
+			while (pos != last)
+			{
+				node_iterator child = pos.begin();
+				if (child != last) pos = child;
+				else
+				{
+					// 右兄弟、あるいは祖先の右兄弟へ移る
+					while (pos != root)
+					{
+						node_iterator sibling = pos;
+						++sibling;
+						if (sibling != last)
+						{
+							pos = sibling;
+							break;
+						}
+						pos = pos.parent();
+					}
+					if (pos == root) return last;
+				}
+
+				if (pos) return pos;
+			}
+
+			return last;
+		}
+
+	protected:
+		value_container m_values;
+		slot_container  m_free;
+	};
+
+	/*! @brief ストリームへ出力する
+
+	値の配列、空きスロット、ダブル・アレイの順に出力する。
+	ダブル・アレイの入力はストリームの終端まで読むため、最後に置く。
+	*/
+	template <typename Label1, typename T1, typename Base1>
+	inline std::ostream& operator<<(std::ostream& os, basic_trie_map<Label1, T1, Base1> const& map)
+	{
+		using value_io = detail::trie_map_value_io<T1>;
+		using size_io  = detail::trie_map_value_io<std::uint32_t>;
+
+		size_io::write(os, static_cast<std::uint32_t>(map.m_values.size()));
+		for (T1 const& value : map.m_values) value_io::write(os, value);
+
+		size_io::write(os, static_cast<std::uint32_t>(map.m_free.size()));
+		for (std::uint32_t idx : map.m_free) size_io::write(os, idx);
+
+		typename basic_trie_map<Label1, T1, Base1>::base_type const& base = map;
+		return os << base;
+	}
+
+	/*! @brief ストリームから入力する
+	*/
+	template <typename Label1, typename T1, typename Base1>
+	inline std::istream& operator>>(std::istream& is, basic_trie_map<Label1, T1, Base1>& map)
+	{
+		using value_io = detail::trie_map_value_io<T1>;
+
+		map.m_values.clear();
+		map.m_free.clear();
+
+		auto it1 = std::istreambuf_iterator<char>(is);
+		auto it2 = std::istreambuf_iterator<char>();
+
+		std::uint32_t n = 0;
+		it1 = deserialize(it1, it2, n);
+		for (std::uint32_t i = 0; i < n && it1 != it2; ++i)
+		{
+			T1 value{};
+			it1 = value_io::read(it1, it2, value);
+			map.m_values.push_back(std::move(value));
+		}
+
+		it1 = deserialize(it1, it2, n);
+		for (std::uint32_t i = 0; i < n && it1 != it2; ++i)
+		{
+			std::uint32_t idx = 0;
+			it1 = deserialize(it1, it2, idx);
+			map.m_free.push_back(idx);
+		}
+
+		typename basic_trie_map<Label1, T1, Base1>::base_type& base = map;
+		return is >> base;
+	}
+
+	/*! @brief メモリー使用量削減を目標とする、任意の型の値を持つTrie
+	*/
+	template <typename Label, typename T, typename Allocator = std::allocator<detail::trie_node>>
+	using trie_map = basic_trie_map<Label, T, detail::trie_base<Allocator>>;
+
+	/*! @brief 葉からの空遷移先INDEXが衝突によって変更されない、任意の型の値を持つTrie
+	*/
+	template <typename Label, typename T, typename Allocator = std::allocator<detail::trie_node>>
+	using stable_trie_map = basic_trie_map<Label, T, detail::stable_trie_base<Allocator>>;
+}
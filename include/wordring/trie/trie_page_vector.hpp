@@ -0,0 +1,387 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace wordring::detail
+{
+	// ------------------------------------------------------------------------
+	// trie_page_allocator
+	// ------------------------------------------------------------------------
+
+	/*! @brief ノード配列をページ単位で確保するよう trie_heap に指示するアロケータ
+
+	@tparam T         割り当てる型
+	@tparam HugePages ノード配列に透過的ヒュージページを使う場合 true
+
+	このアロケータをノード型で trie_heap へ渡すと、ノード配列が std::vector から trie_page_vector に替わる。
+	ノード配列以外（未使用ノードの索引など）へ再束縛した場合、 std::allocator と同じく動作する。
+
+	@code
+		using big_trie = wordring::trie<char32_t, wordring::detail::trie_page_allocator<wordring::detail::trie_node>>;
+	@endcode
+
+	@sa trie_page_vector
+	*/
+	template <typename T, bool HugePages = true>
+	class trie_page_allocator : public std::allocator<T>
+	{
+	public:
+		using value_type = T;
+
+		template <typename U>
+		struct rebind { using other = trie_page_allocator<U, HugePages>; };
+
+	public:
+		trie_page_allocator() noexcept = default;
+
+		template <typename U>
+		trie_page_allocator(trie_page_allocator<U, HugePages> const&) noexcept
+		{
+		}
+	};
+
+	template <typename T1, typename T2, bool HugePages>
+	inline bool operator==(trie_page_allocator<T1, HugePages> const&, trie_page_allocator<T2, HugePages> const&) noexcept
+	{
+		return true;
+	}
+
+	template <typename T1, typename T2, bool HugePages>
+	inline bool operator!=(trie_page_allocator<T1, HugePages> const&, trie_page_allocator<T2, HugePages> const&) noexcept
+	{
+		return false;
+	}
+
+	// ------------------------------------------------------------------------
+	// trie_page_vector
+	// ------------------------------------------------------------------------
+
+	/*! @brief 複写せずに伸長するノード配列
+
+	@tparam T         要素の型（トリビアルに複写可能であること）
+	@tparam HugePages 透過的ヒュージページを使う場合 true
+
+	std::vector は容量を超えると新しい領域を確保して全要素を複写するため、
+	大きなTrie木では挿入の途中に配列全体の複写による長い停止が起こる。
+	このクラスは、配列を匿名メモリ・マッピングに置き、 mremap() で伸長する。
+	伸長は仮想アドレスの付け替えで行われ、要素は複写されない。
+
+	- 2MiB以上のマッピングは2MiB境界に揃え、 HugePages が true の場合 madvise(MADV_HUGEPAGE) を指定する。
+	  カーネルが透過的ヒュージページを使えば、検索時のTLBミスが減る。
+	- 2MiB未満の配列は通常のページで確保するため、小さなTrie木の常駐メモリは増えない。
+	- 配列は連続しているため、INDEXの変換は不要で、イテレータや trie_view からはそのまま参照できる。
+	- Linux以外では、 std::allocator で確保し直して複写する。
+
+	trie_heap が使う std::vector のメンバの部分集合を実装する。
+	*/
+	template <typename T, bool HugePages = true>
+	class trie_page_vector
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+
+	public:
+		using value_type      = T;
+		using allocator_type  = trie_page_allocator<T, HugePages>;
+		using size_type       = std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference       = T&;
+		using const_reference = T const&;
+		using pointer         = T*;
+		using const_pointer   = T const*;
+		using iterator        = T*;
+		using const_iterator  = T const*;
+
+	protected:
+		static constexpr std::size_t page_bytes = 4096;
+		static constexpr std::size_t huge_bytes = 2 * 1024 * 1024;
+
+	public:
+		trie_page_vector() noexcept
+			: m_data(nullptr)
+			, m_size(0)
+			, m_bytes(0)
+		{
+		}
+
+		explicit trie_page_vector(allocator_type const&) noexcept
+			: trie_page_vector()
+		{
+		}
+
+		trie_page_vector(size_type n, value_type const& value, allocator_type const& = allocator_type())
+			: trie_page_vector()
+		{
+			insert(end(), n, value);
+		}
+
+		trie_page_vector(std::initializer_list<value_type> il, allocator_type const& = allocator_type())
+			: trie_page_vector()
+		{
+			reserve(il.size());
+			std::copy(il.begin(), il.end(), m_data);
+			m_size = il.size();
+		}
+
+		trie_page_vector(trie_page_vector const& other)
+			: trie_page_vector()
+		{
+			operator=(other);
+		}
+
+		trie_page_vector(trie_page_vector&& other) noexcept
+			: trie_page_vector()
+		{
+			swap(other);
+		}
+
+		~trie_page_vector() { release(m_data, m_bytes); }
+
+		trie_page_vector& operator=(trie_page_vector const& other)
+		{
+			if (this != &other)
+			{
+				clear();
+				reserve(other.m_size);
+				if (other.m_size != 0) std::memcpy(m_data, other.m_data, other.m_size * sizeof(value_type));
+				m_size = other.m_size;
+			}
+			return *this;
+		}
+
+		trie_page_vector& operator=(trie_page_vector&& other) noexcept
+		{
+			trie_page_vector(std::move(other)).swap(*this);
+			return *this;
+		}
+
+		trie_page_vector& operator=(std::initializer_list<value_type> il)
+		{
+			trie_page_vector(il).swap(*this);
+			return *this;
+		}
+
+		allocator_type get_allocator() const noexcept { return allocator_type(); }
+
+		// 要素アクセス --------------------------------------------------------
+
+		reference operator[](size_type i) noexcept { assert(i < m_size); return m_data[i]; }
+
+		const_reference operator[](size_type i) const noexcept { assert(i < m_size); return m_data[i]; }
+
+		reference front() noexcept { assert(m_size != 0); return *m_data; }
+
+		const_reference front() const noexcept { assert(m_size != 0); return *m_data; }
+
+		reference back() noexcept { assert(m_size != 0); return m_data[m_size - 1]; }
+
+		const_reference back() const noexcept { assert(m_size != 0); return m_data[m_size - 1]; }
+
+		pointer data() noexcept { return m_data; }
+
+		const_pointer data() const noexcept { return m_data; }
+
+		// イテレータ ----------------------------------------------------------
+
+		iterator begin() noexcept { return m_data; }
+
+		const_iterator begin() const noexcept { return m_data; }
+
+		iterator end() noexcept { return m_data + m_size; }
+
+		const_iterator end() const noexcept { return m_data + m_size; }
+
+		// 容量 ---------------------------------------------------------------
+
+		bool empty() const noexcept { return m_size == 0; }
+
+		size_type size() const noexcept { return m_size; }
+
+		size_type max_size() const noexcept { return std::numeric_limits<difference_type>::max() / sizeof(value_type); }
+
+		size_type capacity() const noexcept { return m_bytes / sizeof(value_type); }
+
+		/*! 少なくともn要素を格納できるようマッピングを伸長する
+		- 伸長は倍々に行い、2MiB以上では2MiB単位に切り上げる。
+		*/
+		void reserve(size_type n)
+		{
+			if (n <= capacity()) return;
+			if (max_size() < n) throw std::length_error("");
+
+			std::size_t bytes = std::max(n * sizeof(value_type), m_bytes * 2);
+			std::size_t unit = (huge_bytes <= bytes) ? huge_bytes : page_bytes;
+			bytes = (bytes + unit - 1) / unit * unit;
+
+			m_data = static_cast<pointer>(reallocate(m_data, m_bytes, bytes));
+			m_bytes = bytes;
+		}
+
+		// 変更 ---------------------------------------------------------------
+
+		/*! 要素を空にする
+		- マッピングは解放しない。
+		*/
+		void clear() noexcept { m_size = 0; }
+
+		void push_back(value_type const& value)
+		{
+			if (m_size == capacity())
+			{
+				value_type tmp = value; // valueが配列内を指す場合に備える
+				reserve(m_size + 1);
+				m_data[m_size++] = tmp;
+			}
+			else m_data[m_size++] = value;
+		}
+
+		iterator insert(const_iterator pos, size_type n, value_type const& value)
+		{
+			assert(begin() <= pos && pos <= end());
+
+			size_type i = pos - m_data;
+			value_type tmp = value;
+
+			reserve(m_size + n);
+			if (i != m_size) std::memmove(m_data + i + n, m_data + i, (m_size - i) * sizeof(value_type));
+			std::fill(m_data + i, m_data + i + n, tmp);
+			m_size += n;
+
+			return m_data + i;
+		}
+
+		void resize(size_type n, value_type const& value = value_type())
+		{
+			if (m_size < n) insert(end(), n - m_size, value);
+			else m_size = n;
+		}
+
+		void swap(trie_page_vector& other) noexcept
+		{
+			std::swap(m_data, other.m_data);
+			std::swap(m_size, other.m_size);
+			std::swap(m_bytes, other.m_bytes);
+		}
+
+	protected:
+		/*! pからbytes分のマッピングをnew_bytesに伸長し、先頭を返す
+		- pがnullptrの場合、新たに確保する。
+		*/
+		static void* reallocate(void* p, std::size_t bytes, std::size_t new_bytes)
+		{
+#if defined(__linux__)
+			void* result = nullptr;
+
+			// 後続の仮想アドレスが空いていれば、その場で伸ばす
+			// 2MiBに達する時、先頭が2MiB境界に無ければ、揃えた位置へ移す
+			bool aligned = reinterpret_cast<std::uintptr_t>(p) % huge_bytes == 0;
+			if (p != nullptr && (new_bytes < huge_bytes || aligned)) result = ::mremap(p, bytes, new_bytes, 0);
+
+			if (result == nullptr || result == MAP_FAILED)
+			{
+				// 2MiB境界に揃えるため、余分に予約して前後を返す
+				std::size_t align = (huge_bytes <= new_bytes) ? huge_bytes : page_bytes;
+				std::size_t reserved = new_bytes + align - page_bytes;
+
+				void* area = ::mmap(nullptr, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+				if (area == MAP_FAILED) throw std::bad_alloc();
+
+				std::uintptr_t first = reinterpret_cast<std::uintptr_t>(area);
+				std::uintptr_t head = (first + align - 1) / align * align;
+				std::uintptr_t last = first + reserved;
+
+				if (first != head) ::munmap(area, head - first);
+				if (head + new_bytes != last) ::munmap(reinterpret_cast<void*>(head + new_bytes), last - head - new_bytes);
+
+				result = reinterpret_cast<void*>(head);
+
+				// 古いマッピングは、ページ表の付け替えで移す
+				if (p != nullptr && ::mremap(p, bytes, new_bytes, MREMAP_MAYMOVE | MREMAP_FIXED, result) == MAP_FAILED)
+				{
+					::munmap(result, new_bytes);
+					throw std::bad_alloc();
+				}
+			}
+
+			if constexpr (HugePages)
+			{
+				if (huge_bytes <= new_bytes) ::madvise(result, new_bytes, MADV_HUGEPAGE);
+			}
+
+			return result;
+#else
+			std::allocator<value_type> alloc;
+			void* result = alloc.allocate(new_bytes / sizeof(value_type));
+			if (p != nullptr)
+			{
+				std::memcpy(result, p, bytes);
+				alloc.deallocate(static_cast<pointer>(p), bytes / sizeof(value_type));
+			}
+			return result;
+#endif
+		}
+
+		static void release(void* p, std::size_t bytes) noexcept
+		{
+			if (p == nullptr) return;
+#if defined(__linux__)
+			::munmap(p, bytes);
+#else
+			std::allocator<value_type>().deallocate(static_cast<pointer>(p), bytes / sizeof(value_type));
+#endif
+		}
+
+	protected:
+		pointer     m_data;
+		size_type   m_size;
+		std::size_t m_bytes; // マッピングのバイト数
+	};
+
+	template <typename T, bool HugePages>
+	inline bool operator==(trie_page_vector<T, HugePages> const& lhs, trie_page_vector<T, HugePages> const& rhs)
+	{
+		return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+	template <typename T, bool HugePages>
+	inline bool operator!=(trie_page_vector<T, HugePages> const& lhs, trie_page_vector<T, HugePages> const& rhs)
+	{
+		return !(lhs == rhs);
+	}
+
+	// ------------------------------------------------------------------------
+	// trie_heap_container
+	// ------------------------------------------------------------------------
+
+	/*! @brief アロケータから trie_heap のノード配列の型を選ぶ
+
+	- 既定では std::vector を使う。
+	- trie_page_allocator の場合、 trie_page_vector を使う。
+	*/
+	template <typename Allocator>
+	struct trie_heap_container
+	{
+		using type = std::vector<typename std::allocator_traits<Allocator>::value_type, Allocator>;
+	};
+
+	template <typename T, bool HugePages>
+	struct trie_heap_container<trie_page_allocator<T, HugePages>>
+	{
+		using type = trie_page_vector<T, HugePages>;
+	};
+}
@@ -0,0 +1,549 @@
+﻿#pragma once
+
+#include <wordring/serialize/serialize_iterator.hpp>
+#include <wordring/trie/stable_trie_base_iterator.hpp>
+#include <wordring/trie/trie.hpp>
+#include <wordring/trie/trie_base_iterator.hpp>
+#include <wordring/trie/trie_heap.hpp>
+#include <wordring/trie/trie_iterator.hpp>
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace wordring::detail
+{
+	// ------------------------------------------------------------------------
+	// trie_node_span
+	// ------------------------------------------------------------------------
+
+	/*! @brief 外部メモリー上のノード配列を所有せずに参照する読み取り専用コンテナ
+
+	mmap されたファイル・イメージのように、他者が所有するメモリー上のノード配列を、
+	trie_heap の内部コンテナと同じインターフェースで参照するために用意した。
+	イテレータは data() と size() しか使わないため、既存のイテレータをそのまま使える。
+	*/
+	class trie_node_span
+	{
+	public:
+		using value_type     = trie_node;
+		using size_type      = std::size_t;
+		using const_iterator = trie_node const*;
+
+	public:
+		trie_node_span()
+			: m_data(nullptr)
+			, m_size(0)
+		{
+		}
+
+		trie_node_span(trie_node const* data, size_type n)
+			: m_data(data)
+			, m_size(n)
+		{
+		}
+
+		trie_node const* data() const noexcept { return m_data; }
+
+		size_type size() const noexcept { return m_size; }
+
+		bool empty() const noexcept { return m_size == 0; }
+
+		trie_node const& front() const { return *m_data; }
+
+		trie_node const& operator[](size_type i) const { return *(m_data + i); }
+
+		const_iterator begin() const noexcept { return m_data; }
+
+		const_iterator end() const noexcept { return m_data + m_size; }
+
+	protected:
+		trie_node const* m_data;
+		size_type        m_size;
+	};
+
+	// ------------------------------------------------------------------------
+	// trie_view_flavour
+	// ------------------------------------------------------------------------
+
+	/*! @brief ビューの基本イテレータから、参照できるイメージの種類を求める
+	*/
+	template <typename Base>
+	struct trie_view_flavour;
+
+	template <typename Container>
+	struct trie_view_flavour<const_trie_base_iterator<Container>>
+	{
+		static constexpr trie_image_flavour value = trie_image_flavour::trie;
+	};
+
+	template <typename Container>
+	struct trie_view_flavour<const_stable_trie_base_iterator<Container>>
+	{
+		static constexpr trie_image_flavour value = trie_image_flavour::stable_trie;
+	};
+}
+
+namespace wordring
+{
+	// ------------------------------------------------------------------------
+	// basic_trie_view
+	// ------------------------------------------------------------------------
+
+	/*! @class basic_trie_view trie_view.hpp wordring/trie/trie_view.hpp
+
+	@brief 外部メモリー上のダブル・アレイを複製せずに参照する読み取り専用Trie
+
+	@tparam Label ラベルとして使用する任意の整数型
+	@tparam Base  基本となるイテレータ（ detail::const_trie_base_iterator あるいは detail::const_stable_trie_base_iterator ）
+
+	trie_heap::assign() は直列化データからノード配列を一つずつ再構築するため、
+	巨大な辞書では読み込みに時間がかかり、プロセス毎に複製を持つことになる。
+	このクラスは mmap されたファイル・イメージ上で直接検索を行うため、構築は O(1) であり、
+	複数のプロセスがページ・キャッシュを共有できる。
+
+	検索とイテレータは basic_trie と同じインターフェースを持つ。
+	変更は出来ない。
+
+	事前に定義された別名は以下の通り。
+
+	@code
+		template <typename Label>
+		using trie_view = basic_trie_view<Label, detail::const_trie_base_iterator<detail::trie_node_span const>>;
+
+		template <typename Label>
+		using stable_trie_view = basic_trie_view<Label, detail::const_stable_trie_base_iterator<detail::trie_node_span const>>;
+	@endcode
+
+	@par イメージ
+
+	イメージは basic_trie::write() が出力する一括入出力形式（ detail::trie_image_header ）である。
+	ビューはヘッダーを検査し、その後に続くノード配列を直接参照する。
+	ノード配列はリトル・エンディアンで記録されるため、ビッグ・エンディアンのホストではイメージを参照できない。
+	INDEX は32ビット（ detail::trie_node ）のものに限る。
+	構築を O(1) に保つため、チェックサムは検査しない。
+	ビューはイメージを参照するだけなので、イメージはビューより長く生存しなければならない。
+
+	@par 例
+	@code
+		// Trie木を作成してイメージを書き出す
+		std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+		auto t = trie<char32_t>(v.begin(), v.end());
+
+		std::ofstream os("dict.bin", std::ios::binary);
+		t.write(os);
+		os.close();
+
+		// イメージを mmap してビューを構築する
+		boost::interprocess::file_mapping fm("dict.bin", boost::interprocess::read_only);
+		boost::interprocess::mapped_region mr(fm, boost::interprocess::read_only);
+
+		auto tv = trie_view<char32_t>(mr.get_address(), mr.get_size());
+		assert(tv.contains(std::u32string(U"うあい")));
+	@endcode
+
+	@sa wordring::basic_trie
+	*/
+	template <typename Label, typename Base>
+	class basic_trie_view
+	{
+	protected:
+		using container  = detail::trie_node_span;
+		using node_type  = detail::trie_node;
+		using index_type = typename node_type::index_type;
+
+		static constexpr std::uint16_t null_value = 256u;
+
+		static constexpr detail::trie_image_flavour image_flavour = detail::trie_view_flavour<Base>::value;
+
+	public:
+		using label_type      = Label;
+		using value_type      = std::uint32_t;
+		using size_type       = typename container::size_type;
+		using const_iterator  = detail::const_trie_iterator<label_type, Base>;
+
+	protected:
+		static std::uint32_t constexpr coefficient = sizeof(label_type);
+
+		static_assert(std::is_integral_v<label_type>);
+		static_assert(1 <= coefficient);
+
+		/*! 空のビューが参照するイメージ
+		- 根のみを持つ空のTrieに相当する。
+		*/
+		static inline node_type const empty_image[2] = { { 0, 0 }, { 0, 0 } };
+
+	public:
+		/*! @brief 空のビューを構築する
+		*/
+		basic_trie_view()
+			: m_c(empty_image, 2)
+		{
+		}
+
+		/*! @brief ノード配列からビューを構築する
+
+		@param [in] first ノード配列の先頭を指すポインタ
+		@param [in] last  ノード配列の終端を指すポインタ
+
+		@throw std::invalid_argument ノード数が根を含むのに足りない場合
+		*/
+		basic_trie_view(node_type const* first, node_type const* last)
+			: m_c(first, static_cast<size_type>(std::distance(first, last)))
+		{
+			if (m_c.size() < 2) throw std::invalid_argument("");
+		}
+
+		/*! @brief 一括入出力形式のイメージからビューを構築する
+
+		@param [in] data  イメージの先頭を指すポインタ
+		@param [in] bytes イメージのバイト数
+
+		@throw std::invalid_argument
+			マジック、版、ラベルのバイト数、INDEXのバイト数、Trieの種類のいずれかが一致しない場合、
+			ヘッダーのノード数とイメージの大きさが一致しない場合、ノード数が根を含むのに足りない場合、
+			ノード配列がノードの境界に整列していない場合、あるいはホストがビッグ・エンディアンの場合
+
+		mmap で得たアドレスと大きさをそのまま渡すことを想定している。
+
+		@sa basic_trie::write()
+		*/
+		basic_trie_view(void const* data, std::size_t bytes)
+			: m_c(open_image(data, bytes))
+		{
+		}
+
+		/*! @brief Trieのノード配列を参照するビューを構築する
+
+		@param [in] trie 参照するTrie
+
+		Trieを変更するとビューは無効となる。
+		Trieの種類がビューの種類と一致しない場合、このコンストラクタは候補から外れる。
+		*/
+		template <typename Base1, typename std::enable_if_t<Base1::image_flavour == image_flavour, std::nullptr_t> = nullptr>
+		explicit basic_trie_view(basic_trie<Label, Base1> const& trie)
+			: m_c(trie.data(), trie.node_size())
+		{
+		}
+
+		/*! @brief ノード配列の先頭を指すポインタを返す
+		*/
+		node_type const* data() const noexcept { return m_c.data(); }
+
+		/*! @brief ノード配列の要素数を返す
+		*/
+		size_type node_size() const noexcept { return m_c.size(); }
+
+		// 要素アクセス --------------------------------------------------------
+
+		/*! @brief 葉の値を返す
+
+		@param [in] pos 葉を指すイテレータ
+
+		@return 葉の値
+
+		入力の正当性はチェックされない。
+		*/
+		value_type at(const_iterator pos) const
+		{
+			node_type const* d = m_c.data();
+			// 子遷移が有り、なおかつ文字列終端の場合に対応する。
+			index_type base = (d + pos.m_index)->m_base;
+			index_type idx = (base <= 0)
+				? pos.m_index
+				: base + null_value;
+
+			assert((d + idx)->m_base <= 0);
+			return static_cast<value_type>(-(d + idx)->m_base);
+		}
+
+		/*! @brief 葉の値を返す
+
+		@param [in] first キー文字列の先頭を指すイテレータ
+		@param [in] last  キー文字列の終端を指すイテレータ
+
+		@return 葉の値
+
+		@throw std::out_of_range キー文字列が格納されていない場合
+		*/
+		template <typename InputIterator>
+		value_type at(InputIterator first, InputIterator last) const
+		{
+			auto it = find(first, last);
+			if (it == cend()) throw std::out_of_range("");
+
+			return at(it);
+		}
+
+		/*! @brief 葉の値を返す
+
+		@param [in] key キー文字列（ラベル列）
+
+		@return 葉の値
+
+		@throw std::out_of_range キー文字列が格納されていない場合
+		*/
+		template <typename Key>
+		value_type at(Key const& key) const
+		{
+			return at(std::begin(key), std::end(key));
+		}
+
+		// イテレータ ----------------------------------------------------------
+
+		/*! @brief 根を指すイテレータを返す
+		*/
+		const_iterator begin() const noexcept { return const_iterator(m_c, 1); }
+
+		/*! @brief 根を指すイテレータを返す
+		*/
+		const_iterator cbegin() const noexcept { return const_iterator(m_c, 1); }
+
+		/*! @brief 根の終端を指すイテレータを返す
+		*/
+		const_iterator end() const noexcept { return const_iterator(m_c, 0); }
+
+		/*! @brief 根の終端を指すイテレータを返す
+		*/
+		const_iterator cend() const noexcept { return const_iterator(m_c, 0); }
+
+		// 容量 ---------------------------------------------------------------
+
+		/*! @brief キー文字列を格納していないことを調べる
+		*/
+		bool empty() const noexcept { return size() == 0; }
+
+		/*! @brief 格納しているキー文字列数を調べる
+		*/
+		size_type size() const noexcept { return static_cast<std::uint32_t>(m_c.front().m_base); }
+
+		// 検索 ---------------------------------------------------------------
+
+	protected:
+		/*! イメージのヘッダーを検査し、ノード配列を返す
+		*/
+		static container open_image(void const* data, std::size_t bytes)
+		{
+			using header = detail::trie_image_header;
+
+			if constexpr (std::endian::native != std::endian::little) throw std::invalid_argument("");
+
+			if (data == nullptr || bytes < header::size) throw std::invalid_argument("");
+
+			std::uint8_t const* p = static_cast<std::uint8_t const*>(data);
+			std::array<std::uint8_t, header::size> head;
+			std::copy(p, p + header::size, head.begin());
+
+			header h;
+			if (!h.decode(head)
+				|| h.m_version != header::current_version
+				|| h.m_label_size != sizeof(label_type)
+				|| h.m_index_size != sizeof(index_type)
+				|| h.m_flavour != image_flavour)
+			{
+				throw std::invalid_argument("");
+			}
+
+			std::size_t n = bytes - header::size;
+			if (n % sizeof(node_type) != 0 || n / sizeof(node_type) != h.m_nodes || h.m_nodes < 2) throw std::invalid_argument("");
+			if (reinterpret_cast<std::uintptr_t>(p + header::size) % alignof(node_type) != 0) throw std::invalid_argument("");
+
+			return container(reinterpret_cast<node_type const*>(p + header::size), n / sizeof(node_type));
+		}
+
+		/*! parentからlabelで遷移したINDEXを返す
+		- 遷移先が無ければ0を返す。
+		*/
+		index_type at_index(index_type parent, std::uint16_t label) const
+		{
+			node_type const* d = m_c.data();
+
+			index_type base = (d + parent)->m_base;
+			if (base <= 0) return 0;
+
+			index_type idx = base + label;
+			return (idx < static_cast<index_type>(m_c.size()) && (d + idx)->m_check == parent)
+				? idx
+				: 0;
+		}
+
+		/*! @brief バイト列による部分一致検索
+
+		@param [in]  first 検索するバイト列の先頭を指すイテレータ
+		@param [in]  last  検索するバイト列の終端を指すイテレータ
+		@param [out] i     遷移した数（0で初期化されている必要がある）
+
+		@return 一致した最後のノードのINDEXと次のバイトを指すイテレータのペア
+
+		@sa detail::trie_base::lookup(InputIterator first, InputIterator last, std::uint32_t& i) const
+		*/
+		template <typename InputIterator>
+		auto lookup(InputIterator first, InputIterator last, std::uint32_t& i) const
+		{
+			assert(i == 0);
+
+			index_type parent = 1;
+
+			while (first != last)
+			{
+				index_type idx = at_index(parent, static_cast<std::uint8_t>(*first));
+				if (idx == 0) break;
+				++first;
+				++i;
+				parent = idx;
+			}
+
+			return std::make_pair(parent, first);
+		}
+
+	public:
+		/*! @brief 部分一致検索
+
+		@param [in] first 検索するキー文字列の先頭を指すイテレータ
+		@param [in] last  検索するキー文字列の終端を指すイテレータ
+
+		@return 一致した最後のノードと次の文字を指すイテレータのペア
+
+		一文字も一致しない場合、cbegin()を返す。
+
+		@sa basic_trie::lookup(InputIterator first, InputIterator last) const
+		*/
+		template <typename InputIterator>
+		auto lookup(InputIterator first, InputIterator last) const
+		{
+			assert(coefficient == sizeof(typename std::iterator_traits<InputIterator>::value_type));
+
+			std::pair<const_iterator, InputIterator> result;
+			std::uint32_t i = 0;
+
+			if constexpr (coefficient == 1)
+			{
+				auto ret = lookup(first, last, i);
+				result.first = const_iterator(m_c, ret.first);
+				result.second = ret.second;
+			}
+			else
+			{
+				auto it1 = wordring::serialize_iterator(first);
+				auto it2 = wordring::serialize_iterator(last);
+
+				auto ret = lookup(it1, it2, i);
+
+				// ラベルの途中で一致しなくなった場合、ラベルの境界まで戻る。
+				index_type idx = ret.first;
+				for (i = i % coefficient; i != 0; --i) idx = (m_c.data() + idx)->m_check;
+
+				result.first = const_iterator(m_c, idx);
+				result.second = ret.second.base();
+			}
+
+			return result;
+		}
+
+		/*! @brief 前方一致検索
+
+		@param [in] first 検索するキー文字列の先頭を指すイテレータ
+		@param [in] last  検索するキー文字列の終端を指すイテレータ
+
+		@return 一致した最後のノード、一致しない場合 cend()
+		*/
+		template <typename InputIterator>
+		const_iterator search(InputIterator first, InputIterator last) const
+		{
+			auto pair = lookup(first, last);
+
+			return (pair.second == last)
+				? pair.first
+				: cend();
+		}
+
+		/*! @brief 前方一致検索
+
+		@param [in] key 検索するキー文字列
+
+		@return 一致した最後のノード、一致しない場合 cend()
+		*/
+		template <typename Key>
+		const_iterator search(Key const& key) const
+		{
+			return search(std::begin(key), std::end(key));
+		}
+
+		/*! @brief 完全一致検索
+
+		@param [in] first 検索するキー文字列の先頭を指すイテレータ
+		@param [in] last  検索するキー文字列の終端を指すイテレータ
+
+		@return
+			入力されたキー文字列と完全に一致する葉がある場合、そのノードを指すイテレータ。
+			それ以外の場合、 cend() 。
+		*/
+		template <typename InputIterator>
+		const_iterator find(InputIterator first, InputIterator last) const
+		{
+			auto pair = lookup(first, last);
+
+			return (pair.second == last && pair.first)
+				? pair.first
+				: cend();
+		}
+
+		/*! @brief 完全一致検索
+
+		@param [in] key 検索するキー文字列
+
+		@return
+			入力されたキー文字列と完全に一致する葉がある場合、そのノードを指すイテレータ。
+			それ以外の場合、 cend() 。
+		*/
+		template <typename Key>
+		const_iterator find(Key const& key) const
+		{
+			return find(std::begin(key), std::end(key));
+		}
+
+		/*! @brief キー文字列が格納されているか調べる
+
+		@param [in] first キー文字列の先頭を指すイテレータ
+		@param [in] last  キー文字列の終端を指すイテレータ
+
+		@return 格納されている場合 true 、それ以外の場合 false
+		*/
+		template <typename InputIterator>
+		bool contains(InputIterator first, InputIterator last) const
+		{
+			return find(first, last) != cend();
+		}
+
+		/*! @brief キー文字列が格納されているか調べる
+
+		@param [in] key キー文字列
+
+		@return 格納されている場合 true 、それ以外の場合 false
+		*/
+		template <typename Key>
+		bool contains(Key const& key) const
+		{
+			return contains(std::begin(key), std::end(key));
+		}
+
+	protected:
+		container m_c;
+	};
+
+	/*! @brief trie のイメージを参照する読み取り専用ビュー
+	*/
+	template <typename Label>
+	using trie_view = basic_trie_view<Label, detail::const_trie_base_iterator<detail::trie_node_span const>>;
+
+	/*! @brief stable_trie のイメージを参照する読み取り専用ビュー
+	*/
+	template <typename Label>
+	using stable_trie_view = basic_trie_view<Label, detail::const_stable_trie_base_iterator<detail::trie_node_span const>>;
+}
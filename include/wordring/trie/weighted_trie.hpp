@@ -0,0 +1,669 @@
+﻿#pragma once
+
+#include <wordring/serialize/serialize_iterator.hpp>
+#include <wordring/trie/trie.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace wordring
+{
+	template <typename Label, typename Base>
+	class basic_weighted_trie;
+}
+
+namespace wordring::detail
+{
+	// ------------------------------------------------------------------------
+	// trie_weight_proxy
+	// ------------------------------------------------------------------------
+
+	/*! @brief basic_weighted_trie の葉の値へのプロキシ
+
+	値を設定すると、祖先の重みの注釈を更新する。
+	*/
+	template <typename Trie>
+	struct trie_weight_proxy
+	{
+		using index_type = typename Trie::index_type;
+
+		Trie*      m_trie;
+		index_type m_index;
+
+		trie_weight_proxy()
+			: m_trie(nullptr)
+			, m_index(0)
+		{
+		}
+
+		trie_weight_proxy(Trie* trie, index_type index)
+			: m_trie(trie)
+			, m_index(index)
+		{
+		}
+
+		/*! 葉の値を設定する
+		- 値が INDEX の型で表せない場合、 std::length_error を投げる。
+		*/
+		void operator=(std::uint32_t val)
+		{
+			if (static_cast<std::uint64_t>(std::numeric_limits<index_type>::max()) < val) throw std::length_error("");
+			m_trie->update(m_index, val);
+		}
+
+		operator index_type() const
+		{
+			std::uint32_t result = 0;
+			m_trie->terminal(m_index, result);
+			return static_cast<index_type>(result);
+		}
+	};
+}
+
+namespace wordring
+{
+	// ------------------------------------------------------------------------
+	// basic_weighted_trie
+	// ------------------------------------------------------------------------
+
+	/*! @class basic_weighted_trie weighted_trie.hpp wordring/trie/weighted_trie.hpp
+
+	@brief 葉の値を重みとして、重みの大きい順に補完候補を列挙できるTrie
+
+	@tparam Label ラベルとして使用する任意の整数型
+	@tparam Base  基本クラスとして使用するTrie実装クラス
+
+	basic_trie に、各ノードの部分木に含まれる葉の値の最大値（重みの注釈）を加えたもの。
+	注釈はダブル・アレイと同じINDEXで引く配列に格納され、ノード一つにつき4バイトを消費する。
+
+	top_k() は、注釈を使って重みの大きい部分木から順に探索する。
+	そのため、補完に要する時間は接頭辞以下の部分木の大きさではなく、候補数と深さに比例する。
+
+	注釈は insert() 、 erase() 、値の設定の度に更新される。
+	挿入時の衝突によってノードが移動した場合も、移動先へ注釈を移す。
+	値の設定には at() あるいは operator[]() が返すプロキシを使う。
+
+	@sa basic_trie
+	*/
+	template <typename Label, typename Base>
+	class basic_weighted_trie : public basic_trie<Label, Base>
+	{
+		template <typename Trie>
+		friend struct detail::trie_weight_proxy;
+
+		template <typename Label1, typename Base1>
+		friend std::istream& operator>>(std::istream&, basic_weighted_trie<Label1, Base1>&);
+
+	protected:
+		using base_type = basic_trie<Label, Base>;
+
+		using typename base_type::container;
+		using typename base_type::index_type;
+		using typename base_type::node_type;
+
+		using base_type::null_value;
+		using base_type::coefficient;
+
+		using weight_container = std::vector<std::uint32_t, typename std::allocator_traits<typename Base::allocator_type>::template rebind_alloc<std::uint32_t>>;
+
+	public:
+		using typename base_type::label_type;
+		using typename base_type::value_type;
+		using typename base_type::size_type;
+		using typename base_type::allocator_type;
+		using typename base_type::const_iterator;
+
+		using reference       = detail::trie_weight_proxy<basic_weighted_trie>;
+		using const_reference = detail::trie_weight_proxy<basic_weighted_trie> const;
+
+	public:
+		using base_type::cend;
+		using base_type::size;
+		using base_type::empty;
+		using base_type::find;
+		using base_type::search;
+
+	protected:
+		using base_type::limit;
+
+		using base_type::m_c;
+
+	public:
+		/*! @brief 空のコンテナを構築する
+		*/
+		basic_weighted_trie()
+			: base_type()
+			, m_weight(2, 0)
+		{
+		}
+
+		/*! @brief アロケータを指定して空のコンテナを構築する
+
+		@param [in] alloc アロケータ
+		*/
+		explicit basic_weighted_trie(allocator_type const& alloc)
+			: base_type(alloc)
+			, m_weight(2, 0, alloc)
+		{
+		}
+
+		/*! @brief 文字列リストあるいは直列化データから構築する
+
+		@param [in] first 文字列リストあるいは直列化データの先頭を指すイテレータ
+		@param [in] last  文字列リストあるいは直列化データの終端を指すイテレータ
+		@param [in] alloc アロケータ
+
+		@sa basic_trie::assign()
+		*/
+		template <typename InputIterator>
+		basic_weighted_trie(InputIterator first, InputIterator last, allocator_type const& alloc = allocator_type())
+			: base_type(alloc)
+			, m_weight(alloc)
+		{
+			assign(first, last);
+		}
+
+		/*! @brief 文字列リストあるいは直列化データから割り当てる
+
+		@sa basic_trie::assign()
+		*/
+		template <typename InputIterator>
+		void assign(InputIterator first, InputIterator last)
+		{
+			base_type::assign(first, last);
+			rebuild_weights();
+		}
+
+		/*! @brief 文字列リストから複数のスレッドで割り当てる
+
+		@sa basic_trie::parallel_assign()
+		*/
+		template <typename ForwardIterator>
+		void parallel_assign(ForwardIterator first, ForwardIterator last, std::uint32_t concurrency = 0)
+		{
+			base_type::parallel_assign(first, last, concurrency);
+			rebuild_weights();
+		}
+
+		// 要素アクセス --------------------------------------------------------
+
+		/*! @brief 葉の値への参照を返す
+
+		@param [in] pos 葉を指すイテレータ
+
+		@return 葉の値に対するプロキシ
+
+		プロキシを通して値を設定すると、重みの注釈も更新される。
+		入力の正当性はチェックされない。
+		*/
+		reference at(const_iterator pos)
+		{
+			return reference(this, pos.m_index);
+		}
+
+		const_reference at(const_iterator pos) const
+		{
+			return const_cast<basic_weighted_trie*>(this)->at(pos);
+		}
+
+		/*! @brief 葉の値への参照を返す
+
+		@throw std::out_of_range キー文字列が格納されていない場合
+		*/
+		template <typename InputIterator>
+		reference at(InputIterator first, InputIterator last)
+		{
+			auto it = find(first, last);
+			if (it == cend()) throw std::out_of_range("");
+
+			return at(it);
+		}
+
+		template <typename InputIterator>
+		const_reference at(InputIterator first, InputIterator last) const
+		{
+			return const_cast<basic_weighted_trie*>(this)->at(first, last);
+		}
+
+		template <typename Key>
+		reference at(Key const& key)
+		{
+			return at(std::begin(key), std::end(key));
+		}
+
+		template <typename Key>
+		const_reference at(Key const& key) const
+		{
+			return at(std::begin(key), std::end(key));
+		}
+
+		/*! @brief 葉の値への参照を返す
+
+		キー文字列が格納されていない場合、新たに挿入し、その葉の値への参照を返す。
+		*/
+		template <typename Key>
+		reference operator[](Key const& key)
+		{
+			const_iterator it = find(key);
+			if (it == cend()) it = insert(key);
+
+			return at(it);
+		}
+
+		// 変更 ---------------------------------------------------------------
+
+		/*! @brief すべての要素を削除する
+		*/
+		void clear() noexcept
+		{
+			base_type::clear();
+			m_weight.assign(limit(), 0);
+		}
+
+		/*! @brief キー文字列を挿入する
+
+		@param [in] first キー文字列の先頭を指すイテレータ
+		@param [in] last  キー文字列の終端を指すイテレータ
+		@param [in] value 葉へ格納する値（重み、省略時は0）
+
+		@return 挿入された最後の文字に対応するノードを指すイテレータ
+
+		既に格納されている場合、値は変更されない。
+
+		挿入によって子が移動したノードは、挿入した文字列の経路上の一つだけである。
+		挿入前の経路の各ノードのBASEを記録し、変化したノードの子の注釈を移動先へ移す。
+		*/
+		template <typename InputIterator>
+		const_iterator insert(InputIterator first, InputIterator last, value_type value = 0)
+		{
+			std::string key = to_bytes(first, last);
+			if (key.empty()) return cend();
+
+			// 挿入前の経路
+			std::vector<std::pair<index_type, index_type>> before(1, { 1, (m_c.data() + 1)->m_base });
+			for (char ch : key)
+			{
+				index_type idx = Base::at(before.back().first, static_cast<std::uint8_t>(ch));
+				if (idx == 0) break;
+				before.emplace_back(idx, (m_c.data() + idx)->m_base);
+			}
+
+			size_type n = size();
+			const_iterator result = const_iterator(Base::insert(key.begin(), key.end(), value));
+			if (n == size()) return result;
+
+			m_weight.resize(limit(), 0);
+
+			// 挿入後の経路
+			std::vector<index_type> after(1, 1);
+			for (char ch : key) after.push_back(Base::at(after.back(), static_cast<std::uint8_t>(ch)));
+			assert(after.back() == result.m_index);
+
+			// 移動した子の注釈を移す
+			std::vector<std::pair<index_type, std::uint32_t>> moved;
+			node_type const* d = m_c.data();
+			for (std::size_t i = 0; i < before.size(); ++i)
+			{
+				index_type idx = after[i];
+				index_type from = before[i].second;
+				index_type to = (d + idx)->m_base;
+				assert(idx == before[i].first);
+
+				if (from < 1 || from == to) continue;
+
+				for (std::uint16_t label = 0; label < null_value; ++label)
+				{
+					index_type child = to + label;
+					if (limit() <= child) break;
+					if ((d + child)->m_check != idx) continue;
+					if (i + 1 < after.size() && before.size() <= i + 1 && after[i + 1] == child) continue;
+
+					moved.emplace_back(child, m_weight[from + label]);
+				}
+			}
+			for (auto const& pair : moved) m_weight[pair.first] = pair.second;
+
+			// 経路上の注釈を更新する
+			for (std::size_t i = 0; i < after.size(); ++i)
+			{
+				std::uint32_t& w = m_weight[after[i]];
+				w = (i < before.size()) ? std::max(w, value) : value;
+			}
+
+			return result;
+		}
+
+		template <typename Key>
+		const_iterator insert(Key const& key, value_type value = 0)
+		{
+			return insert(std::begin(key), std::end(key), value);
+		}
+
+		/*! @brief キー文字列を削除する
+
+		@param [in] pos 削除するキー文字列の末尾に対応するノードへのイテレータ
+
+		削除後に残った最も深い祖先から根まで、注釈を再計算する。
+		*/
+		void erase(const_iterator pos)
+		{
+			if (pos.m_index <= 1 || !pos) return;
+
+			std::vector<index_type> path;
+			for (index_type idx = pos.m_index; idx != 1; idx = (m_c.data() + idx)->m_check) path.push_back(idx);
+			path.push_back(1);
+
+			base_type::erase(pos);
+
+			if (empty())
+			{
+				m_weight.assign(limit(), 0);
+				return;
+			}
+
+			node_type const* d = m_c.data();
+			std::size_t i = 0;
+			while (path[i] != 1 && (d + path[i])->m_check != path[i + 1]) ++i;
+
+			refresh(path[i]);
+		}
+
+		template <typename InputIterator>
+		void erase(InputIterator first, InputIterator last)
+		{
+			erase(find(first, last));
+		}
+
+		template <typename Key>
+		void erase(Key const& key)
+		{
+			erase(std::begin(key), std::end(key));
+		}
+
+		void swap(basic_weighted_trie& other)
+		{
+			base_type::swap(other);
+			m_weight.swap(other.m_weight);
+		}
+
+		/*! @brief ダブル・アレイを詰め直す
+
+		注釈は対応表に従って新しいINDEXへ移される。
+
+		@sa detail::trie_heap::compact()
+		*/
+		detail::basic_trie_compact_result<index_type> compact()
+		{
+			auto result = base_type::compact();
+
+			weight_container weight(limit(), 0, m_weight.get_allocator());
+			for (std::size_t i = 1; i < result.m_remap.size(); ++i)
+			{
+				if (result.m_remap[i] != 0) weight[result.m_remap[i]] = m_weight[i];
+			}
+			m_weight.swap(weight);
+
+			return result;
+		}
+
+		/*! @brief 一括入出力形式でストリームから入力する
+
+		入力に成功した場合、重みの注釈を再構築する。
+		出力は basic_trie::write() と同じ形式で行われる。
+
+		@sa basic_trie::read()
+		*/
+		std::istream& read(std::istream& is)
+		{
+			if (base_type::read(is)) rebuild_weights();
+			return is;
+		}
+
+		// 検索 ---------------------------------------------------------------
+
+		/*! @brief 重みの大きい順に補完候補を列挙する
+
+		@param [in]  first 接頭辞の先頭を指すイテレータ
+		@param [in]  last  接頭辞の終端を指すイテレータ
+		@param [in]  k     列挙する候補の最大数
+		@param [out] out   候補の出力先
+
+		@return 出力先の終端
+
+		接頭辞で始まるキー文字列のうち、値の大きいものから最大 k 個について、
+		終端を指すイテレータと値の組 std::pair<const_iterator, value_type> を出力する。
+		文字列は const_iterator::string() で復元できる。
+		重みが等しい候補の順序は規定しない。
+
+		部分木の重みの注釈を優先度とする最良優先探索によって、走査するノード数を候補数と深さの積程度に抑える。
+
+		@par 例
+		@code
+			auto t = weighted_trie<char>();
+			t.insert(std::string("apple"), 5);
+			t.insert(std::string("apply"), 9);
+			t.insert(std::string("ape"), 7);
+
+			std::vector<std::pair<weighted_trie<char>::const_iterator, std::uint32_t>> v;
+			std::string prefix{ "ap" };
+			t.top_k(prefix.begin(), prefix.end(), 2, std::back_inserter(v));
+
+			std::string s;
+			v[0].first.string(s);
+			assert(s == "apply" && v[0].second == 9);
+			v[1].first.string(s);
+			assert(s == "ape" && v[1].second == 7);
+		@endcode
+		*/
+		template <typename InputIterator, typename OutputIterator>
+		OutputIterator top_k(InputIterator first, InputIterator last, std::size_t k, OutputIterator out) const
+		{
+			struct entry
+			{
+				std::uint32_t m_weight;
+				index_type    m_index;
+				bool          m_terminal;
+
+				bool operator<(entry const& rhs) const
+				{
+					if (m_weight != rhs.m_weight) return m_weight < rhs.m_weight;
+					return m_terminal < rhs.m_terminal;
+				}
+			};
+
+			if (k == 0) return out;
+
+			const_iterator it = search(first, last);
+			if (it == cend()) return out;
+
+			node_type const* d = m_c.data();
+			std::priority_queue<entry> queue;
+			queue.push(entry{ m_weight[it.m_index], it.m_index, false });
+
+			while (!queue.empty())
+			{
+				entry e = queue.top();
+				queue.pop();
+
+				if (e.m_terminal)
+				{
+					*out++ = std::make_pair(const_iterator(m_c, e.m_index), e.m_weight);
+					if (--k == 0) break;
+					continue;
+				}
+
+				std::uint32_t value = 0;
+				if (terminal(e.m_index, value)) queue.push(entry{ value, e.m_index, true });
+
+				index_type base = (d + e.m_index)->m_base;
+				if (base <= 0) continue;
+
+				index_type last = std::min<index_type>(base + null_value, limit());
+				for (index_type idx = base; idx < last; ++idx)
+				{
+					if ((d + idx)->m_check == e.m_index) queue.push(entry{ m_weight[idx], idx, false });
+				}
+			}
+
+			return out;
+		}
+
+		template <typename Key, typename OutputIterator>
+		OutputIterator top_k(Key const& prefix, std::size_t k, OutputIterator out) const
+		{
+			return top_k(std::begin(prefix), std::end(prefix), k, out);
+		}
+
+		/*! @brief 部分木に含まれる値の最大値を返す
+
+		@param [in] pos ノードを指すイテレータ
+
+		@return pos を根とする部分木に格納されたキー文字列の値の最大値
+		*/
+		value_type weight(const_iterator pos) const
+		{
+			return m_weight[pos.m_index];
+		}
+
+	protected:
+		template <typename InputIterator>
+		static std::string to_bytes(InputIterator first, InputIterator last)
+		{
+			if constexpr (coefficient == 1) return std::string(first, last);
+			else return std::string(wordring::serialize_iterator(first), wordring::serialize_iterator(last));
+		}
+
+		/*! idx が文字列終端である場合、値を value に格納し true を返す
+		*/
+		bool terminal(index_type idx, std::uint32_t& value) const
+		{
+			node_type const* d = m_c.data();
+
+			index_type base = (d + idx)->m_base;
+			if (base <= 0)
+			{
+				if (idx <= 1) return false;
+				value = static_cast<std::uint32_t>(-base);
+				return true;
+			}
+
+			index_type i = base + null_value;
+			if (i < limit() && (d + i)->m_check == idx)
+			{
+				value = static_cast<std::uint32_t>(-(d + i)->m_base);
+				return true;
+			}
+
+			return false;
+		}
+
+		/*! idx から根へ向かって注釈を再計算する
+		- 注釈が変化しなかったノードで止まる。
+		*/
+		void refresh(index_type idx)
+		{
+			node_type const* d = m_c.data();
+
+			while (true)
+			{
+				std::uint32_t w = 0;
+				terminal(idx, w);
+
+				index_type base = (d + idx)->m_base;
+				if (1 <= base)
+				{
+					index_type last = std::min<index_type>(base + null_value, limit());
+					for (index_type i = base; i < last; ++i) if ((d + i)->m_check == idx) w = std::max(w, m_weight[i]);
+				}
+
+				if (m_weight[idx] == w) break;
+				m_weight[idx] = w;
+
+				if (idx == 1) break;
+				idx = (d + idx)->m_check;
+			}
+		}
+
+		/*! 値を設定し、注釈を更新する
+		*/
+		void update(index_type idx, std::uint32_t value)
+		{
+			base_type::at(const_iterator(m_c, idx)) = value;
+			refresh(idx);
+		}
+
+		/*! すべての注釈を再構築する
+
+		文字列終端を値の降順に並べ、根へ向かって未設定の祖先に値を設定する。
+		各ノードは一度だけ設定される。
+		*/
+		void rebuild_weights()
+		{
+			node_type const* d = m_c.data();
+
+			m_weight.assign(limit(), 0);
+
+			std::vector<std::pair<std::uint32_t, index_type>> terminals;
+			for (index_type idx = 2; idx < limit(); ++idx)
+			{
+				index_type parent = (d + idx)->m_check;
+				if (parent <= 0 || (d + parent)->m_base + null_value == idx) continue;
+
+				std::uint32_t value = 0;
+				if (terminal(idx, value)) terminals.emplace_back(value, idx);
+			}
+			std::sort(terminals.begin(), terminals.end(), [](auto const& lhs, auto const& rhs) { return rhs.first < lhs.first; });
+
+			std::vector<bool> done(limit(), false);
+			for (auto const& pair : terminals)
+			{
+				for (index_type idx = pair.second; !done[idx]; idx = (d + idx)->m_check)
+				{
+					done[idx] = true;
+					m_weight[idx] = pair.first;
+					if (idx == 1) break;
+				}
+			}
+		}
+
+	protected:
+		weight_container m_weight;
+	};
+
+	/*! @brief ストリームから入力する
+
+	入力後、重みの注釈を再構築する。
+	出力は basic_trie と同じ形式で行われる。
+	*/
+	template <typename Label1, typename Base1>
+	inline std::istream& operator>>(std::istream& is, basic_weighted_trie<Label1, Base1>& trie)
+	{
+		typename basic_weighted_trie<Label1, Base1>::base_type& base = trie;
+		is >> base;
+		trie.rebuild_weights();
+
+		return is;
+	}
+
+	/*! @brief 重み付き補完を備えた、メモリー使用量削減を目標とする汎用Trie
+
+	予測入力を用途として想定する。
+	*/
+	template <typename Label, typename Allocator = std::allocator<detail::trie_node>>
+	using weighted_trie = basic_weighted_trie<Label, detail::trie_base<Allocator>>;
+
+	/*! @brief 重み付き補完を備えた、葉からの空遷移先INDEXが衝突によって変更されない汎用Trie
+	*/
+	template <typename Label, typename Allocator = std::allocator<detail::trie_node>>
+	using stable_weighted_trie = basic_weighted_trie<Label, detail::stable_trie_base<Allocator>>;
+}
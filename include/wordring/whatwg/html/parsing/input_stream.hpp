@@ -331,42 +331,30 @@ namespace wordring::whatwg::html::parsing
 		*/
 		std::array<char32_t, 2> match_named_character_reference(std::uint32_t& len)
 		{
-			len = 0;
-
-			auto it1 = named_character_reference_idx_tbl.begin();
-			auto it2 = named_character_reference_idx_tbl.end();
+			// 一致は短い順に出力されるため、最後の一致だけを残す
+			struct longest_match
+			{
+				std::size_t&   m_length;
+				std::uint32_t& m_value;
 
-			auto tail = it1;
-			std::uint32_t j = 0;
+				longest_match& operator*() { return *this; }
+				longest_match& operator++() { return *this; }
+				longest_match& operator++(int) { return *this; }
 
-			for (std::uint32_t i = 0; it1 != it2 && i < m_c.size(); ++i)
-			{
-				it1 = it1[m_c[i]];
-				if (it1)
+				longest_match& operator=(std::pair<std::size_t, std::uint32_t> const& m)
 				{
-					tail = it1;
-					j = i + 1;
+					m_length = m.first;
+					m_value  = m.second;
+					return *this;
 				}
-			}
-			std::u32string s;
-			tail.string(s);
+			};
 
-			while (tail != named_character_reference_idx_tbl.begin())
-			{
-				if (tail)
-				{
-					len = j;
-					break;
-				}
-				tail = tail.parent();
-			}
+			std::size_t n = 0;
+			std::uint32_t idx = 0;
+			named_character_reference_idx_tbl.common_prefix_search(m_c.begin(), m_c.end(), longest_match{ n, idx });
 
-			if (len != 0)
-			{
-				std::uint32_t idx = named_character_reference_idx_tbl.at(tail);
-				std::array<char32_t, 2> a = named_character_reference_map_tbl[idx];
-				return a;
-			}
+			len = static_cast<std::uint32_t>(n);
+			if (n != 0) return named_character_reference_map_tbl[idx];
 
 			return std::array<char32_t, 2>();
 		}
@@ -8,6 +8,7 @@
 #include <iterator>
 #include <iomanip>
 #include <memory>
+#include <sstream>
 #include <string>
 
 BOOST_AUTO_TEST_SUITE(atom__test)
@@ -129,6 +130,36 @@ BOOST_AUTO_TEST_CASE(basic_atom__string__4)
 	BOOST_CHECK(s == U"");
 }
 
+/*
+アトムの文字列を参照する
+
+view_type view() const
+*/
+BOOST_AUTO_TEST_CASE(basic_atom__view__1)
+{
+	using namespace wordring;
+	using namespace wordring::detail;
+
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	auto as = basic_atom_set<std::u32string>(v.begin(), v.end());
+	as.use_string_pool();
+
+	for (auto const& s : v) BOOST_CHECK(as.at(s).view() == s);
+	BOOST_CHECK(as.at(U"").view().empty());
+
+	std::uint32_t id = as.at(U"うあい");
+	BOOST_CHECK(as.at(id).view() == U"うあい");
+	BOOST_CHECK(static_cast<std::u32string>(as.at(id)) == U"うあい");
+
+	std::u32string s;
+	BOOST_CHECK(as.at(U"うえ").string(s) == U"うえ");
+
+	// 既定構築したアトム、文字列表を使わないコンテナのアトム
+	BOOST_CHECK(basic_atom<std::u32string>().view().empty());
+	auto as2 = basic_atom_set<std::u32string>(v.begin(), v.end());
+	BOOST_CHECK(as2.at(U"い").view().empty());
+}
+
 /*
 二つのアトムが等しいか調べる
 
@@ -825,4 +856,145 @@ BOOST_AUTO_TEST_CASE(basic_atom_set__serialize__1)
 	BOOST_CHECK(as2.size() == 5);
 }
 
+/*
+一括入出力形式
+
+std::ostream& write(std::ostream& os) const
+std::istream& read(std::istream& is)
+*/
+BOOST_AUTO_TEST_CASE(basic_atom_set__write__1)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v1{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	auto as1 = basic_atom_set<std::u32string>(v1.begin(), v1.end());
+
+	std::stringstream ss;
+	as1.write(ss);
+
+	basic_atom_set<std::u32string> as2;
+	BOOST_CHECK(as2.read(ss));
+
+	BOOST_CHECK(as2.size() == 5);
+	for (auto const& s : v1)
+	{
+		std::uint32_t id = as1.at(s);
+		BOOST_CHECK(static_cast<std::uint32_t>(as2.at(s)) == id);
+		BOOST_CHECK(static_cast<std::u32string>(as2.at(id)) == s);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(basic_atom_set__write__2)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v1{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	auto as1 = basic_atom_set<std::u32string>(v1.begin(), v1.end());
+
+	// 種類が異なるため読み込めない
+	std::stringstream ss1;
+	as1.write(ss1);
+	stable_trie<char32_t> t;
+	BOOST_CHECK(!t.read(ss1));
+	BOOST_CHECK(t.empty());
+
+	// ラベルの大きさが異なるため読み込めない
+	std::stringstream ss2;
+	as1.write(ss2);
+	basic_atom_set<std::u16string> as2;
+	BOOST_CHECK(!as2.read(ss2));
+	BOOST_CHECK(as2.empty());
+}
+
+/*
+アトムIDから文字列を引く表
+
+void use_string_pool(bool enable = true)
+*/
+BOOST_AUTO_TEST_CASE(basic_atom_set__use_string_pool__1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v;
+	for (int i = 0; i < 1000; ++i) v.push_back("atom" + std::to_string(i * 7));
+
+	basic_atom_set<std::string> as;
+	as.use_string_pool();
+	BOOST_CHECK(as.uses_string_pool());
+	for (auto const& s : v) as.insert(s);
+
+	// 挿入済みの文字列を再び挿入しても変わらない
+	std::uint32_t id = as.insert(v[10]);
+	BOOST_CHECK(as.at(id).view() == v[10]);
+
+	// 削除と再挿入を繰り返し、詰め直しを起こす
+	for (int j = 0; j < 3; ++j)
+	{
+		for (std::size_t i = 0; i < v.size(); i += 2) as.erase(v[i]);
+		for (std::size_t i = 0; i < v.size(); i += 2) BOOST_CHECK(as.at(v[i]).view().empty());
+		for (std::size_t i = 0; i < v.size(); i += 2) as.insert(v[i]);
+	}
+
+	int e = 0;
+	for (auto const& s : v) if (as.at(s).view() != s) ++e;
+	BOOST_CHECK(e == 0);
+
+	// 詰め直した後もIDから引ける
+	for (std::size_t i = 1; i < v.size(); i += 3) as.erase(v[i]);
+	as.compact();
+	e = 0;
+	for (std::size_t i = 0; i < v.size(); ++i)
+	{
+		auto a = as.at(v[i]);
+		if (i % 3 == 1) { if (a) ++e; continue; }
+		if (as.at(static_cast<std::uint32_t>(a)).view() != v[i]) ++e;
+	}
+	BOOST_CHECK(e == 0);
+
+	// 使用をやめても文字列へ変換できる
+	as.use_string_pool(false);
+	BOOST_CHECK(!as.uses_string_pool());
+	BOOST_CHECK(as.string_pool_bytes() == 0);
+	BOOST_CHECK(static_cast<std::string>(as.at(v[0])) == v[0]);
+
+	as.use_string_pool();
+	as.clear();
+	BOOST_CHECK(as.uses_string_pool());
+	BOOST_CHECK(as[v[0]].view() == v[0]);
+}
+
+BOOST_AUTO_TEST_CASE(basic_atom_set__use_string_pool__2)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v1{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	auto as1 = basic_atom_set<std::u32string>(v1.begin(), v1.end());
+
+	// 入力した後、表が作り直される
+	basic_atom_set<std::u32string> as2;
+	as2.use_string_pool();
+	std::stringstream ss1;
+	as1.write(ss1);
+	BOOST_CHECK(as2.read(ss1));
+	for (auto const& s : v1) BOOST_CHECK(as2.at(s).view() == s);
+
+	basic_atom_set<std::u32string> as3;
+	as3.use_string_pool();
+	std::stringstream ss2;
+	ss2 << as1;
+	ss2 >> as3;
+	for (auto const& s : v1) BOOST_CHECK(as3.at(s).view() == s);
+
+	auto v2 = std::vector<std::uint32_t>(as1.ibegin(), as1.iend());
+	basic_atom_set<std::u32string> as4;
+	as4.use_string_pool();
+	as4.assign(v2.begin(), v2.end());
+	for (auto const& s : v1) BOOST_CHECK(as4.at(s).view() == s);
+
+	as4.swap(as1);
+	BOOST_CHECK(as1.uses_string_pool());
+	BOOST_CHECK(!as4.uses_string_pool());
+	BOOST_CHECK(as1.at(U"うあい").view() == U"うあい");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,164 @@
+﻿// test/string/concurrent_atom.cpp
+
+#include <boost/test/unit_test.hpp>
+
+#include <wordring/string/concurrent_atom.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(concurrent_atom__test)
+
+/*
+IDは登録順の連番で、公開の前後で変わらない
+
+reader::insert(view_type sv)
+reader::find(view_type sv)
+view(std::uint32_t id)
+*/
+BOOST_AUTO_TEST_CASE(basic_concurrent_atom_set__insert__1)
+{
+	using namespace wordring;
+
+	concurrent_atom_set<std::string> as;
+	auto r = as.get_reader();
+
+	BOOST_CHECK(r.insert("div") == 1);
+	BOOST_CHECK(r.insert("span") == 2);
+	BOOST_CHECK(r.insert("div") == 1);
+	BOOST_CHECK(r.insert("") == 0);
+	BOOST_CHECK(as.size() == 2);
+
+	BOOST_CHECK(r.find("span") == 2);
+	BOOST_CHECK(r.find("p") == 0);
+	BOOST_CHECK(r.find("") == 0);
+
+	BOOST_CHECK(as.view(1) == "div");
+	BOOST_CHECK(as.view(2) == "span");
+	BOOST_CHECK(as.view(0).empty());
+	BOOST_CHECK(as.view(3).empty());
+
+	as.commit();
+	BOOST_CHECK(r.find("div") == 1);
+	BOOST_CHECK(r.insert("span") == 2);
+	BOOST_CHECK(r.insert("p") == 3);
+	BOOST_CHECK(as.view(3) == "p");
+}
+
+/*
+区画と自動公開をまたいで登録する
+*/
+BOOST_AUTO_TEST_CASE(basic_concurrent_atom_set__insert__2)
+{
+	using namespace wordring;
+
+	u32concurrent_atom_set<> as;
+	auto r = as.get_reader();
+
+	std::vector<std::u32string> v;
+	for (char32_t i = 0; i < 5000; ++i) v.push_back(std::u32string(U"あ") + i + U'い' + static_cast<char32_t>(i * 7));
+
+	for (std::uint32_t i = 0; i < v.size(); ++i) BOOST_REQUIRE(r.insert(v[i]) == i + 1);
+	BOOST_CHECK(as.size() == v.size());
+
+	int e = 0;
+	for (std::uint32_t i = 0; i < v.size(); ++i)
+	{
+		if (r.find(v[i]) != i + 1) ++e;
+		if (as.view(i + 1) != v[i]) ++e;
+	}
+	BOOST_CHECK(e == 0);
+}
+
+/*
+IDが葉の値に収まらない場合、登録数と区画を変えずに std::length_error を投げる
+*/
+BOOST_AUTO_TEST_CASE(basic_concurrent_atom_set__insert__3)
+{
+	using namespace wordring;
+
+	struct test_set : basic_concurrent_atom_set<std::string, std::allocator<detail::trie_node16>>
+	{
+		using basic_concurrent_atom_set::m_size;
+		using basic_concurrent_atom_set::m_segments;
+		using basic_concurrent_atom_set::m_pending;
+	};
+
+	test_set as;
+	auto r = as.get_reader();
+
+	// 葉の値は INDEX の型の正の範囲に限られる
+	std::uint32_t const max = std::numeric_limits<std::int16_t>::max();
+	as.m_size = max;
+
+	BOOST_CHECK_THROW(r.insert("div"), std::length_error);
+	BOOST_CHECK(as.size() == max);
+	BOOST_CHECK(as.m_segments[std::bit_width(max + 1) - 1].load() == nullptr);
+	BOOST_CHECK(as.m_pending.empty());
+	BOOST_CHECK(r.find("div") == 0);
+
+	as.commit();
+	BOOST_CHECK(r.find("div") == 0);
+}
+
+/*
+複数のスレッドから同じ文字列群を異なる順序で登録すると、どのスレッドも同じIDを得る
+*/
+BOOST_AUTO_TEST_CASE(basic_concurrent_atom_set__threads__1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v;
+	for (int i = 0; i < 3000; ++i) v.push_back("name" + std::to_string(i));
+
+	concurrent_atom_set<std::string> as;
+
+	std::size_t const n = 8;
+	std::vector<std::vector<std::uint32_t>> ids(n, std::vector<std::uint32_t>(v.size()));
+	std::atomic<int> error = 0;
+
+	auto fn = [&](std::size_t k)
+	{
+		auto r = as.get_reader();
+
+		std::vector<std::size_t> order(v.size());
+		for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+		std::shuffle(order.begin(), order.end(), std::mt19937(static_cast<std::uint32_t>(k)));
+
+		for (std::size_t i : order)
+		{
+			std::uint32_t id = r.insert(v[i]);
+			ids[k][i] = id;
+			if (as.view(id) != v[i]) ++error;
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (std::size_t k = 0; k < n; ++k) threads.emplace_back(fn, k);
+	for (auto& th : threads) th.join();
+
+	BOOST_CHECK(error == 0);
+	BOOST_CHECK(as.size() == v.size());
+
+	for (std::size_t k = 1; k < n; ++k) BOOST_CHECK(ids[k] == ids[0]);
+
+	std::vector<std::uint32_t> sorted = ids[0];
+	std::sort(sorted.begin(), sorted.end());
+	for (std::uint32_t i = 0; i < sorted.size(); ++i) BOOST_CHECK(sorted[i] == i + 1);
+
+	as.commit();
+	auto r = as.get_reader();
+	int e = 0;
+	for (std::size_t i = 0; i < v.size(); ++i) if (r.find(v[i]) != ids[0][i]) ++e;
+	BOOST_CHECK(e == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,6 +5,7 @@
 #include <wordring/string/matcher.hpp>
 
 #include <string>
+#include <vector>
 
 namespace
 {
@@ -29,6 +30,14 @@ BOOST_AUTO_TEST_CASE(string_matcher_construct_1)
 	BOOST_CHECK(tm.m_c.size() == 2);
 }
 
+BOOST_AUTO_TEST_CASE(string_matcher_construct_2)
+{
+	std::vector<std::string> v{ "ABB", "ABC", "B" };
+	test_matcher tm(v.begin(), v.end());
+	BOOST_CHECK(tm.m_c.size() == 3);
+	BOOST_CHECK(tm.push_back('B') == test_matcher::match_result::succeed);
+}
+
 BOOST_AUTO_TEST_CASE(string_matcher_data_1)
 {
 	test_matcher tm({ "ABC", "ABB" });
@@ -0,0 +1,173 @@
+﻿// test/trie/aho_corasick.cpp
+
+#include <boost/test/unit_test.hpp>
+
+#include <wordring/trie/aho_corasick.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+	using result_type = std::tuple<std::size_t, std::size_t, std::uint32_t>;
+
+	/*! 全ての位置で全てのパターンを比較する素朴な照合
+	- 終了位置の昇順、同じ終了位置では長い順に並べる。
+	*/
+	template <typename String>
+	std::vector<result_type> naive(std::vector<String> const& patterns, String const& s)
+	{
+		std::vector<result_type> result;
+		for (std::size_t end = 1; end <= s.size(); ++end)
+		{
+			std::vector<result_type> v;
+			for (std::uint32_t i = 0; i < patterns.size(); ++i)
+			{
+				String const& p = patterns[i];
+				if (p.empty() || end < p.size() || s.compare(end - p.size(), p.size(), p) != 0) continue;
+				if (std::find(patterns.begin(), patterns.begin() + i, p) != patterns.begin() + i) continue;
+				v.emplace_back(end - p.size(), p.size(), i);
+			}
+			std::sort(v.begin(), v.end());
+			result.insert(result.end(), v.begin(), v.end());
+		}
+		return result;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(aho_corasick_test)
+
+// basic_aho_corasick(ForwardIterator first, ForwardIterator last, allocator_type const& alloc = allocator_type())
+BOOST_AUTO_TEST_CASE(aho_corasick_construct_1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v{ "she", "he", "", "his", "hers", "he" };
+	auto ac = aho_corasick<char>(v.begin(), v.end());
+
+	BOOST_CHECK(ac.size() == 4);
+	BOOST_CHECK(ac.contains(std::string("hers")));
+	BOOST_CHECK(ac.contains(std::string("her")) == false);
+
+	auto ac2 = aho_corasick<char>({ "a", "ab" });
+	BOOST_CHECK(ac2.size() == 2);
+
+	aho_corasick<char> ac3;
+	BOOST_CHECK(ac3.empty());
+	std::vector<result_type> result;
+	ac3.scan(std::string("abc"), std::back_inserter(result));
+	BOOST_CHECK(result.empty());
+}
+
+// basic_aho_corasick(trie_type const& trie)
+BOOST_AUTO_TEST_CASE(aho_corasick_construct_2)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v{ U"あい", U"い" };
+	auto t = trie<char32_t>(v.begin(), v.end());
+	t[std::u32string(U"あい")] = 10;
+	t[std::u32string(U"い")] = 20;
+
+	auto ac = aho_corasick<char32_t>(t);
+
+	std::vector<result_type> result;
+	ac.scan(std::u32string(U"うあい"), std::back_inserter(result));
+	BOOST_CHECK(result == std::vector<result_type>({ { 1, 2, 10 }, { 2, 1, 20 } }));
+}
+
+// scan(InputIterator first, InputIterator last, OutputIterator out) const
+BOOST_AUTO_TEST_CASE(aho_corasick_scan_1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v{ "he", "she", "his", "hers" };
+	auto ac = aho_corasick<char>(v.begin(), v.end());
+
+	std::string s{ "ushers" };
+	std::vector<result_type> result;
+	ac.scan(s.begin(), s.end(), std::back_inserter(result));
+
+	BOOST_CHECK(result == std::vector<result_type>({ { 1, 3, 1 }, { 2, 2, 0 }, { 2, 4, 3 } }));
+	BOOST_CHECK(result == naive(v, s));
+}
+
+// 多バイトのラベルでは、文字の途中から始まる一致を報告しない
+BOOST_AUTO_TEST_CASE(aho_corasick_scan_2)
+{
+	using namespace wordring;
+
+	std::vector<std::u16string> v{ u"ā", u"Ăā", u"ȁ" };
+	auto ac = aho_corasick<char16_t>(v.begin(), v.end());
+
+	// 0x01 0x02 0x01 0x01 のバイト列に 0x0201 は現れるが、文字としては一致しない
+	std::u16string s{ u"Ăā" };
+	std::vector<result_type> result;
+	ac.scan(s, std::back_inserter(result));
+
+	BOOST_CHECK(result == naive(v, s));
+	BOOST_CHECK(result.size() == 2);
+}
+
+// 乱数で生成したパターンと文字列を素朴な照合と比較する
+BOOST_AUTO_TEST_CASE(aho_corasick_scan_3)
+{
+	using namespace wordring;
+
+	std::mt19937 mt;
+	auto random_string = [&](std::size_t max, char32_t alphabet)
+	{
+		std::u32string s(mt() % max + 1, U'\0');
+		for (char32_t& ch : s) ch = U'あ' + static_cast<char32_t>(mt() % alphabet);
+		return s;
+	};
+
+	for (int n = 0; n < 20; ++n)
+	{
+		std::vector<std::u32string> v;
+		for (int i = 0; i < 50; ++i) v.push_back(random_string(6, 3));
+		auto ac = aho_corasick<char32_t>(v.begin(), v.end());
+
+		std::u32string s = random_string(300, 4);
+		std::vector<result_type> result;
+		ac.scan(s, std::back_inserter(result));
+
+		BOOST_CHECK(result == naive(v, s));
+	}
+}
+
+// matcher
+BOOST_AUTO_TEST_CASE(aho_corasick_matcher_1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v{ "he", "she", "his", "hers" };
+	auto ac = aho_corasick<char>(v.begin(), v.end());
+
+	auto m = ac.get_matcher();
+	BOOST_CHECK(m.push_back('u') == false);
+	BOOST_CHECK(m.push_back('s') == false);
+	BOOST_CHECK(m.push_back('h') == false);
+	BOOST_CHECK(m.push_back('e'));
+	BOOST_CHECK(m.longest() == std::make_pair(std::size_t(3), std::uint32_t(1)));
+
+	std::vector<aho_corasick<char>::match_type> result;
+	m.matches(std::back_inserter(result));
+	BOOST_CHECK(result == std::vector<aho_corasick<char>::match_type>({ { 3, 1 }, { 2, 0 } }));
+
+	BOOST_CHECK(m.push_back('r') == false);
+	BOOST_CHECK(m.longest() == std::make_pair(std::size_t(0), std::uint32_t(0)));
+	BOOST_CHECK(m.push_back('s'));
+	BOOST_CHECK(m.longest() == std::make_pair(std::size_t(4), std::uint32_t(3)));
+	BOOST_CHECK(m.size() == 6);
+
+	m.clear();
+	BOOST_CHECK(m.size() == 0);
+	BOOST_CHECK(m.push_back('e') == false);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
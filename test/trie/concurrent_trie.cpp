@@ -0,0 +1,147 @@
+﻿// test/trie/concurrent_trie.cpp
+
+#include <boost/test/unit_test.hpp>
+
+#include <wordring/trie/concurrent_trie.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	template <typename Trie>
+	class test_concurrent_trie : public Trie
+	{
+	public:
+		using base_type = Trie;
+
+		using base_type::m_retired;
+		using base_type::m_slots;
+	};
+}
+
+BOOST_AUTO_TEST_SUITE(concurrent_trie_test)
+
+// insert(), erase(), commit()
+BOOST_AUTO_TEST_CASE(concurrent_trie__commit__1)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い" };
+	auto t = concurrent_trie<char32_t>(v.begin(), v.end());
+	auto r = t.get_reader();
+
+	t.insert(std::u32string(U"うえ"), 5);
+	t.erase(std::u32string(U"い"));
+	t.insert(std::u32string(U"あ"), 3);
+	BOOST_CHECK(t.pending() == 3);
+
+	// commit() まで見えない
+	{
+		auto s = r.pin();
+		BOOST_CHECK(s->contains(std::u32string(U"い")));
+		BOOST_CHECK(!s->contains(std::u32string(U"うえ")));
+	}
+
+	t.commit();
+	BOOST_CHECK(t.pending() == 0);
+	BOOST_CHECK(t.version() == 1);
+
+	auto s = r.pin();
+	BOOST_CHECK(s->size() == 3);
+	BOOST_CHECK(!s->contains(std::u32string(U"い")));
+	BOOST_CHECK(s->at(std::u32string(U"うえ")) == 5);
+	BOOST_CHECK(s->at(std::u32string(U"あ")) == 3);
+}
+
+// reader, snapshot, reclaim()
+BOOST_AUTO_TEST_CASE(concurrent_trie__snapshot__1)
+{
+	using namespace wordring;
+
+	auto t = test_concurrent_trie<stable_concurrent_trie<char>>();
+	auto r1 = t.get_reader();
+	auto r2 = t.get_reader();
+
+	t.insert(std::string("a"));
+	t.commit();
+
+	// 固定中の版は、公開が進んでも変わらず、解放もされない
+	auto s1 = r1.pin();
+	t.insert(std::string("b"));
+	t.commit();
+	BOOST_CHECK(t.m_retired.size() == 1);
+
+	BOOST_CHECK(s1->contains(std::string("a")));
+	BOOST_CHECK(!s1->contains(std::string("b")));
+	{
+		auto s2 = r2.pin();
+		BOOST_CHECK(s2->contains(std::string("b")));
+	}
+
+	{
+		auto s = std::move(s1);
+	}
+	BOOST_CHECK(t.reclaim() == 0);
+
+	// 枠は再利用される
+	std::size_t n = 0;
+	{
+		auto r3 = std::move(r1);
+	}
+	auto r4 = t.get_reader();
+	for (auto p = t.m_slots.load(); p != nullptr; p = p->m_next) ++n;
+	BOOST_CHECK(n == 2);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_trie__threads__1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v;
+	for (int i = 0; i < 1000; ++i) v.push_back("key" + std::to_string(i));
+
+	auto t = concurrent_trie<char>(v.begin(), v.end());
+
+	std::atomic<bool> done = false;
+	std::atomic<int> error = 0;
+
+	auto fn = [&]()
+	{
+		auto r = t.get_reader();
+		std::uint64_t version = 0;
+		while (!done)
+		{
+			auto s = r.pin();
+			// 初期のキーは常に見え、追加されるキーは常に連番の接頭部分を成す
+			for (auto const& k : v) if (!s->contains(k)) ++error;
+
+			std::size_t n = s->size() - v.size();
+			if (n != 0 && !s->contains("new" + std::to_string(n - 1))) ++error;
+			if (s->contains("new" + std::to_string(n))) ++error;
+
+			if (t.version() < version) ++error;
+			version = t.version();
+		}
+	};
+
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 4; ++i) readers.emplace_back(fn);
+
+	for (int i = 0; i < 200; ++i)
+	{
+		t.insert("new" + std::to_string(i));
+		t.commit();
+	}
+
+	done = true;
+	for (auto& th : readers) th.join();
+
+	BOOST_CHECK(error == 0);
+	BOOST_CHECK(t.version() == 200);
+	BOOST_CHECK(t.reclaim() == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,220 @@
+﻿// test/trie/dawg.cpp
+
+#include <boost/test/unit_test.hpp>
+
+#include <wordring/tree/tree_iterator.hpp>
+#include <wordring/trie/dawg.hpp>
+#include <wordring/trie/trie.hpp>
+
+#include <wordring/whatwg/infra/unicode.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define STRING(str) #str
+#define TO_STRING(str) STRING(str)
+
+namespace
+{
+	std::string const japanese_words_path{ TO_STRING(JAPANESE_WORDS_PATH) };
+	std::string const english_words_path{ TO_STRING(ENGLISH_WORDS_PATH) };
+
+	/*! 葉から復元した文字列の集合を返す
+	*/
+	template <typename String, typename Trie>
+	std::set<String> strings(Trie const& t)
+	{
+		using namespace wordring;
+		std::set<String> result;
+
+		auto it1 = tree_iterator<decltype(t.begin())>(t.begin());
+		auto it2 = tree_iterator<decltype(t.begin())>();
+
+		String s;
+		while (it1 != it2)
+		{
+			if (it1.base())
+			{
+				it1.base().string(s);
+				result.insert(s);
+			}
+			++it1;
+		}
+
+		return result;
+	}
+
+	template <typename Trie>
+	std::size_t nodes(Trie const& t)
+	{
+		std::vector<std::int32_t> v(t.ibegin(), t.iend());
+		std::size_t n = 0;
+		for (std::size_t i = 3; i < v.size(); i += 2) if (0 < v[i]) ++n;
+		return n;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(dawg_test)
+
+// basic_dawg(ForwardIterator first, ForwardIterator last, allocator_type const& alloc = allocator_type())
+BOOST_AUTO_TEST_CASE(dawg_construct_1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v{ "walking", "cooking", "look", "looking", "taking", "cooking", "" };
+	auto d = dawg<char>(v.begin(), v.end());
+
+	BOOST_CHECK(d.size() == 5);
+	BOOST_CHECK(d.contains(std::string("walking")));
+	BOOST_CHECK(d.contains(std::string("cooking")));
+	BOOST_CHECK(d.contains(std::string("look")));
+	BOOST_CHECK(d.contains(std::string("looking")));
+	BOOST_CHECK(d.contains(std::string("taking")));
+	BOOST_CHECK(d.contains(std::string("king")) == false);
+	BOOST_CHECK(d.contains(std::string("cook")) == false);
+	BOOST_CHECK(d.contains(std::string("walk")) == false);
+	BOOST_CHECK(d.contains(std::string("lookingg")) == false);
+
+	// 「-ing」は共有される
+	auto t = trie<char>(v.begin(), v.end());
+	BOOST_CHECK(nodes(d) < nodes(t));
+
+	dawg<char> d2;
+	BOOST_CHECK(d2.empty());
+	BOOST_CHECK(d2.contains(std::string("a")) == false);
+	BOOST_CHECK(d2.begin().begin() == d2.begin().end());
+}
+
+// const_iterator
+BOOST_AUTO_TEST_CASE(dawg_iterator_1)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v{ U"たべる", U"たべない", U"のべる", U"のべない", U"の" };
+	auto d = dawg<char32_t>(v.begin(), v.end());
+
+	auto it = d.begin()[U'の'];
+	BOOST_CHECK(*it == U'の');
+	BOOST_CHECK(it);
+	BOOST_CHECK(*it[U'べ'] == U'べ');
+	BOOST_CHECK(it[U'べ'].parent() == it);
+	BOOST_CHECK(it[U'か'] == d.end());
+	BOOST_CHECK(it.parent() == d.begin());
+
+	// 共有された部分木でも、経路に沿ってラベル列を復元する
+	std::u32string s;
+	d.search(std::u32string(U"たべな")).string(s);
+	BOOST_CHECK(s == U"たべな");
+	d.search(std::u32string(U"のべな")).string(s);
+	BOOST_CHECK(s == U"のべな");
+
+	BOOST_CHECK(strings<std::u32string>(d) == std::set<std::u32string>(v.begin(), v.end()));
+
+	std::set<char32_t> children;
+	for (auto it1 = d.begin().begin(); it1 != d.begin().end(); ++it1) children.insert(*it1);
+	BOOST_CHECK(children == std::set<char32_t>({ U'た', U'の' }));
+}
+
+// lookup(), search(), find()
+BOOST_AUTO_TEST_CASE(dawg_lookup_1)
+{
+	using namespace wordring;
+
+	std::vector<std::u16string> v{ u"あ", u"あう", u"い", u"うあい", u"うえ" };
+	auto d = dawg<char16_t>(v.begin(), v.end());
+
+	std::u16string s1(u"うあか");
+	auto pair = d.lookup(s1.begin(), s1.end());
+	BOOST_CHECK(*pair.first == u'あ');
+	BOOST_CHECK(pair.second == s1.begin() + 2);
+
+	BOOST_CHECK(d.search(std::u16string(u"うあ")) != d.end());
+	BOOST_CHECK(d.search(std::u16string(u"うか")) == d.end());
+	BOOST_CHECK(d.find(std::u16string(u"うあ")) == d.end());
+	BOOST_CHECK(d.find(std::u16string(u"うあい")) != d.end());
+	BOOST_CHECK(d.find(std::u16string(u"あ")));
+}
+
+// operator<<, operator>>, assign(InputIterator first, InputIterator last)
+BOOST_AUTO_TEST_CASE(dawg_stream_1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v{ "cooking", "looking", "taking", "walking" };
+	auto d1 = dawg<char>(v.begin(), v.end());
+
+	std::stringstream ss;
+	ss << d1;
+
+	dawg<char> d2;
+	ss >> d2;
+
+	BOOST_CHECK(std::equal(d1.ibegin(), d1.iend(), d2.ibegin(), d2.iend()));
+	for (auto const& s : v) BOOST_CHECK(d2.contains(s));
+
+	std::vector<std::int32_t> buf(d1.ibegin(), d1.iend());
+	auto d3 = dawg<char>(buf.begin(), buf.end());
+	BOOST_CHECK(strings<std::string>(d3) == std::set<std::string>(v.begin(), v.end()));
+}
+
+BOOST_AUTO_TEST_CASE(dawg_stress_1)
+{
+	using wordring::whatwg::encoding_cast;
+
+	std::ifstream is(japanese_words_path);
+	BOOST_REQUIRE(is.is_open());
+
+	std::vector<std::u32string> w;
+	std::string buf{};
+#ifdef NDEBUG
+	while (std::getline(is, buf)) w.push_back(encoding_cast<std::u32string>(buf));
+#else
+	for (size_t i = 0; i < 1000 && std::getline(is, buf); ++i) w.push_back(encoding_cast<std::u32string>(buf));
+#endif
+
+	auto d = wordring::dawg<char32_t>(w.begin(), w.end());
+
+	std::sort(w.begin(), w.end());
+	w.erase(std::unique(w.begin(), w.end()), w.end());
+	auto t = wordring::trie<char32_t>(w.begin(), w.end());
+
+	BOOST_CHECK(d.size() == w.size());
+
+	int e = 0;
+	for (auto const& s : w) if (!d.contains(s)) ++e;
+	for (auto const& s : w) if (d.contains(s + U'ー') != t.contains(s + U'ー')) ++e;
+	BOOST_CHECK(e == 0);
+
+	BOOST_CHECK(strings<std::u32string>(d) == std::set<std::u32string>(w.begin(), w.end()));
+	BOOST_CHECK(nodes(d) < nodes(t));
+}
+
+BOOST_AUTO_TEST_CASE(dawg_stress_2)
+{
+	std::ifstream is(english_words_path);
+	BOOST_REQUIRE(is.is_open());
+
+	std::vector<std::string> w;
+	std::string buf{};
+	while (std::getline(is, buf)) if (!buf.empty()) w.push_back(buf);
+
+	auto d = wordring::dawg<char>(w.begin(), w.end());
+
+	std::sort(w.begin(), w.end());
+	w.erase(std::unique(w.begin(), w.end()), w.end());
+	auto t = wordring::trie<char>(w.begin(), w.end());
+
+	int e = 0;
+	for (auto const& s : w) if (!d.contains(s)) ++e;
+	for (auto const& s : w) if (d.contains(s + "s") != t.contains(s + "s")) ++e;
+	BOOST_CHECK(e == 0);
+
+	BOOST_CHECK(d.size() == w.size());
+	BOOST_CHECK(nodes(d) < nodes(t));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
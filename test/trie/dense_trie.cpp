@@ -0,0 +1,309 @@
+﻿// test/trie/dense_trie.cpp
+
+#include <boost/test/unit_test.hpp>
+
+#include <wordring/tree/tree_iterator.hpp>
+#include <wordring/trie/dense_trie.hpp>
+#include <wordring/trie/trie.hpp>
+
+#include <wordring/whatwg/infra/unicode.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define STRING(str) #str
+#define TO_STRING(str) STRING(str)
+
+namespace
+{
+	std::string const japanese_words_path{ TO_STRING(JAPANESE_WORDS_PATH) };
+
+	template <typename Trie>
+	class test_dense_trie : public Trie
+	{
+	public:
+		using base_type = Trie;
+
+		using base_type::begin;
+
+		using base_type::m_c;
+
+	public:
+		/*! 葉から復元した文字列の集合を返す
+		*/
+		template <typename String>
+		std::set<String> strings() const
+		{
+			using namespace wordring;
+			std::set<String> result;
+
+			auto it1 = tree_iterator<decltype(begin())>(begin());
+			auto it2 = tree_iterator<decltype(begin())>();
+
+			String s;
+			while (it1 != it2)
+			{
+				if (it1.base())
+				{
+					it1.base().string(s);
+					result.insert(s);
+				}
+				++it1;
+			}
+
+			return result;
+		}
+
+		/*! 使用中のノード数を返す
+		*/
+		std::size_t nodes() const
+		{
+			return std::count_if(m_c.begin() + 1, m_c.end(), [](auto const& node) { return 0 < node.m_check; });
+		}
+	};
+
+	template <typename Trie>
+	std::size_t nodes(Trie const& t)
+	{
+		std::vector<std::int32_t> v(t.ibegin(), t.iend());
+		std::size_t n = 0;
+		for (std::size_t i = 3; i < v.size(); i += 2) if (0 < v[i]) ++n;
+		return n;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(dense_trie_test)
+
+// trie_label_map
+BOOST_AUTO_TEST_CASE(trie_label_map_1)
+{
+	using namespace wordring::detail;
+
+	std::vector<std::u32string> v{ U"あい", U"い", U"いう", U"え" };
+	trie_label_map<char32_t> m;
+	m.assign(v.begin(), v.end());
+
+	BOOST_CHECK(m.size() == 4);
+	BOOST_CHECK(m.labels()[0] == U'い');
+	BOOST_CHECK(m.labels()[1] == U'あ');
+
+	std::uint8_t code[trie_label_map<char32_t>::max_length];
+	BOOST_CHECK(m.encode(U'い', code) == 1);
+	BOOST_CHECK(code[0] == 0);
+	BOOST_CHECK(m.decode(code, 1) == U'い');
+
+	for (char32_t ch : { U'か', char32_t(0), char32_t(0x10FFFF), char32_t(0xFFFFFFFF) })
+	{
+		std::uint32_t n = m.encode(ch, code);
+		BOOST_CHECK(n == trie_label_map<char32_t>::max_length);
+		BOOST_CHECK(code[0] == 0xFF);
+		BOOST_CHECK(std::all_of(code + 1, code + n, [](std::uint8_t c) { return c < 0xC0; }));
+		BOOST_CHECK(m.decode(code, n) == ch);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(trie_label_map_2)
+{
+	using namespace wordring::detail;
+
+	std::vector<char16_t> labels;
+	for (char16_t ch = 0x4E00; ch < 0x4E00 + 1000; ++ch) labels.push_back(ch);
+
+	trie_label_map<char16_t> m;
+	m.assign_labels(labels.begin(), labels.end());
+	BOOST_CHECK(m.labels() == labels);
+
+	std::uint8_t code[trie_label_map<char16_t>::max_length];
+	for (std::size_t i = 0; i < labels.size(); ++i)
+	{
+		std::uint32_t n = m.encode(labels[i], code);
+		BOOST_CHECK(n == (i < 192 ? 1 : 2));
+		BOOST_CHECK(m.decode(code, n) == labels[i]);
+	}
+}
+
+// basic_dense_trie(ForwardIterator first, ForwardIterator last, allocator_type const& alloc = allocator_type())
+BOOST_AUTO_TEST_CASE(dense_trie_construct_1)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v{ U"うえ", U"あ", U"い", U"あう", U"うあい", U"あ", U"" };
+	auto t = dense_trie<char32_t>(v.begin(), v.end());
+
+	BOOST_CHECK(t.size() == 5);
+	BOOST_CHECK(t.contains(std::u32string(U"あ")));
+	BOOST_CHECK(t.contains(std::u32string(U"あう")));
+	BOOST_CHECK(t.contains(std::u32string(U"い")));
+	BOOST_CHECK(t.contains(std::u32string(U"うあい")));
+	BOOST_CHECK(t.contains(std::u32string(U"うえ")));
+	BOOST_CHECK(t.contains(std::u32string(U"う")) == false);
+	BOOST_CHECK(t.contains(std::u32string(U"え")) == false);
+}
+
+// const_iterator
+BOOST_AUTO_TEST_CASE(dense_trie_iterator_1)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	auto t = test_dense_trie<dense_trie<char32_t>>();
+	t.assign(v.begin(), v.end());
+
+	auto it = t.begin()[U'う'];
+	BOOST_CHECK(*it == U'う');
+	BOOST_CHECK(!it);
+	BOOST_CHECK(*it[U'あ'] == U'あ');
+	BOOST_CHECK(it[U'あ'].parent() == it);
+	BOOST_CHECK(it[U'か'] == t.end());
+	BOOST_CHECK(it.parent() == t.begin());
+
+	std::u32string s;
+	t.search(std::u32string(U"うあい")).string(s);
+	BOOST_CHECK(s == U"うあい");
+
+	auto w = t.strings<std::u32string>();
+	BOOST_CHECK(w == std::set<std::u32string>(v.begin(), v.end()));
+
+	std::set<char32_t> children;
+	for (auto it1 = t.begin().begin(); it1 != t.begin().end(); ++it1) children.insert(*it1);
+	BOOST_CHECK(children == std::set<char32_t>({ U'あ', U'い', U'う' }));
+}
+
+// insert(), erase()
+BOOST_AUTO_TEST_CASE(dense_trie_insert_1)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	auto t = test_dense_trie<dense_trie<char32_t>>();
+	t.assign(v.begin(), v.end());
+
+	// 写像表に無いラベルを含む
+	std::vector<std::u32string> w{ U"か", U"あか", U"うあいかき", U"\U0010FFFF", U"い\U0010FFFFい" };
+	std::uint32_t i = 100;
+	for (auto const& s : w)
+	{
+		auto it = t.insert(s, i);
+		BOOST_CHECK(*it == s.back());
+		BOOST_CHECK(static_cast<std::uint32_t>(t.at(s)) == i++);
+	}
+	BOOST_CHECK(t.size() == v.size() + w.size());
+
+	v.insert(v.end(), w.begin(), w.end());
+	BOOST_CHECK(t.strings<std::u32string>() == std::set<std::u32string>(v.begin(), v.end()));
+
+	for (auto const& s : v)
+	{
+		t.erase(s);
+		BOOST_CHECK(t.contains(s) == false);
+	}
+	BOOST_CHECK(t.empty());
+}
+
+// lookup()
+BOOST_AUTO_TEST_CASE(dense_trie_lookup_1)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	auto t = dense_trie<char32_t>(v.begin(), v.end());
+	t.insert(std::u32string(U"か\U0010FFFF"));
+
+	std::u32string s1{ U"うい" };
+	auto pair1 = t.lookup(s1.begin(), s1.end());
+	BOOST_CHECK(*pair1.first == U'う');
+	BOOST_CHECK(*pair1.second == U'い');
+
+	// 符号の途中で一致しなくなる
+	std::u32string s2{ U"か\U0010FFFE" };
+	auto pair2 = t.lookup(s2.begin(), s2.end());
+	BOOST_CHECK(*pair2.first == U'か');
+	BOOST_CHECK(*pair2.second == U'\U0010FFFE');
+
+	BOOST_CHECK(t.search(std::u32string(U"うあ")) != t.cend());
+	BOOST_CHECK(t.find(std::u32string(U"うあ")) == t.cend());
+	BOOST_CHECK(t.find(std::u32string(U"か\U0010FFFF")) != t.cend());
+}
+
+// operator<<, operator>>
+BOOST_AUTO_TEST_CASE(dense_trie_stream_1)
+{
+	using namespace wordring;
+
+	std::vector<std::u16string> v{ u"あ", u"あう", u"い", u"うあい", u"うえ" };
+	auto t1 = dense_trie<char16_t>(v.begin(), v.end());
+	t1[std::u16string(u"うえ")] = 5;
+
+	std::stringstream ss;
+	ss << t1;
+
+	dense_trie<char16_t> t2;
+	ss >> t2;
+
+	BOOST_CHECK(t2.label_map().labels() == t1.label_map().labels());
+	BOOST_CHECK(std::equal(t1.ibegin(), t1.iend(), t2.ibegin(), t2.iend()));
+	for (auto const& s : v) BOOST_CHECK(t2.contains(s));
+	BOOST_CHECK(t2.at(std::u16string(u"うえ")) == 5);
+}
+
+// stable_dense_trie
+BOOST_AUTO_TEST_CASE(stable_dense_trie_1)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	auto t = test_dense_trie<stable_dense_trie<char32_t>>();
+	t.assign(v.begin(), v.end());
+	t.insert(std::u32string(U"あうえ"), 3);
+
+	BOOST_CHECK(t.size() == 6);
+	BOOST_CHECK(t.at(std::u32string(U"あうえ")) == 3);
+	BOOST_CHECK(t.find(std::u32string(U"あう")));
+	v.push_back(U"あうえ");
+	BOOST_CHECK(t.strings<std::u32string>() == std::set<std::u32string>(v.begin(), v.end()));
+}
+
+BOOST_AUTO_TEST_CASE(dense_trie_stress_1)
+{
+	using wordring::whatwg::encoding_cast;
+
+	std::ifstream is(japanese_words_path);
+	BOOST_REQUIRE(is.is_open());
+
+	std::vector<std::u32string> w;
+	std::string buf{};
+#ifdef NDEBUG
+	while (std::getline(is, buf)) w.push_back(encoding_cast<std::u32string>(buf));
+#else
+	for (size_t i = 0; i < 1000 && std::getline(is, buf); ++i) w.push_back(encoding_cast<std::u32string>(buf));
+#endif
+
+	auto t1 = test_dense_trie<wordring::dense_trie<char32_t>>();
+	t1.assign(w.begin(), w.end());
+
+	std::uint32_t i = 0;
+	for (auto const& s : w) t1[s] = i++;
+
+	int e = 0;
+	i = 0;
+	for (auto const& s : w)
+	{
+		auto it = t1.find(s);
+		if (it == t1.cend() || static_cast<std::uint32_t>(t1.at(it)) != i++) ++e;
+	}
+	BOOST_CHECK(e == 0);
+	BOOST_CHECK(t1.strings<std::u32string>() == std::set<std::u32string>(w.begin(), w.end()));
+
+	std::sort(w.begin(), w.end());
+	w.erase(std::unique(w.begin(), w.end()), w.end());
+	auto t2 = wordring::trie<char32_t>(w.begin(), w.end());
+
+	BOOST_CHECK(t1.nodes() == nodes(t1));
+	BOOST_CHECK(nodes(t1) * 2 < nodes(t2));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
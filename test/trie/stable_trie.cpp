@@ -324,6 +324,36 @@ BOOST_AUTO_TEST_CASE(stable_trie__assign__9)
 	BOOST_CHECK(trie.contains(std::string("cd")));
 }
 
+// void parallel_assign(ForwardIterator first, ForwardIterator last, std::uint32_t concurrency)
+BOOST_AUTO_TEST_CASE(stable_trie__parallel_assign__1)
+{
+	std::vector<std::string> v{ "a", "ab", "abc", "abd", "b", "bc", "bcd", "bd", "c" };
+	test_trie<char> trie;
+	trie.parallel_assign(v.begin(), v.end(), 8);
+
+	BOOST_CHECK(trie.size() == v.size());
+	BOOST_CHECK(trie.size() == trie.count());
+	for (auto const& s : v) BOOST_CHECK(trie.contains(s));
+	BOOST_CHECK(trie.contains(std::string("bcdd")) == false);
+
+	trie.at(std::string("ab")) = 100;
+	trie.erase(std::string("abc"));
+	BOOST_CHECK(trie.at(std::string("ab")) == 100);
+	BOOST_CHECK(trie.contains(std::string("abc")) == false);
+	BOOST_CHECK(trie.size() == trie.count());
+}
+
+BOOST_AUTO_TEST_CASE(stable_trie__parallel_assign__2)
+{
+	std::vector<std::u16string> v{ u"あ", u"あう", u"い", u"うあい", u"うえ" };
+	test_trie<char16_t> trie;
+	trie.parallel_assign(v.begin(), v.end(), 4);
+
+	BOOST_CHECK(trie.size() == 5);
+	BOOST_CHECK(trie.size() == trie.count());
+	for (auto const& s : v) BOOST_CHECK(trie.contains(s));
+}
+
 // 要素アクセス ----------------------------------------------------------------
 
 // reference at(const_iterator pos)
@@ -1336,6 +1366,89 @@ BOOST_AUTO_TEST_CASE(stable_trie__contains__3)
 	BOOST_CHECK(trie.contains(std::string("")) == false);
 }
 
+// OutputIterator common_prefix_search(InputIterator first, InputIterator last, OutputIterator out) const
+BOOST_AUTO_TEST_CASE(stable_trie__common_prefix_search__1)
+{
+	std::vector<std::u32string> v{ U"あ", U"あう", U"あうえ", U"い", U"うあい", U"うえ" };
+	test_trie<char32_t> trie;
+	trie.assign(v.begin(), v.end());
+	trie[std::u32string(U"あ")] = 1;
+	trie[std::u32string(U"あう")] = 2;
+	trie[std::u32string(U"あうえ")] = 3;
+
+	std::vector<std::pair<std::size_t, std::uint32_t>> result;
+
+	std::u32string s1{ U"あうえお" };
+	trie.common_prefix_search(s1.begin(), s1.end(), std::back_inserter(result));
+	BOOST_CHECK(result == (std::vector<std::pair<std::size_t, std::uint32_t>>{ { 1, 1 }, { 2, 2 }, { 3, 3 } }));
+
+	result.clear();
+	trie.common_prefix_search(std::u32string(U"あい"), std::back_inserter(result));
+	BOOST_CHECK(result == (std::vector<std::pair<std::size_t, std::uint32_t>>{ { 1, 1 } }));
+
+	result.clear();
+	trie.common_prefix_search(std::u32string(U"うあ"), std::back_inserter(result));
+	BOOST_CHECK(result.empty());
+
+	result.clear();
+	trie.common_prefix_search(std::u32string(U""), std::back_inserter(result));
+	BOOST_CHECK(result.empty());
+}
+
+// trie_compact_result compact()
+BOOST_AUTO_TEST_CASE(stable_trie__compact__1)
+{
+	std::vector<std::string> v{ "a", "ac", "b", "cab", "cd", "e", "eab", "ef" };
+	auto t = wordring::stable_trie<char>(v.begin(), v.end());
+
+	// 空遷移先INDEXを保存する
+	std::vector<std::int32_t> id(v.size());
+	for (std::size_t i = 0; i < v.size(); ++i)
+	{
+		t.at(t.find(v[i]), id[i]);
+		t.at(t.find(v[i])) = static_cast<std::int32_t>(i);
+	}
+
+	t.erase(std::string("cab"));
+	t.erase(std::string("eab"));
+
+	auto r = t.compact();
+	BOOST_CHECK(r.m_after <= r.m_before);
+
+	for (std::size_t i = 0; i < v.size(); ++i)
+	{
+		if (v[i] == "cab" || v[i] == "eab")
+		{
+			BOOST_CHECK(t.contains(v[i]) == false);
+			continue;
+		}
+
+		std::int32_t idx = 0;
+		t.at(t.find(v[i]), idx);
+		BOOST_CHECK(r.m_remap[id[i]] == idx);
+		BOOST_CHECK(t.at(v[i]) == static_cast<std::int32_t>(i));
+	}
+}
+
+// OutputIterator find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out) const
+BOOST_AUTO_TEST_CASE(stable_trie__find_batch__1)
+{
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	test_trie<char32_t> trie;
+	trie.assign(v.begin(), v.end());
+
+	std::vector<std::u32string> keys{ U"あう", U"うあ", U"", U"え", U"うえ", U"あ" };
+	std::vector<test_trie<char32_t>::const_iterator> result;
+	trie.find_batch(keys.begin(), keys.end(), std::back_inserter(result));
+
+	BOOST_REQUIRE(result.size() == keys.size());
+	for (std::size_t i = 0; i < keys.size(); ++i) BOOST_CHECK(result[i] == trie.find(keys[i]));
+
+	std::vector<char> found;
+	trie.contains_batch(keys.begin(), keys.end(), std::back_inserter(found));
+	BOOST_CHECK(found == std::vector<char>({ 1, 0, 0, 0, 1, 1 }));
+}
+
 // 関数 -----------------------------------------------------------------------
 
 // inline std::ostream& operator<<(std::ostream& os, basic_trie<Label1, Base1> const& trie)
@@ -0,0 +1,347 @@
+﻿// test/trie/tail_trie_base.cpp
+
+#include <boost/test/unit_test.hpp>
+
+#include <wordring/tree/tree_iterator.hpp>
+#include <wordring/trie/tail_trie_base.hpp>
+#include <wordring/trie/trie.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <list>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define STRING(str) #str
+#define TO_STRING(str) STRING(str)
+
+namespace
+{
+	std::string const english_words_path{ TO_STRING(ENGLISH_WORDS_PATH) };
+
+	class test_tail_trie : public wordring::tail_trie<>
+	{
+	public:
+		using base_type = wordring::tail_trie<>;
+
+		using base_type::m_c;
+		using base_type::m_garbage;
+
+	public:
+		/*! 葉から復元した文字列の集合を返す
+		*/
+		std::set<std::string> strings() const
+		{
+			using namespace wordring;
+			std::set<std::string> result;
+
+			auto it1 = tree_iterator<const_iterator>(begin());
+			auto it2 = tree_iterator<const_iterator>();
+
+			std::string s;
+			while (it1 != it2)
+			{
+				if (it1.base())
+				{
+					it1.base().string(s);
+					result.insert(s);
+				}
+				++it1;
+			}
+
+			return result;
+		}
+
+		/*! 使用中のノード数を返す
+		*/
+		std::size_t nodes() const
+		{
+			return std::count_if(m_c.begin() + 2, m_c.end(), [](auto const& node) { return 0 < node.m_check; });
+		}
+	};
+
+	std::vector<std::string> english_words()
+	{
+		std::ifstream is(english_words_path);
+		BOOST_REQUIRE(is.is_open());
+
+		std::vector<std::string> w;
+		std::string buf{};
+#ifdef NDEBUG
+		while (std::getline(is, buf)) w.push_back(buf);
+#else
+		for (size_t i = 0; i < 2000 && std::getline(is, buf); ++i) w.push_back(buf);
+#endif
+		return w;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(tail_trie_base_test)
+
+// tail_trie_base(ForwardIterator first, ForwardIterator last, allocator_type const& alloc = allocator_type())
+BOOST_AUTO_TEST_CASE(tail_trie_base__construct__1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v{ "a", "ac", "b", "cab", "cd", "" };
+	std::sort(v.begin(), v.end());
+	auto t = test_tail_trie();
+	t.assign(v.begin(), v.end());
+
+	BOOST_CHECK(t.size() == 5);
+	BOOST_CHECK(t.contains(std::string("a")));
+	BOOST_CHECK(t.contains(std::string("ac")));
+	BOOST_CHECK(t.contains(std::string("b")));
+	BOOST_CHECK(t.contains(std::string("cab")));
+	BOOST_CHECK(t.contains(std::string("cd")));
+	BOOST_CHECK(t.contains(std::string("c")) == false);
+	BOOST_CHECK(t.contains(std::string("ca")) == false);
+	BOOST_CHECK(t.contains(std::string("cabc")) == false);
+	BOOST_CHECK(t.contains(std::string("")) == false);
+
+	// 「cab」の「b」は接尾辞配列に格納される
+	BOOST_CHECK(t.nodes() == 7);
+	BOOST_CHECK(t.strings() == std::set<std::string>({ "a", "ac", "b", "cab", "cd" }));
+}
+
+// const_iterator
+BOOST_AUTO_TEST_CASE(tail_trie_base__iterator__1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v{ "a", "ac", "b", "cab", "cd" };
+	auto t = tail_trie<>(v.begin(), v.end());
+
+	auto it = t.begin()['c']['a'];
+	BOOST_CHECK(*it == 'a');
+	BOOST_CHECK(!it);
+	BOOST_CHECK(it['b']);
+	BOOST_CHECK(*it['b'] == 'b');
+	BOOST_CHECK(it['b'].parent() == it);
+	BOOST_CHECK(it['c'] == t.end());
+	BOOST_CHECK(*it.begin() == 'b');
+	BOOST_CHECK(it.begin().begin() == t.end());
+	BOOST_CHECK(it.parent().parent() == t.begin());
+
+	std::string s;
+	it['b'].string(s);
+	BOOST_CHECK(s == "cab");
+
+	BOOST_CHECK(t.search(std::string("ca")) == it);
+	BOOST_CHECK(t.search(std::string("cb")) == t.cend());
+	BOOST_CHECK(t.find(std::string("cab")) == it['b']);
+}
+
+// lookup()
+BOOST_AUTO_TEST_CASE(tail_trie_base__lookup__1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v{ "abcde", "b" };
+	auto t = tail_trie<>(v.begin(), v.end());
+
+	std::string s{ "abcx" };
+	auto pair = t.lookup(s.begin(), s.end());
+	BOOST_CHECK(*pair.first == 'c');
+	BOOST_CHECK(*pair.second == 'x');
+
+	std::list<char> l{ 'a', 'b', 'c', 'd', 'e' };
+	BOOST_CHECK(t.find(l.begin(), l.end()) == t.find(std::string("abcde")));
+	BOOST_CHECK(t.contains(std::string("abcdef")) == false);
+	BOOST_CHECK(t.contains(std::string("abcd")) == false);
+}
+
+// insert(), at()
+BOOST_AUTO_TEST_CASE(tail_trie_base__insert__1)
+{
+	using namespace wordring;
+
+	auto t = test_tail_trie();
+
+	t.insert(std::string("abcde"), 1);
+	BOOST_CHECK(t.nodes() == 1);
+	BOOST_CHECK(t.at(std::string("abcde")) == 1);
+
+	// 接尾辞の途中で分岐
+	t.insert(std::string("abxyz"), 2);
+	BOOST_CHECK(t.nodes() == 4);
+
+	// 接尾辞の終端より手前で終わる
+	t.insert(std::string("abx"), 3);
+	// 既存の接尾辞より長い
+	t.insert(std::string("abcdef"), 4);
+	// 既存
+	auto it = t.insert(std::string("abx"), 5);
+	BOOST_CHECK(*it == 'x');
+	BOOST_CHECK(it);
+
+	BOOST_CHECK(t.size() == 4);
+	BOOST_CHECK(t.at(std::string("abcde")) == 1);
+	BOOST_CHECK(t.at(std::string("abxyz")) == 2);
+	BOOST_CHECK(t.at(std::string("abx")) == 3);
+	BOOST_CHECK(t.at(std::string("abcdef")) == 4);
+	BOOST_CHECK(t.strings() == std::set<std::string>({ "abcde", "abxyz", "abx", "abcdef" }));
+
+	t[std::string("ab")] = 6;
+	BOOST_CHECK(t.at(std::string("ab")) == 6);
+	BOOST_CHECK_THROW(t.at(std::string("a")), std::out_of_range);
+	BOOST_CHECK_THROW(t.at(std::string("ab")) = 0x80000000u, std::length_error);
+	BOOST_CHECK(t.at(std::string("ab")) == 6);
+}
+
+// 挿入だけでも、分岐で不要になったレコードが回収される
+BOOST_AUTO_TEST_CASE(tail_trie_base__insert__2)
+{
+	using namespace wordring;
+
+	auto t = test_tail_trie();
+
+	std::string const s(64, 'x');
+	t.insert(s, 0);
+
+	int e = 0;
+	for (std::uint32_t i = 1; i < s.size(); ++i)
+	{
+		std::string key = s.substr(0, i) + 'y';
+		auto it = t.insert(key, i);
+		if (*it != 'y' || !it) ++e;
+		if (t.tail_size() < t.m_garbage * 2) ++e;
+	}
+	BOOST_CHECK(e == 0);
+
+	BOOST_CHECK(t.size() == s.size());
+	BOOST_CHECK(t.at(s) == 0);
+	e = 0;
+	for (std::uint32_t i = 1; i < s.size(); ++i) if (t.at(s.substr(0, i) + 'y') != i) ++e;
+	BOOST_CHECK(e == 0);
+}
+
+// erase()
+BOOST_AUTO_TEST_CASE(tail_trie_base__erase__1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v{ "a", "ab", "abc", "abd", "b" };
+	auto t = test_tail_trie();
+	t.assign(v.begin(), v.end());
+	std::uint32_t i = 0;
+	for (auto const& s : v) t[s] = i++;
+
+	t.erase(std::string("abd"));
+	BOOST_CHECK(t.contains(std::string("abd")) == false);
+	BOOST_CHECK(t.at(std::string("abc")) == 2);
+	BOOST_CHECK(t.at(std::string("ab")) == 1);
+
+	// 空遷移だけが残った「ab」は葉になり、値を保つ
+	t.erase(std::string("abc"));
+	BOOST_CHECK(t.at(std::string("ab")) == 1);
+	BOOST_CHECK(t.at(std::string("a")) == 0);
+
+	t.erase(std::string("a"));
+	BOOST_CHECK(t.at(std::string("ab")) == 1);
+	BOOST_CHECK(t.strings() == std::set<std::string>({ "ab", "b" }));
+
+	t.erase(std::string("ab"));
+	t.erase(std::string("b"));
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.tail_size() == 0);
+}
+
+// operator<<, operator>>
+BOOST_AUTO_TEST_CASE(tail_trie_base__stream__1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v{ "a", "ac", "b", "cab", "cd" };
+	auto t1 = tail_trie<>(v.begin(), v.end());
+	t1[std::string("cab")] = 5;
+
+	std::stringstream ss;
+	ss << t1;
+
+	auto t2 = test_tail_trie();
+	ss >> t2;
+
+	BOOST_CHECK(std::equal(t1.ibegin(), t1.iend(), t2.ibegin(), t2.iend()));
+	BOOST_CHECK(t2.tail_size() == t1.tail_size());
+	BOOST_CHECK(t2.m_garbage == 0);
+	BOOST_CHECK(t2.strings() == std::set<std::string>(v.begin(), v.end()));
+	BOOST_CHECK(t2.at(std::string("cab")) == 5);
+}
+
+// compact()
+BOOST_AUTO_TEST_CASE(tail_trie_base__compact__1)
+{
+	auto w = english_words();
+	std::sort(w.begin(), w.end());
+	w.erase(std::unique(w.begin(), w.end()), w.end());
+	if (!w.empty() && w.front().empty()) w.erase(w.begin());
+
+	auto t = test_tail_trie();
+	std::uint32_t i = 0;
+	for (auto const& s : w) t.insert(s, i++);
+	for (std::size_t j = 0; j < w.size(); ++j) if (j % 4 != 0) t.erase(w[j]);
+
+	auto r = t.compact();
+	BOOST_CHECK(r.m_after < r.m_before);
+	BOOST_CHECK(t.m_garbage == 0);
+
+	int e = 0;
+	for (std::size_t j = 0; j < w.size(); j += 4) if (static_cast<std::size_t>(t.at(w[j])) != j) ++e;
+	BOOST_CHECK(e == 0);
+	BOOST_CHECK(t.size() == (w.size() + 3) / 4);
+}
+
+BOOST_AUTO_TEST_CASE(tail_trie_base__stress__1)
+{
+	auto w = english_words();
+
+	std::sort(w.begin(), w.end());
+	w.erase(std::unique(w.begin(), w.end()), w.end());
+	if (!w.empty() && w.front().empty()) w.erase(w.begin());
+
+	auto t1 = test_tail_trie();
+	t1.assign(w.begin(), w.end());
+	auto t2 = wordring::trie<char>(w.begin(), w.end());
+
+	BOOST_CHECK(t1.size() == w.size());
+	BOOST_CHECK(t1.strings() == std::set<std::string>(w.begin(), w.end()));
+
+	std::vector<std::int32_t> v2(t2.ibegin(), t2.iend());
+	std::size_t n = 0;
+	for (std::size_t j = 5; j < v2.size(); j += 2) if (0 < v2[j]) ++n;
+	BOOST_CHECK(t1.nodes() * 2 < n);
+
+	// 無作為な順に挿入したものと一致する
+	auto t3 = test_tail_trie();
+	std::mt19937 mt;
+	auto r = w;
+	std::shuffle(r.begin(), r.end(), mt);
+	std::uint32_t i = 0;
+	for (auto const& s : r) t3.insert(s, i++);
+
+	BOOST_CHECK(t3.size() == w.size());
+	BOOST_CHECK(t3.strings() == t1.strings());
+
+	int e = 0;
+	i = 0;
+	for (auto const& s : r) if (static_cast<std::uint32_t>(t3.at(s)) != i++) ++e;
+	BOOST_CHECK(e == 0);
+
+	// 半分を削除する
+	for (std::size_t j = 0; j < r.size(); j += 2) t3.erase(r[j]);
+	e = 0;
+	for (std::size_t j = 0; j < r.size(); ++j) if (t3.contains(r[j]) != (j % 2 == 1)) ++e;
+	BOOST_CHECK(e == 0);
+	BOOST_CHECK(t3.size() == r.size() / 2);
+
+	e = 0;
+	for (std::size_t j = 1; j < r.size(); j += 2) if (static_cast<std::size_t>(t3.at(r[j])) != j) ++e;
+	BOOST_CHECK(e == 0);
+	BOOST_CHECK(t3.m_garbage * 2 <= t3.tail_size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
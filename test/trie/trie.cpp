@@ -15,8 +15,10 @@
 #include <iostream>
 #include <memory>
 #include <random>
+#include <set>
 #include <sstream>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #define STRING(str) #str
@@ -27,6 +29,7 @@ namespace
 	using wordring::detail::trie_node;
 
 	std::string const japanese_words_path{ TO_STRING(JAPANESE_WORDS_PATH) };
+	std::string const english_words_path{ TO_STRING(ENGLISH_WORDS_PATH) };
 
 	template <typename Char>
 	class test_trie : public wordring::trie<Char>
@@ -325,6 +328,77 @@ BOOST_AUTO_TEST_CASE(trie_assign_9)
 	BOOST_CHECK(trie.contains(std::string("cd")));
 }
 
+// void parallel_assign(ForwardIterator first, ForwardIterator last, std::uint32_t concurrency)
+BOOST_AUTO_TEST_CASE(trie_parallel_assign_1)
+{
+	std::vector<std::string> v{ "a", "ac", "b", "cab", "cd" };
+	test_trie<char> trie;
+	trie.parallel_assign(v.begin(), v.end(), 4);
+
+	BOOST_CHECK(trie.size() == 5);
+	BOOST_CHECK(trie.size() == trie.count());
+	BOOST_CHECK(trie.contains(std::string("a")));
+	BOOST_CHECK(trie.contains(std::string("ac")));
+	BOOST_CHECK(trie.contains(std::string("b")));
+	BOOST_CHECK(trie.contains(std::string("cab")));
+	BOOST_CHECK(trie.contains(std::string("cd")));
+	BOOST_CHECK(trie.contains(std::string("c")) == false);
+	BOOST_CHECK(trie.contains(std::string("ca")) == false);
+}
+
+BOOST_AUTO_TEST_CASE(trie_parallel_assign_2)
+{
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	test_trie<char32_t> trie;
+	trie.parallel_assign(v.begin(), v.end(), 4);
+
+	BOOST_CHECK(trie.size() == 5);
+	BOOST_CHECK(trie.size() == trie.count());
+	BOOST_CHECK(trie.contains(std::u32string(U"あ")));
+	BOOST_CHECK(trie.contains(std::u32string(U"あう")));
+	BOOST_CHECK(trie.contains(std::u32string(U"い")));
+	BOOST_CHECK(trie.contains(std::u32string(U"うあい")));
+	BOOST_CHECK(trie.contains(std::u32string(U"うえ")));
+	BOOST_CHECK(trie.contains(std::u32string(U"う")) == false);
+}
+
+BOOST_AUTO_TEST_CASE(trie_parallel_assign_3)
+{
+	// 整列していない場合、 assign() と同じ動作となる。
+	std::vector<std::string> v{ "cd", "a", "cab", "ac", "b", "a" };
+	test_trie<char> trie;
+	trie.parallel_assign(v.begin(), v.end(), 4);
+
+	BOOST_CHECK(trie.size() == 5);
+	BOOST_CHECK(trie.size() == trie.count());
+	BOOST_CHECK(trie.contains(std::string("a")));
+	BOOST_CHECK(trie.contains(std::string("cab")));
+}
+
+BOOST_AUTO_TEST_CASE(trie_parallel_assign_4)
+{
+	std::vector<std::string> v{ "a", "ab", "abc", "abd", "b", "bc", "bcd", "bd", "c" };
+	test_trie<char> t1, t2;
+	t1.assign(v.begin(), v.end());
+	t2.parallel_assign(v.begin(), v.end(), 8);
+
+	BOOST_CHECK(t2.size() == t1.size());
+	BOOST_CHECK(t2.size() == t2.count());
+	for (auto const& s : v) BOOST_CHECK(t2.contains(s));
+
+	// 構築後も挿入・削除できる
+	t2.insert(std::string("abe"));
+	t2.erase(std::string("bc"));
+	t2.erase(std::string("a"));
+	BOOST_CHECK(t2.contains(std::string("abe")));
+	BOOST_CHECK(t2.contains(std::string("bc")) == false);
+	BOOST_CHECK(t2.contains(std::string("bcd")));
+	BOOST_CHECK(t2.contains(std::string("a")) == false);
+	BOOST_CHECK(t2.contains(std::string("ab")));
+	BOOST_CHECK(t2.size() == 8);
+	BOOST_CHECK(t2.size() == t2.count());
+}
+
 // 要素アクセス ----------------------------------------------------------------
 
 // reference at(const_iterator pos)
@@ -1350,6 +1424,522 @@ BOOST_AUTO_TEST_CASE(trie_contains_3)
 	BOOST_CHECK(trie.contains(std::string("")) == false);
 }
 
+// const_leaf_iterator lower_bound(InputIterator first, InputIterator last) const
+// const_leaf_iterator lower_bound(Key const& key) const
+// const_leaf_iterator upper_bound(InputIterator first, InputIterator last) const
+// const_leaf_iterator upper_bound(Key const& key) const
+BOOST_AUTO_TEST_CASE(trie_lower_bound_1)
+{
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	test_trie<char32_t> trie;
+	trie.assign(v.begin(), v.end());
+
+	auto string = [](auto it) { std::u32string s; it.string(s); return s; };
+
+	BOOST_CHECK(string(trie.lower_bound(std::u32string(U""))) == U"あ");
+	BOOST_CHECK(string(trie.lower_bound(std::u32string(U"あ"))) == U"あ");
+	BOOST_CHECK(string(trie.lower_bound(std::u32string(U"あい"))) == U"あう");
+	BOOST_CHECK(string(trie.lower_bound(std::u32string(U"あうう"))) == U"い");
+	BOOST_CHECK(string(trie.lower_bound(std::u32string(U"う"))) == U"うあい");
+	BOOST_CHECK(string(trie.lower_bound(std::u32string(U"うえ"))) == U"うえ");
+	BOOST_CHECK(trie.lower_bound(std::u32string(U"うえあ")) == trie.leaf_end());
+	BOOST_CHECK(trie.lower_bound(std::u32string(U"え")) == trie.leaf_end());
+
+	BOOST_CHECK(string(trie.upper_bound(std::u32string(U""))) == U"あ");
+	BOOST_CHECK(string(trie.upper_bound(std::u32string(U"あ"))) == U"あう");
+	BOOST_CHECK(string(trie.upper_bound(std::u32string(U"うあい"))) == U"うえ");
+	BOOST_CHECK(trie.upper_bound(std::u32string(U"うえ")) == trie.leaf_end());
+
+	// 範囲の列挙
+	std::vector<std::u32string> result;
+	for (auto it = trie.lower_bound(std::u32string(U"あい")); it != trie.upper_bound(std::u32string(U"うあい")); ++it)
+	{
+		result.push_back(string(it));
+	}
+	BOOST_CHECK(result == std::vector<std::u32string>({ U"あう", U"い", U"うあい" }));
+}
+
+BOOST_AUTO_TEST_CASE(trie_lower_bound_2)
+{
+	// 符号付きの char も、バイト列の順に並ぶ
+	std::vector<std::string> v{ "a", "ac", "b", "cab", "cd", "\xE3\x81\x82" };
+	wordring::stable_trie<char> trie;
+	trie.assign(v.begin(), v.end());
+
+	auto string = [](auto it) { std::string s; it.string(s); return s; };
+
+	BOOST_CHECK(string(trie.lower_bound(std::string("aa"))) == "ac");
+	BOOST_CHECK(string(trie.lower_bound(std::string("ca"))) == "cab");
+	BOOST_CHECK(string(trie.lower_bound(std::string("d"))) == "\xE3\x81\x82");
+	BOOST_CHECK(string(trie.upper_bound(std::string("cd"))) == "\xE3\x81\x82");
+	BOOST_CHECK(trie.upper_bound(std::string("\xE3\x81\x82")) == trie.leaf_end());
+
+	BOOST_CHECK(trie.lower_bound(std::string("cab")).value() == 0);
+	trie.at(std::string("cab")) = 100;
+	BOOST_CHECK(trie.lower_bound(std::string("caa")).value() == 100);
+}
+
+BOOST_AUTO_TEST_CASE(trie_lower_bound_3)
+{
+	// 乱数で生成したキー文字列を std::set と比較する
+	std::mt19937 mt;
+	auto random_string = [&]()
+	{
+		std::u16string s(mt() % 6 + 1, u'\0');
+		for (char16_t& ch : s) ch = static_cast<char16_t>(0xFE + mt() % 4);
+		return s;
+	};
+
+	for (bool sibling : { false, true })
+	{
+		std::set<std::u16string> set;
+		wordring::trie<char16_t> trie;
+		trie.use_sibling_table(sibling);
+
+		for (int i = 0; i < 2000; ++i)
+		{
+			std::u16string s = random_string();
+			set.insert(s);
+			trie.insert(s);
+		}
+		for (int i = 0; i < 500; ++i)
+		{
+			std::u16string s = random_string();
+			set.erase(s);
+			trie.erase(s);
+		}
+
+		int e = 0;
+		for (int i = 0; i < 1000; ++i)
+		{
+			std::u16string s = random_string();
+			std::u16string s1, s2;
+
+			auto it1 = set.lower_bound(s);
+			auto it2 = trie.lower_bound(s);
+			if ((it1 == set.end()) != (it2 == trie.leaf_end())) ++e;
+			else if (it1 != set.end() && (it2.string(s1), s1 != *it1)) ++e;
+
+			it1 = set.upper_bound(s);
+			it2 = trie.upper_bound(s);
+			if ((it1 == set.end()) != (it2 == trie.leaf_end())) ++e;
+			else if (it1 != set.end() && (it2.string(s2), s2 != *it1)) ++e;
+		}
+		BOOST_CHECK(e == 0);
+	}
+}
+
+// OutputIterator common_prefix_search(InputIterator first, InputIterator last, OutputIterator out) const
+BOOST_AUTO_TEST_CASE(trie_common_prefix_search_1)
+{
+	std::vector<std::u32string> v{ U"あ", U"あう", U"あうえ", U"い", U"うあい", U"うえ" };
+	test_trie<char32_t> trie;
+	trie.assign(v.begin(), v.end());
+	trie[std::u32string(U"あ")] = 1;
+	trie[std::u32string(U"あう")] = 2;
+	trie[std::u32string(U"あうえ")] = 3;
+
+	std::vector<std::pair<std::size_t, std::uint32_t>> result;
+
+	std::u32string s1{ U"あうえお" };
+	trie.common_prefix_search(s1.begin(), s1.end(), std::back_inserter(result));
+	BOOST_CHECK(result == (std::vector<std::pair<std::size_t, std::uint32_t>>{ { 1, 1 }, { 2, 2 }, { 3, 3 } }));
+
+	result.clear();
+	trie.common_prefix_search(std::u32string(U"あい"), std::back_inserter(result));
+	BOOST_CHECK(result == (std::vector<std::pair<std::size_t, std::uint32_t>>{ { 1, 1 } }));
+
+	result.clear();
+	trie.common_prefix_search(std::u32string(U"うあ"), std::back_inserter(result));
+	BOOST_CHECK(result.empty());
+
+	result.clear();
+	trie.common_prefix_search(std::u32string(U""), std::back_inserter(result));
+	BOOST_CHECK(result.empty());
+}
+
+// OutputIterator fuzzy_search(InputIterator first, InputIterator last, std::uint32_t max_distance, OutputIterator out) const
+// OutputIterator fuzzy_search(Key const& key, std::uint32_t max_distance, OutputIterator out) const
+BOOST_AUTO_TEST_CASE(trie_fuzzy_search_1)
+{
+	using result_type = std::vector<std::tuple<std::u32string, std::uint32_t, std::uint32_t>>;
+
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	test_trie<char32_t> trie;
+	trie.assign(v.begin(), v.end());
+	trie[std::u32string(U"うあい")] = 10;
+
+	result_type result;
+
+	std::u32string s1{ U"うい" };
+	trie.fuzzy_search<std::u32string>(s1.begin(), s1.end(), 1, std::back_inserter(result));
+	BOOST_CHECK(result == (result_type{ { U"い", 0, 1 }, { U"うあい", 10, 1 }, { U"うえ", 0, 1 } }));
+
+	result.clear();
+	trie.fuzzy_search(std::u32string(U"あう"), 0, std::back_inserter(result));
+	BOOST_CHECK(result == (result_type{ { U"あう", 0, 0 } }));
+
+	result.clear();
+	trie.fuzzy_search(std::u32string(U""), 1, std::back_inserter(result));
+	BOOST_CHECK(result == (result_type{ { U"あ", 0, 1 }, { U"い", 0, 1 } }));
+
+	result.clear();
+	trie.fuzzy_search(std::u32string(U"かきく"), 1, std::back_inserter(result));
+	BOOST_CHECK(result.empty());
+}
+
+BOOST_AUTO_TEST_CASE(trie_fuzzy_search_2)
+{
+	using wordring::whatwg::encoding_cast;
+
+	std::ifstream is(japanese_words_path);
+	BOOST_REQUIRE(is.is_open());
+
+	std::vector<std::u32string> w;
+	std::string buf{};
+	for (size_t i = 0; i < 1000 && std::getline(is, buf); ++i) w.push_back(encoding_cast<std::u32string>(buf));
+	std::sort(w.begin(), w.end());
+	w.erase(std::unique(w.begin(), w.end()), w.end());
+
+	auto t = wordring::trie<char32_t>(w.begin(), w.end());
+
+	auto distance = [](std::u32string const& a, std::u32string const& b)
+	{
+		std::vector<std::uint32_t> row(b.size() + 1);
+		for (std::size_t j = 0; j <= b.size(); ++j) row[j] = static_cast<std::uint32_t>(j);
+		for (std::size_t i = 1; i <= a.size(); ++i)
+		{
+			std::uint32_t diag = row[0];
+			row[0] = static_cast<std::uint32_t>(i);
+			for (std::size_t j = 1; j <= b.size(); ++j)
+			{
+				std::uint32_t up = row[j];
+				row[j] = std::min({ up + 1, row[j - 1] + 1, diag + (a[i - 1] == b[j - 1] ? 0 : 1) });
+				diag = up;
+			}
+		}
+		return row.back();
+	};
+
+	int e = 0;
+	for (std::size_t i = 0; i < w.size(); i += 10)
+	{
+		std::u32string key = w[i];
+		if (1 < key.size()) key[1] = U'ー';
+
+		std::vector<std::tuple<std::u32string, std::uint32_t, std::uint32_t>> result, expected;
+		t.fuzzy_search(key, 2, std::back_inserter(result));
+		for (auto const& s : w)
+		{
+			std::uint32_t d = distance(key, s);
+			if (d <= 2) expected.emplace_back(s, 0, d);
+		}
+
+		if (result != expected) ++e;
+	}
+
+	BOOST_CHECK(e == 0);
+}
+
+// 行の最小値が許容範囲に達した後の直接遷移を、乱数で生成した語の全件の距離計算と比較する
+BOOST_AUTO_TEST_CASE(trie_fuzzy_search_3)
+{
+	using namespace wordring;
+
+	std::mt19937 mt;
+	std::string const alphabet{ "ab\x7F\x80\xFF" };
+	auto random_string = [&](std::size_t max)
+	{
+		std::string s(mt() % max + 1, '\0');
+		for (char& ch : s) ch = alphabet[mt() % alphabet.size()];
+		return s;
+	};
+
+	std::vector<std::string> w;
+	for (int i = 0; i < 500; ++i) w.push_back(random_string(7));
+	std::sort(w.begin(), w.end());
+	w.erase(std::unique(w.begin(), w.end()), w.end());
+
+	auto t1 = trie<char>(w.begin(), w.end());
+	auto t2 = stable_trie<char>(w.begin(), w.end());
+
+	auto distance = [](std::string const& a, std::string const& b)
+	{
+		std::vector<std::uint32_t> row(b.size() + 1);
+		for (std::size_t j = 0; j <= b.size(); ++j) row[j] = static_cast<std::uint32_t>(j);
+		for (std::size_t i = 1; i <= a.size(); ++i)
+		{
+			std::uint32_t diag = row[0];
+			row[0] = static_cast<std::uint32_t>(i);
+			for (std::size_t j = 1; j <= b.size(); ++j)
+			{
+				std::uint32_t up = row[j];
+				row[j] = std::min({ up + 1, row[j - 1] + 1, diag + (a[i - 1] == b[j - 1] ? 0 : 1) });
+				diag = up;
+			}
+		}
+		return row.back();
+	};
+
+	int e = 0;
+	for (int i = 0; i < 100; ++i)
+	{
+		std::string key = random_string(8);
+		for (std::uint32_t k = 0; k <= 3; ++k)
+		{
+			std::vector<std::tuple<std::string, std::uint32_t, std::uint32_t>> r1, r2, expected;
+			t1.fuzzy_search(key, k, std::back_inserter(r1));
+			t2.fuzzy_search(key, k, std::back_inserter(r2));
+			for (auto const& s : w)
+			{
+				std::uint32_t d = distance(key, s);
+				if (d <= k) expected.emplace_back(s, 0, d);
+			}
+
+			if (r1 != expected || r2 != expected) ++e;
+		}
+	}
+
+	BOOST_CHECK(e == 0);
+}
+
+// 英単語について、兄弟表の有無にかかわらず全件の距離計算と一致する
+BOOST_AUTO_TEST_CASE(trie_fuzzy_search_4)
+{
+	using namespace wordring;
+
+	std::ifstream is(english_words_path);
+	BOOST_REQUIRE(is.is_open());
+
+	std::vector<std::string> w;
+	std::string buf{};
+	for (std::size_t i = 0; i < 1000 && std::getline(is, buf); ++i) if (!buf.empty()) w.push_back(buf);
+	std::sort(w.begin(), w.end());
+	w.erase(std::unique(w.begin(), w.end()), w.end());
+
+	auto t = trie<char>(w.begin(), w.end());
+
+	auto distance = [](std::string const& a, std::string const& b)
+	{
+		std::vector<std::uint32_t> row(b.size() + 1);
+		for (std::size_t j = 0; j <= b.size(); ++j) row[j] = static_cast<std::uint32_t>(j);
+		for (std::size_t i = 1; i <= a.size(); ++i)
+		{
+			std::uint32_t diag = row[0];
+			row[0] = static_cast<std::uint32_t>(i);
+			for (std::size_t j = 1; j <= b.size(); ++j)
+			{
+				std::uint32_t up = row[j];
+				row[j] = std::min({ up + 1, row[j - 1] + 1, diag + (a[i - 1] == b[j - 1] ? 0 : 1) });
+				diag = up;
+			}
+		}
+		return row.back();
+	};
+
+	int e = 0;
+	for (std::size_t i = 0; i < w.size(); i += 20)
+	{
+		std::string key = w[i];
+		if (1 < key.size()) key[1] = '#';
+
+		for (std::uint32_t k = 1; k <= 2; ++k)
+		{
+			std::vector<std::tuple<std::string, std::uint32_t, std::uint32_t>> r1, r2, expected;
+			t.use_sibling_table(false);
+			t.fuzzy_search(key, k, std::back_inserter(r1));
+			t.use_sibling_table(true);
+			t.fuzzy_search(key, k, std::back_inserter(r2));
+			for (auto const& s : w)
+			{
+				std::uint32_t d = distance(key, s);
+				if (d <= k) expected.emplace_back(s, 0, d);
+			}
+
+			if (r1 != expected || r2 != expected) ++e;
+		}
+	}
+
+	BOOST_CHECK(e == 0);
+}
+
+// trie_stats stats() const
+BOOST_AUTO_TEST_CASE(trie_stats_1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v{ "a", "ac", "b", "cab", "cd" };
+	auto t = trie<char>(v.begin(), v.end());
+
+	auto r = t.stats();
+	BOOST_CHECK(r.m_size == 5);
+	BOOST_CHECK(r.m_nodes == t.node_size());
+	BOOST_CHECK(r.m_live == 9);
+	BOOST_CHECK(r.m_live + r.m_free + 1 == r.m_nodes);
+	BOOST_CHECK(0 < r.m_fill && r.m_fill <= 1);
+	BOOST_CHECK(r.m_bytes == t.node_size() * sizeof(detail::trie_node));
+	BOOST_CHECK(r.m_depth == (std::vector<std::size_t>{ 1, 3, 4, 1 }));
+	BOOST_CHECK(r.m_fanout == (std::vector<std::size_t>{ 5, 1, 2, 1 }));
+	BOOST_CHECK(r.m_tail == (std::vector<std::size_t>{ 0, 4, 1 }));
+
+	t.erase(std::string("cab"));
+	t.erase(std::string("cd"));
+	r = t.stats();
+	BOOST_CHECK(r.m_size == 3);
+	BOOST_CHECK(r.m_live == 5);
+	BOOST_CHECK(r.m_live + r.m_free + 1 == r.m_nodes);
+
+	trie<char> t2;
+	r = t2.stats();
+	BOOST_CHECK(r.m_size == 0);
+	BOOST_CHECK(r.m_live == 1);
+	BOOST_CHECK(r.m_depth == (std::vector<std::size_t>{ 1 }));
+	BOOST_CHECK(r.m_tail.empty());
+}
+
+// trie_counters const& counters() const noexcept
+// void reset_counters() noexcept
+BOOST_AUTO_TEST_CASE(trie_counters_1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v{ "cd", "a", "cab", "b", "ac", "ca", "d", "abc" };
+	trie<char> t;
+	for (auto const& s : v) t.insert(s);
+
+	auto c = t.counters();
+	if constexpr (detail::trie_counters_enabled)
+	{
+		BOOST_CHECK(c.m_locate != 0);
+		BOOST_CHECK(c.m_relocate != 0);
+	}
+	else
+	{
+		BOOST_CHECK(c.m_locate == 0);
+		BOOST_CHECK(c.m_relocate == 0);
+		BOOST_CHECK(c.m_walk == 0);
+	}
+	BOOST_CHECK(t.stats().m_counters.m_relocate == c.m_relocate);
+
+	t.reset_counters();
+	BOOST_CHECK(t.counters().m_locate == 0);
+	BOOST_CHECK(t.counters().m_relocate == 0);
+	BOOST_CHECK(t.counters().m_walk == 0);
+}
+
+// trie_compact_result compact()
+BOOST_AUTO_TEST_CASE(trie_compact_1)
+{
+	using wordring::whatwg::encoding_cast;
+
+	std::ifstream is(japanese_words_path);
+	BOOST_REQUIRE(is.is_open());
+
+	std::vector<std::u32string> w;
+	std::string buf{};
+	for (size_t i = 0; i < 1000 && std::getline(is, buf); ++i) w.push_back(encoding_cast<std::u32string>(buf));
+	std::sort(w.begin(), w.end());
+	w.erase(std::unique(w.begin(), w.end()), w.end());
+
+	test_trie<char32_t> t;
+	t.assign(w.begin(), w.end());
+
+	// 9割を削除する
+	std::vector<std::u32string> rest;
+	for (std::size_t j = 0; j < w.size(); ++j)
+	{
+		if (j % 10 == 0) rest.push_back(w[j]);
+		else t.erase(w[j]);
+	}
+	std::uint32_t i = 0;
+	for (auto const& s : rest) t[s] = i++;
+	std::size_t limit = t.m_c.size();
+
+	auto r = t.compact();
+	BOOST_CHECK(r.m_before == limit);
+	BOOST_CHECK(r.m_after == t.m_c.size());
+	BOOST_CHECK(r.m_after * 4 < r.m_before);
+	BOOST_CHECK(r.m_remap.size() == limit);
+
+	int e = 0;
+	for (std::size_t j = 0; j < rest.size(); ++j) if (!t.contains(rest[j]) || t.at(rest[j]) != static_cast<std::int32_t>(j)) ++e;
+	BOOST_CHECK(e == 0);
+	BOOST_CHECK(t.size() == rest.size());
+	BOOST_CHECK(t.count() == t.size());
+
+	// 詰め直した後も挿入、削除できる
+	for (auto const& s : w) t.insert(s);
+	for (auto const& s : w) if (!t.contains(s)) ++e;
+	BOOST_CHECK(e == 0);
+
+	test_trie<char32_t> t2;
+	BOOST_CHECK(t2.compact().m_after == 2);
+	BOOST_CHECK(t2.empty());
+}
+
+// OutputIterator lookup_batch(ForwardIterator first, ForwardIterator last, OutputIterator out) const
+BOOST_AUTO_TEST_CASE(trie_lookup_batch_1)
+{
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	test_trie<char32_t> trie;
+	trie.assign(v.begin(), v.end());
+
+	std::vector<std::u32string> keys{ U"うい", U"あう", U"", U"か", U"うあいう" };
+	std::vector<std::pair<test_trie<char32_t>::const_iterator, std::u32string::const_iterator>> result;
+	trie.lookup_batch(keys.cbegin(), keys.cend(), std::back_inserter(result));
+
+	BOOST_REQUIRE(result.size() == keys.size());
+	for (std::size_t i = 0; i < keys.size(); ++i)
+	{
+		auto pair = trie.lookup(keys[i].cbegin(), keys[i].cend());
+		BOOST_CHECK(result[i].first == pair.first);
+		BOOST_CHECK(result[i].second == pair.second);
+	}
+	BOOST_CHECK(*result[0].first == U'う');
+	BOOST_CHECK(*result[0].second == U'い');
+}
+
+// OutputIterator find_batch(ForwardIterator first, ForwardIterator last, OutputIterator out) const
+BOOST_AUTO_TEST_CASE(trie_find_batch_1)
+{
+	std::vector<std::u16string> v{ u"あ", u"あう", u"い", u"うあい", u"うえ" };
+	test_trie<char16_t> trie;
+	trie.assign(v.begin(), v.end());
+
+	std::vector<std::u16string> keys{ u"あう", u"うあ", u"", u"え", u"うえ" };
+	std::vector<test_trie<char16_t>::const_iterator> result;
+	trie.find_batch(keys.begin(), keys.end(), std::back_inserter(result));
+
+	BOOST_REQUIRE(result.size() == keys.size());
+	for (std::size_t i = 0; i < keys.size(); ++i) BOOST_CHECK(result[i] == trie.find(keys[i]));
+	BOOST_CHECK(*result[0] == u'う');
+	BOOST_CHECK(result[1] == trie.cend());
+}
+
+// OutputIterator contains_batch(ForwardIterator first, ForwardIterator last, OutputIterator out) const
+BOOST_AUTO_TEST_CASE(trie_contains_batch_1)
+{
+	std::vector<std::string> v{ "a", "ac", "b", "cab", "cd" };
+	test_trie<char> trie;
+	trie.assign(v.begin(), v.end());
+
+	// batch_size を超える数のキー文字列
+	std::vector<std::string> keys;
+	for (char const* s : { "a", "ac", "b", "cab", "cd", "d", "", "ca", "cabc", "\xFF" })
+	{
+		keys.push_back(s);
+		keys.push_back(s);
+		keys.push_back(s);
+	}
+
+	std::vector<bool> result;
+	trie.contains_batch(keys.begin(), keys.end(), std::back_inserter(result));
+
+	BOOST_REQUIRE(result.size() == keys.size());
+	for (std::size_t i = 0; i < keys.size(); ++i) BOOST_CHECK(result[i] == trie.contains(keys[i]));
+	BOOST_CHECK(std::count(result.begin(), result.end(), true) == 15);
+}
+
 // 関数 -----------------------------------------------------------------------
 
 // inline std::ostream& operator<<(std::ostream& os, basic_trie<Label1, Base1> const& trie)
@@ -1378,8 +1968,322 @@ BOOST_AUTO_TEST_CASE(trie_stream_2)
 	BOOST_CHECK(t1.m_c == t2.m_c);
 }
 
+// std::ostream& write(std::ostream& os) const
+// std::istream& read(std::istream& is)
+BOOST_AUTO_TEST_CASE(trie_write_1)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	test_trie<char32_t> t1, t2;
+	t1.assign(v.begin(), v.end());
+	t1[std::u32string(U"うあい")] = 100;
+
+	std::stringstream ss;
+	t1.write(ss);
+	BOOST_CHECK(ss.str().size() == detail::trie_image_header::size + t1.node_size() * sizeof(detail::trie_node));
+
+	BOOST_CHECK(t2.read(ss));
+	BOOST_CHECK(t1.m_c == t2.m_c);
+	BOOST_CHECK(t2.size() == 5);
+	BOOST_CHECK(t2.at(std::u32string(U"うあい")) == 100);
+
+	// 読み込んだ後も変更できる
+	t2.insert(std::u32string(U"え"));
+	BOOST_CHECK(t2.contains(std::u32string(U"え")));
+	BOOST_CHECK(t2.size() == 6);
+}
+
+BOOST_AUTO_TEST_CASE(trie_write_2)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v{ "a", "ac", "b", "cab", "cd" };
+	auto t1 = stable_trie<char>(v.begin(), v.end());
+
+	std::stringstream ss1;
+	t1.write(ss1);
+	std::string image = ss1.str();
+
+	auto t2 = stable_trie<char>(v.begin(), v.begin() + 2);
+	std::vector<std::int32_t> before(t2.ibegin(), t2.iend());
+
+	auto check = [&](std::string const& bytes)
+	{
+		std::stringstream ss(bytes);
+		bool ok = static_cast<bool>(t2.read(ss));
+		return ok == false && std::vector<std::int32_t>(t2.ibegin(), t2.iend()) == before;
+	};
+
+	// 途中で切れている
+	BOOST_CHECK(check(image.substr(0, image.size() - 1)));
+	BOOST_CHECK(check(image.substr(0, 10)));
+	// マジックが異なる
+	BOOST_CHECK(check("X" + image.substr(1)));
+	// チェックサムが異なる
+	std::string broken = image;
+	broken[broken.size() - 1] ^= 1;
+	BOOST_CHECK(check(broken));
+	// ヘッダーのノード数が実際のデータより多い（先に確保せず、データが尽きた時点で失敗する）
+	std::string oversized = image;
+	oversized[16] = '\xFF';
+	oversized[17] = '\xFF';
+	oversized[18] = '\xFF';
+	oversized[19] = '\x7F';
+	BOOST_CHECK(check(oversized));
+	BOOST_CHECK(check(oversized.substr(0, detail::trie_image_header::size)));
+	// 複数回に分けて読み込み、チェックサムで失敗する
+	oversized[18] = '\x01';
+	oversized[19] = '\0';
+	BOOST_CHECK(check(oversized + std::string(0x1FFFF * sizeof(detail::trie_node), '\0')));
+
+	// 種類が異なる
+	std::stringstream ss2(image);
+	trie<char> t3;
+	BOOST_CHECK(!t3.read(ss2));
+	BOOST_CHECK(t3.empty());
+
+	// ラベルの大きさが異なる
+	std::stringstream ss3(image);
+	stable_trie<char16_t> t4;
+	BOOST_CHECK(!t4.read(ss3));
+
+	// 正しいイメージ
+	std::stringstream ss4(image);
+	BOOST_CHECK(t2.read(ss4));
+	BOOST_CHECK(std::equal(t1.ibegin(), t1.iend(), t2.ibegin(), t2.iend()));
+	for (auto const& s : v) BOOST_CHECK(t2.contains(s));
+}
+
+// INDEX の幅 ----------------------------------------------------------------
+
+// basic_trie_node<std::int16_t>
+BOOST_AUTO_TEST_CASE(trie_index_width_1)
+{
+	using namespace wordring;
+	using trie16 = trie<char, std::allocator<detail::trie_node16>>;
+
+	std::ifstream is(english_words_path);
+	BOOST_REQUIRE(is.is_open());
+
+	std::vector<std::string> w;
+	std::string buf{};
+	for (std::size_t i = 0; i < 1000 && std::getline(is, buf); ++i) if (!buf.empty()) w.push_back(buf);
+	std::sort(w.begin(), w.end());
+	w.erase(std::unique(w.begin(), w.end()), w.end());
+
+	auto t1 = trie<char>(w.begin(), w.end());
+	auto t2 = trie16(w.begin(), w.end());
+
+	BOOST_CHECK(sizeof(detail::trie_node16) * 2 == sizeof(trie_node));
+	BOOST_CHECK(t2.size() == w.size());
+	BOOST_CHECK(t2.node_size() == t1.node_size());
+	BOOST_CHECK(t2.stats().m_bytes < t1.stats().m_bytes);
+
+	int e = 0;
+	for (auto const& s : w) if (!t2.contains(s) || t2.contains(s + "'") != t1.contains(s + "'")) ++e;
+	BOOST_CHECK(e == 0);
+
+	t2[w.front()] = 32767;
+	BOOST_CHECK(t2.at(w.front()) == 32767);
+
+	// 直列化
+	std::vector<std::int16_t> v(t2.ibegin(), t2.iend());
+	trie16 t3;
+	t3.assign(v.begin(), v.end());
+	BOOST_CHECK(std::equal(t2.ibegin(), t2.iend(), t3.ibegin(), t3.iend()));
+
+	std::stringstream ss1;
+	ss1 << t2;
+	trie16 t4;
+	ss1 >> t4;
+	BOOST_CHECK(std::equal(t2.ibegin(), t2.iend(), t4.ibegin(), t4.iend()));
+
+	// 一括入出力形式は INDEX のバイト数を照合する
+	std::stringstream ss2;
+	t2.write(ss2);
+	BOOST_CHECK(ss2.str().size() == detail::trie_image_header::size + t2.node_size() * sizeof(detail::trie_node16));
+	trie16 t5;
+	BOOST_CHECK(t5.read(ss2));
+	BOOST_CHECK(t5.at(w.front()) == 32767);
+	// 葉の値は INDEX の型で表せる範囲に限られる
+	BOOST_CHECK_THROW(t5[w.front()] = 70000u, std::length_error);
+	BOOST_CHECK_THROW(t5.at(w.front()) = 40000u, std::length_error);
+	BOOST_CHECK(t5.at(w.front()) == 32767);
+	ss2.clear();
+	ss2.seekg(0);
+	trie<char> t6;
+	BOOST_CHECK(!t6.read(ss2));
+
+	// INDEX の型で表せない大きさへは伸長しない
+	trie16 t7;
+	auto fill = [&]()
+	{
+		for (std::uint32_t i = 0; i < 100000; ++i) t7.insert(std::to_string(i * 7919u));
+	};
+	BOOST_CHECK_THROW(fill(), std::length_error);
+	BOOST_CHECK(t7.node_size() <= static_cast<std::size_t>(std::numeric_limits<std::int16_t>::max() - 256));
+	BOOST_CHECK(t7.contains(std::to_string(7919u)));
+
+	// 削除と再配置
+	trie16 t8(w.begin(), w.end());
+	for (std::size_t i = 0; i < w.size(); i += 2) t8.erase(w[i]);
+	t8.compact();
+	e = 0;
+	for (std::size_t i = 0; i < w.size(); ++i) if (t8.contains(w[i]) != (i % 2 == 1)) ++e;
+	BOOST_CHECK(e == 0);
+}
+
+// basic_trie_node<std::int64_t>
+BOOST_AUTO_TEST_CASE(trie_index_width_2)
+{
+	using namespace wordring;
+	using whatwg::encoding_cast;
+	using trie64 = stable_trie<char32_t, std::allocator<detail::trie_node64>>;
+
+	std::ifstream is(japanese_words_path);
+	BOOST_REQUIRE(is.is_open());
+
+	std::vector<std::u32string> w;
+	std::string buf{};
+	for (std::size_t i = 0; i < 1000 && std::getline(is, buf); ++i) w.push_back(encoding_cast<std::u32string>(buf));
+	std::sort(w.begin(), w.end());
+	w.erase(std::unique(w.begin(), w.end()), w.end());
+
+	auto t1 = stable_trie<char32_t>(w.begin(), w.end());
+	auto t2 = trie64(w.begin(), w.end());
+	t2.use_sibling_table();
+
+	BOOST_CHECK(sizeof(detail::trie_node64) == sizeof(trie_node) * 2);
+	BOOST_CHECK(t2.size() == w.size());
+	BOOST_CHECK(std::equal(t1.ibegin(), t1.iend(), t2.ibegin(), t2.iend(), [](std::uint32_t a, std::uint64_t b) { return static_cast<std::int32_t>(a) == static_cast<std::int64_t>(b); }));
+
+	for (std::size_t i = 0; i < w.size(); i += 2) t2.erase(w[i]);
+	auto r = t2.compact();
+	BOOST_CHECK(r.m_after <= r.m_before);
+
+	int e = 0;
+	for (std::size_t i = 0; i < w.size(); ++i) if (t2.contains(w[i]) != (i % 2 == 1)) ++e;
+	BOOST_CHECK(e == 0);
+
+	std::stringstream ss;
+	t2.write(ss);
+	trie64 t3;
+	BOOST_CHECK(t3.read(ss));
+	BOOST_CHECK(std::equal(t2.ibegin(), t2.iend(), t3.ibegin(), t3.iend()));
+}
+
 // ストレステスト --------------------------------------------------------------
 
+// void use_sibling_table(bool enable = true)
+BOOST_AUTO_TEST_CASE(trie_sibling_table_1)
+{
+	using namespace wordring;
+
+	// 前順に訪問したノードのラベルと終端の有無
+	auto walk = [](auto const& t)
+	{
+		std::vector<std::pair<char16_t, bool>> result;
+		auto it1 = tree_iterator<decltype(t.begin())>(t.begin());
+		auto it2 = tree_iterator<decltype(t.begin())>();
+		for (++it1; it1 != it2; ++it1) result.emplace_back(*it1.base(), static_cast<bool>(it1.base()));
+		return result;
+	};
+
+	std::vector<std::u16string> v{ u"あ", u"あう", u"い", u"うあい", u"うえ" };
+	auto t1 = trie<char16_t>(v.begin(), v.end());
+	auto t2 = trie<char16_t>(v.begin(), v.end());
+
+	BOOST_CHECK(t2.uses_sibling_table() == false);
+	t2.use_sibling_table();
+	BOOST_CHECK(t2.uses_sibling_table());
+	BOOST_CHECK(walk(t1) == walk(t2));
+
+	for (auto* t : { &t1, &t2 })
+	{
+		t->insert(std::u16string(u"うあ"));
+		t->insert(std::u16string(u"あい"));
+		t->erase(std::u16string(u"うあい"));
+		t->erase(std::u16string(u"い"));
+	}
+	BOOST_CHECK(walk(t1) == walk(t2));
+
+	auto it = t2.search(std::u16string(u"う"));
+	std::u16string s;
+	for (auto it1 = it.begin(); it1 != it.end(); ++it1) s.push_back(*it1);
+	BOOST_CHECK(s == u"あえ");
+
+	t2.clear();
+	BOOST_CHECK(t2.uses_sibling_table());
+	BOOST_CHECK(t2.begin().begin() == t2.end());
+
+	t2.use_sibling_table(false);
+	BOOST_CHECK(t2.uses_sibling_table() == false);
+}
+
+BOOST_AUTO_TEST_CASE(trie_sibling_table_2)
+{
+	using wordring::whatwg::encoding_cast;
+
+	std::ifstream is(japanese_words_path);
+	BOOST_REQUIRE(is.is_open());
+
+	std::vector<std::u32string> w;
+	std::string buf{};
+#ifdef NDEBUG
+	while (std::getline(is, buf)) w.push_back(encoding_cast<std::u32string>(buf));
+#else
+	for (size_t i = 0; i < 1000 && std::getline(is, buf); ++i) w.push_back(encoding_cast<std::u32string>(buf));
+#endif
+
+	test_trie<char32_t> t1;
+	test_trie<char32_t> t2;
+	t2.use_sibling_table();
+
+	std::shuffle(w.begin(), w.end(), std::mt19937(1));
+	for (auto const& s : w)
+	{
+		t1.insert(s);
+		t2.insert(s);
+	}
+	for (std::size_t i = 0; i < w.size(); i += 2)
+	{
+		t1.erase(w[i]);
+		t2.erase(w[i]);
+	}
+
+	// 挿入・削除・移動で同じ配置となり、列挙の結果も一致する
+	BOOST_CHECK(std::equal(t1.ibegin(), t1.iend(), t2.ibegin(), t2.iend()));
+	BOOST_CHECK(t2.count() == t2.size());
+
+	int e = 0;
+	for (std::size_t i = 0; i < w.size(); ++i) if (t2.contains(w[i]) != (i % 2 == 1)) ++e;
+	BOOST_CHECK(e == 0);
+
+	auto strings = [](auto const& t)
+	{
+		std::vector<std::u32string> result;
+		auto it1 = wordring::tree_iterator<decltype(t.begin())>(t.begin());
+		auto it2 = wordring::tree_iterator<decltype(t.begin())>();
+		std::u32string s;
+		for (; it1 != it2; ++it1)
+		{
+			if (!it1.base()) continue;
+			it1.base().string(s);
+			result.push_back(s);
+		}
+		return result;
+	};
+
+	auto v = strings(t2);
+	BOOST_CHECK(v == strings(t1));
+
+	// 表を作り直しても同じ順序で列挙される
+	t2.use_sibling_table(false);
+	t2.use_sibling_table(true);
+	BOOST_CHECK(v == strings(t2));
+}
+
 BOOST_AUTO_TEST_CASE(trie_stress_1)
 {
 	using wordring::whatwg::encoding_cast;
@@ -1471,4 +2375,41 @@ BOOST_AUTO_TEST_CASE(trie_stress_3)
 	BOOST_CHECK(t.count() == t.size());
 }
 
+BOOST_AUTO_TEST_CASE(trie_stress_4)
+{
+	using wordring::whatwg::encoding_cast;
+
+	std::ifstream is(japanese_words_path);
+	BOOST_REQUIRE(is.is_open());
+
+	std::vector<std::u32string> w;
+	std::string buf{};
+#ifdef NDEBUG
+	while (std::getline(is, buf)) w.push_back(encoding_cast<std::u32string>(buf));
+#else
+	for (size_t i = 0; i < 1000 && std::getline(is, buf); ++i) w.push_back(encoding_cast<std::u32string>(buf));
+#endif
+	std::sort(w.begin(), w.end());
+	w.erase(std::unique(w.begin(), w.end()), w.end());
+
+	test_trie<char32_t> t;
+	t.parallel_assign(w.begin(), w.end(), 4);
+
+	int e = 0;
+	for (auto const& s : w) if (!t.contains(s)) ++e;
+
+	BOOST_CHECK(e == 0);
+	BOOST_CHECK(t.size() == w.size());
+	BOOST_CHECK(t.count() == t.size());
+
+	// 半分を削除して再挿入する
+	for (std::size_t i = 0; i < w.size(); i += 2) t.erase(w[i]);
+	for (std::size_t i = 0; i < w.size(); i += 2) if (t.contains(w[i])) ++e;
+	for (std::size_t i = 0; i < w.size(); i += 2) t.insert(w[i]);
+	for (auto const& s : w) if (!t.contains(s)) ++e;
+
+	BOOST_CHECK(e == 0);
+	BOOST_CHECK(t.count() == t.size());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -829,6 +829,23 @@ BOOST_AUTO_TEST_CASE(trie_base_erase_9)
 	BOOST_CHECK(error == 0);
 }
 
+// 子を失って葉に戻る祖先は、空遷移に格納されていた値を保持する
+BOOST_AUTO_TEST_CASE(trie_base_erase_10)
+{
+	test_trie trie{};
+
+	trie.insert(std::string("ab"), 1);
+	trie.insert(std::string("abc"), 2);
+	trie.insert(std::string("abd"), 3);
+
+	trie.erase(std::string("abc"));
+	trie.erase(std::string("abd"));
+
+	BOOST_CHECK(trie.size() == 1);
+	BOOST_CHECK(trie.contains(std::string("ab")));
+	BOOST_CHECK(trie.at(std::string("ab")) == 1);
+}
+
 // 検索 -----------------------------------------------------------------------
 
 // auto lookup(InputIterator first, InputIterator last) const
@@ -366,6 +366,56 @@ BOOST_AUTO_TEST_CASE(trie_base_benchmark__words_random_1)
 	BOOST_CHECK(error == 0);
 }
 
+BOOST_AUTO_TEST_CASE(trie_base_benchmark__insert_erase_1)
+{
+	using namespace wordring;
+
+	setup2();
+
+	std::vector<std::string> const& w = words2;
+	std::uint32_t error = 0;
+
+	std::cout.imbue(std::locale(""));
+
+	std::cout << "---------- trie_base_benchmark__insert_erase_1 ----------" << std::endl;
+
+	std::cout << "std::vector<std::string> w{ (random words...) };" << std::endl;
+	std::cout << "\tsize:\t" << w.size() << std::endl;
+
+	std::cout << "detail::trie_base<>" << std::endl;
+
+	detail::trie_base<> t{};
+	auto start = std::chrono::system_clock::now();
+	for (auto const& s : w) t.insert(s);
+	auto duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tinsert:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+	// 半分を削除して未使用ノードを散らばらせる。
+	start = std::chrono::system_clock::now();
+	for (std::size_t i = 0; i < w.size(); i += 2) t.erase(w[i]);
+	duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\terase:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+	// 散らばった未使用ノードへ再挿入する。
+	start = std::chrono::system_clock::now();
+	for (std::size_t i = 0; i < w.size(); i += 2) t.insert(w[i]);
+	duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tinsert:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+	std::vector<std::uint32_t> buf;
+	std::copy(t.ibegin(), t.iend(), std::back_inserter(buf));
+	std::cout << "\tnodes:\t" << (buf.size() / 2) << std::endl;
+
+	for (auto const& s : w) if (t.find(s) == t.end()) ++error;
+
+	std::cout << std::endl;
+
+	BOOST_CHECK(error == 0);
+}
+
 BOOST_AUTO_TEST_CASE(trie_base_benchmark__words_sorted_1)
 {
 	using namespace wordring;
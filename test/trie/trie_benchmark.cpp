@@ -2,22 +2,32 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <wordring/string/atom.hpp>
+#include <wordring/string/concurrent_atom.hpp>
+#include <wordring/trie/aho_corasick.hpp>
+#include <wordring/trie/concurrent_trie.hpp>
+#include <wordring/trie/dawg.hpp>
+#include <wordring/trie/dense_trie.hpp>
 #include <wordring/trie/trie.hpp>
 #include <wordring/tree/tree_iterator.hpp>
 
 #include <wordring/whatwg/infra/unicode.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <random>
 #include <set>
+#include <shared_mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
@@ -26,6 +36,7 @@
 
 namespace
 {
+	std::string const english_words_path{ TO_STRING(ENGLISH_WORDS_PATH) };
 	std::string const japanese_words_path{ TO_STRING(JAPANESE_WORDS_PATH) };
 	std::string const current_source_path{ TO_STRING(CURRENT_SOURCE_PATH) };
 	std::string const current_binary_path{ TO_STRING(CURRENT_BINARY_PATH) };
@@ -276,6 +287,72 @@ BOOST_AUTO_TEST_CASE(trie_benchmark__serialize_6)
 	std::cout << std::endl;
 }
 
+BOOST_AUTO_TEST_CASE(trie_benchmark__serialize_7)
+{
+	using namespace wordring;
+
+	setup1();
+
+	std::cout.imbue(std::locale(""));
+	std::cout << "---------- trie_benchmark__serialize_7 ----------" << std::endl;
+
+	auto run = [](auto const& t1, char const* name)
+	{
+		using trie_type = std::remove_cv_t<std::remove_reference_t<decltype(t1)>>;
+
+		std::size_t const bytes = t1.node_size() * sizeof(detail::trie_node);
+		auto mbps = [bytes](auto duration)
+		{
+			auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+			return us == 0 ? 0 : bytes / us;
+		};
+
+		std::cout << name << std::endl;
+		std::cout << "\tnodes:\t" << t1.node_size() << std::endl;
+		std::cout << "\tbytes:\t" << bytes << std::endl;
+
+		// 1バイト毎の直列化
+		std::stringstream ss1;
+		auto start = std::chrono::system_clock::now();
+		ss1 << t1;
+		auto duration = std::chrono::system_clock::now() - start;
+		std::cout << "\tos << trie:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms\t" << mbps(duration) << "MB/s" << std::endl;
+
+		trie_type t2;
+		start = std::chrono::system_clock::now();
+		ss1 >> t2;
+		duration = std::chrono::system_clock::now() - start;
+		std::cout << "\tis >> trie:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms\t" << mbps(duration) << "MB/s" << std::endl;
+
+		std::string s1 = ss1.str();
+		start = std::chrono::system_clock::now();
+		trie_type t3(s1.begin() + 8, s1.end());
+		duration = std::chrono::system_clock::now() - start;
+		std::cout << "\ttrie(first, last):\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms\t" << mbps(duration) << "MB/s" << std::endl;
+
+		// 一括入出力形式
+		std::stringstream ss2;
+		start = std::chrono::system_clock::now();
+		t1.write(ss2);
+		duration = std::chrono::system_clock::now() - start;
+		std::cout << "\ttrie.write(os):\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms\t" << mbps(duration) << "MB/s" << std::endl;
+
+		trie_type t4;
+		start = std::chrono::system_clock::now();
+		t4.read(ss2);
+		duration = std::chrono::system_clock::now() - start;
+		std::cout << "\ttrie.read(is):\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms\t" << mbps(duration) << "MB/s" << std::endl;
+
+		BOOST_CHECK(std::equal(t1.ibegin(), t1.iend(), t2.ibegin(), t2.iend()));
+		BOOST_CHECK(std::equal(t1.ibegin(), t1.iend(), t4.ibegin(), t4.iend()));
+	};
+
+	run(trie<char32_t>(words_32.begin(), words_32.end()), "trie<char32_t>");
+	run(stable_trie<char32_t>(words_32.begin(), words_32.end()), "stable_trie<char32_t>");
+
+	std::cout << std::endl;
+}
+
 BOOST_AUTO_TEST_CASE(trie_benchmark__copy_assignment_1)
 {
 	using namespace wordring;
@@ -906,4 +983,894 @@ BOOST_AUTO_TEST_CASE(trie_benchmark__words_sorted_3)
 	BOOST_CHECK(t2.size() == set.size());
 }
 
+BOOST_AUTO_TEST_CASE(trie_benchmark__insert_erase_1)
+{
+	using namespace wordring;
+
+	setup1();
+
+	std::vector<std::u32string> w = words_32;
+	std::shuffle(w.begin(), w.end(), std::mt19937());
+	std::uint32_t error = 0;
+
+	std::cout.imbue(std::locale(""));
+
+	std::cout << "---------- trie_benchmark__insert_erase_1 ----------" << std::endl;
+
+	std::cout << "std::vector<std::u32string> w{ (random words...) };" << std::endl;
+	std::cout << "\tsize:\t" << w.size() << std::endl;
+
+	std::cout << "trie<char32_t>" << std::endl;
+
+	trie<char32_t> t{};
+	auto start = std::chrono::system_clock::now();
+	for (auto const& s : w) t.insert(s);
+	auto duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tinsert:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+	// 半分を削除して未使用ノードを散らばらせる。
+	start = std::chrono::system_clock::now();
+	for (std::size_t i = 0; i < w.size(); i += 2) t.erase(w[i]);
+	duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\terase:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+	// 散らばった未使用ノードへ再挿入する。
+	start = std::chrono::system_clock::now();
+	for (std::size_t i = 0; i < w.size(); i += 2) t.insert(w[i]);
+	duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tinsert:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+	std::vector<std::uint32_t> buf;
+	std::copy(t.ibegin(), t.iend(), std::back_inserter(buf));
+	std::cout << "\tnodes:\t" << (buf.size() / 2) << std::endl;
+
+	for (auto const& s : w) if (t.find(s) == t.end()) ++error;
+
+	std::cout << std::endl;
+
+	BOOST_CHECK(error == 0);
+}
+
+BOOST_AUTO_TEST_CASE(trie_benchmark__sibling_table_1)
+{
+	using namespace wordring;
+
+	setup1();
+
+	std::vector<std::u32string> w = words_32;
+	std::shuffle(w.begin(), w.end(), std::mt19937());
+	std::uint32_t error = 0;
+
+	std::cout.imbue(std::locale(""));
+
+	std::cout << "---------- trie_benchmark__sibling_table_1 ----------" << std::endl;
+
+	std::cout << "std::vector<std::u32string> w{ (random words...) };" << std::endl;
+	std::cout << "\tsize:\t" << w.size() << std::endl;
+
+	// 根から前順にすべてのノードを訪問する
+	auto traverse = [](trie<char32_t> const& t)
+	{
+		std::size_t n = 0;
+		auto it1 = tree_iterator<decltype(t.begin())>(t.begin());
+		auto it2 = tree_iterator<decltype(t.begin())>();
+		for (; it1 != it2; ++it1) ++n;
+		return n;
+	};
+
+	std::size_t nodes[2] = { 0, 0 };
+	for (bool enable : { false, true })
+	{
+		std::cout << "trie<char32_t>" << (enable ? " (use_sibling_table)" : "") << std::endl;
+
+		trie<char32_t> t{};
+		t.use_sibling_table(enable);
+
+		auto start = std::chrono::system_clock::now();
+		for (auto const& s : w) t.insert(s);
+		auto duration = std::chrono::system_clock::now() - start;
+
+		std::cout << "\tinsert:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+		start = std::chrono::system_clock::now();
+		for (std::size_t i = 0; i < w.size(); i += 2) t.erase(w[i]);
+		for (std::size_t i = 0; i < w.size(); i += 2) t.insert(w[i]);
+		duration = std::chrono::system_clock::now() - start;
+
+		std::cout << "\terase/insert:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+		start = std::chrono::system_clock::now();
+		nodes[enable] = traverse(t);
+		duration = std::chrono::system_clock::now() - start;
+
+		std::cout << "\ttraverse:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+		std::cout << "\tvisited:\t" << nodes[enable] << std::endl;
+
+		for (auto const& s : w) if (!t.contains(s)) ++error;
+	}
+
+	std::cout << std::endl;
+
+	BOOST_CHECK(nodes[0] == nodes[1]);
+	BOOST_CHECK(error == 0);
+}
+
+BOOST_AUTO_TEST_CASE(trie_benchmark__stats_1)
+{
+	using namespace wordring;
+
+	setup1();
+
+	std::vector<std::u32string> w1 = words_32;
+	std::shuffle(w1.begin(), w1.end(), std::mt19937());
+	std::vector<std::u32string> w2 = words_32;
+	std::sort(w2.begin(), w2.end());
+	w2.erase(std::unique(w2.begin(), w2.end()), w2.end());
+
+	std::cout.imbue(std::locale(""));
+
+	std::cout << "---------- trie_benchmark__stats_1 ----------" << std::endl;
+
+	auto print = [](trie<char32_t> const& t)
+	{
+		auto start = std::chrono::system_clock::now();
+		auto r = t.stats();
+		auto duration = std::chrono::system_clock::now() - start;
+
+		std::size_t tail = 0;
+		for (std::size_t i = 0; i < r.m_tail.size(); ++i) tail += i * r.m_tail[i];
+
+		std::cout << "\tstats():\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+		std::cout << "\tsize:\t" << r.m_size << std::endl;
+		std::cout << "\tnodes:\t" << r.m_nodes << std::endl;
+		std::cout << "\tlive:\t" << r.m_live << std::endl;
+		std::cout << "\tfree:\t" << r.m_free << std::endl;
+		std::cout << "\tfill:\t" << r.m_fill << std::endl;
+		std::cout << "\tbytes:\t" << r.m_bytes << std::endl;
+		std::cout << "\tdepth:\t" << r.m_depth.size() - 1 << std::endl;
+		std::cout << "\tfan-out 1/2/3:\t" << r.m_fanout[1] << "/" << r.m_fanout[2] << "/" << r.m_fanout[3] << std::endl;
+		std::cout << "\ttail nodes:\t" << tail << std::endl;
+		if constexpr (detail::trie_counters_enabled)
+		{
+			std::cout << "\trelocate:\t" << r.m_counters.m_relocate << std::endl;
+			std::cout << "\tlocate:\t" << r.m_counters.m_locate << std::endl;
+			std::cout << "\twalk:\t" << r.m_counters.m_walk << std::endl;
+		}
+	};
+
+	trie<char32_t> t1;
+	for (auto const& s : w1) t1.insert(s);
+	std::cout << "trie<char32_t> (insert random words...)" << std::endl;
+	print(t1);
+
+	trie<char32_t> t2;
+	for (auto const& s : w2) t2.insert(s);
+	std::cout << "trie<char32_t> (insert sorted words...)" << std::endl;
+	print(t2);
+
+	auto t3 = trie<char32_t>(w2.begin(), w2.end());
+	std::cout << "trie<char32_t> (assign sorted words...)" << std::endl;
+	print(t3);
+
+	std::cout << std::endl;
+
+	BOOST_CHECK(t1.stats().m_live == t3.stats().m_live);
+}
+
+BOOST_AUTO_TEST_CASE(trie_benchmark__parallel_assign_1)
+{
+	using namespace wordring;
+
+	setup1();
+
+	std::vector<std::string> w8 = words_8;
+	std::sort(w8.begin(), w8.end());
+	w8.erase(std::unique(w8.begin(), w8.end()), w8.end());
+
+	std::vector<std::u32string> w32 = words_32;
+	std::sort(w32.begin(), w32.end());
+	w32.erase(std::unique(w32.begin(), w32.end()), w32.end());
+
+	std::uint32_t error = 0;
+
+	std::cout.imbue(std::locale(""));
+
+	std::cout << "---------- trie_benchmark__parallel_assign_1 ----------" << std::endl;
+
+	std::cout << "std::vector<std::string> w{ (sorted words...) };" << std::endl;
+	std::cout << "\tsize:\t" << w8.size() << std::endl;
+
+	std::cout << "trie<char>" << std::endl;
+
+	trie<char> t1{};
+	auto start = std::chrono::system_clock::now();
+	t1.assign(w8.begin(), w8.end());
+	auto duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tassign:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+	for (std::uint32_t n : { 1u, 2u, 4u, 8u, 16u })
+	{
+		trie<char> t2{};
+		start = std::chrono::system_clock::now();
+		t2.parallel_assign(w8.begin(), w8.end(), n);
+		duration = std::chrono::system_clock::now() - start;
+
+		std::cout << "\tparallel_assign(" << n << "):\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+		for (auto const& s : w8) if (t2.find(s) == t2.end()) ++error;
+		if (t2.size() != t1.size()) ++error;
+	}
+
+	std::cout << "std::vector<std::u32string> w{ (sorted words...) };" << std::endl;
+	std::cout << "\tsize:\t" << w32.size() << std::endl;
+
+	std::cout << "trie<char32_t>" << std::endl;
+
+	trie<char32_t> t3{};
+	start = std::chrono::system_clock::now();
+	t3.assign(w32.begin(), w32.end());
+	duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tassign:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+	for (std::uint32_t n : { 1u, 2u, 4u, 8u, 16u })
+	{
+		trie<char32_t> t4{};
+		start = std::chrono::system_clock::now();
+		t4.parallel_assign(w32.begin(), w32.end(), n);
+		duration = std::chrono::system_clock::now() - start;
+
+		std::cout << "\tparallel_assign(" << n << "):\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+		for (auto const& s : w32) if (t4.find(s) == t4.end()) ++error;
+		if (t4.size() != t3.size()) ++error;
+	}
+
+	std::cout << std::endl;
+
+	BOOST_CHECK(error == 0);
+}
+
+BOOST_AUTO_TEST_CASE(trie_benchmark__dense_1)
+{
+	using namespace wordring;
+
+	setup1();
+
+	std::vector<std::u32string> w32 = words_32;
+	std::sort(w32.begin(), w32.end());
+	w32.erase(std::unique(w32.begin(), w32.end()), w32.end());
+
+	auto nodes = [](auto const& t)
+	{
+		std::vector<std::int32_t> v(t.ibegin(), t.iend());
+		std::size_t n = 0;
+		for (std::size_t i = 3; i < v.size(); i += 2) if (0 < v[i]) ++n;
+		return n;
+	};
+
+	std::uint32_t error = 0;
+
+	std::cout.imbue(std::locale(""));
+
+	std::cout << "---------- trie_benchmark__dense_1 ----------" << std::endl;
+
+	std::cout << "std::vector<std::u32string> w{ (sorted words...) };" << std::endl;
+	std::cout << "\tsize:\t" << w32.size() << std::endl;
+
+	std::cout << "trie<char32_t>" << std::endl;
+
+	trie<char32_t> t1{};
+	auto start = std::chrono::system_clock::now();
+	t1.assign(w32.begin(), w32.end());
+	auto duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tassign:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+	std::cout << "\tnodes:\t" << nodes(t1) << std::endl;
+
+	start = std::chrono::system_clock::now();
+	for (auto const& s : w32) if (t1.find(s) == t1.end()) ++error;
+	duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tfind:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+	std::cout << "dense_trie<char32_t>" << std::endl;
+
+	dense_trie<char32_t> t2{};
+	start = std::chrono::system_clock::now();
+	t2.assign(w32.begin(), w32.end());
+	duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tassign:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+	std::cout << "\tnodes:\t" << nodes(t2) << std::endl;
+	std::cout << "\tlabels:\t" << t2.label_map().size() << std::endl;
+
+	start = std::chrono::system_clock::now();
+	for (auto const& s : w32) if (t2.find(s) == t2.end()) ++error;
+	duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tfind:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+	std::cout << std::endl;
+
+	BOOST_CHECK(error == 0);
+}
+
+BOOST_AUTO_TEST_CASE(trie_benchmark__dawg_1)
+{
+	using namespace wordring;
+
+	setup1();
+
+	std::vector<std::u32string> w32 = words_32;
+	std::sort(w32.begin(), w32.end());
+	w32.erase(std::unique(w32.begin(), w32.end()), w32.end());
+
+	auto nodes = [](auto const& t)
+	{
+		std::vector<std::int32_t> v(t.ibegin(), t.iend());
+		std::size_t n = 0;
+		for (std::size_t i = 3; i < v.size(); i += 2) if (0 < v[i]) ++n;
+		return n;
+	};
+
+	auto bytes = [](auto const& t)
+	{
+		std::stringstream ss;
+		ss << t;
+		return ss.str().size();
+	};
+
+	std::uint32_t error = 0;
+
+	std::cout.imbue(std::locale(""));
+
+	std::cout << "---------- trie_benchmark__dawg_1 ----------" << std::endl;
+
+	std::cout << "std::vector<std::u32string> w{ (sorted words...) };" << std::endl;
+	std::cout << "\tsize:\t" << w32.size() << std::endl;
+
+	std::cout << "trie<char32_t>" << std::endl;
+
+	trie<char32_t> t1{};
+	auto start = std::chrono::system_clock::now();
+	t1.assign(w32.begin(), w32.end());
+	auto duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tassign:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+	std::cout << "\tnodes:\t" << nodes(t1) << std::endl;
+	std::cout << "\tbytes:\t" << bytes(t1) << std::endl;
+
+	start = std::chrono::system_clock::now();
+	for (auto const& s : w32) if (t1.find(s) == t1.end()) ++error;
+	duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tfind:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+	start = std::chrono::system_clock::now();
+	for (auto const& s : w32) if (!t1.contains(s)) ++error;
+	duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tcontains:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+	std::cout << "dawg<char32_t>" << std::endl;
+
+	dawg<char32_t> t2{};
+	start = std::chrono::system_clock::now();
+	t2.assign(w32.begin(), w32.end());
+	duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tassign:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+	std::cout << "\tnodes:\t" << nodes(t2) << std::endl;
+	std::cout << "\tbytes:\t" << bytes(t2) << std::endl;
+
+	start = std::chrono::system_clock::now();
+	for (auto const& s : w32) if (t2.find(s) == t2.end()) ++error;
+	duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tfind:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+	start = std::chrono::system_clock::now();
+	for (auto const& s : w32) if (!t2.contains(s)) ++error;
+	duration = std::chrono::system_clock::now() - start;
+
+	std::cout << "\tcontains:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+	std::cout << std::endl;
+
+	BOOST_CHECK(error == 0);
+}
+
+BOOST_AUTO_TEST_CASE(trie_benchmark__find_batch_1)
+{
+	using namespace wordring;
+
+	setup1();
+
+	// 検索順を無作為にして、キャッシュに乗らない遷移を再現する
+	std::vector<std::string> w8 = words_8;
+	std::vector<std::u32string> w32 = words_32;
+	std::shuffle(w8.begin(), w8.end(), std::mt19937());
+	std::shuffle(w32.begin(), w32.end(), std::mt19937());
+
+	std::uint32_t error = 0;
+
+	std::cout.imbue(std::locale(""));
+
+	std::cout << "---------- trie_benchmark__find_batch_1 ----------" << std::endl;
+
+	auto run = [&error](auto const& t, auto const& w)
+	{
+		std::size_t n1 = 0, n2 = 0;
+
+		auto start = std::chrono::system_clock::now();
+		for (int i = 0; i < 10; ++i) for (auto const& s : w) if (t.contains(s)) ++n1;
+		auto duration = std::chrono::system_clock::now() - start;
+
+		std::cout << "\tcontains:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+		std::vector<char> v(w.size());
+		start = std::chrono::system_clock::now();
+		for (int i = 0; i < 10; ++i)
+		{
+			t.contains_batch(w.begin(), w.end(), v.begin());
+			n2 += std::count(v.begin(), v.end(), 1);
+		}
+		duration = std::chrono::system_clock::now() - start;
+
+		std::cout << "\tcontains_batch:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+		if (n1 != n2 || n1 != w.size() * 10) ++error;
+	};
+
+	std::cout << "std::vector<std::string> w{ (shuffled words...) };" << std::endl;
+	std::cout << "\tsize:\t" << w8.size() << std::endl;
+	std::cout << "trie<char>" << std::endl;
+	run(trie<char>(words_8.begin(), words_8.end()), w8);
+
+	std::cout << "std::vector<std::u32string> w{ (shuffled words...) };" << std::endl;
+	std::cout << "\tsize:\t" << w32.size() << std::endl;
+	std::cout << "trie<char32_t>" << std::endl;
+	run(trie<char32_t>(words_32.begin(), words_32.end()), w32);
+
+	std::cout << std::endl;
+
+	BOOST_CHECK(error == 0);
+}
+
+BOOST_AUTO_TEST_CASE(trie_benchmark__concurrent_1)
+{
+	using namespace wordring;
+
+	setup1();
+
+	std::vector<std::string> w8 = words_8;
+	std::sort(w8.begin(), w8.end());
+	w8.erase(std::unique(w8.begin(), w8.end()), w8.end());
+
+	// 前半を初期の辞書とし、後半を実行中に追加・削除する
+	std::vector<std::string> w1(w8.begin(), w8.begin() + w8.size() / 2);
+	std::vector<std::string> w2(w8.begin() + w8.size() / 2, w8.end());
+	std::shuffle(w2.begin(), w2.end(), std::mt19937());
+
+	std::vector<std::string> keys = w8;
+	std::shuffle(keys.begin(), keys.end(), std::mt19937());
+
+	std::uint32_t const readers = std::clamp(std::thread::hardware_concurrency(), 2u, 8u) - 1;
+	auto const period = std::chrono::milliseconds(500);
+	std::size_t const batch = 256;
+
+	std::cout.imbue(std::locale(""));
+
+	std::cout << "---------- trie_benchmark__concurrent_1 ----------" << std::endl;
+	std::cout << "std::vector<std::string> w{ (sorted words...) };" << std::endl;
+	std::cout << "\tsize:\t" << w8.size() << std::endl;
+	std::cout << "\treaders:\t" << readers << std::endl;
+
+	// 読み取りスレッドを走らせ、期間中の検索回数を返す
+	auto run = [&](auto make_reader, auto write)
+	{
+		std::atomic<bool> done = false;
+		std::atomic<std::size_t> total = 0;
+
+		std::vector<std::thread> threads;
+		for (std::uint32_t i = 0; i < readers; ++i)
+		{
+			threads.emplace_back([&, i]()
+			{
+				auto read = make_reader();
+				std::size_t n = 0;
+				for (std::size_t j = i; !done; j = (j + 1) % keys.size(), ++n) read(keys[j]);
+				total += n;
+			});
+		}
+
+		std::size_t commits = 0;
+		auto start = std::chrono::system_clock::now();
+		while (std::chrono::system_clock::now() - start < period) if (write()) ++commits;
+
+		done = true;
+		for (auto& th : threads) th.join();
+
+		std::cout << "\t\tfinds/s:\t" << total * 1000 / period.count() << std::endl;
+		std::cout << "\t\tcommits:\t" << commits << std::endl;
+	};
+
+	for (bool update : { false, true })
+	{
+		std::cout << (update ? "updating " : "read only ") << std::endl;
+
+		std::cout << "\ttrie<char> + std::shared_mutex" << std::endl;
+		{
+			trie<char> t(w1.begin(), w1.end());
+			std::shared_mutex mutex;
+			std::size_t i = 0;
+
+			run([&]()
+			{
+				return [&](std::string const& s)
+				{
+					std::shared_lock<std::shared_mutex> lock(mutex);
+					return t.contains(s);
+				};
+			}, [&]()
+			{
+				if (!update) return false;
+
+				std::unique_lock<std::shared_mutex> lock(mutex);
+				for (std::size_t j = 0; j < batch; ++j)
+				{
+					std::string const& s = w2[(i / 2 * batch + j) % w2.size()];
+					if (i % 2 == 0) t.insert(s);
+					else t.erase(s);
+				}
+				++i;
+				return true;
+			});
+		}
+
+		std::cout << "\tconcurrent_trie<char>" << std::endl;
+		{
+			concurrent_trie<char> t(w1.begin(), w1.end());
+			std::size_t i = 0;
+
+			run([&]()
+			{
+				return [r = t.get_reader()](std::string const& s)
+				{
+					return r.pin()->contains(s);
+				};
+			}, [&]()
+			{
+				if (!update) return false;
+
+				for (std::size_t j = 0; j < batch; ++j)
+				{
+					std::string const& s = w2[(i / 2 * batch + j) % w2.size()];
+					if (i % 2 == 0) t.insert(s);
+					else t.erase(s);
+				}
+				++i;
+				t.commit();
+				return true;
+			});
+		}
+	}
+
+	std::cout << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(trie_benchmark__index_width_1)
+{
+	using namespace wordring;
+
+	setup1();
+
+	std::ifstream is(english_words_path);
+	BOOST_REQUIRE(is.is_open());
+
+	std::vector<std::string> w;
+	std::string buf{};
+	while (std::getline(is, buf)) if (!buf.empty()) w.push_back(buf);
+	std::shuffle(w.begin(), w.end(), std::mt19937());
+
+	// 16ビットの INDEX に収まる大きさまで減らす
+	std::vector<std::string> small(w.begin(), w.begin() + 8000);
+	while (30000 < trie<char>(small.begin(), small.end()).node_size()) small.resize(small.size() * 3 / 4);
+	std::sort(small.begin(), small.end());
+	small.erase(std::unique(small.begin(), small.end()), small.end());
+
+	std::vector<std::string> large = words_8;
+	std::sort(large.begin(), large.end());
+	large.erase(std::unique(large.begin(), large.end()), large.end());
+
+	std::cout.imbue(std::locale(""));
+
+	std::cout << "---------- trie_benchmark__index_width_1 ----------" << std::endl;
+
+	auto run = [](auto const& t, std::vector<std::string> const& keys, std::uint32_t rounds)
+	{
+		std::size_t n = 0;
+		auto start = std::chrono::system_clock::now();
+		for (std::uint32_t i = 0; i < rounds; ++i) for (auto const& s : keys) if (t.contains(s)) ++n;
+		auto duration = std::chrono::system_clock::now() - start;
+
+		std::cout << "		bytes:	" << t.stats().m_bytes << std::endl;
+		std::cout << "		contains():	" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+		return n;
+	};
+
+	std::cout << "std::vector<std::string> w{ (small english words...) };" << std::endl;
+	std::cout << "	size:	" << small.size() << std::endl;
+	std::uint32_t constexpr rounds = 200;
+
+	std::cout << "	trie<char, std::allocator<detail::trie_node16>>" << std::endl;
+	std::size_t n1 = run(trie<char, std::allocator<detail::trie_node16>>(small.begin(), small.end()), small, rounds);
+	std::cout << "	trie<char>" << std::endl;
+	std::size_t n2 = run(trie<char>(small.begin(), small.end()), small, rounds);
+	std::cout << "	trie<char, std::allocator<detail::trie_node64>>" << std::endl;
+	std::size_t n3 = run(trie<char, std::allocator<detail::trie_node64>>(small.begin(), small.end()), small, rounds);
+
+	std::cout << "std::vector<std::string> w{ (japanese words...) };" << std::endl;
+	std::cout << "	size:	" << large.size() << std::endl;
+
+	std::cout << "	trie<char>" << std::endl;
+	std::size_t n4 = run(trie<char>(large.begin(), large.end()), large, 10);
+	std::cout << "	trie<char, std::allocator<detail::trie_node64>>" << std::endl;
+	std::size_t n5 = run(trie<char, std::allocator<detail::trie_node64>>(large.begin(), large.end()), large, 10);
+
+	std::cout << std::endl;
+
+	BOOST_CHECK(n1 == small.size() * rounds && n1 == n2 && n2 == n3);
+	BOOST_CHECK(n4 == n5);
+}
+
+BOOST_AUTO_TEST_CASE(trie_benchmark__atom_string_pool_1)
+{
+	using namespace wordring;
+
+	setup1();
+
+	std::vector<std::u32string> w = words_32;
+	std::sort(w.begin(), w.end());
+	w.erase(std::unique(w.begin(), w.end()), w.end());
+
+	std::cout.imbue(std::locale(""));
+
+	std::cout << "---------- trie_benchmark__atom_string_pool_1 ----------" << std::endl;
+	std::cout << "std::vector<std::u32string> w{ (japanese words...) };" << std::endl;
+	std::cout << "\tsize:\t" << w.size() << std::endl;
+
+	auto as = basic_atom_set<std::u32string>(w.begin(), w.end());
+	std::vector<std::uint32_t> ids;
+	for (auto const& s : w) ids.push_back(as.at(s));
+	std::shuffle(ids.begin(), ids.end(), std::mt19937());
+
+	std::uint32_t constexpr rounds = 10;
+	std::size_t n1 = 0, n2 = 0, n3 = 0;
+
+	std::cout << "basic_atom_set<std::u32string>" << std::endl;
+	{
+		std::u32string s;
+		auto start = std::chrono::system_clock::now();
+		for (std::uint32_t i = 0; i < rounds; ++i) for (std::uint32_t id : ids) n1 += as.at(id).string(s).size();
+		auto duration = std::chrono::system_clock::now() - start;
+		std::cout << "\tstring():\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+	}
+
+	auto start = std::chrono::system_clock::now();
+	as.use_string_pool();
+	auto duration = std::chrono::system_clock::now() - start;
+	std::cout << "basic_atom_set<std::u32string> + use_string_pool()" << std::endl;
+	std::cout << "\tuse_string_pool():\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+	std::cout << "\tbytes:\t" << as.string_pool_bytes() << std::endl;
+	{
+		std::u32string s;
+		auto start = std::chrono::system_clock::now();
+		for (std::uint32_t i = 0; i < rounds; ++i) for (std::uint32_t id : ids) n2 += as.at(id).string(s).size();
+		auto duration = std::chrono::system_clock::now() - start;
+		std::cout << "\tstring():\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+	}
+	{
+		auto start = std::chrono::system_clock::now();
+		for (std::uint32_t i = 0; i < rounds; ++i) for (std::uint32_t id : ids) n3 += as.at(id).view().size();
+		auto duration = std::chrono::system_clock::now() - start;
+		std::cout << "\tview():\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+	}
+
+	std::cout << std::endl;
+
+	BOOST_CHECK(n1 == n2 && n2 == n3);
+}
+
+
+BOOST_AUTO_TEST_CASE(trie_benchmark__concurrent_atom_set_1)
+{
+	using namespace wordring;
+
+	setup1();
+
+	std::vector<std::string> w = words_8;
+	std::sort(w.begin(), w.end());
+	w.erase(std::unique(w.begin(), w.end()), w.end());
+
+	std::cout.imbue(std::locale(""));
+
+	std::cout << "---------- trie_benchmark__concurrent_atom_set_1 ----------" << std::endl;
+	std::cout << "std::vector<std::string> w{ (japanese words...) };" << std::endl;
+	std::cout << "\tsize:\t" << w.size() << std::endl;
+	std::cout << "\thardware_concurrency:\t" << std::thread::hardware_concurrency() << std::endl;
+
+	// スレッドごとに語を異なる順序で並べる
+	std::uint32_t constexpr max_threads = 32;
+	std::vector<std::vector<std::string const*>> orders(max_threads);
+	for (std::uint32_t i = 0; i < max_threads; ++i)
+	{
+		for (auto const& s : w) orders[i].push_back(&s);
+		std::shuffle(orders[i].begin(), orders[i].end(), std::mt19937(i));
+	}
+
+	// 各スレッドが全語を登録し、登録数/秒を表示する
+	auto run = [&](std::uint32_t n, auto make_intern)
+	{
+		std::atomic<std::size_t> sum = 0;
+		std::vector<std::thread> threads;
+
+		auto start = std::chrono::system_clock::now();
+		for (std::uint32_t i = 0; i < n; ++i)
+		{
+			threads.emplace_back([&, i]()
+			{
+				auto intern = make_intern();
+				std::size_t m = 0;
+				for (std::string const* s : orders[i]) m += intern(*s);
+				sum += m;
+			});
+		}
+		for (auto& th : threads) th.join();
+		auto duration = std::chrono::system_clock::now() - start;
+
+		auto us = std::max<std::int64_t>(1, std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+		std::cout << "\t\t" << n << " threads:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms\t"
+			<< (w.size() * n * 1000000 / us) << " interns/s" << std::endl;
+
+		return sum.load();
+	};
+
+	for (bool warm : { false, true })
+	{
+		std::cout << (warm ? "warm (all names interned)" : "cold (empty set)") << std::endl;
+
+		for (std::uint32_t n = 1; n <= max_threads; n *= 2)
+		{
+			std::size_t n1 = 0, n2 = 0;
+
+			std::cout << "\tstd::mutex + basic_atom_set<std::string>" << std::endl;
+			{
+				basic_atom_set<std::string> as;
+				std::mutex mutex;
+				if (warm) for (auto const& s : w) as.insert(s);
+
+				n1 = run(n, [&]()
+				{
+					return [&](std::string const& s)
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						return static_cast<std::uint32_t>(as.insert(s)) != 0;
+					};
+				});
+			}
+
+			std::cout << "\tconcurrent_atom_set<std::string>" << std::endl;
+			{
+				concurrent_atom_set<std::string> as;
+				if (warm)
+				{
+					auto r = as.get_reader();
+					for (auto const& s : w) r.insert(s);
+					as.commit();
+				}
+
+				n2 = run(n, [&]()
+				{
+					return [r = as.get_reader()](std::string const& s) mutable
+					{
+						return r.insert(s) != 0;
+					};
+				});
+				BOOST_CHECK(as.size() == w.size());
+			}
+
+			BOOST_CHECK(n1 == n2);
+		}
+	}
+
+	std::cout << std::endl;
+}
+
+
+BOOST_AUTO_TEST_CASE(trie_benchmark__aho_corasick_1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> w8;
+	std::ifstream is(english_words_path);
+	BOOST_REQUIRE(is.is_open());
+	std::string buf{};
+	while (std::getline(is, buf)) if (!buf.empty()) w8.push_back(buf);
+
+	// 語から無作為に選んだキーワードで、語を空白でつないだ文書を走査する
+	std::mt19937 mt;
+	std::size_t constexpr text_size = 1'000'000;
+
+	std::string text;
+	while (text.size() < text_size)
+	{
+		text += w8[mt() % w8.size()];
+		text.push_back(' ');
+	}
+
+	std::cout.imbue(std::locale(""));
+
+	std::cout << "---------- trie_benchmark__aho_corasick_1 ----------" << std::endl;
+	std::cout << "std::string text{ (english words...) };" << std::endl;
+	std::cout << "\tsize:\t" << text.size() << std::endl;
+
+	for (std::size_t n : { 100, 1'000, 10'000, 100'000 })
+	{
+		std::vector<std::string> keywords;
+		for (std::size_t i = 0; i < n; ++i) keywords.push_back(w8[mt() % w8.size()]);
+
+		std::cout << "keywords:\t" << n << std::endl;
+		std::size_t n1 = 0, n2 = 0;
+
+		std::cout << "\ttrie<char>::common_prefix_search() at each position" << std::endl;
+		{
+			auto t = trie<char>(keywords.begin(), keywords.end());
+			std::vector<std::pair<std::size_t, std::uint32_t>> result;
+
+			auto start = std::chrono::system_clock::now();
+			for (auto it = text.begin(); it != text.end(); ++it)
+			{
+				result.clear();
+				t.common_prefix_search(it, text.end(), std::back_inserter(result));
+				n1 += result.size();
+			}
+			auto duration = std::chrono::system_clock::now() - start;
+			std::cout << "\t\tscan:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+		}
+
+		std::cout << "\taho_corasick<char>" << std::endl;
+		{
+			auto start = std::chrono::system_clock::now();
+			auto ac = aho_corasick<char>(keywords.begin(), keywords.end());
+			auto duration = std::chrono::system_clock::now() - start;
+			std::cout << "\t\tconstruct:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+
+			start = std::chrono::system_clock::now();
+			auto m = ac.get_matcher();
+			std::vector<aho_corasick<char>::match_type> result;
+			for (char ch : text)
+			{
+				if (!m.push_back(ch)) continue;
+				result.clear();
+				m.matches(std::back_inserter(result));
+				n2 += result.size();
+			}
+			duration = std::chrono::system_clock::now() - start;
+			std::cout << "\t\tscan:\t" << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms" << std::endl;
+		}
+
+		std::cout << "\tmatches:\t" << n2 << std::endl;
+		BOOST_CHECK(n1 == n2);
+	}
+
+	std::cout << std::endl;
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,160 @@
+﻿// test/trie/trie_builder.cpp
+
+#include <boost/test/unit_test.hpp>
+
+#include <wordring/trie/trie_builder.hpp>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+	/*! 整列済みの重複の無いキー文字列を乱数で生成する
+	*/
+	template <typename String>
+	std::vector<String> random_keys(std::uint32_t seed, std::size_t n, typename String::value_type first, std::uint32_t alphabet)
+	{
+		std::mt19937 mt(seed);
+		std::vector<String> v;
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			String s(mt() % 8 + 1, first);
+			for (auto& ch : s) ch = static_cast<typename String::value_type>(first + mt() % alphabet);
+			v.push_back(s);
+		}
+		std::sort(v.begin(), v.end());
+		v.erase(std::unique(v.begin(), v.end()), v.end());
+		return v;
+	}
+
+	/*! ビルダーで構築した Trie木と insert() で構築した Trie木を比較する
+	*/
+	template <typename Builder, typename Trie, typename String>
+	void check(std::vector<String> const& v)
+	{
+		Builder b;
+		for (std::uint32_t i = 0; i < v.size(); ++i) b.push_back(v[i], i * 3);
+		BOOST_CHECK(b.size() == v.size());
+
+		auto t1 = b.finish();
+		BOOST_CHECK(b.size() == 0);
+
+		Trie t2;
+		for (std::uint32_t i = 0; i < v.size(); ++i) t2[v[i]] = i * 3;
+
+		BOOST_CHECK(t1.size() == v.size());
+		BOOST_CHECK(t1.stats().m_live == t2.stats().m_live);
+
+		int e = 0;
+		for (std::uint32_t i = 0; i < v.size(); ++i)
+		{
+			if (!t1.contains(v[i]) || static_cast<std::uint32_t>(t1.at(v[i])) != i * 3) ++e;
+			// 途中のノードは葉ではない
+			String s = v[i].substr(0, v[i].size() - 1);
+			if (t1.contains(s) != t2.contains(s)) ++e;
+		}
+		BOOST_CHECK(e == 0);
+
+		// 構築後も通常の Trie木として変更できる
+		for (std::uint32_t i = 0; i < v.size(); i += 2) t1.erase(v[i]);
+		for (std::uint32_t i = 0; i < v.size(); ++i) if (t1.contains(v[i]) != (i % 2 == 1)) ++e;
+		BOOST_CHECK(e == 0);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(trie_builder__test)
+
+/*
+basic_trie_builder(allocator_type const& alloc = allocator_type())
+trie_type finish()
+*/
+BOOST_AUTO_TEST_CASE(trie_builder__construct__1)
+{
+	using namespace wordring;
+
+	trie_builder<char> b;
+	auto t1 = b.finish();
+	BOOST_CHECK(t1.empty());
+	BOOST_CHECK(t1.size() == 0);
+
+	t1.insert(std::string("a"));
+	BOOST_CHECK(t1.contains(std::string("a")));
+}
+
+/*
+void push_back(Key const& key, value_type value = 0)
+*/
+BOOST_AUTO_TEST_CASE(trie_builder__push_back__1)
+{
+	using namespace wordring;
+
+	trie_builder<char32_t> b;
+	b.push_back(std::u32string(U"あ"), 1);
+	b.push_back(std::u32string(U"あう"), 2);
+	b.push_back(std::u32string(U"い"), 3);
+	b.push_back(std::u32string(U"うあい"), 4);
+	b.push_back(std::u32string(U"うえ"), 5);
+	b.push_back(std::u32string(U""));
+	BOOST_CHECK(b.size() == 5);
+
+	auto t = b.finish();
+	BOOST_CHECK(t.size() == 5);
+	BOOST_CHECK(t.at(std::u32string(U"あ")) == 1);
+	BOOST_CHECK(t.at(std::u32string(U"あう")) == 2);
+	BOOST_CHECK(t.at(std::u32string(U"い")) == 3);
+	BOOST_CHECK(t.at(std::u32string(U"うあい")) == 4);
+	BOOST_CHECK(t.at(std::u32string(U"うえ")) == 5);
+	BOOST_CHECK(t.contains(std::u32string(U"う")) == false);
+	BOOST_CHECK(t.contains(std::u32string(U"うあ")) == false);
+
+	auto t2 = trie<char32_t>(t.ibegin(), t.iend());
+	BOOST_CHECK(t2.size() == 5);
+	BOOST_CHECK(t2.at(std::u32string(U"うえ")) == 5);
+}
+
+/*
+整列されていないキー文字列、重複するキー文字列は例外を投げる
+*/
+BOOST_AUTO_TEST_CASE(trie_builder__push_back__2)
+{
+	using namespace wordring;
+
+	trie_builder<char> b;
+	b.push_back(std::string("ab"));
+	BOOST_CHECK_THROW(b.push_back(std::string("ab")), std::invalid_argument);
+	BOOST_CHECK_THROW(b.push_back(std::string("a")), std::invalid_argument);
+	BOOST_CHECK_THROW(b.push_back(std::string("aa")), std::invalid_argument);
+	b.push_back(std::string("b"));
+	// char は符号付きでも、バイト列として比較する
+	b.push_back(std::string("\xE3\x81\x82"));
+	BOOST_CHECK_THROW(b.push_back(std::string("c")), std::invalid_argument);
+
+	auto t = b.finish();
+	BOOST_CHECK(t.size() == 3);
+	BOOST_CHECK(t.contains(std::string("\xE3\x81\x82")));
+
+	// finish() の後は最初から追加できる
+	b.push_back(std::string("a"));
+	BOOST_CHECK(b.finish().size() == 1);
+}
+
+/*
+乱数で生成したキー文字列を insert() で構築した Trie木と比較する
+*/
+BOOST_AUTO_TEST_CASE(trie_builder__push_back__3)
+{
+	using namespace wordring;
+
+	for (std::uint32_t seed = 0; seed < 5; ++seed)
+	{
+		check<trie_builder<char>, trie<char>>(random_keys<std::string>(seed, 2000, 'a', 4));
+		check<stable_trie_builder<char>, stable_trie<char>>(random_keys<std::string>(seed, 2000, 'a', 4));
+		check<trie_builder<char16_t>, trie<char16_t>>(random_keys<std::u16string>(seed, 2000, u'\x00FE', 4));
+		check<stable_trie_builder<char32_t>, stable_trie<char32_t>>(random_keys<std::u32string>(seed, 2000, U'あ', 300));
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,7 +4,10 @@
 
 #include <wordring/trie/trie_heap.hpp>
 
+#include <algorithm>
+#include <random>
 #include <sstream>
+#include <vector>
 
 namespace
 {
@@ -21,7 +24,7 @@ namespace
 
 		using base_type::trie_heap_serialize_iterator;
 
-		test_iterator(container const& c, std::uint32_t n)
+		test_iterator(container const& c, std::size_t n)
 			: base_type(c, n)
 		{
 		}
@@ -39,6 +42,9 @@ namespace
 		using base_type::free;
 		using base_type::locate;
 		using base_type::is_free;
+		using base_type::invalidate;
+
+		using base_type::label_vector;
 
 		using base_type::m_c;
 
@@ -82,6 +88,156 @@ BOOST_AUTO_TEST_CASE(trie_heap_serialize_iterator__construct__1)
 	BOOST_CHECK(it1 != it2);
 }
 
+// ----------------------------------------------------------------------------
+// trie_label_set
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(trie_label_set__construct__1)
+{
+	using namespace wordring;
+
+	detail::trie_label_set ls1{};
+	BOOST_CHECK(ls1.empty());
+
+	std::vector<std::uint16_t> v{ 0, 63, 64, 255, 256 };
+	detail::trie_label_set ls2(v);
+	BOOST_CHECK(!ls2.empty());
+	BOOST_CHECK(ls2.test(0));
+	BOOST_CHECK(ls2.test(1) == false);
+	BOOST_CHECK(ls2.test(64));
+	BOOST_CHECK(ls2.test(256));
+
+	std::vector<std::uint16_t> labels;
+	ls2.labels(labels);
+	BOOST_CHECK(labels == v);
+}
+
+// trie_label_set& operator|=(trie_label_set const& other) noexcept
+BOOST_AUTO_TEST_CASE(trie_label_set__union__1)
+{
+	using namespace wordring;
+
+	detail::trie_label_set ls(std::vector<std::uint16_t>{ 3, 200 });
+	ls |= detail::trie_label_set(std::vector<std::uint16_t>{ 1, 3, 256 });
+
+	std::vector<std::uint16_t> labels;
+	ls.labels(labels);
+	BOOST_CHECK(labels == std::vector<std::uint16_t>({ 1, 3, 200, 256 }));
+}
+
+// ----------------------------------------------------------------------------
+// trie_free_bitmap
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(trie_free_bitmap__construct__1)
+{
+	using namespace wordring;
+
+	detail::trie_free_bitmap<std::allocator<base_node>> bm{};
+
+	BOOST_CHECK(bm.limit() == 0);
+	BOOST_CHECK(bm.prev(100) == 0);
+	BOOST_CHECK(bm.next(0) == 0);
+}
+
+// void set(index_type idx)
+// void erase(index_type idx)
+// bool test(index_type idx) const
+BOOST_AUTO_TEST_CASE(trie_free_bitmap__set__1)
+{
+	using namespace wordring;
+
+	detail::trie_free_bitmap<std::allocator<base_node>> bm{};
+	bm.reset(200);
+
+	bm.set(63);
+	bm.set(64);
+	bm.set(64);
+	BOOST_CHECK(bm.test(63));
+	BOOST_CHECK(bm.test(64));
+	BOOST_CHECK(bm.test(65) == false);
+
+	bm.erase(63);
+	bm.erase(63);
+	BOOST_CHECK(bm.test(63) == false);
+	BOOST_CHECK(bm.test(64));
+}
+
+// index_type prev(index_type idx) const
+BOOST_AUTO_TEST_CASE(trie_free_bitmap__prev__1)
+{
+	using namespace wordring;
+
+	detail::trie_free_bitmap<std::allocator<base_node>> bm{};
+	bm.reset(20000);
+
+	bm.set(1);
+	bm.set(63);
+	bm.set(64);
+	bm.set(4095);
+	bm.set(12289);
+
+	BOOST_CHECK(bm.prev(1) == 0);
+	BOOST_CHECK(bm.prev(2) == 1);
+	BOOST_CHECK(bm.prev(63) == 1);
+	BOOST_CHECK(bm.prev(64) == 63);
+	BOOST_CHECK(bm.prev(65) == 64);
+	BOOST_CHECK(bm.prev(4095) == 64);
+	BOOST_CHECK(bm.prev(4096) == 4095);
+	BOOST_CHECK(bm.prev(12289) == 4095);
+	BOOST_CHECK(bm.prev(20000) == 12289);
+	BOOST_CHECK(bm.prev(30000) == 12289);
+}
+
+// index_type next(index_type idx) const
+BOOST_AUTO_TEST_CASE(trie_free_bitmap__next__1)
+{
+	using namespace wordring;
+
+	detail::trie_free_bitmap<std::allocator<base_node>> bm{};
+	bm.reset(20000);
+
+	bm.set(1);
+	bm.set(63);
+	bm.set(64);
+	bm.set(4095);
+	bm.set(12289);
+
+	BOOST_CHECK(bm.next(0) == 1);
+	BOOST_CHECK(bm.next(1) == 1);
+	BOOST_CHECK(bm.next(2) == 63);
+	BOOST_CHECK(bm.next(64) == 64);
+	BOOST_CHECK(bm.next(65) == 4095);
+	BOOST_CHECK(bm.next(4096) == 12289);
+	BOOST_CHECK(bm.next(12290) == 0);
+	BOOST_CHECK(bm.next(30000) == 0);
+}
+
+// index_type find(index_type first, trie_label_set const& labels, std::uint64_t& walk) const
+BOOST_AUTO_TEST_CASE(trie_free_bitmap__find__1)
+{
+	using namespace wordring;
+
+	detail::trie_free_bitmap<std::allocator<base_node>> bm{};
+	bm.reset(300);
+
+	bm.set(10);
+	bm.set(12);
+	bm.set(100);
+	bm.set(200);
+	bm.set(202);
+
+	std::uint64_t walk = 0;
+	BOOST_CHECK(bm.find(1, detail::trie_label_set(std::vector<std::uint16_t>{ 0 }), walk) == 10);
+	BOOST_CHECK(bm.find(11, detail::trie_label_set(std::vector<std::uint16_t>{ 0 }), walk) == 12);
+	BOOST_CHECK(bm.find(1, detail::trie_label_set(std::vector<std::uint16_t>{ 5, 7 }), walk) == 5);
+	BOOST_CHECK(bm.find(1, detail::trie_label_set(std::vector<std::uint16_t>{ 0, 100 }), walk) == 100);
+	// 範囲外のノードは未使用として扱う
+	BOOST_CHECK(bm.find(1, detail::trie_label_set(std::vector<std::uint16_t>{ 0, 1 }), walk) == 300);
+	BOOST_CHECK(bm.find(1, detail::trie_label_set(std::vector<std::uint16_t>{ 0, 2, 100 }), walk) == 200);
+	BOOST_CHECK(walk != 0);
+}
+
 // ----------------------------------------------------------------------------
 // trie_heap
 // ----------------------------------------------------------------------------
@@ -206,6 +362,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__reserve__5)
 
 	test_heap heap{};
 	heap.m_c = { { 0, -2 }, { 0, 0 }, { 0, 0 }, { 0, 0 } };
+	heap.invalidate();
 	heap.reserve(1);
 
 	std::vector<detail::trie_node> v{ { 0, -2 }, { 0, 0 }, { 0, -4 }, { 0, 0 }, { 0, 0 } };
@@ -219,6 +376,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__reserve__6)
 
 	test_heap heap{};
 	heap.m_c = { { 0, -2 }, { 0, 0 }, { 0, 0 }, { 0, 0 } };
+	heap.invalidate();
 	heap.reserve(2);
 
 	std::vector<detail::trie_node> v{ { 0, -2 }, { 0, 0 }, { 0, -4 }, { 0, 0 }, { 0, -5 }, { 0, 0 } };
@@ -232,6 +390,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__reserve__7)
 
 	test_heap heap{};
 	heap.m_c = { { 0, 0 }, { 0, 0 }, { 0, 0 }, { 0, 0 } };
+	heap.invalidate();
 	heap.reserve(1);
 
 	std::vector<detail::trie_node> v{ { 0, -4 }, { 0, 0 }, { 0, 0 }, { 0, 0 }, { 0, 0 } };
@@ -245,6 +404,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__reserve__8)
 
 	test_heap heap{};
 	heap.m_c = { { 0, 0 }, { 0, 0 }, { 0, 0 }, { 0, 0 } };
+	heap.invalidate();
 	heap.reserve(2);
 
 	std::vector<detail::trie_node> v{ { 0, -4 }, { 0, 0 }, { 0, 0 }, { 0, 0 }, { 0, -5 }, { 0, 0 } };
@@ -259,6 +419,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__allocate__1)
 
 	test_heap heap{};
 	heap.m_c = { { 0, -2 }, { 0, 0 }, { 0, 0 } };
+	heap.invalidate();
 
 	heap.allocate(2);
 
@@ -266,12 +427,31 @@ BOOST_AUTO_TEST_CASE(trie_heap__allocate__1)
 	BOOST_CHECK(heap.m_c == v);
 }
 
+// 大きさを変えずに m_c を書き換えた後、 invalidate() で索引を作り直す
+BOOST_AUTO_TEST_CASE(trie_heap__allocate__invalidate__1)
+{
+	using namespace wordring;
+
+	test_heap heap{};
+	heap.m_c = { { 0, -2 }, { 0, 0 }, { 0, -3 }, { 0, -4 }, { 0, 0 } };
+	heap.invalidate();
+	heap.allocate(2);
+
+	heap.m_c = { { 0, -4 }, { 0, 0 }, { 0, 9 }, { 0, 9 }, { 0, 0 } };
+	heap.invalidate();
+	heap.allocate(4);
+
+	std::vector<detail::trie_node> v{ { 0, 0 }, { 0, 0 }, { 0, 9 }, { 0, 9 }, { 0, 0 } };
+	BOOST_CHECK(heap.m_c == v);
+}
+
 BOOST_AUTO_TEST_CASE(trie_heap__allocate__2)
 {
 	using namespace wordring;
 
 	test_heap heap{};
 	heap.m_c = { { 0, -3 }, { 0, 0 }, { 0, 0 }, { 0, -4 }, { 0, 0 } };
+	heap.invalidate();
 
 	heap.allocate(3);
 
@@ -285,6 +465,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__allocate__3)
 
 	test_heap heap{};
 	heap.m_c = { { 0, -1 }, { 0, -2 }, { 0, -3 }, { 0, 0 } };
+	heap.invalidate();
 
 	heap.allocate(2);
 
@@ -299,6 +480,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__allocate__4)
 
 	test_heap heap{};
 	heap.m_c = { { 0, -1 }, { 0, 0 } };
+	heap.invalidate();
 
 	static_vector<std::uint16_t, 257> sv = { 0 };
 	heap.allocate(1, sv);
@@ -313,6 +495,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__allocate__5)
 
 	test_heap heap{};
 	heap.m_c = { { 0, -1 }, { 0, -2 }, { 0, -3 }, { 0, -4 }, { 0, 0 } };
+	heap.invalidate();
 
 	heap.allocate(1, { 0, 2 });
 
@@ -326,6 +509,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__allocate__6)
 
 	test_heap heap{};
 	heap.m_c = { { 0, 0 } };
+	heap.invalidate();
 
 	static_vector<std::uint16_t, 257> sv = { 0 };
 	heap.allocate(1, sv);
@@ -340,6 +524,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__allocate__7)
 
 	test_heap heap{};
 	heap.m_c = { { 0, 0 } };
+	heap.invalidate();
 
 	heap.allocate(1, { 0, 2 });
 
@@ -362,6 +547,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__free__1)
 
 	test_heap heap{};
 	heap.m_c = { { 0, 0 }, { 0, 0 }, { 0, 9 } };
+	heap.invalidate();
 
 	heap.free(2);
 
@@ -375,6 +561,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__free__2)
 
 	test_heap heap{};
 	heap.m_c = { { 0, -1 }, { 0, -3 }, { 0, 9 }, { 0, 0 } };
+	heap.invalidate();
 
 	heap.free(2);
 
@@ -388,6 +575,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__free__3)
 
 	test_heap heap{};
 	heap.m_c = { { 0, -2 }, { 0, 9 }, { 0, 0 }, { 0, 9 } };
+	heap.invalidate();
 
 	heap.free(3);
 
@@ -395,6 +583,31 @@ BOOST_AUTO_TEST_CASE(trie_heap__free__3)
 	BOOST_CHECK(heap.m_c == v);
 }
 
+BOOST_AUTO_TEST_CASE(trie_heap__free__8)
+{
+	using namespace wordring;
+
+	// 未使用ノードの索引を使った解放と割り当てが、整列したリンクリストを保つことを確認する。
+	test_heap heap{};
+	heap.reserve(10000);
+
+	std::vector<std::int32_t> v;
+	for (std::int32_t i = 2; i < 10002; ++i) v.push_back(i);
+	std::shuffle(v.begin(), v.end(), std::mt19937());
+
+	for (std::int32_t idx : v) heap.allocate(idx);
+	BOOST_CHECK(heap.m_c.front().m_check == 0);
+
+	for (std::size_t i = 0; i < v.size(); i += 2) heap.free(v[i]);
+
+	std::vector<std::int32_t> v1, v2;
+	for (std::size_t i = 0; i < v.size(); i += 2) v1.push_back(v[i]);
+	std::sort(v1.begin(), v1.end());
+	for (std::int32_t i = -heap.m_c.front().m_check; i != 0; i = -heap.m_c[i].m_check) v2.push_back(i);
+
+	BOOST_CHECK(v1 == v2);
+}
+
 // void free(index_type base, label_vector const& labels)
 BOOST_AUTO_TEST_CASE(trie_heap__free__4)
 {
@@ -402,6 +615,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__free__4)
 
 	test_heap heap{};
 	heap.m_c = { { 0, 0 }, { 0, 0 }, { 0, 9 } };
+	heap.invalidate();
 
 	static_vector<std::uint16_t, 257> labels{ 0 };
 	heap.free(2, labels);
@@ -416,6 +630,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__free__5)
 
 	test_heap heap{};
 	heap.m_c = { { 0, -4 }, { 0, 0 }, { 0, 9 }, { 0, 9 }, { 0, 0 } };
+	heap.invalidate();
 
 	heap.free(2, { 0, 1 });
 
@@ -429,6 +644,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__free__6)
 
 	test_heap heap{};
 	heap.m_c = { { 0, -3 }, { 0, 0 }, { 0, 9 }, { 0, -5 }, { 0, 9 }, { 0, 0 } };
+	heap.invalidate();
 
 	heap.free(2, { 0, 2 });
 
@@ -442,6 +658,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__free__7)
 
 	test_heap heap{};
 	heap.m_c = { { 0, -3 }, { 0, 0 }, { 0, 9 }, { 0, 0 }, { 0, 9 } };
+	heap.invalidate();
 
 	heap.free(2, { 0, 2 });
 
@@ -502,6 +719,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__locate__5)
 {
 	test_heap heap{};
 	heap.m_c = { { 0, -3 }, { 0, 0 }, { 0, 0 }, { 0, 0 } };
+	heap.invalidate();
 
 	std::int32_t before;
 	BOOST_CHECK(heap.locate({ 1 }, before) == 2);
@@ -512,6 +730,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__locate__6)
 {
 	test_heap heap{};
 	heap.m_c = { { 0, -3 }, { 0, 0 }, { 0, 0 }, { 0, 0 } };
+	heap.invalidate();
 
 	std::int32_t before;
 	BOOST_CHECK(heap.locate({ 2 }, before) == 1);
@@ -522,17 +741,71 @@ BOOST_AUTO_TEST_CASE(trie_heap__locate__7)
 {
 	test_heap heap{};
 	heap.m_c = { { 0, -2 }, { 0, 0 }, { 0, -4 }, { 0, 9 }, { 0, 0 } };
+	heap.invalidate();
 
 	std::int32_t before;
 	BOOST_CHECK(heap.locate({ 2 }, before) == 2);
 	BOOST_CHECK(before == 2);
 }
 
+/*
+乱数で割り当てと解放を繰り返したヒープで、全てのBASEを順に調べた結果と比較する
+*/
+BOOST_AUTO_TEST_CASE(trie_heap__locate__8)
+{
+	using namespace wordring;
+
+	std::mt19937 mt;
+
+	test_heap heap{};
+	heap.reserve(3000);
+
+	std::vector<std::int32_t> used;
+	for (int n = 0; n < 5000; ++n)
+	{
+		if (used.empty() || mt() % 3 != 0)
+		{
+			std::int32_t idx = mt() % (heap.m_c.size() - 2) + 2;
+			if (!heap.is_free(idx, { 0 })) continue;
+			heap.allocate(idx);
+			heap.m_c[idx].m_check = 1;
+			used.push_back(idx);
+		}
+		else
+		{
+			std::size_t i = mt() % used.size();
+			heap.free(used[i]);
+			used.erase(used.begin() + i);
+		}
+	}
+
+	int e = 0;
+	for (int n = 0; n < 500; ++n)
+	{
+		std::vector<std::uint16_t> v;
+		std::uint32_t fanout = (n % 2 == 0) ? mt() % 4 + 1 : mt() % 200 + 1;
+		for (std::uint32_t i = 0; i < fanout; ++i) v.push_back(mt() % 257);
+		std::sort(v.begin(), v.end());
+		v.erase(std::unique(v.begin(), v.end()), v.end());
+
+		test_heap::label_vector labels(v.begin(), v.end());
+
+		std::int32_t base = 1;
+		while (!heap.is_free(base, labels)) ++base;
+
+		std::int32_t before;
+		if (heap.locate(labels, before) != base) ++e;
+		if (before != 0 && (heap.m_c[before].m_check > 0 || base + labels.front() <= before)) ++e;
+	}
+	BOOST_CHECK(e == 0);
+}
+
 // bool is_free(index_type base, label_vector const& labels) const
 BOOST_AUTO_TEST_CASE(trie_heap__is_free__1)
 {
 	test_heap heap{};
 	heap.m_c = { { 0, -1 }, { 0, 0 } };
+	heap.invalidate();
 
 	BOOST_CHECK(heap.is_free(1, { 0 }) == false);  // index 1のcheckは常に0なので使用できない
 }
@@ -541,6 +814,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__is_free__2)
 {
 	test_heap heap{};
 	heap.m_c = { { 0, -1 }, { 0, 1 } };
+	heap.invalidate();
 
 	BOOST_CHECK(heap.is_free(1, { 1 }));
 }
@@ -549,6 +823,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__is_free__3)
 {
 	test_heap heap{};
 	heap.m_c = { { 0, -1 }, { 0, 1 } };
+	heap.invalidate();
 
 	BOOST_CHECK(heap.is_free(1, { 0 }) == false);
 }
@@ -558,6 +833,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__is_free__4)
 {
 	test_heap heap{};
 	heap.m_c = { { 0, -3 }, { 0, 0 }, { 0, 1 }, { 0, 0 } };
+	heap.invalidate();
 
 	BOOST_CHECK(heap.is_free(1, 1, { 1, 2 }));
 }
@@ -566,6 +842,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__is_free__5)
 {
 	test_heap heap{};
 	heap.m_c = { { 0, -3 }, { 0, 0 }, { 0, 1 }, { 0, 0 } };
+	heap.invalidate();
 
 	BOOST_CHECK(heap.is_free(1, 1, { 0, 1 }) == false);
 }
@@ -578,6 +855,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__stream__1)
 {
 	test_heap h1{}, h2{};
 	h1.m_c = { { 1, 2 }, { 3, 4 }, { 5, 6 }, { 7, 8 } };
+	h1.invalidate();
 
 	std::stringstream ss;
 	ss << h1;
@@ -590,6 +868,7 @@ BOOST_AUTO_TEST_CASE(trie_heap__stream__2)
 {
 	test_heap h1{}, h2{};
 	h1.m_c = {};
+	h1.invalidate();
 
 	std::stringstream ss;
 	ss << h1;
@@ -0,0 +1,117 @@
+﻿// test/trie/trie_leaf_iterator.cpp
+
+#include <boost/test/unit_test.hpp>
+
+#include <wordring/trie/trie.hpp>
+#include <wordring/trie/trie_leaf_iterator.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	template <typename Trie, typename String>
+	std::vector<String> enumerate(Trie const& trie)
+	{
+		std::vector<String> result;
+		for (auto it = trie.leaf_begin(); it != trie.leaf_end(); ++it)
+		{
+			String s;
+			it.string(s);
+			result.push_back(s);
+		}
+		return result;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(trie_leaf_iterator__test)
+
+// ----------------------------------------------------------------------------
+// const_trie_leaf_iterator
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(const_trie_leaf_iterator__construct__1)
+{
+	using namespace wordring;
+
+	trie<char32_t> t;
+	BOOST_CHECK(t.leaf_begin() == t.leaf_end());
+
+	trie<char32_t>::const_leaf_iterator it1{}, it2;
+	BOOST_CHECK(it1 == it2);
+}
+
+/*
+value_type operator*() const
+std::uint32_t value() const
+*/
+BOOST_AUTO_TEST_CASE(const_trie_leaf_iterator__reference__1)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	auto t = trie<char32_t>(v.begin(), v.end());
+	for (std::uint32_t i = 0; i < v.size(); ++i) t.at(v[i]) = i + 10;
+
+	auto it = t.leaf_begin();
+	BOOST_CHECK(*(*it) == U'あ');
+	BOOST_CHECK(*it == t.find(std::u32string(U"あ")));
+	BOOST_CHECK(it.value() == 10);
+	BOOST_CHECK(t.at(*it) == 10);
+
+	++it;
+	BOOST_CHECK(*(*it) == U'う');
+	BOOST_CHECK(*(*it).parent() == U'あ');
+	BOOST_CHECK(it.value() == 11);
+
+	it++;
+	BOOST_CHECK(it.value() == 12);
+}
+
+/*
+const_trie_leaf_iterator& operator++()
+
+全ての葉を辞書順に列挙する
+*/
+BOOST_AUTO_TEST_CASE(const_trie_leaf_iterator__increment__1)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+
+	auto t1 = trie<char32_t>(v.begin(), v.end());
+	BOOST_CHECK((enumerate<trie<char32_t>, std::u32string>(t1) == v));
+
+	auto t2 = stable_trie<char32_t>(v.begin(), v.end());
+	BOOST_CHECK((enumerate<stable_trie<char32_t>, std::u32string>(t2) == v));
+
+	t1.use_sibling_table();
+	BOOST_CHECK((enumerate<trie<char32_t>, std::u32string>(t1) == v));
+}
+
+BOOST_AUTO_TEST_CASE(const_trie_leaf_iterator__increment__2)
+{
+	using namespace wordring;
+
+	std::mt19937 mt;
+	std::vector<std::string> v;
+	for (int i = 0; i < 3000; ++i)
+	{
+		std::string s(mt() % 6 + 1, '\0');
+		for (char& ch : s) ch = static_cast<char>(0x7E + mt() % 4);
+		v.push_back(s);
+	}
+
+	trie<char> t;
+	for (auto const& s : v) t.insert(s);
+
+	// std::string の比較は unsigned char による
+	std::sort(v.begin(), v.end());
+	v.erase(std::unique(v.begin(), v.end()), v.end());
+
+	BOOST_CHECK((enumerate<trie<char>, std::string>(t) == v));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,203 @@
+﻿// test/trie/trie_map.cpp
+
+#include <boost/test/unit_test.hpp>
+
+#include <wordring/trie/trie_map.hpp>
+
+#include <wordring/whatwg/infra/unicode.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define STRING(str) #str
+#define TO_STRING(str) STRING(str)
+
+namespace
+{
+	std::string const japanese_words_path{ TO_STRING(JAPANESE_WORDS_PATH) };
+
+	template <typename Map>
+	std::map<typename Map::key_type, typename Map::mapped_type> to_map(Map const& m)
+	{
+		std::map<typename Map::key_type, typename Map::mapped_type> result;
+		for (auto [key, value] : m) result.emplace(key, value);
+		return result;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(trie_map_test)
+
+// basic_trie_map(std::initializer_list<std::pair<key_type const, mapped_type>> il, allocator_type const& alloc = allocator_type())
+BOOST_AUTO_TEST_CASE(trie_map_construct_1)
+{
+	using namespace wordring;
+
+	auto m = trie_map<char, std::string>{ { "b", "2" }, { "a", "1" }, { "ab", "3" }, { "a", "x" } };
+
+	BOOST_CHECK(m.size() == 3);
+	BOOST_CHECK(m.at(std::string("a")) == "1");
+	BOOST_CHECK(m.at(std::string("ab")) == "3");
+	BOOST_CHECK(m.at(std::string("b")) == "2");
+	BOOST_CHECK_THROW(m.at(std::string("c")), std::out_of_range);
+
+	trie_map<char, std::string> m2;
+	BOOST_CHECK(m2.empty());
+	BOOST_CHECK(m2.begin() == m2.end());
+}
+
+// emplace(), operator[](), insert_or_assign()
+BOOST_AUTO_TEST_CASE(trie_map_emplace_1)
+{
+	using namespace wordring;
+
+	trie_map<char32_t, std::vector<int>> m;
+
+	auto r1 = m.emplace(std::u32string(U"あい"), 3, 7);
+	BOOST_CHECK(r1.second);
+	BOOST_CHECK((*r1.first).first == U"あい");
+	BOOST_CHECK((*r1.first).second == std::vector<int>(3, 7));
+
+	auto r2 = m.emplace(std::u32string(U"あい"), 1, 1);
+	BOOST_CHECK(r2.second == false);
+	BOOST_CHECK(r2.first == r1.first);
+	BOOST_CHECK(m.at(std::u32string(U"あい")) == std::vector<int>(3, 7));
+
+	BOOST_CHECK(m.emplace(std::u32string()).second == false);
+
+	m[std::u32string(U"あ")].push_back(5);
+	BOOST_CHECK(m.at(std::u32string(U"あ")) == std::vector<int>(1, 5));
+	BOOST_CHECK(m.size() == 2);
+
+	auto r3 = m.insert_or_assign(std::u32string(U"あ"), std::vector<int>{ 9 });
+	BOOST_CHECK(r3.second == false);
+	BOOST_CHECK(m.at(std::u32string(U"あ")) == std::vector<int>{ 9 });
+	BOOST_CHECK(m.at(std::u32string(U"あい")) == std::vector<int>(3, 7));
+}
+
+// erase()
+BOOST_AUTO_TEST_CASE(trie_map_erase_1)
+{
+	using namespace wordring;
+
+	auto m = trie_map<char, std::string>{ { "a", "1" }, { "ab", "2" }, { "abc", "3" }, { "b", "4" } };
+	BOOST_CHECK(m.capacity() == 4);
+
+	BOOST_CHECK(m.erase(std::string("abc")) == 1);
+	BOOST_CHECK(m.erase(std::string("abc")) == 0);
+	BOOST_CHECK(m.size() == 3);
+	BOOST_CHECK(m.at(std::string("ab")) == "2");
+
+	// 空きスロットは再利用される
+	m.emplace(std::string("c"), "5");
+	BOOST_CHECK(m.capacity() == 4);
+	BOOST_CHECK(m.at(std::string("c")) == "5");
+
+	auto it = m.erase(m.find(std::string("ab")));
+	BOOST_CHECK((*it).first == "b");
+	BOOST_CHECK(m.at(std::string("a")) == "1");
+
+	it = m.erase(m.find(std::string("c")));
+	BOOST_CHECK(it == m.end());
+
+	BOOST_CHECK((to_map(m) == std::map<std::string, std::string>{ { "a", "1" }, { "b", "4" } }));
+}
+
+// iterator
+BOOST_AUTO_TEST_CASE(trie_map_iterator_1)
+{
+	using namespace wordring;
+
+	std::map<std::u16string, int> expected{ { u"あ", 1 }, { u"あう", 2 }, { u"い", 3 }, { u"うあい", 4 }, { u"うえ", 5 } };
+
+	trie_map<char16_t, int> m(expected.begin(), expected.end());
+
+	std::vector<std::u16string> keys;
+	for (auto it = m.begin(); it != m.end(); ++it) keys.push_back((*it).first);
+	BOOST_CHECK(std::is_sorted(keys.begin(), keys.end()));
+	BOOST_CHECK(to_map(m) == expected);
+
+	for (auto [key, value] : m) value *= 10;
+	BOOST_CHECK(m.at(std::u16string(u"うえ")) == 50);
+
+	trie_map<char16_t, int> const& c = m;
+	trie_map<char16_t, int>::const_iterator it = m.find(std::u16string(u"うあい"));
+	BOOST_CHECK(it == c.find(std::u16string(u"うあい")));
+	BOOST_CHECK(it.node() == c.trie().find(std::u16string(u"うあい")));
+	BOOST_CHECK(c.find(std::u16string(u"うあ")) == c.end());
+}
+
+// operator<<, operator>>
+BOOST_AUTO_TEST_CASE(trie_map_stream_1)
+{
+	using namespace wordring;
+
+	auto m1 = stable_trie_map<char, std::string>{ { "a", "1" }, { "ab", "" }, { "abc", "3" }, { "b", "4" } };
+	m1.erase(std::string("abc"));
+
+	std::stringstream ss;
+	ss << m1;
+
+	stable_trie_map<char, std::string> m2;
+	ss >> m2;
+
+	BOOST_CHECK(to_map(m1) == to_map(m2));
+	BOOST_CHECK(m2.capacity() == 4);
+
+	m2.emplace(std::string("c"), "5");
+	BOOST_CHECK(m2.capacity() == 4);
+
+	trie_map<char, std::uint64_t> m3{ { "x", 0x0102030405060708u } };
+	std::stringstream ss2;
+	ss2 << m3;
+	trie_map<char, std::uint64_t> m4;
+	ss2 >> m4;
+	BOOST_CHECK(m4.at(std::string("x")) == 0x0102030405060708u);
+}
+
+BOOST_AUTO_TEST_CASE(trie_map_stress_1)
+{
+	using wordring::whatwg::encoding_cast;
+
+	std::ifstream is(japanese_words_path);
+	BOOST_REQUIRE(is.is_open());
+
+	std::vector<std::u32string> w;
+	std::string buf{};
+#ifdef NDEBUG
+	while (std::getline(is, buf)) if (!buf.empty()) w.push_back(encoding_cast<std::u32string>(buf));
+#else
+	for (size_t i = 0; i < 1000 && std::getline(is, buf); ++i) if (!buf.empty()) w.push_back(encoding_cast<std::u32string>(buf));
+#endif
+
+	std::map<std::u32string, std::size_t> expected;
+	wordring::trie_map<char32_t, std::size_t> m;
+	for (std::size_t i = 0; i < w.size(); ++i)
+	{
+		expected.emplace(w[i], i);
+		m.emplace(w[i], i);
+	}
+
+	std::mt19937 mt(1);
+	std::shuffle(w.begin(), w.end(), mt);
+	for (std::size_t i = 0; i < w.size() / 2; ++i)
+	{
+		expected.erase(w[i]);
+		m.erase(w[i]);
+	}
+
+	BOOST_CHECK(m.size() == expected.size());
+	BOOST_CHECK(to_map(m) == expected);
+
+	int e = 0;
+	for (auto const& pair : expected) if (m.at(pair.first) != pair.second) ++e;
+	BOOST_CHECK(e == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
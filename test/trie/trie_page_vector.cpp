@@ -0,0 +1,174 @@
+﻿// test/trie/trie_page_vector.cpp
+
+#include <boost/test/unit_test.hpp>
+
+#include <wordring/trie/stable_trie_base.hpp>
+#include <wordring/trie/trie.hpp>
+#include <wordring/trie/trie_page_vector.hpp>
+#include <wordring/trie/trie_view.hpp>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+	using wordring::detail::trie_node;
+
+	using page_allocator = wordring::detail::trie_page_allocator<trie_node>;
+	using page_vector    = wordring::detail::trie_page_vector<trie_node>;
+
+	template <typename Label>
+	using page_trie = wordring::trie<Label, page_allocator>;
+}
+
+BOOST_AUTO_TEST_SUITE(trie_page_vector__test)
+
+// ----------------------------------------------------------------------------
+// trie_heap_container
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(trie_heap_container__1)
+{
+	using namespace wordring;
+
+	static_assert(std::is_same_v<detail::trie_heap_container<std::allocator<trie_node>>::type, std::vector<trie_node>>);
+	static_assert(std::is_same_v<detail::trie_heap_container<page_allocator>::type, page_vector>);
+
+	// ノード配列以外へ再束縛すると、通常のアロケータとして働く
+	std::vector<std::uint64_t, std::allocator_traits<page_allocator>::rebind_alloc<std::uint64_t>> v(100, 1);
+	BOOST_CHECK(v.size() == 100);
+}
+
+// ----------------------------------------------------------------------------
+// trie_page_vector
+// ----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(trie_page_vector__construct__1)
+{
+	page_vector v1{};
+	BOOST_CHECK(v1.empty());
+	BOOST_CHECK(v1.capacity() == 0);
+
+	page_vector v2(2, { 0, 0 });
+	BOOST_CHECK(v2.size() == 2);
+	BOOST_CHECK((v2[1] == trie_node{ 0, 0 }));
+
+	page_vector v3{ { 1, 2 }, { 3, 4 } };
+	BOOST_CHECK(v3.size() == 2);
+	BOOST_CHECK((v3.front() == trie_node{ 1, 2 }));
+	BOOST_CHECK((v3.back() == trie_node{ 3, 4 }));
+
+	page_vector v4(v3);
+	BOOST_CHECK(v4 == v3);
+
+	page_vector v5(std::move(v4));
+	BOOST_CHECK(v5 == v3);
+	BOOST_CHECK(v4.empty());
+
+	v5 = { { 5, 6 } };
+	BOOST_CHECK(v5.size() == 1);
+	BOOST_CHECK(v5 != v3);
+}
+
+/*
+void push_back(value_type const& value)
+iterator insert(const_iterator pos, size_type n, value_type const& value)
+void resize(size_type n, value_type const& value)
+*/
+BOOST_AUTO_TEST_CASE(trie_page_vector__insert__1)
+{
+	page_vector v;
+	v.push_back({ 1, 1 });
+	v.push_back({ 3, 3 });
+	v.insert(v.begin() + 1, 2, { 2, 2 });
+	BOOST_CHECK(v.size() == 4);
+	BOOST_CHECK((v[1] == trie_node{ 2, 2 }));
+	BOOST_CHECK((v[2] == trie_node{ 2, 2 }));
+	BOOST_CHECK((v[3] == trie_node{ 3, 3 }));
+
+	v.resize(2);
+	BOOST_CHECK(v.size() == 2);
+	v.resize(3, { 9, 9 });
+	BOOST_CHECK((v.back() == trie_node{ 9, 9 }));
+
+	v.clear();
+	BOOST_CHECK(v.empty());
+	BOOST_CHECK(v.capacity() != 0);
+}
+
+/*
+2MiBを越えて伸長しても、要素は保たれ、先頭は2MiB境界に揃う
+*/
+BOOST_AUTO_TEST_CASE(trie_page_vector__reserve__1)
+{
+	page_vector v;
+	std::int32_t const n = 1'000'000;
+	for (std::int32_t i = 0; i < n; ++i) v.push_back({ i, -i });
+
+	int e = 0;
+	for (std::int32_t i = 0; i < n; ++i) if (!(v[i] == trie_node{ i, -i })) ++e;
+	BOOST_CHECK(e == 0);
+
+	BOOST_CHECK(n * sizeof(trie_node) <= v.capacity() * sizeof(trie_node));
+#if defined(__linux__)
+	BOOST_CHECK(reinterpret_cast<std::uintptr_t>(v.data()) % (2 * 1024 * 1024) == 0);
+#endif
+
+	page_vector v2;
+	v2.swap(v);
+	BOOST_CHECK(v.empty());
+	BOOST_CHECK(v2.size() == n);
+}
+
+// ----------------------------------------------------------------------------
+// trie_page_allocator
+// ----------------------------------------------------------------------------
+
+/*
+ノード配列の格納先を替えても、 std::allocator と同じTrie木が出来る
+*/
+BOOST_AUTO_TEST_CASE(trie_page_allocator__trie__1)
+{
+	using namespace wordring;
+
+	std::mt19937 mt;
+	std::vector<std::u32string> v;
+	for (int i = 0; i < 20000; ++i)
+	{
+		std::u32string s(mt() % 6 + 1, U'\0');
+		for (char32_t& ch : s) ch = U'あ' + mt() % 40;
+		v.push_back(s);
+	}
+
+	trie<char32_t> t1;
+	page_trie<char32_t> t2;
+	for (auto const& s : v)
+	{
+		t1.insert(s);
+		t2.insert(s);
+	}
+	for (std::size_t i = 0; i < v.size(); i += 3)
+	{
+		t1.erase(v[i]);
+		t2.erase(v[i]);
+	}
+
+	BOOST_CHECK(t1.size() == t2.size());
+	BOOST_CHECK(std::equal(t1.ibegin(), t1.iend(), t2.ibegin(), t2.iend()));
+
+	auto t3 = t2;
+	BOOST_CHECK(std::equal(t1.ibegin(), t1.iend(), t3.ibegin(), t3.iend()));
+
+	auto view = trie_view<char32_t>(t2);
+	int e = 0;
+	for (std::size_t i = 0; i < v.size(); ++i) if (view.contains(v[i]) != t1.contains(v[i])) ++e;
+	BOOST_CHECK(e == 0);
+
+	stable_trie<char32_t, page_allocator> t4(v.begin(), v.end());
+	BOOST_CHECK(t4.contains(v.front()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,317 @@
+﻿// test/trie/trie_view.cpp
+
+#include <boost/test/unit_test.hpp>
+
+#include <wordring/trie/trie.hpp>
+#include <wordring/trie/trie_view.hpp>
+#include <wordring/tree/tree_iterator.hpp>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#define STRING(str) #str
+#define TO_STRING(str) STRING(str)
+
+namespace
+{
+	std::string const current_binary_path{ TO_STRING(CURRENT_BINARY_PATH) };
+
+	template <typename View>
+	std::size_t count(View const& v)
+	{
+		using namespace wordring;
+		std::size_t n = 0;
+
+		auto it1 = tree_iterator<decltype(v.begin())>(v.begin());
+		auto it2 = tree_iterator<decltype(v.begin())>();
+
+		while (it1 != it2)
+		{
+			if (it1.base()) ++n;
+			++it1;
+		}
+
+		return n;
+	}
+
+	/*! 一括入出力形式のイメージを、ノードの境界に整列したバッファへ複写する
+	- 大きさは bytes で受け取り、バッファは余分に確保する。
+	*/
+	template <typename Trie>
+	std::vector<std::uint64_t> make_image(Trie const& t, std::size_t& bytes)
+	{
+		std::stringstream ss;
+		t.write(ss);
+		std::string s = ss.str();
+
+		std::vector<std::uint64_t> result(s.size() / sizeof(std::uint64_t) + 2);
+		std::memcpy(result.data(), s.data(), s.size());
+		bytes = s.size();
+
+		return result;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(trie_view_test)
+
+// basic_trie_view()
+BOOST_AUTO_TEST_CASE(trie_view_construct_1)
+{
+	using namespace wordring;
+
+	trie_view<char32_t> tv;
+
+	BOOST_CHECK(tv.empty());
+	BOOST_CHECK(tv.size() == 0);
+	BOOST_CHECK(tv.contains(std::u32string(U"あ")) == false);
+	BOOST_CHECK(tv.begin().begin() == tv.end());
+}
+
+// basic_trie_view(basic_trie<Label, Base1> const& trie)
+BOOST_AUTO_TEST_CASE(trie_view_construct_2)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	auto t = trie<char32_t>(v.begin(), v.end());
+
+	auto tv = trie_view<char32_t>(t);
+
+	BOOST_CHECK(tv.size() == 5);
+	BOOST_CHECK(count(tv) == 5);
+	for (auto const& s : v) BOOST_CHECK(tv.contains(s));
+
+	// Trieの種類が異なるビューは構築できない
+	static_assert(!std::is_constructible_v<trie_view<char32_t>, stable_trie<char32_t> const&>);
+	static_assert(!std::is_constructible_v<stable_trie_view<char32_t>, trie<char32_t> const&>);
+	static_assert(std::is_constructible_v<stable_trie_view<char32_t>, stable_trie<char32_t> const&>);
+}
+
+// basic_trie_view(node_type const* first, node_type const* last)
+BOOST_AUTO_TEST_CASE(trie_view_construct_3)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v{ "a", "ac", "b", "cab", "cd" };
+	auto t = trie<char>(v.begin(), v.end());
+
+	auto tv = trie_view<char>(t.data(), t.data() + t.node_size());
+
+	BOOST_CHECK(tv.size() == 5);
+	for (auto const& s : v) BOOST_CHECK(tv.contains(s));
+	BOOST_CHECK(tv.contains(std::string("c")) == false);
+}
+
+// basic_trie_view(void const* data, std::size_t bytes)
+BOOST_AUTO_TEST_CASE(trie_view_construct_4)
+{
+	using namespace wordring;
+
+	// ヘッダーの無いノード配列
+	std::vector<detail::trie_node> v{ { 0, 0 }, { 0, 0 } };
+	BOOST_CHECK_THROW(trie_view<char>(v.data(), sizeof(detail::trie_node)), std::invalid_argument);
+	BOOST_CHECK_THROW(trie_view<char>(v.data(), 3), std::invalid_argument);
+	BOOST_CHECK_THROW(trie_view<char>(v.data(), v.size() * sizeof(detail::trie_node)), std::invalid_argument);
+
+	std::vector<std::string> keys{ "a", "ac", "b", "cab", "cd" };
+	auto t = trie<char>(keys.begin(), keys.end());
+
+	std::size_t bytes = 0;
+	auto image = make_image(t, bytes);
+	char* p = reinterpret_cast<char*>(image.data());
+
+	auto tv = trie_view<char>(image.data(), bytes);
+	BOOST_CHECK(tv.size() == 5);
+	BOOST_CHECK(tv.node_size() == t.node_size());
+	for (auto const& s : keys) BOOST_CHECK(tv.contains(s));
+
+	// 途中で切れたイメージ、余分なバイトを持つイメージ
+	BOOST_CHECK_THROW(trie_view<char>(image.data(), bytes - sizeof(detail::trie_node)), std::invalid_argument);
+	BOOST_CHECK_THROW(trie_view<char>(image.data(), bytes - 1), std::invalid_argument);
+	BOOST_CHECK_THROW(trie_view<char>(image.data(), bytes + sizeof(detail::trie_node)), std::invalid_argument);
+	BOOST_CHECK_THROW(trie_view<char>(image.data(), detail::trie_image_header::size), std::invalid_argument);
+	BOOST_CHECK_THROW(trie_view<char>(image.data(), detail::trie_image_header::size - 1), std::invalid_argument);
+
+	// ラベルの大きさと、Trieの種類が異なる
+	BOOST_CHECK_THROW(trie_view<char16_t>(image.data(), bytes), std::invalid_argument);
+	BOOST_CHECK_THROW(stable_trie_view<char>(image.data(), bytes), std::invalid_argument);
+
+	// ヘッダーの破損
+	auto broken = [&](std::size_t offset, char ch)
+	{
+		char c = p[offset];
+		p[offset] = ch;
+		bool result = false;
+		try { trie_view<char>(image.data(), bytes); }
+		catch (std::invalid_argument const&) { result = true; }
+		p[offset] = c;
+		return result;
+	};
+	BOOST_CHECK(broken(0, 'X'));  // マジック
+	BOOST_CHECK(broken(7, '\r')); // 改行変換
+	BOOST_CHECK(broken(8, 2));    // 版
+	BOOST_CHECK(broken(11, 2));   // INDEXのバイト数
+	BOOST_CHECK(broken(16, 1));   // ノード数
+	BOOST_CHECK(broken(16, static_cast<char>(p[16] + 1)));
+
+	// ノード配列の整列
+	std::vector<std::uint64_t> shifted(image.size() + 1);
+	std::memcpy(reinterpret_cast<char*>(shifted.data()) + 1, image.data(), bytes);
+	BOOST_CHECK_THROW(trie_view<char>(reinterpret_cast<char*>(shifted.data()) + 1, bytes), std::invalid_argument);
+}
+
+// 他のINDEXのバイト数を持つイメージは参照できない
+BOOST_AUTO_TEST_CASE(trie_view_construct_5)
+{
+	using namespace wordring;
+
+	std::vector<std::string> keys{ "a", "ac", "b", "cab", "cd" };
+	auto t16 = trie<char, std::allocator<detail::trie_node16>>(keys.begin(), keys.end());
+	auto t64 = trie<char, std::allocator<detail::trie_node64>>(keys.begin(), keys.end());
+
+	std::size_t bytes = 0;
+	auto image16 = make_image(t16, bytes);
+	BOOST_CHECK_THROW(trie_view<char>(image16.data(), bytes), std::invalid_argument);
+
+	auto image64 = make_image(t64, bytes);
+	BOOST_CHECK_THROW(trie_view<char>(image64.data(), bytes), std::invalid_argument);
+}
+
+// stable_trie のイメージ
+BOOST_AUTO_TEST_CASE(stable_trie_view_construct_1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> keys{ "a", "ac", "b", "cab", "cd" };
+	stable_trie<char> t;
+	std::uint32_t i = 1;
+	for (auto const& s : keys) t.insert(s, i++);
+
+	std::size_t bytes = 0;
+	auto image = make_image(t, bytes);
+
+	auto tv = stable_trie_view<char>(image.data(), bytes);
+	BOOST_CHECK(tv.size() == 5);
+	BOOST_CHECK(tv.at(std::string("cab")) == 4);
+
+	BOOST_CHECK_THROW(trie_view<char>(image.data(), bytes), std::invalid_argument);
+}
+
+// value_type at(const_iterator pos) const
+// value_type at(Key const& key) const
+BOOST_AUTO_TEST_CASE(trie_view_at_1)
+{
+	using namespace wordring;
+
+	std::vector<std::u16string> v{ u"あ", u"あう", u"い", u"うあい", u"うえ" };
+	trie<char16_t> t;
+	std::uint32_t i = 1;
+	for (auto const& s : v) t.insert(s, i++);
+
+	auto tv = trie_view<char16_t>(t);
+
+	BOOST_CHECK(tv.at(tv.find(std::u16string(u"あ"))) == 1);
+	BOOST_CHECK(tv.at(std::u16string(u"あう")) == 2);
+	BOOST_CHECK(tv.at(std::u16string(u"うえ")) == 5);
+	BOOST_CHECK_THROW(tv.at(std::u16string(u"う")), std::out_of_range);
+}
+
+// auto lookup(InputIterator first, InputIterator last) const
+BOOST_AUTO_TEST_CASE(trie_view_lookup_1)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	auto t = trie<char32_t>(v.begin(), v.end());
+	auto tv = trie_view<char32_t>(t);
+
+	std::u32string s{ U"うい" };
+	auto pair = tv.lookup(s.begin(), s.end());
+
+	BOOST_CHECK(*pair.first == U'う');
+	BOOST_CHECK(*pair.second == U'い');
+}
+
+// const_iterator search(Key const& key) const
+// const_iterator find(Key const& key) const
+BOOST_AUTO_TEST_CASE(trie_view_search_1)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	auto t = trie<char32_t>(v.begin(), v.end());
+	auto tv = trie_view<char32_t>(t);
+
+	auto it = tv.search(std::u32string(U"うあ"));
+	BOOST_CHECK(!it);
+	BOOST_CHECK(*it == U'あ');
+
+	BOOST_CHECK(tv.find(std::u32string(U"うあ")) == tv.cend());
+	BOOST_CHECK(tv.find(std::u32string(U"うあい")) != tv.cend());
+
+	std::u32string s;
+	tv.find(std::u32string(U"うあい")).string(s);
+	BOOST_CHECK(s == U"うあい");
+}
+
+BOOST_AUTO_TEST_CASE(stable_trie_view_find_1)
+{
+	using namespace wordring;
+
+	std::vector<std::string> v{ "a", "ac", "b", "cab", "cd" };
+	stable_trie<char> t;
+	std::uint32_t i = 1;
+	for (auto const& s : v) t.insert(s, i++);
+
+	auto tv = stable_trie_view<char>(t);
+
+	BOOST_CHECK(tv.size() == 5);
+	BOOST_CHECK(count(tv) == 5);
+	BOOST_CHECK(tv.at(std::string("cab")) == 4);
+	BOOST_CHECK(tv.contains(std::string("ca")) == false);
+	BOOST_CHECK(tv.find(std::string("ac")) == tv.find(std::string("ac")));
+}
+
+// mmap されたファイル・イメージ上での検索
+BOOST_AUTO_TEST_CASE(trie_view_mmap_1)
+{
+	using namespace wordring;
+	namespace bip = boost::interprocess;
+
+	std::vector<std::u32string> v{ U"あ", U"あう", U"い", U"うあい", U"うえ" };
+	trie<char32_t> t;
+	std::uint32_t i = 1;
+	for (auto const& s : v) t.insert(s, i++);
+
+	auto path = std::filesystem::path(current_binary_path) / "trie_view_mmap_1.bin";
+	{
+		std::ofstream os(path, std::ios::binary);
+		BOOST_REQUIRE(os.is_open());
+		t.write(os);
+	}
+
+	{
+		bip::file_mapping fm(path.string().c_str(), bip::read_only);
+		bip::mapped_region mr(fm, bip::read_only);
+
+		auto tv = trie_view<char32_t>(mr.get_address(), mr.get_size());
+
+		BOOST_CHECK(tv.size() == 5);
+		i = 1;
+		for (auto const& s : v) BOOST_CHECK(tv.at(s) == i++);
+		BOOST_CHECK(tv.contains(std::u32string(U"う")) == false);
+	}
+
+	std::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,276 @@
+﻿// test/trie/weighted_trie.cpp
+
+#include <boost/test/unit_test.hpp>
+
+#include <wordring/trie/weighted_trie.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define STRING(str) #str
+#define TO_STRING(str) STRING(str)
+
+namespace
+{
+	std::string const english_words_path{ TO_STRING(ENGLISH_WORDS_PATH) };
+
+	template <typename Trie>
+	class test_weighted_trie : public Trie
+	{
+	public:
+		using base_type = Trie;
+
+		using base_type::begin;
+		using base_type::m_c;
+		using base_type::m_weight;
+
+	public:
+		/*! 全ノードの注釈を定義通りに計算し、格納されているものと比較する
+		*/
+		bool verify() const
+		{
+			std::vector<std::uint32_t> w(m_c.size(), 0);
+			bool result = true;
+			verify(begin(), w, result);
+			return result;
+		}
+
+		std::uint32_t verify(typename base_type::const_iterator it, std::vector<std::uint32_t>& w, bool& result) const
+		{
+			std::uint32_t max = it ? static_cast<std::uint32_t>(this->at(it)) : 0;
+			for (auto it1 = it.begin(); it1 != it.end(); ++it1) max = std::max(max, verify(it1, w, result));
+
+			if (this->weight(it) != max) result = false;
+			return max;
+		}
+	};
+
+	/*! 全走査で上位 k 件の重みを求める
+	*/
+	template <typename Trie, typename String>
+	std::vector<std::uint32_t> brute_force(Trie const& t, std::vector<String> const& keys, String const& prefix, std::size_t k)
+	{
+		std::vector<std::uint32_t> result;
+		for (auto const& s : keys)
+		{
+			if (s.compare(0, prefix.size(), prefix) == 0 && t.contains(s)) result.push_back(t.at(s));
+		}
+		std::sort(result.begin(), result.end(), std::greater<std::uint32_t>());
+		if (k < result.size()) result.resize(k);
+
+		return result;
+	}
+
+	template <typename Pairs>
+	std::vector<std::uint32_t> weights(Pairs const& v)
+	{
+		std::vector<std::uint32_t> result;
+		for (auto const& pair : v) result.push_back(pair.second);
+		return result;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(weighted_trie_test)
+
+// top_k()
+BOOST_AUTO_TEST_CASE(weighted_trie__top_k__1)
+{
+	using namespace wordring;
+
+	auto t = weighted_trie<char>();
+	t.insert(std::string("apple"), 5);
+	t.insert(std::string("apply"), 9);
+	t.insert(std::string("ape"), 7);
+	t.insert(std::string("ap"), 1);
+	t.insert(std::string("banana"), 20);
+
+	std::vector<std::pair<weighted_trie<char>::const_iterator, std::uint32_t>> v;
+	t.top_k(std::string("ap"), 3, std::back_inserter(v));
+
+	BOOST_REQUIRE(v.size() == 3);
+	std::string s;
+	v[0].first.string(s);
+	BOOST_CHECK(s == "apply" && v[0].second == 9);
+	v[1].first.string(s);
+	BOOST_CHECK(s == "ape" && v[1].second == 7);
+	v[2].first.string(s);
+	BOOST_CHECK(s == "apple" && v[2].second == 5);
+
+	v.clear();
+	t.top_k(std::string(""), 10, std::back_inserter(v));
+	BOOST_CHECK(v.size() == 5);
+	BOOST_CHECK(v.front().second == 20);
+
+	v.clear();
+	t.top_k(std::string("x"), 10, std::back_inserter(v));
+	BOOST_CHECK(v.empty());
+
+	BOOST_CHECK(t.weight(t.search(std::string("a"))) == 9);
+	BOOST_CHECK(t.weight(t.begin()) == 20);
+}
+
+BOOST_AUTO_TEST_CASE(weighted_trie__top_k__2)
+{
+	using namespace wordring;
+
+	std::vector<std::u32string> keys{ U"あい", U"あいう", U"あえ", U"いう", U"あ" };
+	auto t = stable_weighted_trie<char32_t>();
+	std::uint32_t i = 1;
+	for (auto const& s : keys) t.insert(s, i++);
+
+	std::vector<std::pair<stable_weighted_trie<char32_t>::const_iterator, std::uint32_t>> v;
+	t.top_k(std::u32string(U"あ"), 2, std::back_inserter(v));
+
+	BOOST_REQUIRE(v.size() == 2);
+	std::u32string s;
+	v[0].first.string(s);
+	BOOST_CHECK(s == U"あ" && v[0].second == 5);
+	v[1].first.string(s);
+	BOOST_CHECK(s == U"あえ" && v[1].second == 3);
+}
+
+// insert(), erase(), at()
+BOOST_AUTO_TEST_CASE(weighted_trie__update__1)
+{
+	using namespace wordring;
+
+	auto t = test_weighted_trie<weighted_trie<char>>();
+	t.insert(std::string("ab"), 3);
+	t.insert(std::string("abc"), 8);
+	t.insert(std::string("abd"), 5);
+	BOOST_CHECK(t.verify());
+	BOOST_CHECK(t.weight(t.search(std::string("ab"))) == 8);
+
+	// 値を下げると祖先の注釈も下がる
+	t.at(std::string("abc")) = 1;
+	BOOST_CHECK(t.verify());
+	BOOST_CHECK(t.weight(t.search(std::string("ab"))) == 5);
+
+	t[std::string("a")] = 10;
+	BOOST_CHECK(t.verify());
+	BOOST_CHECK(t.weight(t.begin()) == 10);
+
+	t.erase(std::string("abd"));
+	BOOST_CHECK(t.verify());
+	BOOST_CHECK(t.weight(t.search(std::string("ab"))) == 3);
+
+	t.erase(std::string("a"));
+	BOOST_CHECK(t.verify());
+	BOOST_CHECK(t.weight(t.begin()) == 3);
+}
+
+// INDEX の幅が異なるノード
+BOOST_AUTO_TEST_CASE(weighted_trie__update__2)
+{
+	using namespace wordring;
+
+	auto t1 = test_weighted_trie<weighted_trie<char, std::allocator<detail::trie_node16>>>();
+	t1.insert(std::string("ab"), 3);
+	t1.insert(std::string("abc"), 8);
+	t1[std::string("abc")] = 32767;
+	BOOST_CHECK(t1.verify());
+	BOOST_CHECK(t1.weight(t1.search(std::string("ab"))) == 32767);
+
+	// 葉の値は INDEX の型で表せる範囲に限られる
+	BOOST_CHECK_THROW(t1[std::string("abc")] = 70000u, std::length_error);
+	BOOST_CHECK(t1.at(std::string("abc")) == 32767);
+	BOOST_CHECK(t1.verify());
+
+	auto t2 = test_weighted_trie<weighted_trie<char, std::allocator<detail::trie_node64>>>();
+	t2.insert(std::string("ab"), 3);
+	t2.insert(std::string("abc"), 8);
+	t2[std::string("abc")] = 4000000000u;
+	BOOST_CHECK(t2.verify());
+	BOOST_CHECK(t2.at(std::string("abc")) == 4000000000);
+	BOOST_CHECK(t2.weight(t2.search(std::string("ab"))) == 4000000000u);
+}
+
+// compact()
+BOOST_AUTO_TEST_CASE(weighted_trie__compact__1)
+{
+	using namespace wordring;
+
+	auto t = test_weighted_trie<weighted_trie<char>>();
+	for (int i = 0; i < 100; ++i) t.insert(std::to_string(i * 7919), i);
+	for (int i = 0; i < 100; i += 3) t.erase(std::to_string(i * 7919));
+
+	t.compact();
+	BOOST_CHECK(t.verify());
+	BOOST_CHECK(t.weight(t.begin()) == 98);
+}
+
+// operator<<, operator>>
+BOOST_AUTO_TEST_CASE(weighted_trie__stream__1)
+{
+	using namespace wordring;
+
+	auto t1 = weighted_trie<char16_t>();
+	t1.insert(std::u16string(u"あい"), 4);
+	t1.insert(std::u16string(u"あう"), 6);
+
+	std::stringstream ss;
+	ss << t1;
+
+	auto t2 = test_weighted_trie<weighted_trie<char16_t>>();
+	ss >> t2;
+
+	BOOST_CHECK(t2.verify());
+	BOOST_CHECK(t2.weight(t2.search(std::u16string(u"あ"))) == 6);
+}
+
+BOOST_AUTO_TEST_CASE(weighted_trie__stress__1)
+{
+	std::ifstream is(english_words_path);
+	BOOST_REQUIRE(is.is_open());
+
+	std::vector<std::string> w;
+	std::string buf{};
+	for (size_t i = 0; i < 3000 && std::getline(is, buf); ++i) if (!buf.empty()) w.push_back(buf);
+
+	std::mt19937 mt;
+	std::shuffle(w.begin(), w.end(), mt);
+
+	// 無作為な順に挿入すると衝突によってノードが移動する
+	auto t = test_weighted_trie<wordring::weighted_trie<char>>();
+	for (auto const& s : w) t.insert(s, mt() % 100000);
+	BOOST_CHECK(t.verify());
+
+	// 一括構築したものと注釈が一致する
+	auto t2 = test_weighted_trie<wordring::weighted_trie<char>>();
+	auto v = w;
+	std::sort(v.begin(), v.end());
+	v.erase(std::unique(v.begin(), v.end()), v.end());
+	t2.assign(v.begin(), v.end());
+	for (auto const& s : v) t2.at(s) = static_cast<std::int32_t>(t.at(s));
+	BOOST_CHECK(t2.verify());
+
+	int e = 0;
+	for (std::string prefix : { "", "a", "b", "co", "str", "zz" })
+	{
+		std::vector<std::pair<wordring::weighted_trie<char>::const_iterator, std::uint32_t>> r;
+		t.top_k(prefix, 10, std::back_inserter(r));
+		if (weights(r) != brute_force(t, w, prefix, 10)) ++e;
+	}
+	BOOST_CHECK(e == 0);
+
+	// 半分を削除する
+	for (std::size_t i = 0; i < w.size(); i += 2) t.erase(w[i]);
+	BOOST_CHECK(t.verify());
+
+	e = 0;
+	for (std::string prefix : { "", "a", "b", "co", "str" })
+	{
+		std::vector<std::pair<wordring::weighted_trie<char>::const_iterator, std::uint32_t>> r;
+		t.top_k(prefix, 10, std::back_inserter(r));
+		if (weights(r) != brute_force(t, w, prefix, 10)) ++e;
+	}
+	BOOST_CHECK(e == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()